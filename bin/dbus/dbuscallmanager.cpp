@@ -137,6 +137,15 @@ DBusCallManager::getCallDetails(const std::string& accountId, const std::string&
     return DRing::getCallDetails(accountId, callId);
 }
 
+auto
+DBusCallManager::getCallsDetails(const std::string& accountId,
+                                 const std::vector<std::string>& callIds,
+                                 const std::vector<std::string>& fields)
+    -> decltype(DRing::getCallsDetails(accountId, callIds, fields))
+{
+    return DRing::getCallsDetails(accountId, callIds, fields);
+}
+
 auto
 DBusCallManager::getCallList(const std::string& accountId)
     -> decltype(DRing::getCallList(accountId))
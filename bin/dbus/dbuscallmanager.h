@@ -84,6 +84,10 @@ public:
                           const std::string& targetID);
     std::map<std::string, std::string> getCallDetails(const std::string& accountId,
                                                       const std::string& callId);
+    std::vector<std::map<std::string, std::string>> getCallsDetails(
+        const std::string& accountId,
+        const std::vector<std::string>& callIds,
+        const std::vector<std::string>& fields);
     std::vector<std::string> getCallList(const std::string& accountId);
     std::vector<std::map<std::string, std::string>> getConferenceInfos(const std::string& accountId,
                                                                        const std::string& confId);
@@ -263,6 +263,10 @@ DBusClient::initLibrary(int flags)
             bind(&DBusConfigurationManager::hardwareEncodingChanged, confM, _1)),
         exportable_callback<ConfigurationSignal::MessageSend>(
             bind(&DBusConfigurationManager::messageSend, confM, _1)),
+        exportable_callback<ConfigurationSignal::PluginInstallationProgress>(
+            bind(&DBusConfigurationManager::pluginInstallationProgress, confM, _1, _2, _3)),
+        exportable_callback<ConfigurationSignal::PluginInstallationFinished>(
+            bind(&DBusConfigurationManager::pluginInstallationFinished, confM, _1, _2, _3)),
     };
 
     // Presence event handlers
@@ -295,6 +299,8 @@ DBusClient::initLibrary(int flags)
     const std::map<std::string, SharedCallback> convEvHandlers = {
         exportable_callback<ConversationSignal::ConversationLoaded>(
             bind(&DBusConfigurationManager::conversationLoaded, confM, _1, _2, _3, _4)),
+        exportable_callback<ConversationSignal::ConversationMessagesPage>(
+            bind(&DBusConfigurationManager::conversationMessagesPage, confM, _1, _2, _3, _4, _5)),
         exportable_callback<ConversationSignal::MessageReceived>(
             bind(&DBusConfigurationManager::messageReceived, confM, _1, _2, _3)),
         exportable_callback<ConversationSignal::ConversationRequestReceived>(
@@ -34,6 +34,14 @@ DBusConfigurationManager::getAccountDetails(const std::string& accountID)
     return DRing::getAccountDetails(accountID);
 }
 
+auto
+DBusConfigurationManager::getAccountsDetails(const std::vector<std::string>& accountIDs,
+                                             const std::vector<std::string>& fields)
+    -> decltype(DRing::getAccountsDetails(accountIDs, fields))
+{
+    return DRing::getAccountsDetails(accountIDs, fields);
+}
+
 auto
 DBusConfigurationManager::getVolatileAccountDetails(const std::string& accountID)
     -> decltype(DRing::getVolatileAccountDetails(accountID))
@@ -74,6 +82,38 @@ DBusConfigurationManager::monitor(const bool& continuous) -> decltype(DRing::mon
     return DRing::monitor(continuous);
 }
 
+auto
+DBusConfigurationManager::getCpuAccounting() -> decltype(DRing::getCpuAccounting())
+{
+    return DRing::getCpuAccounting();
+}
+
+void
+DBusConfigurationManager::setCpuAccountingDump(const std::string& path,
+                                               const int32_t& periodSeconds)
+{
+    DRing::setCpuAccountingDump(path, periodSeconds);
+}
+
+auto
+DBusConfigurationManager::getMemoryUsage() -> decltype(DRing::getMemoryUsage())
+{
+    return DRing::getMemoryUsage();
+}
+
+void
+DBusConfigurationManager::setMemorySoftLimits(const std::map<std::string, std::string>& limits)
+{
+    DRing::setMemorySoftLimits(limits);
+}
+
+auto
+DBusConfigurationManager::getAccountActivity(const std::string& accountID)
+    -> decltype(DRing::getAccountActivity(accountID))
+{
+    return DRing::getAccountActivity(accountID);
+}
+
 auto
 DBusConfigurationManager::exportOnRing(const std::string& accountID, const std::string& password)
     -> decltype(DRing::exportOnRing(accountID, password))
@@ -674,6 +714,15 @@ DBusConfigurationManager::getContactDetails(const std::string& accountId, const
     return DRing::getContactDetails(accountId, uri);
 }
 
+auto
+DBusConfigurationManager::getContactsDetails(const std::string& accountId,
+                                             const std::vector<std::string>& uris,
+                                             const std::vector<std::string>& fields)
+    -> decltype(DRing::getContactsDetails(accountId, uris, fields))
+{
+    return DRing::getContactsDetails(accountId, uris, fields);
+}
+
 auto
 DBusConfigurationManager::getContacts(const std::string& accountId)
     -> decltype(DRing::getContacts(accountId))
@@ -864,6 +913,12 @@ DBusConfigurationManager::getConversationRequests(const std::string& accountId)
     return DRing::getConversationRequests(accountId);
 }
 
+std::vector<std::map<std::string, std::string>>
+DBusConfigurationManager::getConversationSummaries(const std::string& accountId)
+{
+    return DRing::getConversationSummaries(accountId);
+}
+
 void
 DBusConfigurationManager::updateConversationInfos(const std::string& accountId,
                                                   const std::string& conversationId,
@@ -879,6 +934,14 @@ DBusConfigurationManager::conversationInfos(const std::string& accountId,
     return DRing::conversationInfos(accountId, conversationId);
 }
 
+std::vector<std::map<std::string, std::string>>
+DBusConfigurationManager::conversationsInfos(const std::string& accountId,
+                                             const std::vector<std::string>& conversationIds,
+                                             const std::vector<std::string>& fields)
+{
+    return DRing::conversationsInfos(accountId, conversationIds, fields);
+}
+
 void
 DBusConfigurationManager::addConversationMember(const std::string& accountId,
                                                 const std::string& conversationId,
@@ -902,6 +965,13 @@ DBusConfigurationManager::getConversationMembers(const std::string& accountId,
     return DRing::getConversationMembers(accountId, conversationId);
 }
 
+std::vector<std::map<std::string, std::string>>
+DBusConfigurationManager::getConversationsMembers(const std::string& accountId,
+                                                  const std::vector<std::string>& conversationIds)
+{
+    return DRing::getConversationsMembers(accountId, conversationIds);
+}
+
 void
 DBusConfigurationManager::sendMessage(const std::string& accountId,
                                       const std::string& conversationId,
@@ -920,6 +990,22 @@ DBusConfigurationManager::loadConversationMessages(const std::string& accountId,
     return DRing::loadConversationMessages(accountId, conversationId, fromMessage, n);
 }
 
+uint32_t
+DBusConfigurationManager::loadConversationMessagesPaged(const std::string& accountId,
+                                                        const std::string& conversationId,
+                                                        const std::string& fromMessage,
+                                                        const uint32_t& pageSize)
+{
+    return DRing::loadConversationMessagesPaged(accountId, conversationId, fromMessage, pageSize);
+}
+
+bool
+DBusConfigurationManager::cancelLoadConversationMessages(const std::string& accountId,
+                                                         const uint32_t& id)
+{
+    return DRing::cancelLoadConversationMessages(accountId, id);
+}
+
 uint32_t
 DBusConfigurationManager::countInteractions(const std::string& accountId,
                                             const std::string& conversationId,
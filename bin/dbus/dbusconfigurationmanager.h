@@ -73,12 +73,19 @@ public:
 
     // Methods
     std::map<std::string, std::string> getAccountDetails(const std::string& accountID);
+    std::vector<std::map<std::string, std::string>> getAccountsDetails(
+        const std::vector<std::string>& accountIDs, const std::vector<std::string>& fields);
     std::map<std::string, std::string> getVolatileAccountDetails(const std::string& accountID);
     void setAccountDetails(const std::string& accountID,
                            const std::map<std::string, std::string>& details);
     void setAccountActive(const std::string& accountID, const bool& active);
     std::map<std::string, std::string> getAccountTemplate(const std::string& accountType);
     void monitor(const bool& continuous);
+    std::vector<std::map<std::string, std::string>> getCpuAccounting();
+    void setCpuAccountingDump(const std::string& path, const int32_t& periodSeconds);
+    std::map<std::string, std::string> getMemoryUsage();
+    void setMemorySoftLimits(const std::map<std::string, std::string>& limits);
+    std::map<std::string, std::string> getAccountActivity(const std::string& accountID);
     std::string addAccount(const std::map<std::string, std::string>& details);
     bool exportOnRing(const std::string& accountID, const std::string& password);
     bool exportToFile(const std::string& accountID,
@@ -211,6 +218,10 @@ public:
     void removeContact(const std::string& accountId, const std::string& uri, const bool& ban);
     std::map<std::string, std::string> getContactDetails(const std::string& accountId,
                                                          const std::string& uri);
+    std::vector<std::map<std::string, std::string>> getContactsDetails(
+        const std::string& accountId,
+        const std::vector<std::string>& uris,
+        const std::vector<std::string>& fields);
     std::vector<std::map<std::string, std::string>> getContacts(const std::string& accountId);
     void connectivityChanged();
     void sendFileLegacy(const RingDBusDataTransferInfo& info,
@@ -260,11 +271,17 @@ public:
     std::vector<std::string> getConversations(const std::string& accountId);
     std::vector<std::map<std::string, std::string>> getConversationRequests(
         const std::string& accountId);
+    std::vector<std::map<std::string, std::string>> getConversationSummaries(
+        const std::string& accountId);
     void updateConversationInfos(const std::string& accountId,
                                  const std::string& conversationId,
                                  const std::map<std::string, std::string>& infos);
     std::map<std::string, std::string> conversationInfos(const std::string& accountId,
                                                          const std::string& conversationId);
+    std::vector<std::map<std::string, std::string>> conversationsInfos(
+        const std::string& accountId,
+        const std::vector<std::string>& conversationIds,
+        const std::vector<std::string>& fields);
     void addConversationMember(const std::string& accountId,
                                const std::string& conversationId,
                                const std::string& contactUri);
@@ -273,6 +290,8 @@ public:
                                   const std::string& contactUri);
     std::vector<std::map<std::string, std::string>> getConversationMembers(
         const std::string& accountId, const std::string& conversationId);
+    std::vector<std::map<std::string, std::string>> getConversationsMembers(
+        const std::string& accountId, const std::vector<std::string>& conversationIds);
     void sendMessage(const std::string& accountId,
                      const std::string& conversationId,
                      const std::string& message,
@@ -281,6 +300,11 @@ public:
                                       const std::string& conversationId,
                                       const std::string& fromMessage,
                                       const uint32_t& n);
+    uint32_t loadConversationMessagesPaged(const std::string& accountId,
+                                           const std::string& conversationId,
+                                           const std::string& fromMessage,
+                                           const uint32_t& pageSize);
+    bool cancelLoadConversationMessages(const std::string& accountId, const uint32_t& id);
     uint32_t countInteractions(const std::string& accountId,
                                const std::string& conversationId,
                                const std::string& toId,
@@ -87,6 +87,12 @@ DBusPluginManagerInterface::installPlugin(const std::string& jplPath, const bool
     return DRing::installPlugin(jplPath, force);
 }
 
+void
+DBusPluginManagerInterface::installPluginAsync(const std::string& jplPath, const bool& force)
+{
+    DRing::installPluginAsync(jplPath, force);
+}
+
 int
 DBusPluginManagerInterface::uninstallPlugin(const std::string& pluginRootPath)
 {
@@ -134,6 +140,19 @@ DBusPluginManagerInterface::getCallMediaHandlerStatus(const std::string& callId)
     return DRing::getCallMediaHandlerStatus(callId);
 }
 
+std::vector<std::map<std::string, std::string>>
+DBusPluginManagerInterface::getCallMediaHandlerStats(const std::string& callId)
+{
+    return DRing::getCallMediaHandlerStats(callId);
+}
+
+void
+DBusPluginManagerInterface::setCallMediaHandlerLatencyBudget(const std::string& mediaHandlerId,
+                                                             const int32_t& budgetMs)
+{
+    DRing::setCallMediaHandlerLatencyBudget(mediaHandlerId, budgetMs);
+}
+
 std::map<std::string, std::string>
 DBusPluginManagerInterface::getChatHandlerDetails(const std::string& chatHanlderId)
 {
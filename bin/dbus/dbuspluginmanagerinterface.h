@@ -64,6 +64,7 @@ public:
     std::vector<std::string> getInstalledPlugins();
     std::vector<std::string> getLoadedPlugins();
     int installPlugin(const std::string& jplPath, const bool& force);
+    void installPluginAsync(const std::string& jplPath, const bool& force);
     int uninstallPlugin(const std::string& pluginRootPath);
     std::vector<std::string> getCallMediaHandlers();
     std::vector<std::string> getChatHandlers();
@@ -76,6 +77,10 @@ public:
                            const bool& toggle);
     std::map<std::string, std::string> getCallMediaHandlerDetails(const std::string& mediaHandlerId);
     std::vector<std::string> getCallMediaHandlerStatus(const std::string& callId);
+    std::vector<std::map<std::string, std::string>> getCallMediaHandlerStats(
+        const std::string& callId);
+    void setCallMediaHandlerLatencyBudget(const std::string& mediaHandlerId,
+                                          const int32_t& budgetMs);
     std::map<std::string, std::string> getChatHandlerDetails(const std::string& chatHandlerId);
     std::vector<std::string> getChatHandlerStatus(const std::string& accontId,
                                                   const std::string& peerId);
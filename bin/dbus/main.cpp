@@ -22,6 +22,7 @@
  */
 
 #include "dbusclient.h"
+#include "../ipc/ipcclient.h"
 #include "jami.h"
 
 #include <signal.h>
@@ -35,6 +36,9 @@
 
 static int ringFlags = 0;
 static std::weak_ptr<DBusClient> weakClient;
+static std::weak_ptr<IpcClient> weakIpcClient;
+static bool useIpc = false;
+static std::string ipcPath;
 
 static void
 print_title()
@@ -60,6 +64,7 @@ print_usage()
     "-d, --debug \t- Debug mode (more verbose)" << std::endl <<
     "-p, --persistent \t- Stay alive after client quits" << std::endl <<
     "--auto-answer \t- Force automatic answer to incoming calls" << std::endl <<
+    "--ipc[=path] \t- Serve the local IPC socket instead of D-Bus" << std::endl <<
     "-h, --help \t- Print help" << std::endl;
 }
 
@@ -83,6 +88,7 @@ parse_args(int argc, char *argv[], bool& persistent)
         {"help",        no_argument,        nullptr,    'h'},
         {"version",     no_argument,        nullptr,    'v'},
         {"auto-answer", no_argument,        &autoAnswer, true},
+        {"ipc",         optional_argument,  nullptr,    'i'},
         {nullptr,       0,                  nullptr,     0} /* Sentinel */
     };
 
@@ -118,6 +124,12 @@ parse_args(int argc, char *argv[], bool& persistent)
                 versionFlag = true;
                 break;
 
+            case 'i':
+                useIpc = true;
+                if (optarg)
+                    ipcPath = optarg;
+                break;
+
             default:
                 break;
         }
@@ -159,6 +171,8 @@ signal_handler(int code)
     // Interrupt the process
     if (auto client = weakClient.lock())
         client->exit();
+    if (auto client = weakIpcClient.lock())
+        client->exit();
 }
 
 int
@@ -178,6 +192,11 @@ main(int argc, char *argv [])
     signal(SIGPIPE, SIG_IGN);
 
     try {
+        if (useIpc) {
+            auto client = std::make_shared<IpcClient>(ringFlags, persistent, ipcPath);
+            weakIpcClient = client;
+            return client->event_loop();
+        }
         if (auto client = std::make_shared<DBusClient>(ringFlags, persistent))
         {
             weakClient = client;
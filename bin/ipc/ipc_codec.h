@@ -0,0 +1,285 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Binary encoding of the local IPC (see ipcserver.h).
+ *
+ * A frame is a 32 bits little endian body size, followed by the body: one byte
+ * for the kind of frame, then its values. Values have no type tag, both sides
+ * know the signature of the methods and signals:
+ * - integers and enums are varints (zigzag for signed ones), bool is one byte;
+ * - float and double are little endian IEEE 754;
+ * - strings and byte vectors are a varint size followed by the bytes;
+ * - vectors and maps are a varint count followed by their elements.
+ */
+
+enum class IpcFrame : uint8_t {
+    Request = 1,   ///< client: varint id, method name, arguments
+    Reply = 2,     ///< server: varint id, status byte (0: ok), result or error message
+    Signal = 3,    ///< server: signal name, arguments
+    Subscribe = 4, ///< client: names of the signals to receive, all of them if empty
+};
+
+static constexpr std::size_t IPC_FRAME_HEADER {4};
+
+class IpcEncoder
+{
+public:
+    explicit IpcEncoder(std::vector<uint8_t>& out)
+        : out_(out)
+    {}
+
+    /** Start a frame, its size is written by end() */
+    void begin(IpcFrame kind)
+    {
+        start_ = out_.size();
+        out_.resize(start_ + IPC_FRAME_HEADER);
+        out_.push_back(static_cast<uint8_t>(kind));
+    }
+
+    void end()
+    {
+        uint32_t size = out_.size() - start_ - IPC_FRAME_HEADER;
+        for (unsigned i = 0; i < IPC_FRAME_HEADER; ++i)
+            out_[start_ + i] = size >> (8 * i);
+    }
+
+    void varint(uint64_t v)
+    {
+        while (v >= 0x80) {
+            out_.push_back(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        out_.push_back(static_cast<uint8_t>(v));
+    }
+
+    void bytes(const void* data, std::size_t size)
+    {
+        varint(size);
+        auto p = static_cast<const uint8_t*>(data);
+        out_.insert(out_.end(), p, p + size);
+    }
+
+    IpcEncoder& operator<<(bool v)
+    {
+        out_.push_back(v ? 1 : 0);
+        return *this;
+    }
+
+    template<typename T, typename std::enable_if_t<std::is_integral<T>::value>* = nullptr>
+    IpcEncoder& operator<<(T v)
+    {
+        if (std::is_signed<T>::value)
+            varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(int64_t(v) >> 63));
+        else
+            varint(v);
+        return *this;
+    }
+
+    template<typename T, typename std::enable_if_t<std::is_enum<T>::value>* = nullptr>
+    IpcEncoder& operator<<(T v)
+    {
+        return *this << static_cast<std::underlying_type_t<T>>(v);
+    }
+
+    IpcEncoder& operator<<(double v) { return fixed(v); }
+    IpcEncoder& operator<<(float v) { return fixed(v); }
+
+    IpcEncoder& operator<<(const std::string& v)
+    {
+        bytes(v.data(), v.size());
+        return *this;
+    }
+
+    IpcEncoder& operator<<(const char* v)
+    {
+        bytes(v, std::strlen(v));
+        return *this;
+    }
+
+    IpcEncoder& operator<<(const std::vector<uint8_t>& v)
+    {
+        bytes(v.data(), v.size());
+        return *this;
+    }
+
+    template<typename T>
+    IpcEncoder& operator<<(const std::vector<T>& v)
+    {
+        varint(v.size());
+        for (const auto& e : v)
+            *this << e;
+        return *this;
+    }
+
+    template<typename K, typename V>
+    IpcEncoder& operator<<(const std::map<K, V>& v)
+    {
+        varint(v.size());
+        for (const auto& e : v)
+            *this << e.first << e.second;
+        return *this;
+    }
+
+private:
+    template<typename T>
+    IpcEncoder& fixed(T v)
+    {
+        uint8_t b[sizeof(T)];
+        std::memcpy(b, &v, sizeof(T));
+        out_.insert(out_.end(), b, b + sizeof(T));
+        return *this;
+    }
+
+    std::vector<uint8_t>& out_;
+    std::size_t start_ {0};
+};
+
+class IpcDecoder
+{
+public:
+    IpcDecoder(const uint8_t* data, std::size_t size)
+        : p_(data)
+        , end_(data + size)
+    {}
+
+    bool empty() const { return p_ == end_; }
+
+    uint64_t varint()
+    {
+        uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            auto b = byte();
+            v |= uint64_t(b & 0x7f) << shift;
+            if (not(b & 0x80))
+                return v;
+        }
+        throw std::runtime_error("Invalid varint");
+    }
+
+    IpcDecoder& operator>>(bool& v)
+    {
+        v = byte() != 0;
+        return *this;
+    }
+
+    template<typename T, typename std::enable_if_t<std::is_integral<T>::value>* = nullptr>
+    IpcDecoder& operator>>(T& v)
+    {
+        auto u = varint();
+        if (std::is_signed<T>::value)
+            v = static_cast<T>(static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1));
+        else
+            v = static_cast<T>(u);
+        return *this;
+    }
+
+    template<typename T, typename std::enable_if_t<std::is_enum<T>::value>* = nullptr>
+    IpcDecoder& operator>>(T& v)
+    {
+        std::underlying_type_t<T> u;
+        *this >> u;
+        v = static_cast<T>(u);
+        return *this;
+    }
+
+    IpcDecoder& operator>>(double& v) { return fixed(v); }
+    IpcDecoder& operator>>(float& v) { return fixed(v); }
+
+    IpcDecoder& operator>>(std::string& v)
+    {
+        auto size = count(1);
+        v.assign(reinterpret_cast<const char*>(p_), size);
+        p_ += size;
+        return *this;
+    }
+
+    IpcDecoder& operator>>(std::vector<uint8_t>& v)
+    {
+        auto size = count(1);
+        v.assign(p_, p_ + size);
+        p_ += size;
+        return *this;
+    }
+
+    template<typename T>
+    IpcDecoder& operator>>(std::vector<T>& v)
+    {
+        auto size = count(1);
+        v.clear();
+        v.reserve(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            v.emplace_back();
+            *this >> v.back();
+        }
+        return *this;
+    }
+
+    template<typename K, typename V>
+    IpcDecoder& operator>>(std::map<K, V>& v)
+    {
+        auto size = count(2);
+        v.clear();
+        for (std::size_t i = 0; i < size; ++i) {
+            K key;
+            *this >> key;
+            *this >> v[std::move(key)];
+        }
+        return *this;
+    }
+
+private:
+    uint8_t byte()
+    {
+        if (p_ == end_)
+            throw std::runtime_error("Truncated frame");
+        return *p_++;
+    }
+
+    // Element count, checked against the remaining size (elements take at least minSize)
+    std::size_t count(std::size_t minSize)
+    {
+        auto n = varint();
+        if (n > std::size_t(end_ - p_) / minSize)
+            throw std::runtime_error("Truncated frame");
+        return n;
+    }
+
+    template<typename T>
+    IpcDecoder& fixed(T& v)
+    {
+        if (std::size_t(end_ - p_) < sizeof(T))
+            throw std::runtime_error("Truncated frame");
+        std::memcpy(&v, p_, sizeof(T));
+        p_ += sizeof(T);
+        return *this;
+    }
+
+    const uint8_t* p_;
+    const uint8_t* end_;
+};
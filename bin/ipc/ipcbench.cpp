@@ -0,0 +1,169 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+/*
+ * Compare the cost of a signal with a large payload (a page of conversation
+ * messages, as ConversationLoaded) on the local IPC and on D-Bus.
+ *
+ * The IPC side goes through the socket: encoding, batching, write, read and
+ * decoding by a client thread. The D-Bus side only marshals and demarshals the
+ * message with dbus-c++, without the bus daemon hop, so it is a lower bound of
+ * the D-Bus cost.
+ */
+
+#include "ipcserver.h"
+
+#include <dbus-c++/dbus.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+using clock_type = std::chrono::steady_clock;
+using Messages = std::vector<std::map<std::string, std::string>>;
+
+static Messages
+makePage(unsigned count)
+{
+    Messages page;
+    for (unsigned i = 0; i < count; ++i)
+        page.push_back({{"id", std::to_string(0x1000000 + i)},
+                        {"author", "f2c815f5554bcc22689ce84d45aefdda1bce9146"},
+                        {"timestamp", "1650000000"},
+                        {"type", "text/plain"},
+                        {"body", std::string(120, 'm')}});
+    return page;
+}
+
+static bool
+readFull(int fd, uint8_t* data, std::size_t size)
+{
+    while (size) {
+        auto r = ::recv(fd, data, size, 0);
+        if (r <= 0)
+            return false;
+        data += r;
+        size -= r;
+    }
+    return true;
+}
+
+static double
+benchIpc(const std::string& path, const Messages& page, unsigned signals)
+{
+    IpcServer server(path);
+    std::thread serverThread([&] { server.run(); });
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+    if (fd < 0 or ::connect(fd, (sockaddr*) &addr, sizeof(addr)) < 0) {
+        std::cerr << "Can't connect to " << path << std::endl;
+        std::exit(1);
+    }
+    std::vector<uint8_t> subscribe;
+    IpcEncoder enc(subscribe);
+    enc.begin(IpcFrame::Subscribe);
+    enc << std::vector<std::string> {"ConversationLoaded"};
+    enc.end();
+    ::send(fd, subscribe.data(), subscribe.size(), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    auto start = clock_type::now();
+    std::thread reader([&] {
+        std::vector<uint8_t> body;
+        for (unsigned i = 0; i < signals; ++i) {
+            uint8_t header[IPC_FRAME_HEADER];
+            if (not readFull(fd, header, sizeof(header)))
+                break;
+            body.resize(header[0] | header[1] << 8 | header[2] << 16 | uint32_t(header[3]) << 24);
+            if (not readFull(fd, body.data(), body.size()))
+                break;
+            IpcDecoder in(body.data(), body.size());
+            uint8_t kind;
+            uint32_t id;
+            std::string name, accountId, conversationId;
+            Messages messages;
+            in >> kind >> name >> id >> accountId >> conversationId >> messages;
+        }
+    });
+    for (unsigned i = 0; i < signals; ++i)
+        server.emitSignal("ConversationLoaded",
+                          false,
+                          i,
+                          std::string("a1b2c3d4e5f6"),
+                          std::string("0123456789abcdef0123456789abcdef01234567"),
+                          page);
+    reader.join();
+    auto elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+
+    ::close(fd);
+    server.stop();
+    serverThread.join();
+    return elapsed;
+}
+
+static double
+benchDBus(const Messages& page, unsigned signals)
+{
+    auto start = clock_type::now();
+    for (unsigned i = 0; i < signals; ++i) {
+        DBus::SignalMessage msg("/cx/ring/Ring/ConfigurationManager",
+                                "cx.ring.Ring.ConfigurationManager",
+                                "ConversationLoaded");
+        DBus::MessageIter w = msg.writer();
+        w << i << std::string("a1b2c3d4e5f6")
+          << std::string("0123456789abcdef0123456789abcdef01234567") << page;
+
+        DBus::MessageIter r = msg.reader();
+        uint32_t id;
+        std::string accountId, conversationId;
+        Messages messages;
+        r >> id >> accountId >> conversationId >> messages;
+    }
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+int
+main(int argc, char* argv[])
+{
+    unsigned signals = argc > 1 ? std::atoi(argv[1]) : 2000;
+    unsigned pageSize = argc > 2 ? std::atoi(argv[2]) : 50;
+    auto page = makePage(pageSize);
+
+    // The socket directory must be private
+    char dirTemplate[] = "/tmp/jami-ipcbench-XXXXXX";
+    if (not mkdtemp(dirTemplate)) {
+        std::cerr << "Can't create a temporary directory" << std::endl;
+        return 1;
+    }
+    std::string dir = dirTemplate;
+    auto ipc = benchIpc(dir + "/jamid.sock", page, signals);
+    ::rmdir(dir.c_str());
+    auto dbus = benchDBus(page, signals);
+    std::cout << signals << " signals of " << pageSize << " messages" << std::endl
+              << "IPC (socket, end to end): " << ipc * 1e6 / signals << " us/signal" << std::endl
+              << "D-Bus (marshalling only): " << dbus * 1e6 / signals << " us/signal" << std::endl;
+    return 0;
+}
@@ -0,0 +1,498 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "ipcclient.h"
+#include "ipcserver.h"
+
+#include "jami.h"
+#include "callmanager_interface.h"
+#include "configurationmanager_interface.h"
+#include "conversation_interface.h"
+#include "datatransfer_interface.h"
+#include "presencemanager_interface.h"
+#ifdef ENABLE_PLUGIN
+#include "plugin_manager_interface.h"
+#endif
+#ifdef ENABLE_VIDEO
+#include "videomanager_interface.h"
+#endif
+
+#include <iostream>
+
+using SharedCallback = std::shared_ptr<DRing::CallbackWrapperBase>;
+
+template<typename Ts, typename... Args>
+static std::pair<std::string, SharedCallback>
+signalHandler(IpcServer& server, bool droppable, void (*)(Args...))
+{
+    return DRing::exportable_callback<Ts>([&server, droppable](Args... args) {
+        server.emitSignal(Ts::name, droppable, args...);
+    });
+}
+
+/**
+ * Forward the signal to the clients, with the arguments of the callback.
+ * Droppable signals are periodic samples, skipped for slow clients.
+ */
+template<typename Ts>
+static std::pair<std::string, SharedCallback>
+signalHandler(IpcServer& server, bool droppable = false)
+{
+    return signalHandler<Ts>(server, droppable, static_cast<typename Ts::cb_type*>(nullptr));
+}
+
+IpcClient::IpcClient(int flags, bool persistent, const std::string& path)
+    : server_(new IpcServer(path.empty() ? IpcServer::defaultPath() : path))
+    , persistent_(persistent)
+{
+    registerMethods();
+    if (initLibrary(flags) < 0)
+        throw std::runtime_error {"cannot initialize libring"};
+}
+
+IpcClient::~IpcClient()
+{
+    DRing::unregisterSignalHandlers();
+}
+
+int
+IpcClient::initLibrary(int flags)
+{
+    using DRing::AudioSignal;
+    using DRing::CallSignal;
+    using DRing::ConfigurationSignal;
+    using DRing::ConversationSignal;
+    using DRing::DataTransferSignal;
+    using DRing::PresenceSignal;
+
+    if (!DRing::init(static_cast<DRing::InitFlag>(flags)))
+        return -1;
+
+    DRing::registerSignalHandlers({
+        signalHandler<CallSignal::StateChange>(*server_),
+        signalHandler<CallSignal::TransferFailed>(*server_),
+        signalHandler<CallSignal::TransferSucceeded>(*server_),
+        signalHandler<CallSignal::RecordPlaybackStopped>(*server_),
+        signalHandler<CallSignal::VoiceMailNotify>(*server_),
+        signalHandler<CallSignal::IncomingMessage>(*server_),
+        signalHandler<CallSignal::IncomingCall>(*server_),
+        signalHandler<CallSignal::IncomingCallWithMedia>(*server_),
+        signalHandler<CallSignal::MediaChangeRequested>(*server_),
+        signalHandler<CallSignal::RecordPlaybackFilepath>(*server_),
+        signalHandler<CallSignal::ConferenceCreated>(*server_),
+        signalHandler<CallSignal::ConferenceChanged>(*server_),
+        signalHandler<CallSignal::UpdatePlaybackScale>(*server_, true),
+        signalHandler<CallSignal::ConferenceRemoved>(*server_),
+        signalHandler<CallSignal::RecordingStateChanged>(*server_),
+        signalHandler<CallSignal::RtcpReportReceived>(*server_, true),
+        signalHandler<CallSignal::OnConferenceInfosUpdated>(*server_),
+        signalHandler<CallSignal::PeerHold>(*server_),
+        signalHandler<CallSignal::AudioMuted>(*server_),
+        signalHandler<CallSignal::VideoMuted>(*server_),
+        signalHandler<CallSignal::SmartInfo>(*server_, true),
+        signalHandler<CallSignal::RemoteRecordingChanged>(*server_),
+        signalHandler<CallSignal::MediaNegotiationStatus>(*server_),
+        signalHandler<ConfigurationSignal::VolumeChanged>(*server_, true),
+        signalHandler<ConfigurationSignal::AccountsChanged>(*server_),
+        signalHandler<ConfigurationSignal::AccountDetailsChanged>(*server_),
+        signalHandler<ConfigurationSignal::StunStatusFailed>(*server_),
+        signalHandler<ConfigurationSignal::RegistrationStateChanged>(*server_),
+        signalHandler<ConfigurationSignal::VolatileDetailsChanged>(*server_),
+        signalHandler<ConfigurationSignal::Error>(*server_),
+        signalHandler<ConfigurationSignal::IncomingAccountMessage>(*server_),
+        signalHandler<ConfigurationSignal::AccountMessageStatusChanged>(*server_),
+        signalHandler<ConfigurationSignal::ProfileReceived>(*server_),
+        signalHandler<ConfigurationSignal::ComposingStatusChanged>(*server_, true),
+        signalHandler<ConfigurationSignal::IncomingTrustRequest>(*server_),
+        signalHandler<ConfigurationSignal::ContactAdded>(*server_),
+        signalHandler<ConfigurationSignal::ContactRemoved>(*server_),
+        signalHandler<ConfigurationSignal::ExportOnRingEnded>(*server_),
+        signalHandler<ConfigurationSignal::KnownDevicesChanged>(*server_),
+        signalHandler<ConfigurationSignal::NameRegistrationEnded>(*server_),
+        signalHandler<ConfigurationSignal::UserSearchEnded>(*server_),
+        signalHandler<ConfigurationSignal::RegisteredNameFound>(*server_),
+        signalHandler<ConfigurationSignal::DeviceRevocationEnded>(*server_),
+        signalHandler<ConfigurationSignal::AccountProfileReceived>(*server_),
+        signalHandler<ConfigurationSignal::CertificatePinned>(*server_),
+        signalHandler<ConfigurationSignal::CertificatePathPinned>(*server_),
+        signalHandler<ConfigurationSignal::CertificateExpired>(*server_),
+        signalHandler<ConfigurationSignal::CertificateStateChanged>(*server_),
+        signalHandler<ConfigurationSignal::MediaParametersChanged>(*server_),
+        signalHandler<ConfigurationSignal::MigrationEnded>(*server_),
+        signalHandler<ConfigurationSignal::HardwareDecodingChanged>(*server_),
+        signalHandler<ConfigurationSignal::HardwareEncodingChanged>(*server_),
+        signalHandler<ConfigurationSignal::MessageSend>(*server_),
+        signalHandler<ConfigurationSignal::PluginInstallationProgress>(*server_, true),
+        signalHandler<ConfigurationSignal::PluginInstallationFinished>(*server_),
+        signalHandler<PresenceSignal::NewServerSubscriptionRequest>(*server_),
+        signalHandler<PresenceSignal::ServerError>(*server_),
+        signalHandler<PresenceSignal::NewBuddyNotification>(*server_),
+        signalHandler<PresenceSignal::NearbyPeerNotification>(*server_),
+        signalHandler<PresenceSignal::SubscriptionStateChanged>(*server_),
+        signalHandler<AudioSignal::DeviceEvent>(*server_),
+        signalHandler<AudioSignal::AudioMeter>(*server_, true),
+        signalHandler<DataTransferSignal::DataTransferEvent>(*server_),
+        signalHandler<ConversationSignal::ConversationLoaded>(*server_),
+        signalHandler<ConversationSignal::ConversationMessagesPage>(*server_),
+        signalHandler<ConversationSignal::MessageReceived>(*server_),
+        signalHandler<ConversationSignal::ConversationRequestReceived>(*server_),
+        signalHandler<ConversationSignal::ConversationRequestDeclined>(*server_),
+        signalHandler<ConversationSignal::ConversationReady>(*server_),
+        signalHandler<ConversationSignal::ConversationRemoved>(*server_),
+        signalHandler<ConversationSignal::ConversationMemberEvent>(*server_),
+        signalHandler<ConversationSignal::OnConversationError>(*server_),
+    });
+#ifdef ENABLE_VIDEO
+    using DRing::VideoSignal;
+    DRing::registerSignalHandlers({
+        signalHandler<VideoSignal::DeviceEvent>(*server_),
+        signalHandler<VideoSignal::DecodingStarted>(*server_),
+        signalHandler<VideoSignal::DecodingStopped>(*server_),
+    });
+#endif
+
+    if (!DRing::start())
+        return -1;
+    return 0;
+}
+
+void
+IpcClient::registerMethods()
+{
+    // Call manager
+    server_->addMethod("placeCall", &DRing::placeCall);
+    server_->addMethod("placeCallWithMedia", &DRing::placeCallWithMedia);
+    server_->addMethod("requestMediaChange", &DRing::requestMediaChange);
+    server_->addMethod("refuse", &DRing::refuse);
+    server_->addMethod("accept", &DRing::accept);
+    server_->addMethod("acceptWithMedia", &DRing::acceptWithMedia);
+    server_->addMethod("answerMediaChangeRequest", &DRing::answerMediaChangeRequest);
+    server_->addMethod("hangUp", &DRing::hangUp);
+    server_->addMethod("hold", &DRing::hold);
+    server_->addMethod("unhold", &DRing::unhold);
+    server_->addMethod("muteLocalMedia", &DRing::muteLocalMedia);
+    server_->addMethod("transfer", &DRing::transfer);
+    server_->addMethod("attendedTransfer", &DRing::attendedTransfer);
+    server_->addMethod("getCallDetails", &DRing::getCallDetails);
+    server_->addMethod("getCallsDetails", &DRing::getCallsDetails);
+    server_->addMethod("getCallList", &DRing::getCallList);
+    server_->addMethod("getConferenceInfos", &DRing::getConferenceInfos);
+    server_->addMethod("joinParticipant", &DRing::joinParticipant);
+    server_->addMethod("createConfFromParticipantList", &DRing::createConfFromParticipantList);
+    server_->addMethod("setConferenceLayout", &DRing::setConferenceLayout);
+    server_->addMethod("setActiveParticipant", &DRing::setActiveParticipant);
+    server_->addMethod("isConferenceParticipant", &DRing::isConferenceParticipant);
+    server_->addMethod("addParticipant", &DRing::addParticipant);
+    server_->addMethod("addMainParticipant", &DRing::addMainParticipant);
+    server_->addMethod("detachLocalParticipant", &DRing::detachLocalParticipant);
+    server_->addMethod("detachParticipant", &DRing::detachParticipant);
+    server_->addMethod("joinConference", &DRing::joinConference);
+    server_->addMethod("hangUpConference", &DRing::hangUpConference);
+    server_->addMethod("holdConference", &DRing::holdConference);
+    server_->addMethod("unholdConference", &DRing::unholdConference);
+    server_->addMethod("getConferenceList", &DRing::getConferenceList);
+    server_->addMethod("getParticipantList", &DRing::getParticipantList);
+    server_->addMethod("getConferenceId", &DRing::getConferenceId);
+    server_->addMethod("getConferenceDetails", &DRing::getConferenceDetails);
+    server_->addMethod("startRecordedFilePlayback", &DRing::startRecordedFilePlayback);
+    server_->addMethod("stopRecordedFilePlayback", &DRing::stopRecordedFilePlayback);
+    server_->addMethod("toggleRecording", &DRing::toggleRecording);
+    server_->addMethod("setRecording", &DRing::setRecording);
+    server_->addMethod("recordPlaybackSeek", &DRing::recordPlaybackSeek);
+    server_->addMethod("getIsRecording", &DRing::getIsRecording);
+    server_->addMethod("switchInput", &DRing::switchInput);
+    server_->addMethod("switchSecondaryInput", &DRing::switchSecondaryInput);
+    server_->addMethod("playDTMF", &DRing::playDTMF);
+    server_->addMethod("startTone", &DRing::startTone);
+    server_->addMethod("sendTextMessage", &DRing::sendTextMessage);
+    server_->addMethod("startSmartInfo", &DRing::startSmartInfo);
+    server_->addMethod("stopSmartInfo", &DRing::stopSmartInfo);
+    server_->addMethod("setModerator", &DRing::setModerator);
+    server_->addMethod("muteParticipant", &DRing::muteParticipant);
+    server_->addMethod("hangupParticipant", &DRing::hangupParticipant);
+    server_->addMethod("raiseParticipantHand", &DRing::raiseParticipantHand);
+
+    // Configuration manager
+    server_->addMethod("getAccountDetails", &DRing::getAccountDetails);
+    server_->addMethod("getAccountsDetails", &DRing::getAccountsDetails);
+    server_->addMethod("getVolatileAccountDetails", &DRing::getVolatileAccountDetails);
+    server_->addMethod("setAccountDetails", &DRing::setAccountDetails);
+    server_->addMethod("setAccountActive", &DRing::setAccountActive);
+    server_->addMethod("getAccountTemplate", &DRing::getAccountTemplate);
+    server_->addMethod("addAccount", &DRing::addAccount);
+    server_->addMethod("monitor", &DRing::monitor);
+    server_->addMethod("getCpuAccounting", &DRing::getCpuAccounting);
+    server_->addMethod("setCpuAccountingDump", &DRing::setCpuAccountingDump);
+    server_->addMethod("getMemoryUsage", &DRing::getMemoryUsage);
+    server_->addMethod("setMemorySoftLimits", &DRing::setMemorySoftLimits);
+    server_->addMethod("getAccountActivity", &DRing::getAccountActivity);
+    server_->addMethod("exportOnRing", &DRing::exportOnRing);
+    server_->addMethod("exportToFile", &DRing::exportToFile);
+    server_->addMethod("revokeDevice", &DRing::revokeDevice);
+    server_->addMethod("getKnownRingDevices", &DRing::getKnownRingDevices);
+    server_->addMethod("changeAccountPassword", &DRing::changeAccountPassword);
+    server_->addMethod("lookupName", &DRing::lookupName);
+    server_->addMethod("lookupAddress", &DRing::lookupAddress);
+    server_->addMethod("registerName", &DRing::registerName);
+    server_->addMethod("searchUser", &DRing::searchUser);
+    server_->addMethod("removeAccount", &DRing::removeAccount);
+    server_->addMethod("getAccountList", &DRing::getAccountList);
+    server_->addMethod("sendRegister", &DRing::sendRegister);
+    server_->addMethod("registerAllAccounts", &DRing::registerAllAccounts);
+    server_->addMethod("sendAccountTextMessage", &DRing::sendAccountTextMessage);
+    server_->addMethod("getLastMessages", [](IpcDecoder& in, IpcEncoder& out) {
+        std::string accountId;
+        uint64_t base;
+        in >> accountId >> base;
+        auto messages = DRing::getLastMessages(accountId, base);
+        out.varint(messages.size());
+        for (const auto& m : messages)
+            out << m.from << m.payloads << m.received;
+    });
+    server_->addMethod("getNearbyPeers", &DRing::getNearbyPeers);
+    server_->addMethod("getMessageStatus", [](IpcDecoder& in, IpcEncoder& out) {
+        std::string accountId;
+        uint64_t id;
+        in >> accountId >> id;
+        out << DRing::getMessageStatus(accountId, id);
+    });
+    server_->addMethod("cancelMessage", &DRing::cancelMessage);
+    server_->addMethod("setIsComposing", &DRing::setIsComposing);
+    server_->addMethod("setMessageDisplayed", &DRing::setMessageDisplayed);
+    server_->addMethod("getCodecList", &DRing::getCodecList);
+    server_->addMethod("getSupportedTlsMethod", &DRing::getSupportedTlsMethod);
+    server_->addMethod("getSupportedCiphers", &DRing::getSupportedCiphers);
+    server_->addMethod("getCodecDetails", &DRing::getCodecDetails);
+    server_->addMethod("setCodecDetails", &DRing::setCodecDetails);
+    server_->addMethod("getActiveCodecList", &DRing::getActiveCodecList);
+    server_->addMethod("setActiveCodecList", &DRing::setActiveCodecList);
+    server_->addMethod("getAudioPluginList", &DRing::getAudioPluginList);
+    server_->addMethod("setAudioPlugin", &DRing::setAudioPlugin);
+    server_->addMethod("getAudioOutputDeviceList", &DRing::getAudioOutputDeviceList);
+    server_->addMethod("setAudioOutputDevice", &DRing::setAudioOutputDevice);
+    server_->addMethod("setAudioInputDevice", &DRing::setAudioInputDevice);
+    server_->addMethod("setAudioRingtoneDevice", &DRing::setAudioRingtoneDevice);
+    server_->addMethod("getAudioInputDeviceList", &DRing::getAudioInputDeviceList);
+    server_->addMethod("getCurrentAudioDevicesIndex", &DRing::getCurrentAudioDevicesIndex);
+    server_->addMethod("getAudioInputDeviceIndex", &DRing::getAudioInputDeviceIndex);
+    server_->addMethod("getAudioOutputDeviceIndex", &DRing::getAudioOutputDeviceIndex);
+    server_->addMethod("getCurrentAudioOutputPlugin", &DRing::getCurrentAudioOutputPlugin);
+    server_->addMethod("getNoiseSuppressState", &DRing::getNoiseSuppressState);
+    server_->addMethod("setNoiseSuppressState", &DRing::setNoiseSuppressState);
+    server_->addMethod("isAgcEnabled", &DRing::isAgcEnabled);
+    server_->addMethod("setAgcState", &DRing::setAgcState);
+    server_->addMethod("muteDtmf", &DRing::muteDtmf);
+    server_->addMethod("isDtmfMuted", &DRing::isDtmfMuted);
+    server_->addMethod("isCaptureMuted", &DRing::isCaptureMuted);
+    server_->addMethod("muteCapture", &DRing::muteCapture);
+    server_->addMethod("isPlaybackMuted", &DRing::isPlaybackMuted);
+    server_->addMethod("mutePlayback", &DRing::mutePlayback);
+    server_->addMethod("isRingtoneMuted", &DRing::isRingtoneMuted);
+    server_->addMethod("muteRingtone", &DRing::muteRingtone);
+    server_->addMethod("getAudioManager", &DRing::getAudioManager);
+    server_->addMethod("setAudioManager", &DRing::setAudioManager);
+    server_->addMethod("getSupportedAudioManagers", &DRing::getSupportedAudioManagers);
+    server_->addMethod("getRecordPath", &DRing::getRecordPath);
+    server_->addMethod("setRecordPath", &DRing::setRecordPath);
+    server_->addMethod("getIsAlwaysRecording", &DRing::getIsAlwaysRecording);
+    server_->addMethod("setIsAlwaysRecording", &DRing::setIsAlwaysRecording);
+    server_->addMethod("getRecordPreview", &DRing::getRecordPreview);
+    server_->addMethod("setRecordPreview", &DRing::setRecordPreview);
+    server_->addMethod("getRecordQuality", &DRing::getRecordQuality);
+    server_->addMethod("setRecordQuality", &DRing::setRecordQuality);
+    server_->addMethod("setHistoryLimit", &DRing::setHistoryLimit);
+    server_->addMethod("getHistoryLimit", &DRing::getHistoryLimit);
+    server_->addMethod("setRingingTimeout", &DRing::setRingingTimeout);
+    server_->addMethod("getRingingTimeout", &DRing::getRingingTimeout);
+    server_->addMethod("setAccountsOrder", &DRing::setAccountsOrder);
+    server_->addMethod("validateCertificate", &DRing::validateCertificate);
+    server_->addMethod("validateCertificatePath", &DRing::validateCertificatePath);
+    server_->addMethod("getCertificateDetails", &DRing::getCertificateDetails);
+    server_->addMethod("getCertificateDetailsPath", &DRing::getCertificateDetailsPath);
+    server_->addMethod("getPinnedCertificates", &DRing::getPinnedCertificates);
+    server_->addMethod("pinCertificate", &DRing::pinCertificate);
+    server_->addMethod("pinCertificatePath", &DRing::pinCertificatePath);
+    server_->addMethod("unpinCertificate", &DRing::unpinCertificate);
+    server_->addMethod("unpinCertificatePath", &DRing::unpinCertificatePath);
+    server_->addMethod("pinRemoteCertificate", &DRing::pinRemoteCertificate);
+    server_->addMethod("setCertificateStatus", &DRing::setCertificateStatus);
+    server_->addMethod("getCertificatesByStatus", &DRing::getCertificatesByStatus);
+    server_->addMethod("getTrustRequests", &DRing::getTrustRequests);
+    server_->addMethod("acceptTrustRequest", &DRing::acceptTrustRequest);
+    server_->addMethod("discardTrustRequest", &DRing::discardTrustRequest);
+    server_->addMethod("sendTrustRequest", &DRing::sendTrustRequest);
+    server_->addMethod("addContact", &DRing::addContact);
+    server_->addMethod("removeContact", &DRing::removeContact);
+    server_->addMethod("getContactDetails", &DRing::getContactDetails);
+    server_->addMethod("getContactsDetails", &DRing::getContactsDetails);
+    server_->addMethod("getContacts", &DRing::getContacts);
+    server_->addMethod("getCredentials", &DRing::getCredentials);
+    server_->addMethod("setCredentials", &DRing::setCredentials);
+    server_->addMethod("getAddrFromInterfaceName", &DRing::getAddrFromInterfaceName);
+    server_->addMethod("getAllIpInterface", &DRing::getAllIpInterface);
+    server_->addMethod("getAllIpInterfaceByName", &DRing::getAllIpInterfaceByName);
+    server_->addMethod("setVolume", &DRing::setVolume);
+    server_->addMethod("getVolume", &DRing::getVolume);
+    server_->addMethod("connectivityChanged", &DRing::connectivityChanged);
+    server_->addMethod("sendFileLegacy", [](IpcDecoder& in, IpcEncoder& out) {
+        DRing::DataTransferInfo info;
+        in >> info.accountId >> info.lastEvent >> info.flags >> info.totalSize
+            >> info.bytesProgress >> info.author >> info.peer >> info.conversationId
+            >> info.displayName >> info.path >> info.mimetype;
+        DRing::DataTransferId id {};
+        auto error = DRing::sendFileLegacy(info, id);
+        out << error << id;
+    });
+    server_->addMethod("sendFile", &DRing::sendFile);
+    server_->addMethod("dataTransferInfo", [](IpcDecoder& in, IpcEncoder& out) {
+        std::string accountId, fileId;
+        in >> accountId >> fileId;
+        DRing::DataTransferInfo info;
+        out << DRing::dataTransferInfo(accountId, fileId, info);
+        out << info.accountId << info.lastEvent << info.flags << info.totalSize
+            << info.bytesProgress << info.author << info.peer << info.conversationId
+            << info.displayName << info.path << info.mimetype;
+    });
+    server_->addMethod("fileTransferInfo", [](IpcDecoder& in, IpcEncoder& out) {
+        std::string accountId, conversationId, fileId, path;
+        in >> accountId >> conversationId >> fileId;
+        int64_t total {0}, progress {0};
+        auto error
+            = DRing::fileTransferInfo(accountId, conversationId, fileId, path, total, progress);
+        out << error << path << total << progress;
+    });
+    server_->addMethod("acceptFileTransfer", &DRing::acceptFileTransfer);
+    server_->addMethod("downloadFile", &DRing::downloadFile);
+    server_->addMethod("cancelDataTransfer", &DRing::cancelDataTransfer);
+    server_->addMethod("startConversation", &DRing::startConversation);
+    server_->addMethod("acceptConversationRequest", &DRing::acceptConversationRequest);
+    server_->addMethod("declineConversationRequest", &DRing::declineConversationRequest);
+    server_->addMethod("removeConversation", &DRing::removeConversation);
+    server_->addMethod("getConversations", &DRing::getConversations);
+    server_->addMethod("getConversationRequests", &DRing::getConversationRequests);
+    server_->addMethod("getConversationSummaries", &DRing::getConversationSummaries);
+    server_->addMethod("updateConversationInfos", &DRing::updateConversationInfos);
+    server_->addMethod("conversationInfos", &DRing::conversationInfos);
+    server_->addMethod("conversationsInfos", &DRing::conversationsInfos);
+    server_->addMethod("addConversationMember", &DRing::addConversationMember);
+    server_->addMethod("removeConversationMember", &DRing::removeConversationMember);
+    server_->addMethod("getConversationMembers", &DRing::getConversationMembers);
+    server_->addMethod("getConversationsMembers", &DRing::getConversationsMembers);
+    server_->addMethod("sendMessage", &DRing::sendMessage);
+    server_->addMethod("loadConversationMessages", &DRing::loadConversationMessages);
+    server_->addMethod("loadConversationMessagesPaged", &DRing::loadConversationMessagesPaged);
+    server_->addMethod("cancelLoadConversationMessages", &DRing::cancelLoadConversationMessages);
+    server_->addMethod("countInteractions", &DRing::countInteractions);
+    server_->addMethod("isAudioMeterActive", &DRing::isAudioMeterActive);
+    server_->addMethod("setAudioMeterState", &DRing::setAudioMeterState);
+    server_->addMethod("setDefaultModerator", &DRing::setDefaultModerator);
+    server_->addMethod("getDefaultModerators", &DRing::getDefaultModerators);
+    server_->addMethod("enableLocalModerators", &DRing::enableLocalModerators);
+    server_->addMethod("isLocalModeratorsEnabled", &DRing::isLocalModeratorsEnabled);
+    server_->addMethod("setAllModerators", &DRing::setAllModerators);
+    server_->addMethod("isAllModerators", &DRing::isAllModerators);
+
+    // Presence manager
+    server_->addMethod("publish", &DRing::publish);
+    server_->addMethod("answerServerRequest", &DRing::answerServerRequest);
+    server_->addMethod("subscribeBuddy", &DRing::subscribeBuddy);
+    server_->addMethod("getSubscriptions", &DRing::getSubscriptions);
+    server_->addMethod("setSubscriptions", &DRing::setSubscriptions);
+
+#ifdef ENABLE_VIDEO
+    // Video manager
+    server_->addMethod("getDeviceList", &DRing::getDeviceList);
+    server_->addMethod("getCapabilities", &DRing::getCapabilities);
+    server_->addMethod("getSettings", &DRing::getSettings);
+    server_->addMethod("applySettings", &DRing::applySettings);
+    server_->addMethod("setDefaultDevice", &DRing::setDefaultDevice);
+    server_->addMethod("getDefaultDevice", &DRing::getDefaultDevice);
+    server_->addMethod("startAudioDevice", &DRing::startAudioDevice);
+    server_->addMethod("stopAudioDevice", &DRing::stopAudioDevice);
+    server_->addMethod("openVideoInput", &DRing::openVideoInput);
+    server_->addMethod("closeVideoInput", &DRing::closeVideoInput);
+    server_->addMethod("getDecodingAccelerated", &DRing::getDecodingAccelerated);
+    server_->addMethod("setDecodingAccelerated", &DRing::setDecodingAccelerated);
+    server_->addMethod("getEncodingAccelerated", &DRing::getEncodingAccelerated);
+    server_->addMethod("setEncodingAccelerated", &DRing::setEncodingAccelerated);
+    server_->addMethod("setDeviceOrientation", &DRing::setDeviceOrientation);
+#if HAVE_SHM
+    server_->addMethod("startShmSink", &DRing::startShmSink);
+#endif
+    server_->addMethod("getRenderer", &DRing::getRenderer);
+    server_->addMethod("startLocalMediaRecorder", &DRing::startLocalMediaRecorder);
+    server_->addMethod("stopLocalRecorder", &DRing::stopLocalRecorder);
+#endif
+
+#ifdef ENABLE_PLUGIN
+    // Plugin manager
+    server_->addMethod("loadPlugin", &DRing::loadPlugin);
+    server_->addMethod("unloadPlugin", &DRing::unloadPlugin);
+    server_->addMethod("getPluginDetails", &DRing::getPluginDetails);
+    server_->addMethod("getPluginPreferences", &DRing::getPluginPreferences);
+    server_->addMethod("setPluginPreference", &DRing::setPluginPreference);
+    server_->addMethod("getPluginPreferencesValues", &DRing::getPluginPreferencesValues);
+    server_->addMethod("resetPluginPreferencesValues", &DRing::resetPluginPreferencesValues);
+    server_->addMethod("getInstalledPlugins", &DRing::getInstalledPlugins);
+    server_->addMethod("getLoadedPlugins", &DRing::getLoadedPlugins);
+    server_->addMethod("installPlugin", &DRing::installPlugin);
+    server_->addMethod("installPluginAsync", &DRing::installPluginAsync);
+    server_->addMethod("uninstallPlugin", &DRing::uninstallPlugin);
+    server_->addMethod("getCallMediaHandlers", &DRing::getCallMediaHandlers);
+    server_->addMethod("getChatHandlers", &DRing::getChatHandlers);
+    server_->addMethod("toggleCallMediaHandler", &DRing::toggleCallMediaHandler);
+    server_->addMethod("toggleChatHandler", &DRing::toggleChatHandler);
+    server_->addMethod("getCallMediaHandlerDetails", &DRing::getCallMediaHandlerDetails);
+    server_->addMethod("getCallMediaHandlerStatus", &DRing::getCallMediaHandlerStatus);
+    server_->addMethod("getCallMediaHandlerStats", &DRing::getCallMediaHandlerStats);
+    server_->addMethod("setCallMediaHandlerLatencyBudget",
+                       &DRing::setCallMediaHandlerLatencyBudget);
+    server_->addMethod("getChatHandlerDetails", &DRing::getChatHandlerDetails);
+    server_->addMethod("getChatHandlerStatus", &DRing::getChatHandlerStatus);
+    server_->addMethod("getPluginsEnabled", &DRing::getPluginsEnabled);
+    server_->addMethod("setPluginsEnabled", &DRing::setPluginsEnabled);
+#endif
+
+    server_->addMethod("getIpcStats", [this](IpcDecoder&, IpcEncoder& out) {
+        out << server_->getStats();
+    });
+}
+
+int
+IpcClient::event_loop() noexcept
+{
+    try {
+        std::function<void()> onNoMoreClient;
+        if (not persistent_)
+            onNoMoreClient = [this] { server_->stop(); };
+        server_->run(std::move(onNoMoreClient));
+    } catch (const std::exception& err) {
+        std::cerr << "quitting: " << err.what() << std::endl;
+        DRing::fini();
+        return 1;
+    }
+    DRing::fini();
+    return 0;
+}
+
+int
+IpcClient::exit() noexcept
+{
+    server_->stop();
+    return 0;
+}
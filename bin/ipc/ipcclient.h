@@ -0,0 +1,52 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include "def.h"
+
+#include <memory>
+#include <string>
+
+class IpcServer;
+
+/**
+ * Serves the DRing API and signals on the local IPC socket, instead of D-Bus.
+ * Methods have the names of the DRing functions.
+ * The socket is IpcServer::defaultPath() if path is empty.
+ */
+class DRING_PUBLIC IpcClient
+{
+public:
+    IpcClient(int flags, bool persistent, const std::string& path);
+    ~IpcClient();
+
+    int event_loop() noexcept;
+    int exit() noexcept;
+
+private:
+    void registerMethods();
+    int initLibrary(int flags);
+
+    std::unique_ptr<IpcServer> server_;
+    bool persistent_;
+};
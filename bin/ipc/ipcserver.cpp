@@ -0,0 +1,540 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "ipcserver.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // SIGPIPE is ignored by the daemon
+#endif
+
+constexpr std::chrono::milliseconds IpcServer::BATCH_DELAY;
+constexpr std::size_t IpcServer::BATCH_SIZE;
+constexpr std::size_t IpcServer::SOFT_LIMIT;
+constexpr std::size_t IpcServer::HARD_LIMIT;
+constexpr std::size_t IpcServer::MAX_REQUEST_SIZE;
+constexpr unsigned IpcServer::WORKERS;
+
+struct IpcServer::Client
+{
+    explicit Client(int fd)
+        : fd(fd)
+    {}
+    ~Client() { ::close(fd); }
+
+    std::size_t pending() const { return out.size() - sent; }
+
+    const int fd;
+    std::vector<uint8_t> in; ///< only used by the server thread
+    bool writeBlocked {false};
+
+    std::mutex mtx; ///< protects the following
+    std::vector<uint8_t> out;
+    std::size_t sent {0};
+    clock::time_point firstPending;
+    bool overflow {false};
+    bool broken {false}; ///< a worker failed to answer
+    std::deque<std::vector<uint8_t>> requests; ///< request bodies, in order
+    std::size_t requestsSize {0};
+    bool scheduled {false}; ///< queued for, or being handled by, a worker
+    bool subscribedAll {true};
+    std::set<std::string> subscriptions;
+};
+
+static void
+setNonBlocking(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
+}
+
+// Only the user may connect: the directory of the socket must be theirs and private
+static void
+checkDirectory(const std::string& dir)
+{
+    if (::mkdir(dir.c_str(), 0700) < 0 and errno != EEXIST)
+        throw std::runtime_error("Can't create " + dir + ": " + strerror(errno));
+    struct stat st;
+    if (::lstat(dir.c_str(), &st) < 0)
+        throw std::runtime_error("Can't access " + dir + ": " + strerror(errno));
+    if (not S_ISDIR(st.st_mode))
+        throw std::runtime_error(dir + " is not a directory");
+    if (st.st_uid != ::geteuid() or (st.st_mode & 077) != 0)
+        throw std::runtime_error(dir + " must belong to the user, with mode 0700");
+}
+
+static bool
+isSameUser(int fd)
+{
+#ifdef SO_PEERCRED
+    ucred cred {};
+    socklen_t len = sizeof(cred);
+    return ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0
+           and cred.uid == ::geteuid();
+#else
+    uid_t uid;
+    gid_t gid;
+    return ::getpeereid(fd, &uid, &gid) == 0 and uid == ::geteuid();
+#endif
+}
+
+std::string
+IpcServer::defaultPath()
+{
+    const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    if (not runtimeDir or not *runtimeDir)
+        throw std::runtime_error("XDG_RUNTIME_DIR isn't set, use --ipc=<path>");
+    return std::string(runtimeDir) + "/jami/jamid.sock";
+}
+
+IpcServer::IpcServer(const std::string& path)
+    : path_(path)
+{
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("IPC socket path too long: " + path);
+    std::copy(path.begin(), path.end(), addr.sun_path);
+
+    auto sep = path.rfind('/');
+    checkDirectory(sep == std::string::npos ? "." : sep == 0 ? "/" : path.substr(0, sep));
+
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd_ < 0)
+        throw std::runtime_error("Can't create IPC socket");
+    // A socket answering connections belongs to another daemon, otherwise it's stale
+    if (::connect(listenFd_, (sockaddr*) &addr, sizeof(addr)) == 0) {
+        ::close(listenFd_);
+        throw std::runtime_error("Another daemon is detected on " + path);
+    }
+    ::close(listenFd_);
+    ::unlink(path.c_str());
+
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd_ < 0 or ::bind(listenFd_, (sockaddr*) &addr, sizeof(addr)) < 0
+        or ::chmod(path.c_str(), 0600) < 0 or ::listen(listenFd_, 16) < 0
+        or ::pipe(wakePipe_) < 0) {
+        auto err = errno;
+        if (listenFd_ >= 0)
+            ::close(listenFd_);
+        throw std::runtime_error("Can't listen on " + path + ": " + strerror(err));
+    }
+    setNonBlocking(listenFd_);
+    setNonBlocking(wakePipe_[0]);
+    setNonBlocking(wakePipe_[1]);
+
+    for (unsigned i = 0; i < WORKERS; ++i)
+        workers_.emplace_back([this] { work(); });
+}
+
+IpcServer::~IpcServer()
+{
+    {
+        std::lock_guard<std::mutex> lk(workMtx_);
+        stopWorkers_ = true;
+        work_.clear();
+    }
+    workCv_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+    {
+        std::lock_guard<std::mutex> lk(clientsMtx_);
+        clients_.clear();
+    }
+    ::close(listenFd_);
+    ::close(wakePipe_[0]);
+    ::close(wakePipe_[1]);
+    ::unlink(path_.c_str());
+}
+
+void
+IpcServer::addMethod(const std::string& name, Method&& method)
+{
+    methods_[name] = std::move(method);
+}
+
+void
+IpcServer::wake()
+{
+    if (not wakePending_.exchange(true))
+        (void) ::write(wakePipe_[1], "w", 1);
+}
+
+void
+IpcServer::stop()
+{
+    running_ = false;
+    wake();
+}
+
+void
+IpcServer::publish(const std::string& name, const std::vector<uint8_t>& frame, bool droppable)
+{
+    ++signals_;
+    bool needWake = false;
+    std::lock_guard<std::mutex> lk(clientsMtx_);
+    for (const auto& client : clients_) {
+        std::lock_guard<std::mutex> clk(client->mtx);
+        if (not client->subscribedAll and not client->subscriptions.count(name))
+            continue;
+        auto pending = client->pending();
+        if (pending > HARD_LIMIT) {
+            client->overflow = true;
+            needWake = true;
+            continue;
+        }
+        if (droppable and pending > SOFT_LIMIT) {
+            ++dropped_;
+            continue;
+        }
+        // Wake the server for the first pending signal (to schedule the batch),
+        // then only once a batch is full
+        if (pending == 0) {
+            client->firstPending = clock::now();
+            needWake = true;
+        } else if (pending < BATCH_SIZE and pending + frame.size() >= BATCH_SIZE) {
+            needWake = true;
+        }
+        client->out.insert(client->out.end(), frame.begin(), frame.end());
+    }
+    if (needWake)
+        wake();
+}
+
+void
+IpcServer::accept()
+{
+    int fd = ::accept(listenFd_, nullptr, nullptr);
+    if (fd < 0)
+        return;
+    if (not isSameUser(fd)) {
+        std::cerr << "IPC: connection from another user refused" << std::endl;
+        ::close(fd);
+        return;
+    }
+    setNonBlocking(fd);
+    std::lock_guard<std::mutex> lk(clientsMtx_);
+    clients_.emplace_back(std::make_shared<Client>(fd));
+}
+
+bool
+IpcServer::read(const std::shared_ptr<Client>& c)
+{
+    auto& client = *c;
+    uint8_t buf[64 * 1024];
+    auto n = ::recv(client.fd, buf, sizeof(buf), 0);
+    if (n == 0 or (n < 0 and errno != EAGAIN and errno != EWOULDBLOCK and errno != EINTR))
+        return false;
+    if (n < 0)
+        return true;
+    client.in.insert(client.in.end(), buf, buf + n);
+
+    std::size_t consumed = 0;
+    try {
+        while (client.in.size() - consumed >= IPC_FRAME_HEADER) {
+            const auto* header = client.in.data() + consumed;
+            uint32_t size = 0;
+            for (unsigned i = 0; i < IPC_FRAME_HEADER; ++i)
+                size |= uint32_t(header[i]) << (8 * i);
+            if (size > MAX_REQUEST_SIZE)
+                return false;
+            if (client.in.size() - consumed - IPC_FRAME_HEADER < size)
+                break;
+            handleFrame(c, header + IPC_FRAME_HEADER, size);
+            consumed += IPC_FRAME_HEADER + size;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "IPC: invalid frame: " << e.what() << std::endl;
+        return false;
+    }
+    client.in.erase(client.in.begin(), client.in.begin() + consumed);
+    return true;
+}
+
+void
+IpcServer::handleFrame(const std::shared_ptr<Client>& client, const uint8_t* body, std::size_t size)
+{
+    IpcDecoder frame(body, size);
+    uint8_t kind;
+    frame >> kind;
+    switch (static_cast<IpcFrame>(kind)) {
+    case IpcFrame::Request: {
+        ++requests_;
+        // Handled by the workers, one request of a client at a time to keep the order
+        bool schedule;
+        {
+            std::lock_guard<std::mutex> lk(client->mtx);
+            client->requests.emplace_back(body, body + size);
+            client->requestsSize += size;
+            schedule = not client->scheduled;
+            client->scheduled = true;
+        }
+        if (schedule) {
+            {
+                std::lock_guard<std::mutex> lk(workMtx_);
+                work_.emplace_back(client);
+            }
+            workCv_.notify_one();
+        }
+        break;
+    }
+    case IpcFrame::Subscribe: {
+        std::vector<std::string> names;
+        frame >> names;
+        std::lock_guard<std::mutex> lk(client->mtx);
+        client->subscribedAll = names.empty();
+        client->subscriptions = {names.begin(), names.end()};
+        break;
+    }
+    default:
+        throw std::runtime_error("Unexpected frame " + std::to_string(kind));
+    }
+}
+
+void
+IpcServer::call(const std::vector<uint8_t>& request, std::vector<uint8_t>& reply)
+{
+    IpcDecoder frame(request.data(), request.size());
+    uint8_t kind;
+    uint64_t id;
+    std::string name;
+    frame >> kind >> id >> name;
+
+    std::vector<uint8_t> result;
+    IpcEncoder res(result);
+    uint8_t status = 0;
+    try {
+        auto method = methods_.find(name);
+        if (method == methods_.end())
+            throw std::runtime_error("Unknown method " + name);
+        method->second(frame, res);
+    } catch (const std::exception& e) {
+        status = 1;
+        result.clear();
+        res << e.what();
+    }
+
+    IpcEncoder enc(reply);
+    enc.begin(IpcFrame::Reply);
+    enc << id << status;
+    reply.insert(reply.end(), result.begin(), result.end());
+    enc.end();
+}
+
+void
+IpcServer::work()
+{
+    std::unique_lock<std::mutex> lk(workMtx_);
+    while (true) {
+        workCv_.wait(lk, [this] { return stopWorkers_ or not work_.empty(); });
+        if (stopWorkers_)
+            return;
+        auto client = std::move(work_.front());
+        work_.pop_front();
+        lk.unlock();
+
+        std::vector<uint8_t> request;
+        bool resume;
+        {
+            std::lock_guard<std::mutex> clk(client->mtx);
+            request = std::move(client->requests.front());
+            client->requests.pop_front();
+            resume = client->requestsSize >= SOFT_LIMIT;
+            client->requestsSize -= request.size();
+            resume = resume and client->requestsSize < SOFT_LIMIT;
+        }
+        std::vector<uint8_t> reply;
+        bool ok = true;
+        try {
+            call(request, reply);
+        } catch (const std::exception& e) {
+            std::cerr << "IPC: invalid request: " << e.what() << std::endl;
+            ok = false;
+        }
+
+        bool more;
+        {
+            std::lock_guard<std::mutex> clk(client->mtx);
+            if (client->pending() == 0)
+                client->firstPending = clock::now();
+            client->out.insert(client->out.end(), reply.begin(), reply.end());
+            more = ok and not client->requests.empty();
+            client->scheduled = more;
+        }
+        // Replies are sent right away, the server thread takes over if the socket is full
+        ok = ok and write(*client);
+        bool blocked;
+        {
+            std::lock_guard<std::mutex> clk(client->mtx);
+            if (not ok)
+                client->broken = true;
+            blocked = client->pending() != 0;
+        }
+        // The server thread must poll again: to disconnect, to write, or to read
+        if (not ok or blocked or resume)
+            wake();
+
+        lk.lock();
+        // One request at a time, other clients first
+        if (more)
+            work_.emplace_back(std::move(client));
+    }
+}
+
+bool
+IpcServer::write(Client& client)
+{
+    std::lock_guard<std::mutex> lk(client.mtx);
+    while (client.pending()) {
+        auto n = ::send(client.fd,
+                        client.out.data() + client.sent,
+                        client.pending(),
+                        MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN and errno != EWOULDBLOCK)
+                return false;
+            client.writeBlocked = true;
+            break;
+        }
+        client.sent += n;
+        ++writes_;
+        bytesSent_ += n;
+    }
+    if (client.pending() == 0) {
+        client.out.clear();
+        client.sent = 0;
+        client.writeBlocked = false;
+    } else if (client.sent > client.out.size() / 2) {
+        client.out.erase(client.out.begin(), client.out.begin() + client.sent);
+        client.sent = 0;
+    }
+    return true;
+}
+
+void
+IpcServer::run(std::function<void()> onNoMoreClient)
+{
+    running_ = true;
+    std::vector<std::shared_ptr<Client>> clients;
+    std::vector<pollfd> fds;
+    while (running_) {
+        {
+            std::lock_guard<std::mutex> lk(clientsMtx_);
+            clients = clients_;
+        }
+        fds.assign({{listenFd_, POLLIN, 0}, {wakePipe_[0], POLLIN, 0}});
+        int timeout = -1;
+        auto now = clock::now();
+        for (const auto& client : clients) {
+            short events = 0;
+            std::lock_guard<std::mutex> lk(client->mtx);
+            auto pending = client->pending();
+            // Backpressure: don't take more requests from a client not reading its replies
+            if (pending < SOFT_LIMIT and client->requestsSize < SOFT_LIMIT)
+                events |= POLLIN;
+            if (pending) {
+                auto due = client->firstPending + BATCH_DELAY;
+                if (client->writeBlocked or client->overflow or pending >= BATCH_SIZE
+                    or due <= now) {
+                    events |= POLLOUT;
+                } else {
+                    auto wait = std::chrono::ceil<std::chrono::milliseconds>(due - now).count();
+                    timeout = timeout < 0 ? wait : std::min<int>(timeout, wait);
+                }
+            }
+            fds.push_back({client->fd, events, 0});
+        }
+
+        if (::poll(fds.data(), fds.size(), timeout) < 0 and errno != EINTR)
+            break;
+
+        if (fds[1].revents & POLLIN) {
+            wakePending_ = false;
+            char buf[64];
+            while (::read(wakePipe_[0], buf, sizeof(buf)) > 0)
+                ;
+        }
+        if (fds[0].revents & POLLIN)
+            accept();
+
+        std::vector<std::shared_ptr<Client>> closed;
+        for (std::size_t i = 0; i < clients.size(); ++i) {
+            auto& client = *clients[i];
+            auto events = fds[i + 2].revents;
+            bool ok;
+            {
+                std::lock_guard<std::mutex> lk(client.mtx);
+                ok = not client.overflow and not client.broken;
+                if (client.overflow)
+                    std::cerr << "IPC: client too slow, disconnecting" << std::endl;
+            }
+            if (ok and (events & POLLIN))
+                ok = read(clients[i]);
+            if (ok and (events & POLLOUT))
+                ok = write(client);
+            if (ok and (events & (POLLERR | POLLNVAL | POLLHUP)) and not(events & POLLIN))
+                ok = false;
+            if (not ok)
+                closed.emplace_back(clients[i]);
+        }
+        if (not closed.empty()) {
+            bool empty;
+            {
+                std::lock_guard<std::mutex> lk(clientsMtx_);
+                for (const auto& client : closed)
+                    clients_.erase(std::find(clients_.begin(), clients_.end(), client));
+                empty = clients_.empty();
+            }
+            disconnected_ += closed.size();
+            if (empty and onNoMoreClient)
+                onNoMoreClient();
+        }
+    }
+}
+
+std::map<std::string, std::string>
+IpcServer::getStats() const
+{
+    std::size_t clients;
+    {
+        std::lock_guard<std::mutex> lk(clientsMtx_);
+        clients = clients_.size();
+    }
+    return {{"clients", std::to_string(clients)},
+            {"signals", std::to_string(signals_)},
+            {"dropped", std::to_string(dropped_)},
+            {"requests", std::to_string(requests_)},
+            {"writes", std::to_string(writes_)},
+            {"bytesSent", std::to_string(bytesSent_)},
+            {"disconnected", std::to_string(disconnected_)}};
+}
@@ -0,0 +1,158 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#pragma once
+
+#include "ipc_codec.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/**
+ * Local IPC server, on a UNIX domain socket, with the encoding of ipc_codec.h.
+ * The socket is in a directory private to the user, and only connections from
+ * the same user are accepted.
+ *
+ * Clients send requests and receive the signals they subscribed to. Methods run
+ * on WORKERS threads: the requests of a client are answered in order, but a slow
+ * method doesn't delay the other clients. Signals are batched: they are written
+ * together after at most BATCH_DELAY, or as soon as BATCH_SIZE bytes are pending.
+ * Backpressure:
+ * - the requests of a client aren't read while more than SOFT_LIMIT bytes wait
+ *   to be sent to it or to be handled, and droppable signals (periodic samples)
+ *   are dropped;
+ * - a client with more than HARD_LIMIT bytes pending is disconnected.
+ * Video frames don't go through the socket: the shared memory sinks are used,
+ * as announced by the DecodingStarted signal.
+ */
+class IpcServer
+{
+public:
+    using clock = std::chrono::steady_clock;
+    using Method = std::function<void(IpcDecoder&, IpcEncoder&)>;
+
+    static constexpr auto BATCH_DELAY = std::chrono::milliseconds(2);
+    static constexpr std::size_t BATCH_SIZE {64 * 1024};
+    static constexpr std::size_t SOFT_LIMIT {1024 * 1024};
+    static constexpr std::size_t HARD_LIMIT {64 * 1024 * 1024};
+    static constexpr std::size_t MAX_REQUEST_SIZE {16 * 1024 * 1024};
+    static constexpr unsigned WORKERS {4};
+
+    /**
+     * The parent directory of the socket is created if needed, it must belong to
+     * the user and not be accessible to others.
+     * @throw std::runtime_error if the socket can't be created
+     */
+    explicit IpcServer(const std::string& path);
+    ~IpcServer();
+
+    /**
+     * Default socket path: $XDG_RUNTIME_DIR/jami/jamid.sock
+     * @throw std::runtime_error if XDG_RUNTIME_DIR isn't set
+     */
+    static std::string defaultPath();
+
+    void addMethod(const std::string& name, Method&& method);
+
+    /** Bind a function: arguments are decoded, the result is encoded */
+    template<typename R, typename... Args>
+    void addMethod(const std::string& name, R (*fn)(Args...))
+    {
+        static_assert(not(... or (std::is_lvalue_reference<Args>::value
+                                  and not std::is_const<std::remove_reference_t<Args>>::value)),
+                      "output parameters must be bound with a Method");
+        addMethod(name, [fn](IpcDecoder& in, IpcEncoder& out) {
+            std::tuple<std::decay_t<Args>...> args;
+            std::apply([&in](auto&... a) { (void) (in >> ... >> a); }, args);
+            if constexpr (std::is_void<R>::value)
+                std::apply(fn, args);
+            else
+                out << std::apply(fn, args);
+        });
+    }
+
+    /** Thread safe. Droppable signals are dropped for clients over the soft limit. */
+    template<typename... Args>
+    void emitSignal(const char* name, bool droppable, const Args&... args)
+    {
+        std::vector<uint8_t> frame;
+        IpcEncoder enc(frame);
+        enc.begin(IpcFrame::Signal);
+        enc << name;
+        (void) (enc << ... << args);
+        enc.end();
+        publish(name, frame, droppable);
+    }
+
+    /**
+     * Serve clients until stop()
+     * @param onNoMoreClient called when the last client disconnects
+     */
+    void run(std::function<void()> onNoMoreClient = {});
+    void stop();
+
+    std::map<std::string, std::string> getStats() const;
+
+private:
+    struct Client;
+
+    void publish(const std::string& name, const std::vector<uint8_t>& frame, bool droppable);
+    void wake();
+    void accept();
+    bool read(const std::shared_ptr<Client>& client);
+    bool write(Client& client);
+    void handleFrame(const std::shared_ptr<Client>& client, const uint8_t* body, std::size_t size);
+    void work();
+    void call(const std::vector<uint8_t>& request, std::vector<uint8_t>& reply);
+
+    const std::string path_;
+    int listenFd_ {-1};
+    int wakePipe_[2] {-1, -1};
+    std::atomic_bool wakePending_ {false};
+    std::atomic_bool running_ {false};
+    std::map<std::string, Method> methods_;
+
+    mutable std::mutex clientsMtx_;
+    std::vector<std::shared_ptr<Client>> clients_;
+
+    std::mutex workMtx_;
+    std::condition_variable workCv_;
+    std::deque<std::shared_ptr<Client>> work_; ///< clients with requests, each once
+    bool stopWorkers_ {false};
+    std::vector<std::thread> workers_;
+
+    // Statistics
+    std::atomic<uint64_t> signals_ {0};
+    std::atomic<uint64_t> dropped_ {0};
+    std::atomic<uint64_t> requests_ {0};
+    std::atomic<uint64_t> writes_ {0};
+    std::atomic<uint64_t> bytesSent_ {0};
+    std::atomic<uint64_t> disconnected_ {0};
+};
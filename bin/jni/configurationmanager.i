@@ -67,6 +67,8 @@ public:
 
     virtual void audioMeter(const std::string& /*id*/, float /*level*/){}
     virtual void messageSend(const std::string& /*message*/){}
+    virtual void pluginInstallationProgress(const std::string& /*jplPath*/, uint64_t /*extracted*/, uint64_t /*total*/){}
+    virtual void pluginInstallationFinished(const std::string& /*jplPath*/, const std::string& /*rootPath*/, int /*status*/){}
 };
 %}
 
@@ -83,11 +85,17 @@ struct Message
 };
 
 std::map<std::string, std::string> getAccountDetails(const std::string& accountID);
+std::vector<std::map<std::string, std::string>> getAccountsDetails(const std::vector<std::string>& accountIDs, const std::vector<std::string>& fields);
 std::map<std::string, std::string> getVolatileAccountDetails(const std::string& accountID);
 void setAccountDetails(const std::string& accountID, const std::map<std::string, std::string>& details);
 void setAccountActive(const std::string& accountID, bool active);
 std::map<std::string, std::string> getAccountTemplate(const std::string& accountType);
 void monitor(bool continuous);
+std::vector<std::map<std::string, std::string>> getCpuAccounting();
+void setCpuAccountingDump(const std::string& path, int32_t periodSeconds);
+std::map<std::string, std::string> getMemoryUsage();
+void setMemorySoftLimits(const std::map<std::string, std::string>& limits);
+std::map<std::string, std::string> getAccountActivity(const std::string& accountID);
 std::string addAccount(const std::map<std::string, std::string>& details);
 void removeAccount(const std::string& accountID);
 std::vector<std::string> getAccountList();
@@ -217,6 +225,7 @@ void addContact(const std::string& accountId, const std::string& uri);
 void removeContact(const std::string& accountId, const std::string& uri, const bool& ban);
 std::vector<std::map<std::string, std::string>> getContacts(const std::string& accountId);
 std::map<std::string, std::string> getContactDetails(const std::string& accountId, const std::string& uri);
+std::vector<std::map<std::string, std::string>> getContactsDetails(const std::string& accountId, const std::vector<std::string>& uris, const std::vector<std::string>& fields);
 
 void connectivityChanged();
 
@@ -280,4 +289,6 @@ public:
 
     virtual void audioMeter(const std::string& /*id*/, float /*level*/){}
     virtual void messageSend(const std::string& /*message*/){}
+    virtual void pluginInstallationProgress(const std::string& /*jplPath*/, uint64_t /*extracted*/, uint64_t /*total*/){}
+    virtual void pluginInstallationFinished(const std::string& /*jplPath*/, const std::string& /*rootPath*/, int /*status*/){}
 };
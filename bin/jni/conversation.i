@@ -26,6 +26,7 @@ class ConversationCallback {
 public:
     virtual ~ConversationCallback(){}
     virtual void conversationLoaded(uint32_t /* id */, const std::string& /*accountId*/, const std::string& /* conversationId */, std::vector<std::map<std::string, std::string>> /*messages*/){}
+    virtual void conversationMessagesPage(uint32_t /* id */, const std::string& /*accountId*/, const std::string& /* conversationId */, std::vector<std::map<std::string, std::string>> /*messages*/, const std::string& /* next */){}
     virtual void messageReceived(const std::string& /*accountId*/, const std::string& /* conversationId */, std::map<std::string, std::string> /*message*/){}
     virtual void conversationRequestReceived(const std::string& /*accountId*/, const std::string& /* conversationId */, std::map<std::string, std::string> /*metadatas*/){}
     virtual void conversationRequestDeclined(const std::string& /*accountId*/, const std::string& /* conversationId */){}
@@ -47,17 +48,22 @@ namespace DRing {
   bool removeConversation(const std::string& accountId, const std::string& conversationId);
   std::vector<std::string> getConversations(const std::string& accountId);
   std::vector<std::map<std::string, std::string>> getConversationRequests(const std::string& accountId);
+  std::vector<std::map<std::string, std::string>> getConversationSummaries(const std::string& accountId);
   void updateConversationInfos(const std::string& accountId, const std::string& conversationId, const std::map<std::string, std::string>& infos);
   std::map<std::string, std::string> conversationInfos(const std::string& accountId, const std::string& conversationId);
+  std::vector<std::map<std::string, std::string>> conversationsInfos(const std::string& accountId, const std::vector<std::string>& conversationIds, const std::vector<std::string>& fields);
 
   // Member management
   void addConversationMember(const std::string& accountId, const std::string& conversationId, const std::string& contactUri);
   void removeConversationMember(const std::string& accountId, const std::string& conversationId, const std::string& contactUri);
   std::vector<std::map<std::string, std::string>> getConversationMembers(const std::string& accountId, const std::string& conversationId);
+  std::vector<std::map<std::string, std::string>> getConversationsMembers(const std::string& accountId, const std::vector<std::string>& conversationIds);
 
   // Message send/load
   void sendMessage(const std::string& accountId, const std::string& conversationId, const std::string& message, const std::string& parent);
   uint32_t loadConversationMessages(const std::string& accountId, const std::string& conversationId, const std::string& fromMessage, size_t n);
+  uint32_t loadConversationMessagesPaged(const std::string& accountId, const std::string& conversationId, const std::string& fromMessage, size_t pageSize);
+  bool cancelLoadConversationMessages(const std::string& accountId, uint32_t id);
   uint32_t countInteractions(const std::string& accountId, const std::string& conversationId, const std::string& toId, const std::string& fromId, const std::string& authorUri);
 }
 
@@ -65,6 +71,7 @@ class ConversationCallback {
 public:
     virtual ~ConversationCallback(){}
     virtual void conversationLoaded(uint32_t /* id */, const std::string& /*accountId*/, const std::string& /* conversationId */, std::vector<std::map<std::string, std::string>> /*messages*/){}
+    virtual void conversationMessagesPage(uint32_t /* id */, const std::string& /*accountId*/, const std::string& /* conversationId */, std::vector<std::map<std::string, std::string>> /*messages*/, const std::string& /* next */){}
     virtual void messageReceived(const std::string& /*accountId*/, const std::string& /* conversationId */, std::map<std::string, std::string> /*message*/){}
     virtual void conversationRequestReceived(const std::string& /*accountId*/, const std::string& /* conversationId */, std::map<std::string, std::string> /*metadatas*/){}
     virtual void conversationRequestDeclined(const std::string& /*accountId*/, const std::string& /* conversationId */){}
@@ -194,6 +194,8 @@ namespace std {
 /* not parsed by SWIG but needed by generated C files */
 %header %{
 
+#include "jami/signal_queue.h"
+
 #include <functional>
 
 %}
@@ -223,6 +225,7 @@ void init(ConfigurationCallback* confM, Callback* callM, PresenceCallback* presM
 
     using std::bind;
     using DRing::exportable_callback;
+    using DRing::exportable_queued_callback;
     using DRing::CallSignal;
     using DRing::ConfigurationSignal;
     using DRing::DataTransferInfo;
@@ -233,78 +236,93 @@ void init(ConfigurationCallback* confM, Callback* callM, PresenceCallback* presM
 
     using SharedCallback = std::shared_ptr<DRing::CallbackWrapperBase>;
 
+    // Signals are delivered by a single thread, attached to the JVM once, so the
+    // daemon threads only post them. Signals with output parameters and the
+    // capture controls stay synchronous.
+    // Never destroyed: the thread must not exit while attached.
+    static auto& queue = []() -> DRing::SignalQueue& {
+        auto q = new DRing::SignalQueue();
+        q->post([] {
+            JNIEnv* env;
+            gJavaVM->AttachCurrentThreadAsDaemon(&env, nullptr);
+        });
+        return *q;
+    }();
+
     // Call event handlers
     const std::map<std::string, SharedCallback> callEvHandlers = {
-        exportable_callback<CallSignal::StateChange>(bind(&Callback::callStateChanged, callM, _1, _2, _3, _4)),
-        exportable_callback<CallSignal::TransferFailed>(bind(&Callback::transferFailed, callM)),
-        exportable_callback<CallSignal::TransferSucceeded>(bind(&Callback::transferSucceeded, callM)),
-        exportable_callback<CallSignal::RecordPlaybackStopped>(bind(&Callback::recordPlaybackStopped, callM, _1)),
-        exportable_callback<CallSignal::VoiceMailNotify>(bind(&Callback::voiceMailNotify, callM, _1, _2, _3, _4)),
-        exportable_callback<CallSignal::IncomingMessage>(bind(&Callback::incomingMessage, callM, _1, _2, _3, _4)),
-        exportable_callback<CallSignal::IncomingCall>(bind(&Callback::incomingCall, callM, _1, _2, _3)),
-        exportable_callback<CallSignal::IncomingCallWithMedia>(bind(&Callback::incomingCallWithMedia, callM, _1, _2, _3, _4)),
-        exportable_callback<CallSignal::MediaChangeRequested>(bind(&Callback::mediaChangeRequested, callM, _1, _2, _3)),
-        exportable_callback<CallSignal::RecordPlaybackFilepath>(bind(&Callback::recordPlaybackFilepath, callM, _1, _2)),
-        exportable_callback<CallSignal::ConferenceCreated>(bind(&Callback::conferenceCreated, callM, _1, _2)),
-        exportable_callback<CallSignal::ConferenceChanged>(bind(&Callback::conferenceChanged, callM, _1, _2, _3)),
-        exportable_callback<CallSignal::ConferenceRemoved>(bind(&Callback::conferenceRemoved, callM, _1, _2)),
-        exportable_callback<CallSignal::UpdatePlaybackScale>(bind(&Callback::updatePlaybackScale, callM, _1, _2, _3)),
-        exportable_callback<CallSignal::RecordingStateChanged>(bind(&Callback::recordingStateChanged, callM, _1, _2)),
-        exportable_callback<CallSignal::RtcpReportReceived>(bind(&Callback::onRtcpReportReceived, callM, _1, _2)),
-        exportable_callback<CallSignal::OnConferenceInfosUpdated>(bind(&Callback::onConferenceInfosUpdated, callM, _1, _2)),
-        exportable_callback<CallSignal::PeerHold>(bind(&Callback::peerHold, callM, _1, _2)),
-        exportable_callback<CallSignal::AudioMuted>(bind(&Callback::audioMuted, callM, _1, _2)),
-        exportable_callback<CallSignal::VideoMuted>(bind(&Callback::videoMuted, callM, _1, _2)),
-        exportable_callback<CallSignal::ConnectionUpdate>(bind(&Callback::connectionUpdate, callM, _1, _2)),
-        exportable_callback<CallSignal::RemoteRecordingChanged>(bind(&Callback::remoteRecordingChanged, callM, _1, _2, _3)),
-        exportable_callback<CallSignal::MediaNegotiationStatus>(bind(&Callback::mediaNegotiationStatus, callM, _1, _2, _3))
+        exportable_queued_callback<CallSignal::StateChange>(queue, bind(&Callback::callStateChanged, callM, _1, _2, _3, _4)),
+        exportable_queued_callback<CallSignal::TransferFailed>(queue, bind(&Callback::transferFailed, callM)),
+        exportable_queued_callback<CallSignal::TransferSucceeded>(queue, bind(&Callback::transferSucceeded, callM)),
+        exportable_queued_callback<CallSignal::RecordPlaybackStopped>(queue, bind(&Callback::recordPlaybackStopped, callM, _1)),
+        exportable_queued_callback<CallSignal::VoiceMailNotify>(queue, bind(&Callback::voiceMailNotify, callM, _1, _2, _3, _4)),
+        exportable_queued_callback<CallSignal::IncomingMessage>(queue, bind(&Callback::incomingMessage, callM, _1, _2, _3, _4)),
+        exportable_queued_callback<CallSignal::IncomingCall>(queue, bind(&Callback::incomingCall, callM, _1, _2, _3)),
+        exportable_queued_callback<CallSignal::IncomingCallWithMedia>(queue, bind(&Callback::incomingCallWithMedia, callM, _1, _2, _3, _4)),
+        exportable_queued_callback<CallSignal::MediaChangeRequested>(queue, bind(&Callback::mediaChangeRequested, callM, _1, _2, _3)),
+        exportable_queued_callback<CallSignal::RecordPlaybackFilepath>(queue, bind(&Callback::recordPlaybackFilepath, callM, _1, _2)),
+        exportable_queued_callback<CallSignal::ConferenceCreated>(queue, bind(&Callback::conferenceCreated, callM, _1, _2)),
+        exportable_queued_callback<CallSignal::ConferenceChanged>(queue, bind(&Callback::conferenceChanged, callM, _1, _2, _3)),
+        exportable_queued_callback<CallSignal::ConferenceRemoved>(queue, bind(&Callback::conferenceRemoved, callM, _1, _2)),
+        exportable_queued_callback<CallSignal::UpdatePlaybackScale>(queue, bind(&Callback::updatePlaybackScale, callM, _1, _2, _3), true),
+        exportable_queued_callback<CallSignal::RecordingStateChanged>(queue, bind(&Callback::recordingStateChanged, callM, _1, _2)),
+        exportable_queued_callback<CallSignal::RtcpReportReceived>(queue, bind(&Callback::onRtcpReportReceived, callM, _1, _2), true),
+        exportable_queued_callback<CallSignal::OnConferenceInfosUpdated>(queue, bind(&Callback::onConferenceInfosUpdated, callM, _1, _2), true),
+        exportable_queued_callback<CallSignal::PeerHold>(queue, bind(&Callback::peerHold, callM, _1, _2)),
+        exportable_queued_callback<CallSignal::AudioMuted>(queue, bind(&Callback::audioMuted, callM, _1, _2)),
+        exportable_queued_callback<CallSignal::VideoMuted>(queue, bind(&Callback::videoMuted, callM, _1, _2)),
+        exportable_queued_callback<CallSignal::ConnectionUpdate>(queue, bind(&Callback::connectionUpdate, callM, _1, _2)),
+        exportable_queued_callback<CallSignal::RemoteRecordingChanged>(queue, bind(&Callback::remoteRecordingChanged, callM, _1, _2, _3)),
+        exportable_queued_callback<CallSignal::MediaNegotiationStatus>(queue, bind(&Callback::mediaNegotiationStatus, callM, _1, _2, _3))
     };
 
     // Configuration event handlers
     const std::map<std::string, SharedCallback> configEvHandlers = {
-        exportable_callback<ConfigurationSignal::VolumeChanged>(bind(&ConfigurationCallback::volumeChanged, confM, _1, _2)),
-        exportable_callback<ConfigurationSignal::AccountsChanged>(bind(&ConfigurationCallback::accountsChanged, confM)),
-        exportable_callback<ConfigurationSignal::StunStatusFailed>(bind(&ConfigurationCallback::stunStatusFailure, confM, _1)),
-        exportable_callback<ConfigurationSignal::AccountDetailsChanged>(bind(&ConfigurationCallback::accountDetailsChanged, confM, _1, _2)),
-        exportable_callback<ConfigurationSignal::RegistrationStateChanged>(bind(&ConfigurationCallback::registrationStateChanged, confM, _1, _2, _3, _4)),
-        exportable_callback<ConfigurationSignal::VolatileDetailsChanged>(bind(&ConfigurationCallback::volatileAccountDetailsChanged, confM, _1, _2)),
-        exportable_callback<ConfigurationSignal::KnownDevicesChanged>(bind(&ConfigurationCallback::knownDevicesChanged, confM, _1, _2)),
-        exportable_callback<ConfigurationSignal::ExportOnRingEnded>(bind(&ConfigurationCallback::exportOnRingEnded, confM, _1, _2, _3)),
-        exportable_callback<ConfigurationSignal::Error>(bind(&ConfigurationCallback::errorAlert, confM, _1)),
-        exportable_callback<ConfigurationSignal::IncomingAccountMessage>(bind(&ConfigurationCallback::incomingAccountMessage, confM, _1, _2, _3, _4 )),
-        exportable_callback<ConfigurationSignal::AccountMessageStatusChanged>(bind(&ConfigurationCallback::accountMessageStatusChanged, confM, _1, _2, _3, _4, _5 )),
-        exportable_callback<ConfigurationSignal::ProfileReceived>(bind(&ConfigurationCallback::profileReceived, confM, _1, _2, _3 )),
-        exportable_callback<ConfigurationSignal::ComposingStatusChanged>(bind(&ConfigurationCallback::composingStatusChanged, confM, _1, _2, _3, _4 )),
-        exportable_callback<ConfigurationSignal::IncomingTrustRequest>(bind(&ConfigurationCallback::incomingTrustRequest, confM, _1, _2, _3, _4, _5 )),
-        exportable_callback<ConfigurationSignal::ContactAdded>(bind(&ConfigurationCallback::contactAdded, confM, _1, _2, _3 )),
-        exportable_callback<ConfigurationSignal::ContactRemoved>(bind(&ConfigurationCallback::contactRemoved, confM, _1, _2, _3 )),
-        exportable_callback<ConfigurationSignal::CertificatePinned>(bind(&ConfigurationCallback::certificatePinned, confM, _1 )),
-        exportable_callback<ConfigurationSignal::CertificatePathPinned>(bind(&ConfigurationCallback::certificatePathPinned, confM, _1, _2 )),
-        exportable_callback<ConfigurationSignal::CertificateExpired>(bind(&ConfigurationCallback::certificateExpired, confM, _1 )),
-        exportable_callback<ConfigurationSignal::CertificateStateChanged>(bind(&ConfigurationCallback::certificateStateChanged, confM, _1, _2, _3 )),
+        exportable_queued_callback<ConfigurationSignal::VolumeChanged>(queue, bind(&ConfigurationCallback::volumeChanged, confM, _1, _2), true),
+        exportable_queued_callback<ConfigurationSignal::AccountsChanged>(queue, bind(&ConfigurationCallback::accountsChanged, confM)),
+        exportable_queued_callback<ConfigurationSignal::StunStatusFailed>(queue, bind(&ConfigurationCallback::stunStatusFailure, confM, _1)),
+        exportable_queued_callback<ConfigurationSignal::AccountDetailsChanged>(queue, bind(&ConfigurationCallback::accountDetailsChanged, confM, _1, _2), true),
+        exportable_queued_callback<ConfigurationSignal::RegistrationStateChanged>(queue, bind(&ConfigurationCallback::registrationStateChanged, confM, _1, _2, _3, _4)),
+        exportable_queued_callback<ConfigurationSignal::VolatileDetailsChanged>(queue, bind(&ConfigurationCallback::volatileAccountDetailsChanged, confM, _1, _2), true),
+        exportable_queued_callback<ConfigurationSignal::KnownDevicesChanged>(queue, bind(&ConfigurationCallback::knownDevicesChanged, confM, _1, _2), true),
+        exportable_queued_callback<ConfigurationSignal::ExportOnRingEnded>(queue, bind(&ConfigurationCallback::exportOnRingEnded, confM, _1, _2, _3)),
+        exportable_queued_callback<ConfigurationSignal::Error>(queue, bind(&ConfigurationCallback::errorAlert, confM, _1)),
+        exportable_queued_callback<ConfigurationSignal::IncomingAccountMessage>(queue, bind(&ConfigurationCallback::incomingAccountMessage, confM, _1, _2, _3, _4 )),
+        exportable_queued_callback<ConfigurationSignal::AccountMessageStatusChanged>(queue, bind(&ConfigurationCallback::accountMessageStatusChanged, confM, _1, _2, _3, _4, _5 )),
+        exportable_queued_callback<ConfigurationSignal::ProfileReceived>(queue, bind(&ConfigurationCallback::profileReceived, confM, _1, _2, _3 )),
+        exportable_queued_callback<ConfigurationSignal::ComposingStatusChanged>(queue, bind(&ConfigurationCallback::composingStatusChanged, confM, _1, _2, _3, _4 ), true),
+        exportable_queued_callback<ConfigurationSignal::IncomingTrustRequest>(queue, bind(&ConfigurationCallback::incomingTrustRequest, confM, _1, _2, _3, _4, _5 )),
+        exportable_queued_callback<ConfigurationSignal::ContactAdded>(queue, bind(&ConfigurationCallback::contactAdded, confM, _1, _2, _3 )),
+        exportable_queued_callback<ConfigurationSignal::ContactRemoved>(queue, bind(&ConfigurationCallback::contactRemoved, confM, _1, _2, _3 )),
+        exportable_queued_callback<ConfigurationSignal::CertificatePinned>(queue, bind(&ConfigurationCallback::certificatePinned, confM, _1 )),
+        exportable_queued_callback<ConfigurationSignal::CertificatePathPinned>(queue, bind(&ConfigurationCallback::certificatePathPinned, confM, _1, _2 )),
+        exportable_queued_callback<ConfigurationSignal::CertificateExpired>(queue, bind(&ConfigurationCallback::certificateExpired, confM, _1 )),
+        exportable_queued_callback<ConfigurationSignal::CertificateStateChanged>(queue, bind(&ConfigurationCallback::certificateStateChanged, confM, _1, _2, _3 )),
         exportable_callback<ConfigurationSignal::GetHardwareAudioFormat>(bind(&ConfigurationCallback::getHardwareAudioFormat, confM, _1 )),
         exportable_callback<ConfigurationSignal::GetAppDataPath>(bind(&ConfigurationCallback::getAppDataPath, confM, _1, _2 )),
         exportable_callback<ConfigurationSignal::GetDeviceName>(bind(&ConfigurationCallback::getDeviceName, confM, _1 )),
-        exportable_callback<ConfigurationSignal::RegisteredNameFound>(bind(&ConfigurationCallback::registeredNameFound, confM, _1, _2, _3, _4 )),
-        exportable_callback<ConfigurationSignal::NameRegistrationEnded>(bind(&ConfigurationCallback::nameRegistrationEnded, confM, _1, _2, _3 )),
-        exportable_callback<ConfigurationSignal::UserSearchEnded>(bind(&ConfigurationCallback::userSearchEnded, confM, _1, _2, _3, _4 )),
-        exportable_callback<ConfigurationSignal::MigrationEnded>(bind(&ConfigurationCallback::migrationEnded, confM, _1, _2)),
-        exportable_callback<ConfigurationSignal::DeviceRevocationEnded>(bind(&ConfigurationCallback::deviceRevocationEnded, confM, _1, _2, _3)),
-        exportable_callback<ConfigurationSignal::AccountProfileReceived>(bind(&ConfigurationCallback::accountProfileReceived, confM, _1, _2, _3)),
-        exportable_callback<ConfigurationSignal::MessageSend>(bind(&ConfigurationCallback::messageSend, confM, _1))
+        exportable_queued_callback<ConfigurationSignal::RegisteredNameFound>(queue, bind(&ConfigurationCallback::registeredNameFound, confM, _1, _2, _3, _4 )),
+        exportable_queued_callback<ConfigurationSignal::NameRegistrationEnded>(queue, bind(&ConfigurationCallback::nameRegistrationEnded, confM, _1, _2, _3 )),
+        exportable_queued_callback<ConfigurationSignal::UserSearchEnded>(queue, bind(&ConfigurationCallback::userSearchEnded, confM, _1, _2, _3, _4 )),
+        exportable_queued_callback<ConfigurationSignal::MigrationEnded>(queue, bind(&ConfigurationCallback::migrationEnded, confM, _1, _2)),
+        exportable_queued_callback<ConfigurationSignal::DeviceRevocationEnded>(queue, bind(&ConfigurationCallback::deviceRevocationEnded, confM, _1, _2, _3)),
+        exportable_queued_callback<ConfigurationSignal::AccountProfileReceived>(queue, bind(&ConfigurationCallback::accountProfileReceived, confM, _1, _2, _3)),
+        exportable_queued_callback<ConfigurationSignal::MessageSend>(queue, bind(&ConfigurationCallback::messageSend, confM, _1)),
+        exportable_queued_callback<ConfigurationSignal::PluginInstallationProgress>(queue, bind(&ConfigurationCallback::pluginInstallationProgress, confM, _1, _2, _3), true),
+        exportable_queued_callback<ConfigurationSignal::PluginInstallationFinished>(queue, bind(&ConfigurationCallback::pluginInstallationFinished, confM, _1, _2, _3))
     };
 
     // Presence event handlers
     const std::map<std::string, SharedCallback> presenceEvHandlers = {
-        exportable_callback<PresenceSignal::NewServerSubscriptionRequest>(bind(&PresenceCallback::newServerSubscriptionRequest, presM, _1 )),
-        exportable_callback<PresenceSignal::ServerError>(bind(&PresenceCallback::serverError, presM, _1, _2, _3 )),
-        exportable_callback<PresenceSignal::NewBuddyNotification>(bind(&PresenceCallback::newBuddyNotification, presM, _1, _2, _3, _4 )),
-        exportable_callback<PresenceSignal::NearbyPeerNotification>(bind(&PresenceCallback::nearbyPeerNotification, presM, _1, _2, _3, _4)),
-        exportable_callback<PresenceSignal::SubscriptionStateChanged>(bind(&PresenceCallback::subscriptionStateChanged, presM, _1, _2, _3 ))
+        exportable_queued_callback<PresenceSignal::NewServerSubscriptionRequest>(queue, bind(&PresenceCallback::newServerSubscriptionRequest, presM, _1 )),
+        exportable_queued_callback<PresenceSignal::ServerError>(queue, bind(&PresenceCallback::serverError, presM, _1, _2, _3 )),
+        exportable_queued_callback<PresenceSignal::NewBuddyNotification>(queue, bind(&PresenceCallback::newBuddyNotification, presM, _1, _2, _3, _4 )),
+        exportable_queued_callback<PresenceSignal::NearbyPeerNotification>(queue, bind(&PresenceCallback::nearbyPeerNotification, presM, _1, _2, _3, _4)),
+        exportable_queued_callback<PresenceSignal::SubscriptionStateChanged>(queue, bind(&PresenceCallback::subscriptionStateChanged, presM, _1, _2, _3 ))
     };
 
     const std::map<std::string, SharedCallback> dataTransferEvHandlers = {
-        exportable_callback<DataTransferSignal::DataTransferEvent>(bind(&DataTransferCallback::dataTransferEvent, dataM, _1, _2, _3, _4, _5)),
+        exportable_queued_callback<DataTransferSignal::DataTransferEvent>(queue, bind(&DataTransferCallback::dataTransferEvent, dataM, _1, _2, _3, _4, _5)),
     };
 
     const std::map<std::string, SharedCallback> videoEvHandlers = {
@@ -319,14 +337,15 @@ void init(ConfigurationCallback* confM, Callback* callM, PresenceCallback* presM
     };
 
     const std::map<std::string, SharedCallback> conversationHandlers = {
-        exportable_callback<ConversationSignal::ConversationLoaded>(bind(&ConversationCallback::conversationLoaded, convM, _1, _2, _3, _4)),
-        exportable_callback<ConversationSignal::MessageReceived>(bind(&ConversationCallback::messageReceived, convM, _1, _2, _3)),
-        exportable_callback<ConversationSignal::ConversationRequestReceived>(bind(&ConversationCallback::conversationRequestReceived, convM, _1, _2, _3)),
-        exportable_callback<ConversationSignal::ConversationRequestDeclined>(bind(&ConversationCallback::conversationRequestDeclined, convM, _1, _2)),
-        exportable_callback<ConversationSignal::ConversationReady>(bind(&ConversationCallback::conversationReady, convM, _1, _2)),
-        exportable_callback<ConversationSignal::ConversationRemoved>(bind(&ConversationCallback::conversationRemoved, convM, _1, _2)),
-        exportable_callback<ConversationSignal::ConversationMemberEvent>(bind(&ConversationCallback::conversationMemberEvent, convM, _1, _2, _3, _4)),
-        exportable_callback<ConversationSignal::OnConversationError>(bind(&ConversationCallback::onConversationError, convM, _1, _2, _3, _4))
+        exportable_queued_callback<ConversationSignal::ConversationLoaded>(queue, bind(&ConversationCallback::conversationLoaded, convM, _1, _2, _3, _4)),
+        exportable_queued_callback<ConversationSignal::ConversationMessagesPage>(queue, bind(&ConversationCallback::conversationMessagesPage, convM, _1, _2, _3, _4, _5)),
+        exportable_queued_callback<ConversationSignal::MessageReceived>(queue, bind(&ConversationCallback::messageReceived, convM, _1, _2, _3)),
+        exportable_queued_callback<ConversationSignal::ConversationRequestReceived>(queue, bind(&ConversationCallback::conversationRequestReceived, convM, _1, _2, _3)),
+        exportable_queued_callback<ConversationSignal::ConversationRequestDeclined>(queue, bind(&ConversationCallback::conversationRequestDeclined, convM, _1, _2)),
+        exportable_queued_callback<ConversationSignal::ConversationReady>(queue, bind(&ConversationCallback::conversationReady, convM, _1, _2)),
+        exportable_queued_callback<ConversationSignal::ConversationRemoved>(queue, bind(&ConversationCallback::conversationRemoved, convM, _1, _2)),
+        exportable_queued_callback<ConversationSignal::ConversationMemberEvent>(queue, bind(&ConversationCallback::conversationMemberEvent, convM, _1, _2, _3, _4)),
+        exportable_queued_callback<ConversationSignal::OnConversationError>(queue, bind(&ConversationCallback::onConversationError, convM, _1, _2, _3, _4))
     };
 
     if (!DRing::init(static_cast<DRing::InitFlag>(DRing::DRING_FLAG_DEBUG)))
@@ -34,6 +34,7 @@ bool resetPluginPreferencesValues(const std::string& path);
 std::vector<std::string> getInstalledPlugins();
 std::vector<std::string> getLoadedPlugins();
 int installPlugin(const std::string& jplPath, bool force);
+void installPluginAsync(const std::string& jplPath, bool force);
 int uninstallPlugin(const std::string& pluginRootPath);
 std::vector<std::string> getCallMediaHandlers();
 std::vector<std::string> getChatHandlers();
@@ -41,6 +42,8 @@ void toggleCallMediaHandler(const std::string& mediaHandlerId, const std::string
 void toggleChatHandler(const std::string& chatHandlerId, const std::string& accountId, const std::string& peerId, bool toggle);
 std::map<std::string,std::string> getCallMediaHandlerDetails(const std::string& mediaHandlerId);
 std::vector<std::string> getCallMediaHandlerStatus(const std::string& callId);
+std::vector<std::map<std::string,std::string>> getCallMediaHandlerStats(const std::string& callId);
+void setCallMediaHandlerLatencyBudget(const std::string& mediaHandlerId, int32_t budgetMs);
 std::map<std::string,std::string> getChatHandlerDetails(const std::string& chatHandlerId);
 std::vector<std::string> getChatHandlerStatus(const std::string& accountId, const std::string& peerId);
 bool getPluginsEnabled();
@@ -27,6 +27,7 @@
 #include "restcpp/restclient.h"
 #else
 #include "dbus/dbusclient.h"
+#include "ipc/ipcclient.h"
 #endif
 
 #include "fileutils.h"
@@ -47,6 +48,9 @@ static int port = 8080;
 static std::weak_ptr<RestClient> weakClient;
 #else
 static std::weak_ptr<DBusClient> weakClient;
+static std::weak_ptr<IpcClient> weakIpcClient;
+static bool useIpc = false;
+static std::string ipcPath;
 #endif
 
 static void
@@ -74,6 +78,7 @@ print_usage()
     "-p, --persistent \t- Stay alive after client quits" << std::endl <<
     "--port \t- Port to use for the rest API. Default is 8080" << std::endl <<
     "--auto-answer \t- Force automatic answer to incoming calls" << std::endl <<
+    "--ipc[=path] \t- Serve the local IPC socket instead of D-Bus" << std::endl <<
     "-h, --help \t- Print help" << std::endl;
 }
 
@@ -97,6 +102,7 @@ parse_args(int argc, char *argv[], bool& persistent)
         {"help",        no_argument,        nullptr,    'h'},
         {"version",     no_argument,        nullptr,    'v'},
         {"auto-answer", no_argument,        &autoAnswer, true},
+        {"ipc",         optional_argument,  nullptr,    'i'},
         {"port",        optional_argument,  nullptr,    'x'},
         {nullptr,       0,                  nullptr,     0} /* Sentinel */
     };
@@ -133,6 +139,12 @@ parse_args(int argc, char *argv[], bool& persistent)
                 versionFlag = true;
                 break;
 
+            case 'i':
+                useIpc = true;
+                if (optarg)
+                    ipcPath = optarg;
+                break;
+
             case 'x':
                 port = std::atoi(optarg);
                 break;
@@ -178,6 +190,10 @@ signal_handler(int code)
     // Interrupt the process
     if (auto client = weakClient.lock())
         client->exit();
+#if !REST_API
+    if (auto client = weakIpcClient.lock())
+        client->exit();
+#endif
 }
 
 int
@@ -210,6 +226,13 @@ main(int argc, char *argv [])
     signal(SIGPIPE, SIG_IGN);
 
     try {
+#if !REST_API
+        if (useIpc) {
+            auto client = std::make_shared<IpcClient>(ringFlags, persistent, ipcPath);
+            weakIpcClient = client;
+            return client->event_loop();
+        }
+#endif
 #if REST_API
         if (auto client = std::make_shared<RestClient>(port, ringFlags, persistent))
 #else
@@ -2,9 +2,9 @@
 
 #include <uv.h>
 
-#include <queue>
+#include "jami/signal_queue.h"
+
 #include <functional>
-#include <mutex>
 #include <string_view>
 
 using namespace v8;
@@ -28,6 +28,7 @@ Persistent<Function> incomingMessageCb;
 Persistent<Function> incomingCallCb;
 Persistent<Function> incomingCallWithMediaCb;
 Persistent<Function> conversationLoadedCb;
+Persistent<Function> conversationMessagesPageCb;
 Persistent<Function> messageReceivedCb;
 Persistent<Function> conversationRequestReceivedCb;
 Persistent<Function> conversationRequestDeclinedCb;
@@ -40,11 +41,11 @@ Persistent<Function> conferenceChangedCb;
 Persistent<Function> conferenceRemovedCb;
 Persistent<Function> onConferenceInfosUpdatedCb;
 
-std::queue<std::function<void()>> pendingSignals;
-std::mutex pendingSignalsLock;
-
 uv_async_t signalAsync;
 
+// Signals are run by the loop of Node, the daemon threads only post them
+DRing::SignalQueue pendingSignals {[] { uv_async_send(&signalAsync); }};
+
 Persistent<Function>*
 getPresistentCb(std::string_view signal)
 {
@@ -86,6 +87,8 @@ getPresistentCb(std::string_view signal)
         return &incomingCallWithMediaCb;
     else if (signal == "ConversationLoaded")
         return &conversationLoadedCb;
+    else if (signal == "ConversationMessagesPage")
+        return &conversationMessagesPageCb;
     else if (signal == "MessageReceived")
         return &messageReceivedCb;
     else if (signal == "ConversationReady")
@@ -192,11 +195,7 @@ void
 handlePendingSignals(uv_async_t* async_data)
 {
     SWIGV8_HANDLESCOPE();
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    while (not pendingSignals.empty()) {
-        pendingSignals.front()();
-        pendingSignals.pop();
-    }
+    pendingSignals.process();
 }
 
 void
@@ -205,8 +204,7 @@ registrationStateChanged(const std::string& accountId,
                          int code,
                          const std::string& detail_str)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, state, code, detail_str]() {
+    pendingSignals.post([accountId, state, code, detail_str]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(),
                                                     registrationStateChangedCb);
         if (!func.IsEmpty()) {
@@ -217,16 +215,14 @@ registrationStateChanged(const std::string& accountId,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 4, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
 volatileDetailsChanged(const std::string& accountId,
                        const std::map<std::string, std::string>& details)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, details]() {
+    auto key = DRing::SignalQueue::makeKey("VolatileDetailsChanged", accountId);
+    pendingSignals.post(std::move(key), [accountId, details]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), volatileDetailsChangedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -234,16 +230,14 @@ volatileDetailsChanged(const std::string& accountId,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 2, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
 accountDetailsChanged(const std::string& accountId,
                       const std::map<std::string, std::string>& details)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, details]() {
+    auto key = DRing::SignalQueue::makeKey("AccountDetailsChanged", accountId);
+    pendingSignals.post(std::move(key), [accountId, details]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), accountDetailsChangedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -251,30 +245,24 @@ accountDetailsChanged(const std::string& accountId,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 2, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
 accountsChanged()
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([]() {
+    pendingSignals.post([]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), accountsChangedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {};
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 0, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
 contactAdded(const std::string& accountId, const std::string& uri, bool confirmed)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, uri, confirmed]() {
+    pendingSignals.post([accountId, uri, confirmed]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), contactAddedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -283,15 +271,12 @@ contactAdded(const std::string& accountId, const std::string& uri, bool confirme
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
 contactRemoved(const std::string& accountId, const std::string& uri, bool banned)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, uri, banned]() {
+    pendingSignals.post([accountId, uri, banned]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), contactRemovedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -300,15 +285,12 @@ contactRemoved(const std::string& accountId, const std::string& uri, bool banned
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
 exportOnRingEnded(const std::string& accountId, int state, const std::string& pin)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, state, pin]() {
+    pendingSignals.post([accountId, state, pin]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), exportOnRingEndedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -317,15 +299,12 @@ exportOnRingEnded(const std::string& accountId, int state, const std::string& pi
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
 nameRegistrationEnded(const std::string& accountId, int state, const std::string& name)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, state, name]() {
+    pendingSignals.post([accountId, state, name]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), nameRegistrationEndedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -334,8 +313,6 @@ nameRegistrationEnded(const std::string& accountId, int state, const std::string
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
@@ -344,8 +321,7 @@ registeredNameFound(const std::string& accountId,
                     const std::string& address,
                     const std::string& name)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, state, address, name]() {
+    pendingSignals.post([accountId, state, address, name]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), registeredNameFoundCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -355,8 +331,6 @@ registeredNameFound(const std::string& accountId,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 4, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
@@ -366,8 +340,7 @@ accountMessageStatusChanged(const std::string& account_id,
                             const std::string& message_id,
                             int state)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([account_id, message_id, peer, state]() {
+    pendingSignals.post([account_id, message_id, peer, state]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(),
                                                     accountMessageStatusChangedCb);
         if (!func.IsEmpty()) {
@@ -378,8 +351,6 @@ accountMessageStatusChanged(const std::string& account_id,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 4, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
@@ -388,8 +359,7 @@ incomingAccountMessage(const std::string& accountId,
                        const std::string& from,
                        const std::map<std::string, std::string>& payloads)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, from, payloads]() {
+    pendingSignals.post([accountId, from, payloads]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), incomingAccountMessageCb);
         if (!func.IsEmpty()) {
             SWIGV8_OBJECT jsMap = stringMapToJsMap(payloads);
@@ -399,15 +369,13 @@ incomingAccountMessage(const std::string& accountId,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
 knownDevicesChanged(const std::string& accountId, const std::map<std::string, std::string>& devices)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, devices]() {
+    auto key = DRing::SignalQueue::makeKey("KnownDevicesChanged", accountId);
+    pendingSignals.post(std::move(key), [accountId, devices]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), knownDevicesChangedCb);
         if (!func.IsEmpty()) {
             SWIGV8_OBJECT jsMap = stringMapToJsMap(devices);
@@ -415,8 +383,6 @@ knownDevicesChanged(const std::string& accountId, const std::map<std::string, st
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 2, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
@@ -425,8 +391,7 @@ incomingTrustRequest(const std::string& accountId,
                      const std::vector<uint8_t>& payload,
                      time_t received)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, from, payload, received]() {
+    pendingSignals.post([accountId, from, payload, received]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), incomingTrustRequestCb);
         if (!func.IsEmpty()) {
             SWIGV8_ARRAY jsArray = intVectToJsArray(payload);
@@ -437,14 +402,12 @@ incomingTrustRequest(const std::string& accountId,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 4, callback_args);
         }
     });
-    uv_async_send(&signalAsync);
 }
 
 void
 callStateChanged(const std::string& callId, const std::string& state, int detail_code)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([callId, state, detail_code]() {
+    pendingSignals.post([callId, state, detail_code]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), callStateChangedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(callId),
@@ -453,8 +416,6 @@ callStateChanged(const std::string& callId, const std::string& state, int detail
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
@@ -462,8 +423,7 @@ mediaChangeRequested(const std::string& accountId,
                      const std::string& callId,
                      const std::vector<std::map<std::string, std::string>>& mediaList)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, callId, mediaList]() {
+    pendingSignals.post([accountId, callId, mediaList]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), mediaChangeRequestedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -472,8 +432,6 @@ mediaChangeRequested(const std::string& accountId,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
@@ -481,8 +439,7 @@ incomingMessage(const std::string& id,
                 const std::string& from,
                 const std::map<std::string, std::string>& messages)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([id, from, messages]() {
+    pendingSignals.post([id, from, messages]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), incomingMessageCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(id),
@@ -491,15 +448,12 @@ incomingMessage(const std::string& id,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
 incomingCall(const std::string& accountId, const std::string& callId, const std::string& from)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, callId, from]() {
+    pendingSignals.post([accountId, callId, from]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), incomingCallCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -508,8 +462,6 @@ incomingCall(const std::string& accountId, const std::string& callId, const std:
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 void
@@ -518,8 +470,7 @@ incomingCallWithMedia(const std::string& accountId,
                       const std::string& from,
                       const std::vector<std::map<std::string, std::string>>& mediaList)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, callId, from, mediaList]() {
+    pendingSignals.post([accountId, callId, from, mediaList]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), incomingCallWithMediaCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -529,8 +480,6 @@ incomingCallWithMedia(const std::string& accountId,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-
-    uv_async_send(&signalAsync);
 }
 
 /** Conversations */
@@ -541,8 +490,7 @@ conversationLoaded(uint32_t id,
                    const std::string& conversationId,
                    const std::vector<std::map<std::string, std::string>>& message)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([id, accountId, conversationId, message]() {
+    pendingSignals.post([id, accountId, conversationId, message]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), conversationLoadedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {SWIGV8_INTEGER_NEW_UNS(id),
@@ -552,7 +500,27 @@ conversationLoaded(uint32_t id,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 4, callback_args);
         }
     });
-    uv_async_send(&signalAsync);
+}
+
+void
+conversationMessagesPage(uint32_t id,
+                         const std::string& accountId,
+                         const std::string& conversationId,
+                         const std::vector<std::map<std::string, std::string>>& messages,
+                         const std::string& next)
+{
+    pendingSignals.post([id, accountId, conversationId, messages, next]() {
+        Local<Function> func = Local<Function>::New(Isolate::GetCurrent(),
+                                                    conversationMessagesPageCb);
+        if (!func.IsEmpty()) {
+            SWIGV8_VALUE callback_args[] = {SWIGV8_INTEGER_NEW_UNS(id),
+                                            V8_STRING_NEW_LOCAL(accountId),
+                                            V8_STRING_NEW_LOCAL(conversationId),
+                                            stringMapVecToJsMapArray(messages),
+                                            V8_STRING_NEW_LOCAL(next)};
+            func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 5, callback_args);
+        }
+    });
 }
 
 void
@@ -560,8 +528,7 @@ messageReceived(const std::string& accountId,
                 const std::string& conversationId,
                 const std::map<std::string, std::string>& message)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, conversationId, message]() {
+    pendingSignals.post([accountId, conversationId, message]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), messageReceivedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -570,7 +537,6 @@ messageReceived(const std::string& accountId,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-    uv_async_send(&signalAsync);
 }
 
 void
@@ -578,8 +544,7 @@ conversationRequestReceived(const std::string& accountId,
                             const std::string& conversationId,
                             const std::map<std::string, std::string>& message)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, conversationId, message]() {
+    pendingSignals.post([accountId, conversationId, message]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(),
                                                     conversationRequestReceivedCb);
         if (!func.IsEmpty()) {
@@ -589,14 +554,12 @@ conversationRequestReceived(const std::string& accountId,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-    uv_async_send(&signalAsync);
 }
 
 void
 conversationRequestDeclined(const std::string& accountId, const std::string& conversationId)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, conversationId]() {
+    pendingSignals.post([accountId, conversationId]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(),
                                                     conversationRequestDeclinedCb);
         if (!func.IsEmpty()) {
@@ -605,14 +568,12 @@ conversationRequestDeclined(const std::string& accountId, const std::string& con
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 2, callback_args);
         }
     });
-    uv_async_send(&signalAsync);
 }
 
 void
 conversationReady(const std::string& accountId, const std::string& conversationId)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, conversationId]() {
+    pendingSignals.post([accountId, conversationId]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), conversationReadyCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {
@@ -622,14 +583,12 @@ conversationReady(const std::string& accountId, const std::string& conversationI
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 2, callback_args);
         }
     });
-    uv_async_send(&signalAsync);
 }
 
 void
 conversationRemoved(const std::string& accountId, const std::string& conversationId)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, conversationId]() {
+    pendingSignals.post([accountId, conversationId]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), conversationRemovedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {
@@ -639,7 +598,6 @@ conversationRemoved(const std::string& accountId, const std::string& conversatio
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 2, callback_args);
         }
     });
-    uv_async_send(&signalAsync);
 }
 
 void
@@ -648,8 +606,7 @@ conversationMemberEvent(const std::string& accountId,
                         const std::string& memberUri,
                         int event)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, conversationId, memberUri, event]() {
+    pendingSignals.post([accountId, conversationId, memberUri, event]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(),
                                                     conversationMemberEventCb);
         if (!func.IsEmpty()) {
@@ -660,7 +617,6 @@ conversationMemberEvent(const std::string& accountId,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 4, callback_args);
         }
     });
-    uv_async_send(&signalAsync);
 }
 
 void
@@ -669,8 +625,7 @@ onConversationError(const std::string& accountId,
                     uint32_t code,
                     const std::string& what)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, conversationId, code, what]() {
+    pendingSignals.post([accountId, conversationId, code, what]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), onConversationErrorCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -680,14 +635,12 @@ onConversationError(const std::string& accountId,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 4, callback_args);
         }
     });
-    uv_async_send(&signalAsync);
 }
 
 void
 conferenceCreated(const std::string& accountId, const std::string& confId)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, confId]() {
+    pendingSignals.post([accountId, confId]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), conferenceCreatedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -695,14 +648,12 @@ conferenceCreated(const std::string& accountId, const std::string& confId)
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 2, callback_args);
         }
     });
-    uv_async_send(&signalAsync);
 }
 
 void
 conferenceChanged(const std::string& accountId, const std::string& confId, const std::string& state)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, confId, state]() {
+    pendingSignals.post([accountId, confId, state]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), conferenceChangedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -711,14 +662,12 @@ conferenceChanged(const std::string& accountId, const std::string& confId, const
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-    uv_async_send(&signalAsync);
 }
 
 void
 conferenceRemoved(const std::string& accountId, const std::string& confId)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, confId]() {
+    pendingSignals.post([accountId, confId]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(), conferenceRemovedCb);
         if (!func.IsEmpty()) {
             SWIGV8_VALUE callback_args[] = {V8_STRING_NEW_LOCAL(accountId),
@@ -726,7 +675,6 @@ conferenceRemoved(const std::string& accountId, const std::string& confId)
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 2, callback_args);
         }
     });
-    uv_async_send(&signalAsync);
 }
 
 void
@@ -734,8 +682,8 @@ onConferenceInfosUpdated(const std::string& accountId,
                          const std::string& confId,
                          const std::vector<std::map<std::string, std::string>>& infos)
 {
-    std::lock_guard<std::mutex> lock(pendingSignalsLock);
-    pendingSignals.emplace([accountId, confId, infos]() {
+    auto key = DRing::SignalQueue::makeKey("OnConferenceInfosUpdated", accountId, confId);
+    pendingSignals.post(std::move(key), [accountId, confId, infos]() {
         Local<Function> func = Local<Function>::New(Isolate::GetCurrent(),
                                                     onConferenceInfosUpdatedCb);
         if (!func.IsEmpty()) {
@@ -745,5 +693,4 @@ onConferenceInfosUpdated(const std::string& accountId,
             func->Call(SWIGV8_CURRENT_CONTEXT(), SWIGV8_NULL(), 3, callback_args);
         }
     });
-    uv_async_send(&signalAsync);
 }
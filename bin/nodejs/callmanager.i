@@ -80,6 +80,7 @@ bool muteLocalMedia(const std::string& accountId, const std::string& callId, con
 bool transfer(const std::string& accountId, const std::string& callId, const std::string& to);
 bool attendedTransfer(const std::string& accountId, const std::string& transferID, const std::string& targetID);
 std::map<std::string, std::string> getCallDetails(const std::string& accountId, const std::string& callId);
+std::vector<std::map<std::string, std::string>> getCallsDetails(const std::string& accountId, const std::vector<std::string>& callIds, const std::vector<std::string>& fields);
 std::vector<std::string> getCallList(const std::string& accountId);
 
 /* Conference related methods */
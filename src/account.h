@@ -71,6 +71,7 @@ class Controller;
 class Call;
 class SystemCodecContainer;
 struct IceTransportOptions;
+class IceTransport;
 
 class VoipLinkException : public std::runtime_error
 {
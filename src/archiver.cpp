@@ -48,7 +48,11 @@ extern "C" {
 #endif
 
 #include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <mutex>
+#include <thread>
 
 using namespace std::literals;
 
@@ -268,12 +272,32 @@ createArchiveDiskWriter()
                 archive_write_free(a);
             }};
 }
+
+static ArchivePtr
+openArchiveReader(const std::string& archivePath)
+{
+    ArchivePtr archiveReader = createArchiveReader();
+    // Set reader formats(archive) and filters(compression)
+    archive_read_support_filter_all(archiveReader.get());
+    archive_read_support_format_all(archiveReader.get());
+    if (archive_read_open_filename(archiveReader.get(), archivePath.c_str(), 10240)) {
+        throw std::runtime_error("Open Archive: " + archivePath + "\t"
+                                 + archive_error_string(archiveReader.get()));
+    }
+    return archiveReader;
+}
+
+// Readers extracting an archive at the same time
+static constexpr std::size_t MAX_EXTRACT_THREADS {4};
 //==========================
 #endif
 #endif
 
 void
-uncompressArchive(const std::string& archivePath, const std::string& dir, const FileMatchPair& f)
+uncompressArchive(const std::string& archivePath,
+                  const std::string& dir,
+                  const FileMatchPair& f,
+                  const ExtractProgress& onProgress)
 {
 #ifdef ENABLE_PLUGIN
 #if defined(__APPLE__)
@@ -332,80 +356,148 @@ uncompressArchive(const std::string& archivePath, const std::string& dir, const
     mz_zip_delete(&zip_handle);
 
 #else
-    int r;
-
-    ArchivePtr archiveReader = createArchiveReader();
-    ArchivePtr archiveDiskWriter = createArchiveDiskWriter();
-    struct archive_entry* entry;
-
-    int flags = ARCHIVE_EXTRACT_TIME | ARCHIVE_EXTRACT_NO_HFS_COMPRESSION;
-
-    // Set reader formats(archive) and filters(compression)
-    archive_read_support_filter_all(archiveReader.get());
-    archive_read_support_format_all(archiveReader.get());
-
-    // Set written files flags and standard lookup(uid/gid)
-    archive_write_disk_set_options(archiveDiskWriter.get(), flags);
-    archive_write_disk_set_standard_lookup(archiveDiskWriter.get());
-
-    // Try to read the archive
-    if ((r = archive_read_open_filename(archiveReader.get(), archivePath.c_str(), 10240))) {
-        throw std::runtime_error("Open Archive: " + archivePath + "\t"
-                                 + archive_error_string(archiveReader.get()));
+    struct Entry
+    {
+        std::size_t index;
+        std::string destination;
+        int64_t size;
+    };
+
+    // List the entries to extract, their data is skipped without being uncompressed
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    {
+        ArchivePtr archiveReader = openArchiveReader(archivePath);
+        struct archive_entry* entry;
+        for (std::size_t index = 0;; ++index) {
+            int r = archive_read_next_header(archiveReader.get(), &entry);
+            if (r == ARCHIVE_EOF)
+                break;
+            if (r != ARCHIVE_OK && r != ARCHIVE_WARN) {
+                throw std::runtime_error("Error reading archive: "s
+                                         + archive_error_string(archiveReader.get()));
+            }
+            const auto& fileMatchPair = f(archive_entry_pathname(entry));
+            if (fileMatchPair.first) {
+                entries.push_back({index,
+                                   dir + DIR_SEPARATOR_CH + fileMatchPair.second,
+                                   archive_entry_size(entry)});
+                total += std::max<int64_t>(entries.back().size, 0);
+            }
+        }
     }
+    fileutils::check_dir(dir.c_str());
 
-    while (true) {
-        // Read headers until End of File
-        r = archive_read_next_header(archiveReader.get(), &entry);
-        if (r == ARCHIVE_EOF) {
-            break;
-        }
-        if (r != ARCHIVE_OK && r != ARCHIVE_WARN) {
-            throw std::runtime_error("Error reading archive: "s
-                                     + archive_error_string(archiveReader.get()));
+    // Each worker reads the archive with its own reader and extracts a share of
+    // the entries, largest first on the least loaded worker. Writing the files
+    // overlaps with decompressing, so the workers don't depend on the core count.
+    unsigned workers = std::min<std::size_t>(MAX_EXTRACT_THREADS, entries.size());
+    std::vector<std::map<std::size_t, const Entry*>> shares(std::max(1u, workers));
+    {
+        std::vector<const Entry*> bySize;
+        for (const auto& e : entries)
+            bySize.emplace_back(&e);
+        std::sort(bySize.begin(), bySize.end(), [](const Entry* a, const Entry* b) {
+            return a->size > b->size;
+        });
+        std::vector<int64_t> load(shares.size(), 0);
+        for (const auto* e : bySize) {
+            auto i = std::min_element(load.begin(), load.end()) - load.begin();
+            load[i] += e->size;
+            shares[i].emplace(e->index, e);
         }
+    }
 
-        std::string_view fileEntry(archive_entry_pathname(entry));
-
-        // File is ok, copy its header to the ext writer
-        const auto& fileMatchPair = f(fileEntry);
-        if (fileMatchPair.first) {
-            std::string entryDestinationPath = dir + DIR_SEPARATOR_CH + fileMatchPair.second;
-            archive_entry_set_pathname(entry, entryDestinationPath.c_str());
-            r = archive_write_header(archiveDiskWriter.get(), entry);
-            if (r != ARCHIVE_OK) {
-                // Rollback if failed at a write operation
-                fileutils::removeAll(dir);
-                throw std::runtime_error("Write file header: " + fileEntry + "\t"
-                                         + archive_error_string(archiveDiskWriter.get()));
-            } else {
-                // Here both the reader and the writer have moved past the headers
-                // Copying the data content
+    std::atomic<uint64_t> done {0};
+    std::atomic<uint64_t> nextReport {0};
+    std::mutex progressMtx;
+    uint64_t reported = 0;
+    const uint64_t reportStep = std::max<uint64_t>(total / 100, 1024 * 1024);
+    auto progress = [&](std::size_t bytes) {
+        auto d = done.fetch_add(bytes) + bytes;
+        auto n = nextReport.load();
+        if (not onProgress or d < n or not nextReport.compare_exchange_strong(n, d + reportStep))
+            return;
+        std::lock_guard<std::mutex> lk(progressMtx);
+        if (d > reported) {
+            reported = d;
+            onProgress(d, total);
+        }
+    };
+
+    std::atomic_bool failed {false};
+    std::exception_ptr error;
+    std::mutex errorMtx;
+    auto extract = [&](const std::map<std::size_t, const Entry*>& share) {
+        try {
+            ArchivePtr archiveReader = openArchiveReader(archivePath);
+            ArchivePtr archiveDiskWriter = createArchiveDiskWriter();
+            // Set written files flags and standard lookup(uid/gid)
+            archive_write_disk_set_options(archiveDiskWriter.get(),
+                                           ARCHIVE_EXTRACT_TIME
+                                               | ARCHIVE_EXTRACT_NO_HFS_COMPRESSION);
+            archive_write_disk_set_standard_lookup(archiveDiskWriter.get());
+
+            struct archive_entry* entry;
+            auto next = share.begin();
+            for (std::size_t index = 0; next != share.end() and not failed; ++index) {
+                // Read headers until the next entry of this share
+                int r = archive_read_next_header(archiveReader.get(), &entry);
+                if (r == ARCHIVE_EOF)
+                    throw std::runtime_error("Truncated archive: " + archivePath);
+                if (r != ARCHIVE_OK && r != ARCHIVE_WARN) {
+                    throw std::runtime_error("Error reading archive: "s
+                                             + archive_error_string(archiveReader.get()));
+                }
+                if (index != next->first)
+                    continue;
+
+                const auto& destination = next->second->destination;
+                archive_entry_set_pathname(entry, destination.c_str());
+                if (archive_write_header(archiveDiskWriter.get(), entry) != ARCHIVE_OK) {
+                    throw std::runtime_error("Write file header: " + destination + "\t"
+                                             + archive_error_string(archiveDiskWriter.get()));
+                }
+                // Here both the reader and the writer have moved past the headers.
+                // Copying the data content, the reader checks the CRC of the entry
+                // while uncompressing it
                 DataBlock db;
-
-                while (true) {
-                    r = readDataBlock(archiveReader, db);
-                    if (r == ARCHIVE_EOF) {
-                        break;
-                    }
-
+                while ((r = readDataBlock(archiveReader, db)) != ARCHIVE_EOF) {
                     if (r != ARCHIVE_OK) {
-                        throw std::runtime_error("Read file data: " + fileEntry + "\t"
+                        throw std::runtime_error("Read file data: " + destination + "\t"
                                                  + archive_error_string(archiveReader.get()));
                     }
-
-                    r = writeDataBlock(archiveDiskWriter, db);
-
-                    if (r != ARCHIVE_OK) {
-                        // Rollback if failed at a write operation
-                        fileutils::removeAll(dir);
-                        throw std::runtime_error("Write file data: " + fileEntry + "\t"
-                                                 + archive_error_string(archiveDiskWriter.get()));
+                    if (writeDataBlock(archiveDiskWriter, db) != ARCHIVE_OK) {
+                        throw std::runtime_error("Write file data: " + destination + "\t"
+                                                 + archive_error_string(
+                                                     archiveDiskWriter.get()));
                     }
+                    progress(db.size);
                 }
+                ++next;
             }
+        } catch (...) {
+            std::lock_guard<std::mutex> lk(errorMtx);
+            if (not error)
+                error = std::current_exception();
+            failed = true;
         }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < shares.size(); ++i)
+        threads.emplace_back(extract, std::cref(shares[i]));
+    extract(shares[0]);
+    for (auto& thread : threads)
+        thread.join();
+
+    if (error) {
+        // Rollback if failed at a write operation
+        fileutils::removeAll(dir);
+        std::rethrow_exception(error);
     }
+    if (onProgress)
+        onProgress(total, total);
 #endif
 #endif
 }
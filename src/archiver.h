@@ -41,6 +41,8 @@ namespace jami {
 namespace archiver {
 
 using FileMatchPair = std::function<std::pair<bool, std::string_view>(std::string_view)>;
+/** Uncompressed bytes written, total uncompressed size */
+using ExtractProgress = std::function<void(uint64_t, uint64_t)>;
 
 /**
  * Compress a STL string using zlib with given compression level and return
@@ -79,9 +81,15 @@ gzFile openGzip(const std::string& path, const char* mode);
  * Where the bool indicates if we should uncompress this file
  * and the new file name relative path puts the file in the directory dir under a different
  * relative path name like mynewsubfolder/myfile
- * @return void
+ * @param onProgress called while extracting, from any of the extracting threads
+ * Entries are extracted in parallel by several readers (libarchive only). On
+ * failure, dir is removed.
+ * @throw std::runtime_error
  */
-void uncompressArchive(const std::string& path, const std::string& dir, const FileMatchPair& f);
+void uncompressArchive(const std::string& path,
+                       const std::string& dir,
+                       const FileMatchPair& f,
+                       const ExtractProgress& onProgress = {});
 
 /**
  * @brief readFileFromArchive read a file from an archive without uncompressing
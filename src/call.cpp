@@ -37,6 +37,7 @@
 #include "call_factory.h"
 #include "string_utils.h"
 #include "enumclass_utils.h"
+#include "smartools.h"
 
 #include "errno.h"
 
@@ -46,6 +47,7 @@
 #include <system_error>
 #include <algorithm>
 #include <functional>
+#include <iterator>
 #include <utility>
 
 namespace jami {
@@ -260,6 +262,8 @@ Call::setState(CallState call_state, ConnectionState cnx_state, signed code)
     callState_ = call_state;
     connectionState_ = cnx_state;
     auto new_client_state = getStateStr();
+    if (connectionState_ == ConnectionState::CONNECTED)
+        markSetupPhase(SetupPhase::SIP_ANSWER);
 
     for (auto it = stateChangedListeners_.begin(); it != stateChangedListeners_.end();) {
         if ((*it)(callState_, connectionState_, code))
@@ -372,7 +376,7 @@ std::map<std::string, std::string>
 Call::getDetails() const
 {
     auto conference = conf_.lock();
-    return {
+    std::map<std::string, std::string> details {
         {DRing::Call::Details::CALL_TYPE, std::to_string((unsigned) type_)},
         {DRing::Call::Details::PEER_NUMBER, peerNumber_},
         {DRing::Call::Details::DISPLAY_NAME, peerDisplayName_},
@@ -386,6 +390,59 @@ Call::getDetails() const
          std::string(bool_to_str(isCaptureDeviceMuted(MediaType::MEDIA_VIDEO)))},
         {DRing::Call::Details::AUDIO_ONLY, std::string(bool_to_str(not hasVideo()))},
     };
+    for (const auto& [phase, time] : getSetupTimeline())
+        details.emplace(DRing::Call::Details::SETUP_TIMELINE_PREFIX + phase,
+                        std::to_string(time.count()));
+    return details;
+}
+
+const char*
+Call::setupPhaseToString(SetupPhase phase)
+{
+    static constexpr const char* names[] {"DHT_REQUEST",
+                                          "ICE_GATHER",
+                                          "ICE_CHECK",
+                                          "TLS_HANDSHAKE",
+                                          "SIP_INVITE",
+                                          "SIP_ANSWER",
+                                          "MEDIA_START",
+                                          "FIRST_FRAME"};
+    static_assert(std::size(names) == static_cast<size_t>(SetupPhase::COUNT__));
+    return names[static_cast<size_t>(phase)];
+}
+
+void
+Call::markSetupPhase(SetupPhase phase, time_point when)
+{
+    {
+        std::lock_guard<std::mutex> lk {setupTimelineMtx_};
+        auto& time = setupTimeline_[static_cast<size_t>(phase)];
+        if (when < setupStart_ or time != time_point {})
+            return;
+        time = when;
+    }
+    // Media only runs in the parent call, report the whole timeline once it flows
+    if (phase != SetupPhase::FIRST_FRAME)
+        return;
+    auto timeline = getSetupTimeline();
+    JAMI_DBG("[call:%s] Setup done in %ld ms",
+             getCallId().c_str(),
+             timeline[setupPhaseToString(phase)].count());
+    Smartools::getInstance().addCallSetupTimeline(timeline);
+}
+
+std::map<std::string, std::chrono::milliseconds>
+Call::getSetupTimeline() const
+{
+    std::lock_guard<std::mutex> lk {setupTimelineMtx_};
+    std::map<std::string, std::chrono::milliseconds> timeline;
+    for (size_t i = 0; i < setupTimeline_.size(); i++) {
+        if (setupTimeline_[i] != time_point {})
+            timeline.emplace(setupPhaseToString(static_cast<SetupPhase>(i)),
+                             std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 setupTimeline_[i] - setupStart_));
+    }
+    return timeline;
 }
 
 void
@@ -571,6 +628,15 @@ Call::merge(Call& subcall)
     if (peerNumber_.empty())
         peerNumber_ = std::move(subcall.peerNumber_);
     peerDisplayName_ = std::move(subcall.peerDisplayName_);
+    decltype(setupTimeline_) subcallTimeline;
+    {
+        std::lock_guard<std::mutex> lk {subcall.setupTimelineMtx_};
+        subcallTimeline = subcall.setupTimeline_;
+    }
+    for (size_t i = 0; i < subcallTimeline.size(); i++) {
+        if (subcallTimeline[i] != time_point {})
+            markSetupPhase(static_cast<SetupPhase>(i), subcallTimeline[i]);
+    }
     setState(subcall.getState(), subcall.getConnectionState());
 
     std::weak_ptr<Call> subCallWeak = subcall.shared_from_this();
@@ -36,7 +36,9 @@
 #include "media_codec.h"
 #include "media/media_attribute.h"
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <map>
 #include <sstream>
@@ -351,6 +353,36 @@ public:
                                                                            - duration_start_);
     }
 
+    /**
+     * Steps of the call setup, in the order they are expected to happen.
+     * Phases of the peer connection are only known for connections opened for this call.
+     */
+    enum class SetupPhase : unsigned {
+        DHT_REQUEST,   // Connection request answered through the DHT
+        ICE_GATHER,    // Local ICE candidates gathered
+        ICE_CHECK,     // ICE connectivity checks succeeded
+        TLS_HANDSHAKE, // TLS session with the peer device ready
+        SIP_INVITE,    // INVITE sent or received
+        SIP_ANSWER,    // 200 OK sent or received
+        MEDIA_START,   // Media started on the negotiated transport
+        FIRST_FRAME,   // First remote media frame decoded
+        COUNT__
+    };
+
+    static const char* setupPhaseToString(SetupPhase phase);
+
+    /**
+     * Record when a setup phase was reached. Only the first occurrence is kept,
+     * and phases reached before the creation of the call are ignored.
+     */
+    void markSetupPhase(SetupPhase phase,
+                        std::chrono::steady_clock::time_point when = std::chrono::steady_clock::now());
+
+    /**
+     * @return the reached setup phases with their time since the creation of the call
+     */
+    std::map<std::string, std::chrono::milliseconds> getSetupTimeline() const;
+
     // media management
     virtual bool toggleRecording();
 
@@ -486,6 +518,11 @@ protected:
     mutable ConfInfo confInfo_ {};
     time_point duration_start_ {time_point::min()};
 
+    const time_point setupStart_ {clock::now()};
+    // Not callMutex_, as phases are also marked from media threads
+    mutable std::mutex setupTimelineMtx_ {};
+    std::array<time_point, static_cast<size_t>(SetupPhase::COUNT__)> setupTimeline_ {};
+
 private:
     bool validStateTransition(CallState newState);
 
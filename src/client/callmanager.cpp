@@ -29,6 +29,7 @@
 #include "sip/sipvoiplink.h"
 #include "audio/audiolayer.h"
 #include "media/media_attribute.h"
+#include "map_utils.h"
 #include "string_utils.h"
 
 #include "logger.h"
@@ -399,6 +400,23 @@ getCallDetails(const std::string& accountId, const std::string& callId)
     return {};
 }
 
+std::vector<std::map<std::string, std::string>>
+getCallsDetails(const std::string& accountId,
+                const std::vector<std::string>& callIds,
+                const std::vector<std::string>& fields)
+{
+    std::vector<std::map<std::string, std::string>> result(callIds.size());
+    if (const auto account = jami::Manager::instance().getAccount(accountId)) {
+        for (std::size_t i = 0; i < callIds.size(); ++i) {
+            if (auto call = account->getCall(callIds[i])) {
+                result[i] = call->getDetails();
+                jami::map_utils::filterKeys(result[i], fields);
+            }
+        }
+    }
+    return result;
+}
+
 std::vector<std::string>
 getCallList()
 {
@@ -33,6 +33,7 @@
 #include "security/certstore.h"
 #include "logger.h"
 #include "fileutils.h"
+#include "map_utils.h"
 #include "archiver.h"
 #include "ip_utils.h"
 #include "sip/sipaccount.h"
@@ -43,6 +44,8 @@
 #include "client/ring_signal.h"
 #include "upnp/upnp_context.h"
 #include "audio/ringbufferpool.h"
+#include "cpu_accounting.h"
+#include "memory_accounting.h"
 
 #ifdef __APPLE__
 #include <TargetConditionals.h>
@@ -84,6 +87,22 @@ getAccountDetails(const std::string& accountID)
     return jami::Manager::instance().getAccountDetails(accountID);
 }
 
+std::vector<std::map<std::string, std::string>>
+getAccountsDetails(const std::vector<std::string>& accountIDs,
+                   const std::vector<std::string>& fields)
+{
+    std::vector<std::map<std::string, std::string>> result;
+    result.reserve(accountIDs.size());
+    for (const auto& accountID : accountIDs) {
+        if (const auto account = jami::Manager::instance().getAccount(accountID))
+            result.emplace_back(account->getAccountDetails());
+        else
+            result.emplace_back();
+        jami::map_utils::filterKeys(result.back(), fields);
+    }
+    return result;
+}
+
 std::map<std::string, std::string>
 getVolatileAccountDetails(const std::string& accountID)
 {
@@ -376,6 +395,16 @@ getContactDetails(const std::string& accountId, const std::string& uri)
     return {};
 }
 
+std::vector<std::map<std::string, std::string>>
+getContactsDetails(const std::string& accountId,
+                   const std::vector<std::string>& uris,
+                   const std::vector<std::string>& fields)
+{
+    if (auto acc = jami::Manager::instance().getAccount<jami::JamiAccount>(accountId))
+        return acc->getContactsDetails(uris, fields);
+    return std::vector<std::map<std::string, std::string>>(uris.size());
+}
+
 std::vector<std::map<std::string, std::string>>
 getContacts(const std::string& accountId)
 {
@@ -441,6 +470,38 @@ monitor(bool continuous)
     return jami::Manager::instance().monitor(continuous);
 }
 
+std::vector<std::map<std::string, std::string>>
+getCpuAccounting()
+{
+    return jami::CpuAccounting::getInstance().getStats();
+}
+
+void
+setCpuAccountingDump(const std::string& path, int32_t periodSeconds)
+{
+    jami::CpuAccounting::getInstance().setDump(path, std::chrono::seconds(periodSeconds));
+}
+
+std::map<std::string, std::string>
+getMemoryUsage()
+{
+    return jami::MemoryAccounting::getStats();
+}
+
+void
+setMemorySoftLimits(const std::map<std::string, std::string>& limits)
+{
+    jami::MemoryAccounting::setSoftLimits(limits);
+}
+
+std::map<std::string, std::string>
+getAccountActivity(const std::string& accountId)
+{
+    if (auto acc = jami::Manager::instance().getAccount<jami::JamiAccount>(accountId))
+        return acc->getActivityStats();
+    return {};
+}
+
 void
 removeAccount(const std::string& accountID)
 {
@@ -87,6 +87,15 @@ getConversationRequests(const std::string& accountId)
     return {};
 }
 
+std::vector<std::map<std::string, std::string>>
+getConversationSummaries(const std::string& accountId)
+{
+    if (auto acc = jami::Manager::instance().getAccount<jami::JamiAccount>(accountId))
+        if (auto convModule = acc->convModule())
+            return convModule->getConversationSummaries();
+    return {};
+}
+
 void
 updateConversationInfos(const std::string& accountId,
                         const std::string& conversationId,
@@ -106,6 +115,17 @@ conversationInfos(const std::string& accountId, const std::string& conversationI
     return {};
 }
 
+std::vector<std::map<std::string, std::string>>
+conversationsInfos(const std::string& accountId,
+                   const std::vector<std::string>& conversationIds,
+                   const std::vector<std::string>& fields)
+{
+    if (auto acc = jami::Manager::instance().getAccount<jami::JamiAccount>(accountId))
+        if (auto convModule = acc->convModule())
+            return convModule->conversationsInfos(conversationIds, fields);
+    return std::vector<std::map<std::string, std::string>>(conversationIds.size());
+}
+
 // Member management
 void
 addConversationMember(const std::string& accountId,
@@ -136,6 +156,16 @@ getConversationMembers(const std::string& accountId, const std::string& conversa
     return {};
 }
 
+std::vector<std::map<std::string, std::string>>
+getConversationsMembers(const std::string& accountId,
+                        const std::vector<std::string>& conversationIds)
+{
+    if (auto acc = jami::Manager::instance().getAccount<jami::JamiAccount>(accountId))
+        if (auto convModule = acc->convModule())
+            return convModule->getConversationsMembers(conversationIds);
+    return {};
+}
+
 // Message send/load
 void
 sendMessage(const std::string& accountId,
@@ -160,6 +190,27 @@ loadConversationMessages(const std::string& accountId,
     return 0;
 }
 
+uint32_t
+loadConversationMessagesPaged(const std::string& accountId,
+                              const std::string& conversationId,
+                              const std::string& fromMessage,
+                              size_t pageSize)
+{
+    if (auto acc = jami::Manager::instance().getAccount<jami::JamiAccount>(accountId))
+        if (auto convModule = acc->convModule())
+            return convModule->loadConversationMessagesPaged(conversationId, fromMessage, pageSize);
+    return 0;
+}
+
+bool
+cancelLoadConversationMessages(const std::string& accountId, uint32_t id)
+{
+    if (auto acc = jami::Manager::instance().getAccount<jami::JamiAccount>(accountId))
+        if (auto convModule = acc->convModule())
+            return convModule->cancelLoadConversationMessages(id);
+    return false;
+}
+
 uint32_t
 countInteractions(const std::string& accountId,
                   const std::string& conversationId,
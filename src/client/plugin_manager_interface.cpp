@@ -92,6 +92,12 @@ installPlugin(const std::string& jplPath, bool force)
     return jami::Manager::instance().getJamiPluginManager().installPlugin(jplPath, force);
 }
 
+void
+installPluginAsync(const std::string& jplPath, bool force)
+{
+    jami::Manager::instance().getJamiPluginManager().installPluginAsync(jplPath, force);
+}
+
 int
 uninstallPlugin(const std::string& pluginRootPath)
 {
@@ -158,6 +164,24 @@ getCallMediaHandlerStatus(const std::string& callId)
         .getCallMediaHandlerStatus(callId);
 }
 
+std::vector<std::map<std::string, std::string>>
+getCallMediaHandlerStats(const std::string& callId)
+{
+    return jami::Manager::instance()
+        .getJamiPluginManager()
+        .getCallServicesManager()
+        .getCallMediaHandlerStats(callId);
+}
+
+void
+setCallMediaHandlerLatencyBudget(const std::string& mediaHandlerId, int32_t budgetMs)
+{
+    jami::Manager::instance()
+        .getJamiPluginManager()
+        .getCallServicesManager()
+        .setCallMediaHandlerLatencyBudget(mediaHandlerId, budgetMs);
+}
+
 std::map<std::string, std::string>
 getChatHandlerDetails(const std::string& chatHandlerId)
 {
@@ -90,6 +90,8 @@ getSignalHandlers()
         exported_callback<DRing::ConfigurationSignal::HardwareDecodingChanged>(),
         exported_callback<DRing::ConfigurationSignal::HardwareEncodingChanged>(),
         exported_callback<DRing::ConfigurationSignal::MessageSend>(),
+        exported_callback<DRing::ConfigurationSignal::PluginInstallationProgress>(),
+        exported_callback<DRing::ConfigurationSignal::PluginInstallationFinished>(),
 
         /* Presence */
         exported_callback<DRing::PresenceSignal::NewServerSubscriptionRequest>(),
@@ -127,6 +129,7 @@ getSignalHandlers()
 
         /* Conversation */
         exported_callback<DRing::ConversationSignal::ConversationLoaded>(),
+        exported_callback<DRing::ConversationSignal::ConversationMessagesPage>(),
         exported_callback<DRing::ConversationSignal::MessageReceived>(),
         exported_callback<DRing::ConversationSignal::ConversationRequestReceived>(),
         exported_callback<DRing::ConversationSignal::ConversationRequestDeclined>(),
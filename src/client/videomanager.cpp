@@ -141,6 +141,7 @@ AudioFrame::reserve(size_t nb_samples)
         if ((err = av_frame_get_buffer(d, 0)) < 0) {
             throw std::bad_alloc();
         }
+        jami::libav_utils::trackFrameMemory(d);
     }
 }
 
@@ -293,6 +294,7 @@ VideoFrame::reserve(int format, int width, int height)
     setGeometry(format, width, height);
     if (av_frame_get_buffer(libav_frame, 32))
         throw std::bad_alloc();
+    jami::libav_utils::trackFrameMemory(libav_frame);
     allocated_ = true;
     releaseBufferCb_ = {};
 }
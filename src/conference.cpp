@@ -220,6 +220,8 @@ Conference::~Conference()
             getConfId());
         confAVStreams.clear();
     }
+    if (not isRecording())
+        unbindMixedAudio();
 #endif // ENABLE_PLUGIN
 }
 
@@ -285,11 +287,19 @@ Conference::createConfAVStreams()
         return std::static_pointer_cast<AudioFrame>(m)->pointer();
     };
 
-    // Preview and Received
-    if ((audioMixer_ = jami::getAudioInput(getConfId()))) {
+    // Received: the mix of the whole conference, processed once per frame.
+    // There is no separate composite for the preview: the host's microphone is part
+    // of this mix, and each participant receives the mix of the others.
+    // Mixing has a cost, so only when media handlers are loaded.
+    if (not ghostRingBuffer_
+        and not Manager::instance()
+                    .getJamiPluginManager()
+                    .getCallServicesManager()
+                    .getCallMediaHandlers()
+                    .empty())
+        bindMixedAudio();
+    if (audioMixer_) {
         auto audioSubject = std::make_shared<MediaStreamSubject>(audioMap);
-        StreamData previewStreamData {getConfId(), false, StreamType::audio, getConfId()};
-        createConfAVStream(previewStreamData, *audioMixer_, audioSubject);
         StreamData receivedStreamData {getConfId(), true, StreamType::audio, getConfId()};
         createConfAVStream(receivedStreamData, *audioMixer_, audioSubject);
     }
@@ -297,7 +307,7 @@ Conference::createConfAVStreams()
 #ifdef ENABLE_VIDEO
 
     if (videoMixer_) {
-        // Review
+        // Received: the composed layout, after the mix and before the encoders and the sink
         auto receiveSubject = std::make_shared<MediaStreamSubject>(pluginVideoMap_);
         StreamData receiveStreamData {getConfId(), true, StreamType::video, getConfId()};
         createConfAVStream(receiveStreamData, *videoMixer_, receiveSubject);
@@ -649,6 +659,9 @@ Conference::addParticipant(const std::string& participant_id)
     } else
         JAMI_ERR("no call associate to participant %s", participant_id.c_str());
 #endif // ENABLE_VIDEO
+    // Keep the mix of the conference (recorder, plugins) complete
+    if (ghostRingBuffer_)
+        bindParticipant(getConfId());
 #ifdef ENABLE_PLUGIN
     createConfAVStreams();
 #endif
@@ -1041,15 +1054,10 @@ Conference::initRecorder(std::shared_ptr<MediaRecorder>& rec)
 #endif
 
     // Audio
-    // Create ghost participant for ringbufferpool
-    auto& rbPool = Manager::instance().getRingBufferPool();
-    ghostRingBuffer_ = rbPool.createRingBuffer(getConfId());
-
-    // Bind it to ringbufferpool in order to get the all mixed frames
-    bindParticipant(getConfId());
+    if (not ghostRingBuffer_)
+        bindMixedAudio();
 
     // Add stream to recorder
-    audioMixer_ = jami::getAudioInput(getConfId());
     if (auto ob = rec->addStream(audioMixer_->getInfo("a:mixer"))) {
         audioMixer_->attach(ob);
     }
@@ -1068,8 +1076,37 @@ Conference::deinitRecorder(std::shared_ptr<MediaRecorder>& rec)
 #endif
 
     // Audio
-    if (auto ob = rec->getStream("a:mixer"))
-        audioMixer_->detach(ob);
+    if (audioMixer_)
+        if (auto ob = rec->getStream("a:mixer"))
+            audioMixer_->detach(ob);
+#ifdef ENABLE_PLUGIN
+    {
+        // Plugins still process the mix
+        std::lock_guard<std::mutex> lk(avStreamsMtx_);
+        if (not confAVStreams.empty())
+            return;
+    }
+#endif
+    unbindMixedAudio();
+}
+
+void
+Conference::bindMixedAudio()
+{
+    // Create ghost participant for ringbufferpool
+    auto& rbPool = Manager::instance().getRingBufferPool();
+    ghostRingBuffer_ = rbPool.createRingBuffer(getConfId());
+
+    // Bind it to ringbufferpool in order to get the all mixed frames
+    bindParticipant(getConfId());
+    audioMixer_ = jami::getAudioInput(getConfId());
+}
+
+void
+Conference::unbindMixedAudio()
+{
+    if (not ghostRingBuffer_)
+        return;
     audioMixer_.reset();
     Manager::instance().getRingBufferPool().unBindAll(getConfId());
     ghostRingBuffer_.reset();
@@ -397,6 +397,14 @@ private:
     void initRecorder(std::shared_ptr<MediaRecorder>& rec);
     void deinitRecorder(std::shared_ptr<MediaRecorder>& rec);
 
+    /**
+     * Binds a ghost participant reading every participant (and the host if attached),
+     * so that audioMixer_ outputs the mix of the whole conference.
+     * Shared by the recorder and the plugins.
+     */
+    void bindMixedAudio();
+    void unbindMixedAudio();
+
     bool isMuted(std::string_view uri) const;
 
     ConfInfo getConfInfoHostUri(std::string_view localHostURI, std::string_view destURI);
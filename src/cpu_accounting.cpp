@@ -0,0 +1,313 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+#include "cpu_accounting.h"
+#include "fileutils.h"
+#include "logger.h"
+#include "manager.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace jami {
+
+static constexpr size_t MAX_THREAD_NAME {15};
+
+static uint64_t
+toNs(const timespec& ts)
+{
+    return uint64_t(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+#ifdef _WIN32
+static uint64_t
+toNs(const FILETIME& kernel, const FILETIME& user)
+{
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) * 100; // 100 ns units
+}
+#endif
+
+static uint64_t
+processCpuNs()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return toNs(kernel, user);
+    return 0;
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) == 0)
+        return toNs(ts);
+    return 0;
+#endif
+}
+
+static std::string_view
+subsystemOf(std::string_view probe)
+{
+    return probe.substr(0, probe.find('.'));
+}
+
+static std::string
+toMs(uint64_t ns)
+{
+    return std::to_string(ns / 1000000);
+}
+
+static std::string
+toSeconds(uint64_t ns)
+{
+    return std::to_string(ns / 1e9);
+}
+
+/**
+ * Account the CPU time of a registered thread to its group when it exits
+ */
+struct ThreadRegistration
+{
+    ~ThreadRegistration() { CpuAccounting::getInstance().unregisterThread(); }
+};
+
+CpuAccounting&
+CpuAccounting::getInstance()
+{
+    // Never destroyed: registered threads may exit during static destruction
+    static auto* instance_ = new CpuAccounting;
+    return *instance_;
+}
+
+CpuAccounting::CpuAccounting()
+    : start_(std::chrono::steady_clock::now())
+{}
+
+std::chrono::nanoseconds
+CpuAccounting::threadCpuTime()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+        return std::chrono::nanoseconds(toNs(kernel, user));
+    return {};
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+        return std::chrono::nanoseconds(toNs(ts));
+    return {};
+#endif
+}
+
+void
+CpuAccounting::registerThread(std::string_view group, std::string_view name)
+{
+    thread_local ThreadRegistration registration;
+
+    ThreadInfo info {std::string(group), std::string(name.substr(0, MAX_THREAD_NAME))};
+#if defined(__linux__)
+    pthread_setname_np(pthread_self(), info.name.c_str());
+    if (pthread_getcpuclockid(pthread_self(), &info.clock) != 0)
+        info.clock = CLOCK_THREAD_CPUTIME_ID; // Only valid for the calling thread
+#elif defined(__APPLE__)
+    pthread_setname_np(info.name.c_str());
+#endif
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    threads_[std::this_thread::get_id()] = std::move(info);
+}
+
+void
+CpuAccounting::unregisterThread()
+{
+    auto cpu = threadCpuTime();
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = threads_.find(std::this_thread::get_id());
+    if (it == threads_.end())
+        return;
+    exitedCpuNs_[it->second.group] += cpu.count();
+    threads_.erase(it);
+}
+
+CpuProbe&
+CpuAccounting::probe(std::string_view name)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = probes_.find(name);
+    if (it == probes_.end())
+        it = probes_.emplace(std::piecewise_construct, std::forward_as_tuple(name), std::tuple<>())
+                 .first;
+    return it->second;
+}
+
+// Live threads' CPU time can only be read from another thread on Linux. On other
+// systems, a group only accounts for its threads that exited.
+std::map<std::string, std::pair<unsigned, uint64_t>>
+CpuAccounting::groupCpu() const
+{
+    std::map<std::string, std::pair<unsigned, uint64_t>> groups;
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (const auto& [group, ns] : exitedCpuNs_)
+        groups[group].second += ns;
+    for (const auto& [id, info] : threads_) {
+        auto& group = groups[info.group];
+        group.first++;
+#ifdef __linux__
+        timespec ts;
+        if (info.clock != CLOCK_THREAD_CPUTIME_ID and clock_gettime(info.clock, &ts) == 0)
+            group.second += toNs(ts);
+#endif
+    }
+    return groups;
+}
+
+std::vector<std::map<std::string, std::string>>
+CpuAccounting::getStats() const
+{
+    std::vector<std::map<std::string, std::string>> stats;
+    auto uptime = std::chrono::nanoseconds(std::chrono::steady_clock::now() - start_).count();
+    auto processNs = processCpuNs();
+    stats.emplace_back(std::map<std::string, std::string> {{"type", "process"},
+                                                           {"name", "jami"},
+                                                           {"cpu_ms", toMs(processNs)},
+                                                           {"wall_ms", toMs(uptime)}});
+
+    uint64_t accountedNs = 0;
+    for (const auto& [group, usage] : groupCpu()) {
+        accountedNs += usage.second;
+        stats.emplace_back(std::map<std::string, std::string> {{"type", "group"},
+                                                               {"name", group},
+                                                               {"threads",
+                                                                std::to_string(usage.first)},
+                                                               {"cpu_ms", toMs(usage.second)}});
+    }
+    // Threads that are not registered, like the DHT thread pools
+    stats.emplace_back(
+        std::map<std::string, std::string> {{"type", "group"},
+                                            {"name", "other"},
+                                            {"cpu_ms",
+                                             toMs(processNs > accountedNs ? processNs - accountedNs
+                                                                          : 0)}});
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (const auto& [name, probe] : probes_) {
+        stats.emplace_back(std::map<std::string, std::string> {
+            {"type", "probe"},
+            {"name", name},
+            {"subsystem", std::string(subsystemOf(name))},
+            {"calls", std::to_string(probe.calls.load(std::memory_order_relaxed))},
+            {"cpu_ms", toMs(probe.cpuNs.load(std::memory_order_relaxed))},
+            {"wall_ms", toMs(probe.wallNs.load(std::memory_order_relaxed))}});
+    }
+    return stats;
+}
+
+std::string
+CpuAccounting::toOpenMetrics() const
+{
+    std::ostringstream out;
+    auto processNs = processCpuNs();
+    out << "# TYPE jami_process_cpu_seconds counter\n"
+        << "jami_process_cpu_seconds_total " << toSeconds(processNs) << "\n";
+
+    auto groups = groupCpu();
+    out << "# TYPE jami_thread_group_threads gauge\n";
+    for (const auto& [group, usage] : groups)
+        out << "jami_thread_group_threads{group=\"" << group << "\"} " << usage.first << "\n";
+    out << "# TYPE jami_thread_group_cpu_seconds counter\n";
+    for (const auto& [group, usage] : groups)
+        out << "jami_thread_group_cpu_seconds_total{group=\"" << group << "\"} "
+            << toSeconds(usage.second) << "\n";
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto probeMetric = [&](std::string_view metric, std::string_view type, auto value) {
+        out << "# TYPE jami_probe_" << metric << " " << type << "\n";
+        for (const auto& [name, probe] : probes_)
+            out << "jami_probe_" << metric << "_total{probe=\"" << name << "\",subsystem=\""
+                << subsystemOf(name) << "\"} " << value(probe) << "\n";
+    };
+    probeMetric("calls", "counter", [](const CpuProbe& p) {
+        return std::to_string(p.calls.load(std::memory_order_relaxed));
+    });
+    probeMetric("cpu_seconds", "counter", [](const CpuProbe& p) {
+        return toSeconds(p.cpuNs.load(std::memory_order_relaxed));
+    });
+    probeMetric("wall_seconds", "counter", [](const CpuProbe& p) {
+        return toSeconds(p.wallNs.load(std::memory_order_relaxed));
+    });
+    out << "# EOF\n";
+    return out.str();
+}
+
+void
+CpuAccounting::setDump(const std::string& path, std::chrono::seconds period)
+{
+    std::lock_guard<std::mutex> lk(dumpMutex_);
+    if (auto t = std::move(dumpTask_))
+        t->cancel();
+    dumpPath_ = path;
+    auto enabled = not path.empty() and period.count() > 0;
+    setProbesEnabled(enabled);
+    if (not enabled)
+        return;
+    JAMI_DBG("Dump CPU accounting to %s every %lds", path.c_str(), (long) period.count());
+    dumpTask_ = Manager::instance().scheduler().scheduleAtFixedRate(
+        [this] {
+            dump();
+            return true;
+        },
+        period);
+}
+
+void
+CpuAccounting::dump()
+{
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lk(dumpMutex_);
+        path = dumpPath_;
+    }
+    if (path.empty())
+        return;
+    // Write then rename, so that readers never see a partial file
+    auto tmpPath = path + ".tmp";
+    {
+        auto file = fileutils::ofstream(tmpPath, std::ios::trunc);
+        if (!file) {
+            JAMI_WARN("Unable to write CPU accounting to %s", tmpPath.c_str());
+            return;
+        }
+        file << toOpenMetrics();
+    }
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+        JAMI_WARN("Unable to write CPU accounting to %s", path.c_str());
+}
+
+} // namespace jami
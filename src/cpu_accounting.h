@@ -0,0 +1,173 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace jami {
+class RepeatedTask;
+
+/**
+ * Cumulated cost of a probe (a scoped timer on a hot path)
+ */
+struct CpuProbe
+{
+    std::atomic<uint64_t> calls {0};
+    std::atomic<uint64_t> cpuNs {0};  // CPU time of the calling thread
+    std::atomic<uint64_t> wallNs {0}; // Elapsed time
+};
+
+/**
+ * Per-subsystem CPU accounting.
+ * Threads registered with a group (media, sip, ice, tls...) are named and their
+ * CPU time is summed per group. Probes measure the CPU and wall time spent in
+ * hot paths; their name is "<subsystem>.<operation>". Probes are off by default
+ * since some run once per packet: they only time their scope once enabled.
+ */
+class CpuAccounting
+{
+public:
+    static CpuAccounting& getInstance();
+
+    /**
+     * Name the calling thread and account its CPU time to group until it exits.
+     * The name is truncated to 15 characters by the system.
+     */
+    void registerThread(std::string_view group, std::string_view name);
+
+    /**
+     * @return the probe called name, created on first use. The reference stays valid.
+     */
+    CpuProbe& probe(std::string_view name);
+
+    /**
+     * One entry per thread group and per probe, plus one for the whole process.
+     * Keys: type (process|group|probe), name, subsystem, threads, calls, cpu_ms, wall_ms.
+     */
+    std::vector<std::map<std::string, std::string>> getStats() const;
+
+    /**
+     * Same statistics in the OpenMetrics text format
+     */
+    std::string toOpenMetrics() const;
+
+    /**
+     * Periodically write toOpenMetrics() to path. An empty path or a null period
+     * stops the dump.
+     */
+    void setDump(const std::string& path, std::chrono::seconds period);
+
+    /**
+     * Start or stop timing probes. Enabled while a dump is active.
+     */
+    static void setProbesEnabled(bool enabled)
+    {
+        probesEnabled_.store(enabled, std::memory_order_relaxed);
+    }
+    static bool probesEnabled() { return probesEnabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @return CPU time used by the calling thread
+     */
+    static std::chrono::nanoseconds threadCpuTime();
+
+private:
+    CpuAccounting();
+
+    struct ThreadInfo
+    {
+        std::string group;
+        std::string name;
+#ifdef __linux__
+        clockid_t clock;
+#endif
+    };
+    friend struct ThreadRegistration;
+    void unregisterThread();
+    std::map<std::string, std::pair<unsigned, uint64_t>> groupCpu() const;
+    void dump();
+
+    static inline std::atomic_bool probesEnabled_ {false};
+
+    const std::chrono::steady_clock::time_point start_;
+    mutable std::mutex mutex_;
+    std::map<std::thread::id, ThreadInfo> threads_;
+    std::map<std::string, uint64_t> exitedCpuNs_; // per group, threads that exited
+    std::map<std::string, CpuProbe, std::less<>> probes_;
+
+    std::mutex dumpMutex_;
+    std::string dumpPath_;
+    std::shared_ptr<RepeatedTask> dumpTask_;
+};
+
+/**
+ * Add the cost of the current scope to a probe, if probes are enabled
+ */
+class ScopedCpuTimer
+{
+public:
+    explicit ScopedCpuTimer(CpuProbe& probe)
+        : probe_(CpuAccounting::probesEnabled() ? &probe : nullptr)
+    {
+        if (probe_) {
+            cpuStart_ = CpuAccounting::threadCpuTime();
+            wallStart_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~ScopedCpuTimer()
+    {
+        if (not probe_)
+            return;
+        auto wall = std::chrono::steady_clock::now() - wallStart_;
+        auto cpu = CpuAccounting::threadCpuTime() - cpuStart_;
+        probe_->calls.fetch_add(1, std::memory_order_relaxed);
+        probe_->cpuNs.fetch_add(cpu.count(), std::memory_order_relaxed);
+        probe_->wallNs.fetch_add(std::chrono::nanoseconds(wall).count(),
+                                 std::memory_order_relaxed);
+    }
+
+private:
+    ScopedCpuTimer(const ScopedCpuTimer&) = delete;
+    ScopedCpuTimer& operator=(const ScopedCpuTimer&) = delete;
+
+    CpuProbe* const probe_;
+    std::chrono::nanoseconds cpuStart_ {};
+    std::chrono::steady_clock::time_point wallStart_ {};
+};
+
+#define JAMI_CPU_CONCAT_(a, b) a##b
+#define JAMI_CPU_CONCAT(a, b)  JAMI_CPU_CONCAT_(a, b)
+/**
+ * Account the rest of the current scope to the probe name (a string literal)
+ */
+#define JAMI_CPU_PROBE(name) \
+    static auto& JAMI_CPU_CONCAT(cpuProbe_, __LINE__) \
+        = ::jami::CpuAccounting::getInstance().probe(name); \
+    ::jami::ScopedCpuTimer JAMI_CPU_CONCAT(cpuTimer_, __LINE__)(JAMI_CPU_CONCAT(cpuProbe_, __LINE__))
+
+} // namespace jami
@@ -38,6 +38,8 @@ class IceSocket
 {
 private:
     std::shared_ptr<IceTransport> ice_transport_ {};
+    // Set when the component is carried by a channel of the peer connection
+    std::shared_ptr<GenericSocket<uint8_t>> channel_ {};
     int compId_ = -1;
 
 public:
@@ -46,6 +48,11 @@ public:
         , compId_(compId)
     {}
 
+    IceSocket(std::shared_ptr<GenericSocket<uint8_t>> channel, int compId)
+        : channel_(std::move(channel))
+        , compId_(compId)
+    {}
+
     void close();
     ssize_t send(const unsigned char* buf, size_t len);
     ssize_t waitForData(std::chrono::milliseconds timeout);
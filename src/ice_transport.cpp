@@ -21,12 +21,16 @@
 #include "ice_transport.h"
 #include "ice_socket.h"
 #include "logger.h"
+#include "cpu_accounting.h"
+#include "memory_accounting.h"
 #include "sip/sip_utils.h"
 #include "manager.h"
 #include "upnp/upnp_control.h"
 #include "transport/peer_channel.h"
 #include "jami/callmanager_interface.h"
+#include "scheduled_executor.h"
 
+#include <opendht/thread_pool.h>
 #include <pjlib.h>
 
 #include <map>
@@ -66,6 +70,11 @@ static constexpr uint16_t IPV4_HEADER_SIZE = 20; ///< Size in bytes of IPV4 pack
 static constexpr int MAX_CANDIDATES {32};
 static constexpr int MAX_DESTRUCTION_TIMEOUT {3000};
 static constexpr int HANDLE_EVENT_DURATION {500};
+// Pooled transports are dropped and gathered again after this delay
+static constexpr std::chrono::minutes POOLED_TRANSPORT_MAX_AGE {10};
+static constexpr std::chrono::minutes POOL_REFRESH_PERIOD {1};
+// Transports are only kept ready for requests seen during this window
+static constexpr std::chrono::minutes POOL_DEMAND_WINDOW {30};
 
 //==============================================================================
 
@@ -526,6 +535,7 @@ IceTransport::Impl::initIceInstance(const IceTransportOptions& options)
 
     // Must be created after any potential failure
     thread_ = std::thread([this] {
+        CpuAccounting::getInstance().registerThread("ice", "ice");
         while (not threadTerminateFlags_) {
             // NOTE: handleEvents can return false in this case
             // but here we don't care if there is event or not.
@@ -1110,8 +1120,21 @@ IceTransport::Impl::onReceiveData(unsigned comp_id, void* pkt, pj_size_t size)
         }
     }
 
+    auto& channel = peerChannels_.at(comp_id - 1);
+    // Runs on the pjnath thread, shared by all transports: never wait for the reader
+    auto limit = MemoryAccounting::softLimit(MemoryPool::ICE_RX);
+    if (limit and channel.size() + size > limit) {
+        MemoryAccounting::dropped(MemoryPool::ICE_RX, size);
+        if (isTcpEnabled()) {
+            // A stream can't skip bytes: close the component
+            JAMI_WARN("[ice:%p] rx: reader is too slow, closing component %u", this, comp_id);
+            channel.stop();
+        }
+        return;
+    }
+
     std::error_code ec;
-    auto err = peerChannels_.at(comp_id - 1).write((const char*) pkt, size, ec);
+    auto err = channel.write((const char*) pkt, size, ec);
     if (err < 0) {
         JAMI_ERR("[ice:%p] rx: channel is closed", this);
     }
@@ -1135,6 +1158,27 @@ IceTransport::initIceInstance(const IceTransportOptions& options)
     pimpl_->initIceInstance(options);
 }
 
+void
+IceTransport::initFrom(IceTransport& initialized, const IceTransportOptions& options)
+{
+    // PJNATH callbacks are bound to the Impl, so the session can change owner
+    {
+        std::lock(pimpl_->iceMutex_, initialized.pimpl_->iceMutex_);
+        std::lock_guard<std::mutex> lk1 {pimpl_->iceMutex_, std::adopt_lock};
+        std::lock_guard<std::mutex> lk2 {initialized.pimpl_->iceMutex_, std::adopt_lock};
+        std::swap(pimpl_, initialized.pimpl_);
+        pimpl_->on_initdone_cb_ = options.onInitDone;
+        pimpl_->on_negodone_cb_ = options.onNegoDone;
+    }
+    JAMI_DBG("[ice:%p] Using pooled session", pimpl_.get());
+    if (options.master)
+        pimpl_->setInitiatorSession();
+    else
+        pimpl_->setSlaveSession();
+    if (options.onInitDone)
+        dht::ThreadPool::io().run([cb = options.onInitDone] { cb(true); });
+}
+
 bool
 IceTransport::isInitialized() const
 {
@@ -1673,6 +1717,7 @@ IceTransport::setOnShutdown(onShutdownCb&& cb)
 ssize_t
 IceTransport::send(unsigned compId, const unsigned char* buf, size_t len)
 {
+    JAMI_CPU_PROBE("ice.send");
     ASSERT_COMP_ID(compId, getComponentCount());
 
     auto remote = getRemoteAddress(compId);
@@ -1879,6 +1924,287 @@ IceTransportFactory::createUTransport(const char* name)
 
 //==============================================================================
 
+IceTransportPool::IceTransportPool(const std::string& name,
+                                   unsigned streamsCount,
+                                   unsigned compCountPerStream,
+                                   bool tcp,
+                                   std::size_t maxSize,
+                                   OptionsProvider&& provider)
+    : name_(name)
+    , streamsCount_(streamsCount)
+    , compCountPerStream_(compCountPerStream)
+    , tcp_(tcp)
+    , maxSize_(maxSize)
+    , provider_(std::move(provider))
+{}
+
+IceTransportPool::~IceTransportPool()
+{
+    if (refreshTask_)
+        refreshTask_->cancel();
+    std::vector<std::shared_ptr<IceTransport>> transports;
+    for (auto& [ptr, entry] : gathering_)
+        transports.emplace_back(std::move(entry.ice));
+    for (auto& entry : ready_)
+        transports.emplace_back(std::move(entry.ice));
+    release(std::move(transports));
+}
+
+void
+IceTransportPool::release(std::vector<std::shared_ptr<IceTransport>>&& transports)
+{
+    // Never destroy a transport from its own thread (i.e. in its callbacks)
+    if (not transports.empty())
+        dht::ThreadPool::io().run([transports = std::move(transports)] {});
+}
+
+bool
+IceTransportPool::sameGatheringOptions(const IceTransportOptions& a, const IceTransportOptions& b)
+{
+    auto sameStun = [](const StunServerInfo& x, const StunServerInfo& y) { return x.uri == y.uri; };
+    auto sameTurn = [](const TurnServerInfo& x, const TurnServerInfo& y) {
+        return x.uri == y.uri and x.username == y.username and x.password == y.password
+               and x.realm == y.realm;
+    };
+    return a.upnpEnable == b.upnpEnable and a.accountLocalAddr == b.accountLocalAddr
+           and a.accountPublicAddr == b.accountPublicAddr
+           and std::equal(a.stunServers.begin(),
+                          a.stunServers.end(),
+                          b.stunServers.begin(),
+                          b.stunServers.end(),
+                          sameStun)
+           and std::equal(a.turnServers.begin(),
+                          a.turnServers.end(),
+                          b.turnServers.begin(),
+                          b.turnServers.end(),
+                          sameTurn);
+}
+
+void
+IceTransportPool::start()
+{
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (started_)
+            return;
+        started_ = true;
+        refreshTask_ = Manager::instance().scheduler().scheduleAtFixedRate(
+            [w = weak_from_this()] {
+                auto pool = w.lock();
+                if (!pool)
+                    return false;
+                std::vector<std::shared_ptr<IceTransport>> dropped;
+                {
+                    std::lock_guard<std::mutex> lk(pool->mutex_);
+                    pool->dropExpired(dropped);
+                }
+                release(std::move(dropped));
+                pool->fill();
+                return true;
+            },
+            POOL_REFRESH_PERIOD);
+    }
+    fill();
+}
+
+void
+IceTransportPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        started_ = false;
+        if (auto task = std::move(refreshTask_))
+            task->cancel();
+    }
+    flush();
+}
+
+void
+IceTransportPool::flush()
+{
+    std::vector<std::shared_ptr<IceTransport>> dropped;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        for (auto& [ptr, entry] : gathering_)
+            dropped.emplace_back(std::move(entry.ice));
+        gathering_.clear();
+        for (auto& entry : ready_)
+            dropped.emplace_back(std::move(entry.ice));
+        ready_.clear();
+    }
+    JAMI_DBG("[ice pool %s] Flushing %zu transports", name_.c_str(), dropped.size());
+    release(std::move(dropped));
+    fill();
+}
+
+std::size_t
+IceTransportPool::target()
+{
+    auto limit = clock::now() - POOL_DEMAND_WINDOW;
+    while (not demand_.empty() and demand_.front() < limit)
+        demand_.pop_front();
+    return std::min(maxSize_, demand_.size());
+}
+
+void
+IceTransportPool::dropExpired(std::vector<std::shared_ptr<IceTransport>>& dropped)
+{
+    auto now = clock::now();
+    for (auto it = ready_.begin(); it != ready_.end();) {
+        if (now - it->gathered > POOLED_TRANSPORT_MAX_AGE or not it->ice->isInitialized()) {
+            dropped.emplace_back(std::move(it->ice));
+            it = ready_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    // Release the allocations not needed anymore, oldest first
+    auto size = target();
+    while (not ready_.empty() and ready_.size() + gathering_.size() > size) {
+        dropped.emplace_back(std::move(ready_.front().ice));
+        ready_.pop_front();
+    }
+}
+
+void
+IceTransportPool::fill()
+{
+    std::size_t missing = 0;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (not started_)
+            return;
+        auto size = target();
+        auto current = ready_.size() + gathering_.size() + requested_;
+        if (current >= size)
+            return;
+        missing = size - current;
+        requested_ += missing;
+    }
+    for (std::size_t i = 0; i < missing; ++i) {
+        provider_([w = weak_from_this()](IceTransportOptions&& options) {
+            auto pool = w.lock();
+            if (!pool)
+                return;
+            auto start = clock::now();
+            options.master = true;
+            options.streamsCount = pool->streamsCount_;
+            options.compCountPerStream = pool->compCountPerStream_;
+            options.tcpEnable = pool->tcp_;
+            options.onNegoDone = {};
+            options.onInitDone = {};
+            std::shared_ptr<IceTransport> ice;
+            {
+                std::lock_guard<std::mutex> lk(pool->mutex_);
+                pool->requested_--;
+                if (not pool->started_)
+                    return;
+                ice = Manager::instance().getIceTransportFactory().createTransport(
+                    pool->name_.c_str());
+                if (!ice)
+                    return;
+                pool->gathering_.emplace(ice.get(), Entry {ice, options});
+            }
+            options.onInitDone = [w, ptr = ice.get(), start](bool ok) {
+                if (auto pool = w.lock())
+                    pool->onGathered(ptr, start, ok);
+            };
+            try {
+                ice->initIceInstance(options);
+            } catch (const std::exception& e) {
+                JAMI_ERR("[ice pool %s] Unable to gather transport: %s",
+                         pool->name_.c_str(),
+                         e.what());
+                std::lock_guard<std::mutex> lk(pool->mutex_);
+                pool->gathering_.erase(ice.get());
+            }
+        });
+    }
+}
+
+void
+IceTransportPool::onGathered(IceTransport* ptr, clock::time_point start, bool ok)
+{
+    std::vector<std::shared_ptr<IceTransport>> dropped;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = gathering_.find(ptr);
+        if (it == gathering_.end())
+            return;
+        auto entry = std::move(it->second);
+        gathering_.erase(it);
+        if (ok) {
+            auto now = clock::now();
+            gatheringTime_ += std::chrono::duration_cast<std::chrono::milliseconds>(now - start);
+            gathered_++;
+            entry.gathered = now;
+            ready_.emplace_back(std::move(entry));
+        } else {
+            // Not refilled now, the next refresh or request will retry
+            JAMI_WARN("[ice pool %s] Gathering failed", name_.c_str());
+            dropped.emplace_back(std::move(entry.ice));
+        }
+    }
+    release(std::move(dropped));
+}
+
+bool
+IceTransportPool::initTransport(IceTransport& ice, const IceTransportOptions& options)
+{
+    if (options.streamsCount != streamsCount_ or options.compCountPerStream != compCountPerStream_
+        or options.tcpEnable != tcp_)
+        return false;
+
+    std::shared_ptr<IceTransport> pooled;
+    std::vector<std::shared_ptr<IceTransport>> dropped;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (not started_)
+            return false;
+        demand_.emplace_back(clock::now());
+        dropExpired(dropped);
+        while (not pooled and not ready_.empty()) {
+            auto entry = std::move(ready_.front());
+            ready_.pop_front();
+            // Gathered with previous settings (servers, addresses changed)
+            if (sameGatheringOptions(entry.options, options))
+                pooled = std::move(entry.ice);
+            else
+                dropped.emplace_back(std::move(entry.ice));
+        }
+        if (pooled)
+            hits_++;
+        else
+            misses_++;
+        JAMI_DBG("[ice pool %s] %s, hit rate %.2f",
+                 name_.c_str(),
+                 pooled ? "hit" : "miss",
+                 static_cast<double>(hits_) / (hits_ + misses_));
+    }
+    release(std::move(dropped));
+    fill();
+
+    if (!pooled)
+        return false;
+    ice.initFrom(*pooled, options);
+    return true;
+}
+
+IceTransportPool::Stats
+IceTransportPool::stats() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.ready = ready_.size();
+    if (gathered_)
+        stats.gatheringTime = gatheringTime_ / gathered_;
+    return stats;
+}
+
+//==============================================================================
+
 void
 IceSocketTransport::setOnRecv(RecvCb&& cb)
 {
@@ -1958,6 +2284,11 @@ IceSocketTransport::remoteAddr() const
 void
 IceSocket::close()
 {
+    if (channel_) {
+        // The channel is owned by the call, only detach from it
+        channel_->setOnRecv({});
+        channel_.reset();
+    }
     if (ice_transport_)
         ice_transport_->setOnRecv(compId_, {});
     ice_transport_.reset();
@@ -1966,6 +2297,11 @@ IceSocket::close()
 ssize_t
 IceSocket::send(const unsigned char* buf, size_t len)
 {
+    if (channel_) {
+        std::error_code ec;
+        auto res = channel_->write(buf, len, ec);
+        return ec ? -1 : static_cast<ssize_t>(res);
+    }
     if (not ice_transport_)
         return -1;
     return ice_transport_->send(compId_, buf, len);
@@ -1974,16 +2310,24 @@ IceSocket::send(const unsigned char* buf, size_t len)
 ssize_t
 IceSocket::waitForData(std::chrono::milliseconds timeout)
 {
+    std::error_code ec;
+    if (channel_)
+        return channel_->waitForData(timeout, ec);
     if (not ice_transport_)
         return -1;
 
-    std::error_code ec;
     return ice_transport_->waitForData(compId_, timeout, ec);
 }
 
 void
 IceSocket::setOnRecv(IceRecvCb cb)
 {
+    if (channel_) {
+        channel_->setOnRecv([cb = std::move(cb)](const uint8_t* buf, std::size_t len) {
+            return cb ? cb(const_cast<uint8_t*>(buf), len) : static_cast<ssize_t>(len);
+        });
+        return;
+    }
     if (ice_transport_)
         ice_transport_->setOnRecv(compId_, cb);
 }
@@ -1991,6 +2335,9 @@ IceSocket::setOnRecv(IceRecvCb cb)
 uint16_t
 IceSocket::getTransportOverhead()
 {
+    if (channel_)
+        return (channel_->remoteAddr().getFamily() == AF_INET) ? IPV4_HEADER_SIZE
+                                                               : IPV6_HEADER_SIZE;
     if (not ice_transport_)
         return 0;
 
@@ -27,9 +27,13 @@
 #include <pjlib.h>
 #include <pjlib-util.h>
 
+#include <chrono>
+#include <deque>
 #include <functional>
+#include <map>
 #include <memory>
 #include <msgpack.hpp>
+#include <mutex>
 #include <vector>
 
 namespace jami {
@@ -38,6 +42,8 @@ namespace upnp {
 class Controller;
 }
 
+class RepeatedTask;
+
 class IceTransport;
 
 using IceTransportCompleteCb = std::function<void(bool)>;
@@ -134,6 +140,14 @@ public:
 
     void initIceInstance(const IceTransportOptions& options);
 
+    /**
+     * Take over the session of an initialized transport instead of
+     * gathering candidates with initIceInstance().
+     * Only the role and the callbacks of options are used, onInitDone
+     * is called asynchronously.
+     */
+    void initFrom(IceTransport& initialized, const IceTransportOptions& options);
+
     /**
      * Get current state
      */
@@ -284,4 +298,102 @@ private:
     pj_ice_strans_cfg ice_cfg_;
 };
 
+/**
+ * Keep ICE transports with gathered candidates (host, server reflexive,
+ * UPnP mapped) ready to be used by new connections and calls.
+ * Transports are gathered in the background with the options given by the
+ * owner, handed out by initTransport() and refilled asynchronously.
+ * The pool is sized on demand: it keeps at most one transport per request
+ * seen recently (up to maxSize), so an idle owner holds no allocation.
+ */
+class IceTransportPool : public std::enable_shared_from_this<IceTransportPool>
+{
+public:
+    using OptionsProvider = std::function<void(std::function<void(IceTransportOptions&&)>&&)>;
+    using clock = std::chrono::steady_clock;
+
+    struct Stats
+    {
+        uint64_t hits {0};
+        uint64_t misses {0};
+        std::size_t ready {0};
+        // Average time to gather the candidates of pooled transports
+        std::chrono::milliseconds gatheringTime {0};
+
+        double hitRate() const
+        {
+            auto total = hits + misses;
+            return total ? static_cast<double>(hits) / total : 0.;
+        }
+    };
+
+    IceTransportPool(const std::string& name,
+                     unsigned streamsCount,
+                     unsigned compCountPerStream,
+                     bool tcp,
+                     std::size_t maxSize,
+                     OptionsProvider&& provider);
+    ~IceTransportPool();
+
+    /**
+     * Start gathering transports and refreshing them periodically
+     */
+    void start();
+    void stop();
+    /**
+     * Drop the pooled transports (e.g. when the connectivity changed)
+     * and gather new ones if started
+     */
+    void flush();
+
+    /**
+     * Initialize ice with a pooled transport if one matching options is ready.
+     * A pooled transport matches if it has the same shape and was gathered with
+     * the same servers, UPnP setting and account addresses.
+     * @return false if the caller must call ice.initIceInstance(options)
+     */
+    bool initTransport(IceTransport& ice, const IceTransportOptions& options);
+
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<IceTransport> ice;
+        // Options used to gather the transport, without callbacks
+        IceTransportOptions options;
+        clock::time_point gathered {};
+    };
+
+    static bool sameGatheringOptions(const IceTransportOptions& a, const IceTransportOptions& b);
+
+    void fill();
+    void onGathered(IceTransport* ice, clock::time_point start, bool ok);
+    // Must be called while holding mutex_
+    std::size_t target();
+    void dropExpired(std::vector<std::shared_ptr<IceTransport>>& dropped);
+    static void release(std::vector<std::shared_ptr<IceTransport>>&& transports);
+
+    const std::string name_;
+    const unsigned streamsCount_;
+    const unsigned compCountPerStream_;
+    const bool tcp_;
+    const std::size_t maxSize_;
+    OptionsProvider provider_;
+
+    mutable std::mutex mutex_ {};
+    bool started_ {false};
+    std::size_t requested_ {0};
+    // Time of the requests seen during the demand window
+    std::deque<clock::time_point> demand_ {};
+    std::map<IceTransport*, Entry> gathering_ {};
+    std::deque<Entry> ready_ {};
+    std::shared_ptr<RepeatedTask> refreshTask_ {};
+
+    uint64_t hits_ {0};
+    uint64_t misses_ {0};
+    uint64_t gathered_ {0};
+    std::chrono::milliseconds gatheringTime_ {0};
+};
+
 }; // namespace jami
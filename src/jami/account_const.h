@@ -75,6 +75,7 @@ namespace VolatileProperties {
 
 constexpr static const char ACTIVE[] = "Account.active";
 constexpr static const char DEVICE_ANNOUNCED[] = "Account.deviceAnnounced";
+constexpr static const char STANDBY[] = "Account.standby";
 constexpr static const char REGISTERED_NAME[] = "Account.registeredName";
 
 // Volatile parameters
@@ -152,6 +153,9 @@ constexpr static const char DEFAULT_MODERATORS[] = "Account.defaultModerators";
 constexpr static const char LOCAL_MODERATORS_ENABLED[] = "Account.localModeratorsEnabled";
 constexpr static const char ALL_MODERATORS_ENABLED[] = "Account.allModeratorsEnabled";
 constexpr static const char ACCOUNT_IP_AUTO_REWRITE[] = "Account.allowIPAutoRewrite";
+constexpr static const char PEER_CONNECTIONS_OVER_UDP[] = "Account.peerConnectionsOverUdp";
+constexpr static const char MEDIA_OVER_PEER_CONNECTIONS[] = "Account.mediaOverPeerConnections";
+constexpr static const char ACTIVATE_ON_DEMAND[] = "Account.activateOnDemand";
 
 namespace Audio {
 
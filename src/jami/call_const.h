@@ -60,6 +60,9 @@ constexpr static char VIDEO_SOURCE[] = "VIDEO_SOURCE";
 constexpr static char AUDIO_ONLY[] = "AUDIO_ONLY";
 constexpr static char AUDIO_CODEC[] = "AUDIO_CODEC";
 constexpr static char VIDEO_CODEC[] = "VIDEO_CODEC";
+// Followed by the name of a setup phase (e.g. SETUP_TIMELINE_ICE_CHECK),
+// value is the time in ms since the creation of the call
+constexpr static char SETUP_TIMELINE_PREFIX[] = "SETUP_TIMELINE_";
 
 } // namespace Details
 
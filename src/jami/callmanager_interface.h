@@ -62,6 +62,14 @@ DRING_PUBLIC bool attendedTransfer(const std::string& accountId,
                                    const std::string& targetID);
 DRING_PUBLIC std::map<std::string, std::string> getCallDetails(const std::string& accountId,
                                                                const std::string& callId);
+/**
+ * Details of several calls in one call, in the order of callIds (empty for unknown ones).
+ * Only the keys in fields are returned, all of them if fields is empty.
+ */
+DRING_PUBLIC std::vector<std::map<std::string, std::string>> getCallsDetails(
+    const std::string& accountId,
+    const std::vector<std::string>& callIds,
+    const std::vector<std::string>& fields = {});
 DRING_PUBLIC std::vector<std::string> getCallList(const std::string& accountId);
 
 /* APIs that supports an arbitrary number of media */
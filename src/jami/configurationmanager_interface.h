@@ -54,6 +54,12 @@ struct DRING_PUBLIC Message
 };
 
 DRING_PUBLIC std::map<std::string, std::string> getAccountDetails(const std::string& accountID);
+/**
+ * Details of several accounts in one call, in the order of accountIDs (empty for unknown ones).
+ * Only the keys in fields are returned, all of them if fields is empty.
+ */
+DRING_PUBLIC std::vector<std::map<std::string, std::string>> getAccountsDetails(
+    const std::vector<std::string>& accountIDs, const std::vector<std::string>& fields = {});
 DRING_PUBLIC std::map<std::string, std::string> getVolatileAccountDetails(
     const std::string& accountID);
 DRING_PUBLIC void setAccountDetails(const std::string& accountID,
@@ -63,6 +69,32 @@ DRING_PUBLIC std::map<std::string, std::string> getAccountTemplate(const std::st
 DRING_PUBLIC std::string addAccount(const std::map<std::string, std::string>& details,
                                     const std::string& accountID = {});
 DRING_PUBLIC void monitor(bool continuous);
+/**
+ * CPU and wall time per thread group (media, sip, ice, tls...) and per hot path
+ */
+DRING_PUBLIC std::vector<std::map<std::string, std::string>> getCpuAccounting();
+/**
+ * Periodically write the CPU accounting to path in the OpenMetrics text format.
+ * Hot path probes are only timed while it runs. An empty path or a period of 0 stops it.
+ */
+DRING_PUBLIC void setCpuAccountingDump(const std::string& path, int32_t periodSeconds);
+/**
+ * Live bytes, peak and soft limit of the accounted memory pools (media frames,
+ * receive queues, git cache). Keys: <pool>.bytes, <pool>.peak, <pool>.allocations,
+ * <pool>.dropped (bytes refused over the limit), <pool>.limit
+ */
+DRING_PUBLIC std::map<std::string, std::string> getMemoryUsage();
+/**
+ * Set the soft limit in bytes of pools (pool name -> bytes). Over its limit, a receive
+ * queue drops datagrams or closes its stream. 0 removes the limit.
+ */
+DRING_PUBLIC void setMemorySoftLimits(const std::map<std::string, std::string>& limits);
+/**
+ * Activity mode of a Jami account (always, active or standby, see Account.activateOnDemand)
+ * and the resources it uses: DHT nodes, storage and messages, connections, pooled ICE
+ * transports and wake-ups.
+ */
+DRING_PUBLIC std::map<std::string, std::string> getAccountActivity(const std::string& accountID);
 DRING_PUBLIC bool exportOnRing(const std::string& accountID, const std::string& password);
 DRING_PUBLIC bool exportToFile(const std::string& accountID,
                                const std::string& destinationPath,
@@ -232,6 +264,14 @@ DRING_PUBLIC void addContact(const std::string& accountId, const std::string& ur
 DRING_PUBLIC void removeContact(const std::string& accountId, const std::string& uri, bool ban);
 DRING_PUBLIC std::map<std::string, std::string> getContactDetails(const std::string& accountId,
                                                                   const std::string& uri);
+/**
+ * Details of several contacts in one call, in the order of uris (empty for unknown ones).
+ * Only the keys in fields are returned, all of them if fields is empty.
+ */
+DRING_PUBLIC std::vector<std::map<std::string, std::string>> getContactsDetails(
+    const std::string& accountId,
+    const std::vector<std::string>& uris,
+    const std::vector<std::string>& fields = {});
 DRING_PUBLIC std::vector<std::map<std::string, std::string>> getContacts(
     const std::string& accountId);
 
@@ -538,6 +578,20 @@ struct DRING_PUBLIC ConfigurationSignal
         constexpr static const char* name = "MessageSend";
         using cb_type = void(const std::string&);
     };
+    struct DRING_PUBLIC PluginInstallationProgress
+    {
+        constexpr static const char* name = "PluginInstallationProgress";
+        using cb_type = void(const std::string& /*jplPath*/,
+                             uint64_t /*extracted*/,
+                             uint64_t /*total*/);
+    };
+    struct DRING_PUBLIC PluginInstallationFinished
+    {
+        constexpr static const char* name = "PluginInstallationFinished";
+        using cb_type = void(const std::string& /*jplPath*/,
+                             const std::string& /*rootPath*/,
+                             int /*status*/);
+    };
 };
 
 } // namespace DRing
@@ -42,6 +42,8 @@ DRING_PUBLIC bool removeConversation(const std::string& accountId,
 DRING_PUBLIC std::vector<std::string> getConversations(const std::string& accountId);
 DRING_PUBLIC std::vector<std::map<std::string, std::string>> getConversationRequests(
     const std::string& accountId);
+DRING_PUBLIC std::vector<std::map<std::string, std::string>> getConversationSummaries(
+    const std::string& accountId);
 
 // Conversation's infos management
 DRING_PUBLIC void updateConversationInfos(const std::string& accountId,
@@ -49,6 +51,15 @@ DRING_PUBLIC void updateConversationInfos(const std::string& accountId,
                                           const std::map<std::string, std::string>& infos);
 DRING_PUBLIC std::map<std::string, std::string> conversationInfos(const std::string& accountId,
                                                                   const std::string& conversationId);
+/**
+ * Infos of several conversations in one call, in the order of conversationIds (empty for
+ * unknown ones). Only the keys in fields are returned, all of them if fields is empty. The
+ * profile (title, description, avatar) isn't read if none of its keys is requested.
+ */
+DRING_PUBLIC std::vector<std::map<std::string, std::string>> conversationsInfos(
+    const std::string& accountId,
+    const std::vector<std::string>& conversationIds,
+    const std::vector<std::string>& fields = {});
 
 // Member management
 DRING_PUBLIC void addConversationMember(const std::string& accountId,
@@ -59,6 +70,11 @@ DRING_PUBLIC void removeConversationMember(const std::string& accountId,
                                            const std::string& contactUri);
 DRING_PUBLIC std::vector<std::map<std::string, std::string>> getConversationMembers(
     const std::string& accountId, const std::string& conversationId);
+/**
+ * Members of several conversations in one call. Each member has a conversationId key.
+ */
+DRING_PUBLIC std::vector<std::map<std::string, std::string>> getConversationsMembers(
+    const std::string& accountId, const std::vector<std::string>& conversationIds);
 
 // Message send/load
 DRING_PUBLIC void sendMessage(const std::string& accountId,
@@ -69,6 +85,11 @@ DRING_PUBLIC uint32_t loadConversationMessages(const std::string& accountId,
                                                const std::string& conversationId,
                                                const std::string& fromMessage,
                                                size_t n);
+DRING_PUBLIC uint32_t loadConversationMessagesPaged(const std::string& accountId,
+                                                    const std::string& conversationId,
+                                                    const std::string& fromMessage,
+                                                    size_t pageSize);
+DRING_PUBLIC bool cancelLoadConversationMessages(const std::string& accountId, uint32_t id);
 DRING_PUBLIC uint32_t countInteractions(const std::string& accountId,
                                         const std::string& conversationId,
                                         const std::string& toId,
@@ -85,6 +106,15 @@ struct DRING_PUBLIC ConversationSignal
                              const std::string& /* conversationId */,
                              std::vector<std::map<std::string, std::string>> /*messages*/);
     };
+    struct DRING_PUBLIC ConversationMessagesPage
+    {
+        constexpr static const char* name = "ConversationMessagesPage";
+        using cb_type = void(uint32_t /* id */,
+                             const std::string& /*accountId*/,
+                             const std::string& /* conversationId */,
+                             std::vector<std::map<std::string, std::string>> /*messages*/,
+                             const std::string& /* next, empty if finished */);
+    };
     struct DRING_PUBLIC MessageReceived
     {
         constexpr static const char* name = "MessageReceived";
@@ -28,6 +28,7 @@
 #include <vector>
 #include <map>
 #include <list>
+#include <cstdint>
 
 #if __APPLE__
 #import "TargetConditionals.h"
@@ -47,6 +48,7 @@ DRING_PUBLIC bool resetPluginPreferencesValues(const std::string& path);
 DRING_PUBLIC std::vector<std::string> getInstalledPlugins();
 DRING_PUBLIC std::vector<std::string> getLoadedPlugins();
 DRING_PUBLIC int installPlugin(const std::string& jplPath, bool force);
+DRING_PUBLIC void installPluginAsync(const std::string& jplPath, bool force);
 DRING_PUBLIC int uninstallPlugin(const std::string& pluginRootPath);
 DRING_PUBLIC std::vector<std::string> getCallMediaHandlers();
 DRING_PUBLIC std::vector<std::string> getChatHandlers();
@@ -60,6 +62,10 @@ DRING_PUBLIC void toggleChatHandler(const std::string& chatHandlerId,
 DRING_PUBLIC std::map<std::string, std::string> getCallMediaHandlerDetails(
     const std::string& mediaHandlerId);
 DRING_PUBLIC std::vector<std::string> getCallMediaHandlerStatus(const std::string& callId);
+DRING_PUBLIC std::vector<std::map<std::string, std::string>> getCallMediaHandlerStats(
+    const std::string& callId);
+DRING_PUBLIC void setCallMediaHandlerLatencyBudget(const std::string& mediaHandlerId,
+                                                   int32_t budgetMs);
 DRING_PUBLIC std::map<std::string, std::string> getChatHandlerDetails(
     const std::string& chatHandlerId);
 DRING_PUBLIC std::vector<std::string> getChatHandlerStatus(const std::string& accountId,
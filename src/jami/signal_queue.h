@@ -0,0 +1,217 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+#pragma once
+
+#include "jami.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace DRing {
+
+/**
+ * Queue of signals for the clients that can't run callbacks on the daemon
+ * threads (language bindings): the thread emitting a signal only copies its
+ * arguments, callbacks are run later, in order, by process().
+ *
+ * Signals posted with a key replace the pending signal with the same key: a
+ * slow client only gets the latest value of periodic signals. The replacing
+ * signal takes the place of the last one posted, after the signals posted
+ * since the replaced one, so the client never sees a value older than an event
+ * that followed it.
+ *
+ * Pending signals are processed in batches: the wake function is only called
+ * when the queue was empty, and process() takes the whole queue at once.
+ * Callbacks are run without the lock, so they can't block the daemon.
+ */
+class SignalQueue
+{
+public:
+    using Callback = std::function<void()>;
+
+    /**
+     * @param wake called (on the posting thread) when signals are pending, it must
+     * get process() called, e.g. by the event loop of the client.
+     * Without wake function, signals are processed by a dedicated thread.
+     */
+    explicit SignalQueue(Callback&& wake = {})
+        : wake_(std::move(wake))
+    {
+        if (not wake_)
+            thread_ = std::thread([this] { loop(); });
+    }
+
+    ~SignalQueue()
+    {
+        if (thread_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                running_ = false;
+            }
+            cv_.notify_one();
+            thread_.join();
+        }
+    }
+
+    SignalQueue(const SignalQueue&) = delete;
+    SignalQueue& operator=(const SignalQueue&) = delete;
+
+    /** Thread safe */
+    void post(Callback&& cb) { post({}, std::move(cb)); }
+
+    /**
+     * Thread safe. The signal replaces a pending one with the same key, if key
+     * isn't empty, and is queued last.
+     */
+    void post(std::string&& key, Callback&& cb)
+    {
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++posted_;
+            wake = pending_.empty();
+            pending_.emplace_back(std::move(cb));
+            if (not key.empty()) {
+                auto it = keys_.find(key);
+                if (it != keys_.end()) {
+                    pending_.erase(it->second);
+                    it->second = std::prev(pending_.end());
+                    ++coalesced_;
+                } else {
+                    keys_.emplace(std::move(key), std::prev(pending_.end()));
+                }
+            }
+        }
+        if (wake)
+            notify();
+    }
+
+    /** Run the pending signals, from the client thread. Return the number of signals run. */
+    std::size_t process()
+    {
+        std::list<Callback> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batch.swap(pending_);
+            keys_.clear();
+        }
+        for (auto& cb : batch)
+            cb();
+        return batch.size();
+    }
+
+    /** Signals posted, and signals replaced by a more recent one */
+    std::pair<uint64_t, uint64_t> getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {posted_, coalesced_};
+    }
+
+    /** Coalescing key of a signal: its name and its string arguments */
+    template<typename... Args>
+    static std::string makeKey(const char* name, const Args&... args)
+    {
+        std::string key(name);
+        (appendKey(key, args), ...);
+        return key;
+    }
+
+private:
+    static void appendKey(std::string& key, const std::string& arg)
+    {
+        key += '\0';
+        key += arg;
+    }
+    template<typename T>
+    static void appendKey(std::string&, const T&)
+    {}
+
+    void notify()
+    {
+        if (wake_)
+            wake_();
+        else
+            cv_.notify_one();
+    }
+
+    void loop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            cv_.wait(lock, [this] { return not running_ or not pending_.empty(); });
+            lock.unlock();
+            process();
+            lock.lock();
+        }
+    }
+
+    const Callback wake_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::list<Callback> pending_;
+    std::map<std::string, std::list<Callback>::iterator> keys_;
+    uint64_t posted_ {0};
+    uint64_t coalesced_ {0};
+    bool running_ {true};
+    std::thread thread_;
+};
+
+template<typename T>
+constexpr bool is_output_parameter = std::is_pointer<std::decay_t<T>>::value
+                                     or (std::is_lvalue_reference<T>::value
+                                         and not std::is_const<std::remove_reference_t<T>>::value);
+
+template<typename T>
+struct has_output_parameter;
+
+template<typename... Args>
+struct has_output_parameter<void(Args...)>
+    : std::bool_constant<(... or is_output_parameter<Args>)>
+{};
+
+/**
+ * Like exportable_callback, for a signal delivered through a SignalQueue.
+ * Arguments are copied. With coalesce, a pending signal with the same string
+ * arguments is replaced: for signals whose last value is enough (levels,
+ * progress, details). Signals with output parameters can't be queued.
+ */
+template<typename Ts>
+std::pair<std::string, std::shared_ptr<CallbackWrapperBase>>
+exportable_queued_callback(SignalQueue& queue,
+                           std::function<typename Ts::cb_type>&& func,
+                           bool coalesce = false)
+{
+    static_assert(not has_output_parameter<typename Ts::cb_type>::value,
+                  "signals with output parameters must be synchronous");
+    auto cb = std::make_shared<std::function<typename Ts::cb_type>>(std::move(func));
+    return exportable_callback<Ts>([&queue, cb, coalesce](const auto&... args) {
+        queue.post(coalesce ? SignalQueue::makeKey(Ts::name, args...) : std::string {},
+                   [cb, args...] { (*cb)(args...); });
+    });
+}
+
+} // namespace DRing
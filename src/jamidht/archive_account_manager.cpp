@@ -599,10 +599,10 @@ ArchiveAccountManager::onSyncData(DeviceSync&& sync, bool checkDevice)
     }
     // saveKnownDevices();
 
+    ContactList::Batch batch(*info_->contacts);
+
     // Sync contacts
-    for (const auto& peer : sync.peers)
-        info_->contacts->updateContact(peer.first, peer.second);
-    info_->contacts->saveContacts();
+    info_->contacts->updateContacts(sync.peers);
 
     // Sync trust requests
     for (const auto& tr : sync.trust_requests)
@@ -612,7 +612,6 @@ ArchiveAccountManager::onSyncData(DeviceSync&& sync, bool checkDevice)
                                         false,
                                         tr.second.conversationId,
                                         {});
-    info_->contacts->saveTrustRequests();
 }
 
 AccountArchive
@@ -23,6 +23,7 @@
 #include "ice_transport.h"
 #include "peer_connection.h"
 #include "logger.h"
+#include "memory_accounting.h"
 
 #include <opendht/crypto.h>
 #include <opendht/thread_pool.h>
@@ -58,6 +59,7 @@ struct ConnectionInfo
     std::unique_ptr<TlsSocketEndpoint> tls_ {nullptr};
     std::shared_ptr<MultiplexedSocket> socket_ {};
     std::set<CallbackId> cbIds_ {};
+    ConnectionTimeline timeline_ {std::chrono::steady_clock::now()};
 };
 
 class ConnectionManager::Impl : public std::enable_shared_from_this<ConnectionManager::Impl>
@@ -281,6 +283,7 @@ ConnectionManager::Impl::connectDeviceStartIce(
     }
 
     std::unique_lock<std::mutex> lk(info->mutex_);
+    info->timeline_.iceGathered = std::chrono::steady_clock::now();
     auto& ice = info->ice_;
 
     auto onError = [&]() {
@@ -310,6 +313,7 @@ ConnectionManager::Impl::connectDeviceStartIce(
 
     val.id = vid; /* Random id for the message unicity */
     val.ice_msg = icemsg.str();
+    val.datagram = not ice->isTCPEnabled();
     auto value = std::make_shared<dht::Value>(std::move(val));
     value->user_type = "peer_request";
 
@@ -335,6 +339,7 @@ ConnectionManager::Impl::connectDeviceStartIce(
         onError();
         return;
     }
+    info->timeline_.dhtAnswered = std::chrono::steady_clock::now();
 
     if (!ice)
         return;
@@ -359,6 +364,7 @@ ConnectionManager::Impl::connectDeviceOnNegoDone(
         return;
 
     std::unique_lock<std::mutex> lk {info->mutex_};
+    info->timeline_.iceConnected = std::chrono::steady_clock::now();
     auto& ice = info->ice_;
     if (!ice || !ice->isRunning()) {
         JAMI_ERR("No ICE detected or not running");
@@ -508,7 +514,7 @@ ConnectionManager::Impl::connectDevice(const std::shared_ptr<dht::crypto::Certif
             auto sthis = w.lock();
             if (!sthis)
                 return;
-            ice_config.tcpEnable = true;
+            ice_config.tcpEnable = not sthis->account.peerConnectionsOverUdp();
             ice_config.onInitDone = [w,
                                      deviceId = std::move(deviceId),
                                      devicePk = std::move(devicePk),
@@ -573,7 +579,8 @@ ConnectionManager::Impl::connectDevice(const std::shared_ptr<dht::crypto::Certif
             ice_config.compCountPerStream = JamiAccount::ICE_COMP_COUNT_PER_STREAM;
             info->ice_ = Manager::instance().getIceTransportFactory().createUTransport(
                 sthis->account.getAccountID().c_str());
-            info->ice_->initIceInstance(ice_config);
+            if (info->ice_ and not sthis->account.initPooledIceTransport(*info->ice_, ice_config))
+                info->ice_->initIceInstance(ice_config);
 
             if (!info->ice_) {
                 JAMI_ERR("Cannot initialize ICE session.");
@@ -761,6 +768,7 @@ ConnectionManager::Impl::answerTo(IceTransport& ice,
     val.id = id;
     val.ice_msg = icemsg.str();
     val.isAnswer = true;
+    val.datagram = not ice.isTCPEnabled();
     auto value = std::make_shared<dht::Value>(std::move(val));
     value->user_type = "peer_request";
 
@@ -785,6 +793,7 @@ ConnectionManager::Impl::onRequestStartIce(const PeerConnectionRequest& req)
         return;
 
     std::unique_lock<std::mutex> lk {info->mutex_};
+    info->timeline_.iceGathered = std::chrono::steady_clock::now();
     auto& ice = info->ice_;
     if (!ice) {
         JAMI_ERR("No ICE detected");
@@ -795,6 +804,7 @@ ConnectionManager::Impl::onRequestStartIce(const PeerConnectionRequest& req)
 
     auto sdp = ice->parseIceCandidates(req.ice_msg);
     answerTo(*ice, req.id, req.owner);
+    info->timeline_.dhtAnswered = std::chrono::steady_clock::now();
     if (not ice->startIce({sdp.rem_ufrag, sdp.rem_pwd}, std::move(sdp.rem_candidates))) {
         JAMI_ERR("[Account:%s] start ICE failed - fallback to TURN", account.getAccountID().c_str());
         ice = nullptr;
@@ -813,6 +823,7 @@ ConnectionManager::Impl::onRequestOnNegoDone(const PeerConnectionRequest& req)
         return;
 
     std::unique_lock<std::mutex> lk {info->mutex_};
+    info->timeline_.iceConnected = std::chrono::steady_clock::now();
     auto& ice = info->ice_;
     if (!ice) {
         JAMI_ERR("No ICE detected");
@@ -878,7 +889,8 @@ ConnectionManager::Impl::onDhtPeerRequest(const PeerConnectionRequest& req,
             }
         };
 
-        ice_config.tcpEnable = true;
+        // Same transport as the initiator (older versions only use ICE-TCP)
+        ice_config.tcpEnable = not req.datagram;
         ice_config.onInitDone = [w, req, deviceId, eraseInfo](bool ok) {
             auto shared = w.lock();
             if (!shared)
@@ -932,7 +944,8 @@ ConnectionManager::Impl::onDhtPeerRequest(const PeerConnectionRequest& req,
         ice_config.master = true;
         info->ice_ = Manager::instance().getIceTransportFactory().createUTransport(
             shared->account.getAccountID().c_str());
-        info->ice_->initIceInstance(ice_config);
+        if (info->ice_ and not shared->account.initPooledIceTransport(*info->ice_, ice_config))
+            info->ice_->initIceInstance(ice_config);
 
         if (not info->ice_) {
             JAMI_ERR("Cannot initialize ICE session.");
@@ -950,6 +963,8 @@ ConnectionManager::Impl::addNewMultiplexedSocket(const DeviceId& deviceId, const
     if (!info)
         return;
     info->socket_ = std::make_shared<MultiplexedSocket>(deviceId, std::move(info->tls_));
+    info->timeline_.tlsReady = std::chrono::steady_clock::now();
+    info->socket_->setTimeline(info->timeline_);
     info->socket_->setOnReady(
         [w = weak()](const DeviceId& deviceId, const std::shared_ptr<ChannelSocket>& socket) {
             if (auto sthis = w.lock())
@@ -1106,6 +1121,8 @@ ConnectionManager::monitor() const
         if (ci->socket_)
             ci->socket_->monitor();
     }
+    // Receive queues of all connections (channels, DTLS, ICE) and media frames
+    MemoryAccounting::monitor();
     JAMI_DBG("ConnectionManager for account %s (%s), end status.",
              pimpl_->account.getAccountID().c_str(),
              pimpl_->account.getUserUri().c_str());
@@ -46,7 +46,8 @@ struct PeerConnectionRequest : public dht::EncryptedValue<PeerConnectionRequest>
     dht::Value::Id id = dht::Value::INVALID_ID;
     std::string ice_msg {};
     bool isAnswer {false};
-    MSGPACK_DEFINE_MAP(id, ice_msg, isAnswer)
+    bool datagram {false}; ///< ICE over UDP, else ICE-TCP
+    MSGPACK_DEFINE_MAP(id, ice_msg, isAnswer, datagram)
 };
 
 /**
@@ -27,11 +27,115 @@
 
 #include "account_const.h"
 
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <gnutls/ocsp.h>
 
 namespace jami {
 
+/*
+ * Contacts and trust requests are stored as a msgpack map (the snapshot),
+ * followed by a journal of the changes made since: <file>.journal holds
+ * [id, value] records, or [id] for a removal. The snapshot is rewritten, and
+ * the journal emptied, when the journal has more records than the map.
+ */
+static constexpr std::size_t MIN_JOURNAL_SIZE {64};
+
+/**
+ * Load a snapshot and its journal in values.
+ * @return number of records in the journal, enough to force a rewrite if the
+ *         journal is corrupted (e.g. truncated by a crash)
+ * @throw std::exception if the snapshot can't be read
+ */
+template<typename T>
+static std::size_t
+loadJournaled(const std::string& path, std::map<dht::InfoHash, T>& values)
+{
+    auto file = fileutils::loadFile(path);
+    msgpack::object_handle oh = msgpack::unpack((const char*) file.data(), file.size());
+    oh.get().convert(values);
+
+    auto journalPath = path + ".journal";
+    if (not fileutils::isFile(journalPath))
+        return 0;
+    auto journal = fileutils::loadFile(journalPath);
+    msgpack::unpacker unpacker;
+    unpacker.reserve_buffer(journal.size());
+    std::memcpy(unpacker.buffer(), journal.data(), journal.size());
+    unpacker.buffer_consumed(journal.size());
+    std::size_t records = 0;
+    try {
+        while (unpacker.next(oh)) {
+            const auto& o = oh.get();
+            if (o.type != msgpack::type::ARRAY or o.via.array.size == 0)
+                throw msgpack::type_error();
+            auto id = o.via.array.ptr[0].as<dht::InfoHash>();
+            if (o.via.array.size > 1)
+                values[id] = o.via.array.ptr[1].as<T>();
+            else
+                values.erase(id);
+            ++records;
+        }
+    } catch (const std::exception& e) {
+        JAMI_WARN("[Contacts] error loading %s: %s", journalPath.c_str(), e.what());
+        return records + values.size() + MIN_JOURNAL_SIZE;
+    }
+    if (unpacker.nonparsed_size() > 0) {
+        JAMI_WARN("[Contacts] ignoring the truncated end of %s", journalPath.c_str());
+        return records + values.size() + MIN_JOURNAL_SIZE;
+    }
+    return records;
+}
+
+/**
+ * Save the dirty values in the journal, or rewrite the snapshot.
+ * @return number of records in the journal
+ */
+template<typename T>
+static std::size_t
+saveJournaled(const std::string& path,
+              const std::map<dht::InfoHash, T>& values,
+              std::set<dht::InfoHash>& dirty,
+              std::size_t journaled,
+              bool rewrite)
+{
+    auto journalPath = path + ".journal";
+    rewrite = rewrite or journaled + dirty.size() > std::max(MIN_JOURNAL_SIZE, values.size())
+              or not fileutils::isFile(path);
+    if (rewrite) {
+        auto tmpPath = path + ".tmp";
+        {
+            std::ofstream file(tmpPath, std::ios::trunc | std::ios::binary);
+            msgpack::pack(file, values);
+        }
+        if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+            JAMI_ERR("[Contacts] can't save %s", path.c_str());
+            return journaled;
+        }
+        fileutils::remove(journalPath);
+        dirty.clear();
+        return 0;
+    }
+    if (dirty.empty())
+        return journaled;
+
+    msgpack::sbuffer buffer;
+    msgpack::packer<msgpack::sbuffer> pk(&buffer);
+    for (const auto& id : dirty) {
+        auto it = values.find(id);
+        pk.pack_array(it != values.end() ? 2 : 1);
+        pk.pack(id);
+        if (it != values.end())
+            pk.pack(it->second);
+    }
+    std::ofstream file(journalPath, std::ios::app | std::ios::binary);
+    file.write(buffer.data(), buffer.size());
+    journaled += dirty.size();
+    dirty.clear();
+    return journaled;
+}
+
 ContactList::ContactList(const std::shared_ptr<crypto::Certificate>& cert,
                          const std::string& path,
                          OnChangeCallback cb)
@@ -47,19 +151,41 @@ ContactList::~ContactList() {}
 void
 ContactList::load()
 {
-    loadContacts();
-    loadTrustRequests();
+    {
+        Batch batch(*this);
+        loadContacts();
+        loadTrustRequests();
+        // Already on disk
+        dirtyContacts_.clear();
+        dirtyTrustRequests_.clear();
+    }
     loadKnownDevices();
 }
 
 void
 ContactList::save()
 {
+    rewriteContacts_ = true;
+    rewriteTrustRequests_ = true;
     saveContacts();
     saveTrustRequests();
     saveKnownDevices();
 }
 
+void
+ContactList::contactChanged(const dht::InfoHash& h)
+{
+    dirtyContacts_.emplace(h);
+    saveContacts();
+}
+
+void
+ContactList::trustRequestChanged(const dht::InfoHash& h)
+{
+    dirtyTrustRequests_.emplace(h);
+    saveTrustRequests();
+}
+
 bool
 ContactList::setCertificateStatus(const std::string& cert_id,
                                   const tls::TrustStore::PermissionStatus status)
@@ -89,7 +215,7 @@ ContactList::addContact(const dht::InfoHash& h, bool confirmed, const std::strin
     c->second.confirmed |= confirmed;
     auto hStr = h.toString();
     trust_.setCertificateStatus(hStr, tls::TrustStore::PermissionStatus::ALLOWED);
-    saveContacts();
+    contactChanged(h);
     callbacks_.contactAdded(hStr, c->second.confirmed);
     return true;
 }
@@ -100,7 +226,7 @@ ContactList::updateConversation(const dht::InfoHash& h, const std::string& conve
     auto c = contacts_.find(h);
     if (c != contacts_.end()) {
         c->second.conversationId = conversationId;
-        saveContacts();
+        contactChanged(h);
     }
 }
 
@@ -120,8 +246,8 @@ ContactList::removeContact(const dht::InfoHash& h, bool ban)
                                 ban ? tls::TrustStore::PermissionStatus::BANNED
                                     : tls::TrustStore::PermissionStatus::UNDEFINED);
     if (trustRequests_.erase(h) > 0)
-        saveTrustRequests();
-    saveContacts();
+        trustRequestChanged(h);
+    contactChanged(h);
 #ifdef ENABLE_PLUGIN
     std::size_t found = path_.find_last_of(DIR_SEPARATOR_CH);
     if (found != std::string::npos) {
@@ -143,7 +269,7 @@ ContactList::removeContactConversation(const dht::InfoHash& h)
     if (c == contacts_.end())
         return false;
     c->second.conversationId = "";
-    saveContacts();
+    contactChanged(h);
     return true;
 }
 
@@ -173,6 +299,8 @@ void
 ContactList::setContacts(const std::map<dht::InfoHash, Contact>& contacts)
 {
     contacts_ = contacts;
+    dirtyContacts_.clear();
+    rewriteContacts_ = true;
     saveContacts();
     // Set contacts is used when creating a new device, so just announce new contacts
     for (auto& peer : contacts)
@@ -188,6 +316,7 @@ ContactList::updateContact(const dht::InfoHash& id, const Contact& contact)
         return;
     }
     bool stateChanged {false};
+    dirtyContacts_.emplace(id);
     auto c = contacts_.find(id);
     if (c == contacts_.end()) {
         // JAMI_DBG("[Contacts] new contact: %s", id.toString().c_str());
@@ -199,7 +328,7 @@ ContactList::updateContact(const dht::InfoHash& id, const Contact& contact)
     }
     if (stateChanged) {
         if (trustRequests_.erase(id) > 0)
-            saveTrustRequests();
+            trustRequestChanged(id);
         if (c->second.isActive()) {
             trust_.setCertificateStatus(id.toString(), tls::TrustStore::PermissionStatus::ALLOWED);
             callbacks_.contactAdded(id.toString(), c->second.confirmed);
@@ -212,16 +341,20 @@ ContactList::updateContact(const dht::InfoHash& id, const Contact& contact)
     }
 }
 
+void
+ContactList::updateContacts(const std::map<dht::InfoHash, Contact>& contacts)
+{
+    Batch batch(*this);
+    for (const auto& peer : contacts)
+        updateContact(peer.first, peer.second);
+}
+
 void
 ContactList::loadContacts()
 {
     decltype(contacts_) contacts;
     try {
-        // read file
-        auto file = fileutils::loadFile("contacts", path_);
-        // load values
-        msgpack::object_handle oh = msgpack::unpack((const char*) file.data(), file.size());
-        oh.get().convert(contacts);
+        contactsJournal_ = loadJournaled(path_ + DIR_SEPARATOR_STR "contacts", contacts);
     } catch (const std::exception& e) {
         JAMI_WARN("[Contacts] error loading contacts: %s", e.what());
         return;
@@ -232,18 +365,29 @@ ContactList::loadContacts()
 }
 
 void
-ContactList::saveContacts() const
+ContactList::saveContacts()
 {
-    std::ofstream file(path_ + DIR_SEPARATOR_STR "contacts", std::ios::trunc | std::ios::binary);
-    msgpack::pack(file, contacts_);
+    if (batch_ > 0)
+        return;
+    contactsJournal_ = saveJournaled(path_ + DIR_SEPARATOR_STR "contacts",
+                                     contacts_,
+                                     dirtyContacts_,
+                                     contactsJournal_,
+                                     rewriteContacts_);
+    rewriteContacts_ = false;
 }
 
 void
-ContactList::saveTrustRequests() const
+ContactList::saveTrustRequests()
 {
-    std::ofstream file(path_ + DIR_SEPARATOR_STR "incomingTrustRequests",
-                       std::ios::trunc | std::ios::binary);
-    msgpack::pack(file, trustRequests_);
+    if (batch_ > 0)
+        return;
+    trustRequestsJournal_ = saveJournaled(path_ + DIR_SEPARATOR_STR "incomingTrustRequests",
+                                          trustRequests_,
+                                          dirtyTrustRequests_,
+                                          trustRequestsJournal_,
+                                          rewriteTrustRequests_);
+    rewriteTrustRequests_ = false;
 }
 
 void
@@ -253,11 +397,8 @@ ContactList::loadTrustRequests()
         return;
     std::map<dht::InfoHash, TrustRequest> requests;
     try {
-        // read file
-        auto file = fileutils::loadFile("incomingTrustRequests", path_);
-        // load values
-        msgpack::object_handle oh = msgpack::unpack((const char*) file.data(), file.size());
-        oh.get().convert(requests);
+        trustRequestsJournal_ = loadJournaled(path_ + DIR_SEPARATOR_STR "incomingTrustRequests",
+                                              requests);
     } catch (const std::exception& e) {
         JAMI_WARN("[Contacts] error loading trust requests: %s", e.what());
         return;
@@ -296,6 +437,7 @@ ContactList::onTrustRequest(const dht::InfoHash& peer_account,
                 accept = true;
             if (not contact->second.confirmed) {
                 contact->second.confirmed = true;
+                contactChanged(peer_account);
                 callbacks_.contactAdded(peer_account.toString(), true);
             }
         }
@@ -319,7 +461,7 @@ ContactList::onTrustRequest(const dht::InfoHash& peer_account,
                          peer_account.toString().c_str());
             }
         }
-        saveTrustRequests();
+        trustRequestChanged(peer_account);
     }
     // Note: call JamiAccount's callback to build ConversationRequest anyway
     if (!confirm)
@@ -376,7 +518,7 @@ ContactList::acceptTrustRequest(const dht::InfoHash& from)
     addContact(from, true, i->second.conversationId);
     // Clear trust request
     trustRequests_.erase(i);
-    saveTrustRequests();
+    trustRequestChanged(from);
     return true;
 }
 
@@ -391,7 +533,7 @@ bool
 ContactList::discardTrustRequest(const dht::InfoHash& from)
 {
     if (trustRequests_.erase(from) > 0) {
-        saveTrustRequests();
+        trustRequestChanged(from);
         return true;
     }
     return false;
@@ -27,6 +27,7 @@
 
 #include <map>
 #include <mutex>
+#include <set>
 #include <chrono>
 
 namespace jami {
@@ -56,12 +57,39 @@ public:
         OnConfirmation onConfirmation;
     };
 
+    /**
+     * Defers the writes of the changes made during its lifetime: they are saved
+     * together when the outermost batch ends.
+     */
+    class Batch
+    {
+    public:
+        explicit Batch(ContactList& list)
+            : list_(list)
+        {
+            ++list_.batch_;
+        }
+        ~Batch()
+        {
+            if (--list_.batch_ == 0) {
+                list_.saveContacts();
+                list_.saveTrustRequests();
+            }
+        }
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+    private:
+        ContactList& list_;
+    };
+
     ContactList(const std::shared_ptr<crypto::Certificate>& cert,
                 const std::string& path,
                 OnChangeCallback cb);
     ~ContactList();
 
     void load();
+    /** Save everything, without journal */
     void save();
 
     /* Contacts */
@@ -103,9 +131,15 @@ public:
     const std::map<dht::InfoHash, Contact>& getContacts() const;
     void setContacts(const std::map<dht::InfoHash, Contact>&);
     void updateContact(const dht::InfoHash&, const Contact&);
+    /** updateContact for each contact, saved once */
+    void updateContacts(const std::map<dht::InfoHash, Contact>&);
 
-    /** Should be called only after updateContact */
-    void saveContacts() const;
+    /**
+     * Should be called only after updateContact.
+     * Changes are appended to a journal, merged in the contact file when it
+     * becomes larger than the contact list. Deferred during a Batch.
+     */
+    void saveContacts();
 
     std::string path() const { return path_; }
 
@@ -125,8 +159,8 @@ public:
     bool acceptTrustRequest(const dht::InfoHash& from);
     bool discardTrustRequest(const dht::InfoHash& from);
 
-    /** Should be called only after onTrustRequest */
-    void saveTrustRequests() const;
+    /** Should be called only after onTrustRequest. Same storage as saveContacts. */
+    void saveTrustRequests();
 
     /* Devices */
     const std::map<dht::PkId, KnownDevice>& getKnownDevices() const { return knownDevices_; }
@@ -160,6 +194,18 @@ private:
 
     OnChangeCallback callbacks_;
 
+    // Changes not saved yet, and number of records in the journals
+    std::set<dht::InfoHash> dirtyContacts_;
+    std::set<dht::InfoHash> dirtyTrustRequests_;
+    bool rewriteContacts_ {false};
+    bool rewriteTrustRequests_ {false};
+    std::size_t contactsJournal_ {0};
+    std::size_t trustRequestsJournal_ {0};
+    unsigned batch_ {0};
+
+    void contactChanged(const dht::InfoHash& h);
+    void trustRequestChanged(const dht::InfoHash& h);
+
     void loadContacts();
     void loadTrustRequests();
 
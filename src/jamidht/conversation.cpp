@@ -70,6 +70,48 @@ ConvInfo::toJson() const
     return json;
 }
 
+/**
+ * Interactions are the messages shown to the user. Member events, votes, profile
+ * updates, merges and the initial commit are not, so they are never unread.
+ */
+static bool
+isInteraction(std::string_view type)
+{
+    return !type.empty() && type != "initial" && type != "member" && type != "vote"
+           && type != "merge" && type != "application/update-profile";
+}
+
+void
+ConvSummary::onMessage(const std::map<std::string, std::string>& message,
+                       std::string_view username)
+{
+    auto get = [&](const std::string& key) {
+        auto it = message.find(key);
+        return it != message.end() ? it->second : std::string {};
+    };
+    lastMessageId = get(ConversationMapKeys::ID);
+    lastMessageAuthor = get("author");
+    lastMessageType = get("type");
+    lastMessageBody = get("body");
+    auto timestamp = static_cast<time_t>(std::strtoll(get("timestamp").c_str(), nullptr, 10));
+    lastActivity = std::max(lastActivity, timestamp);
+    if (lastMessageAuthor == username)
+        unread = 0;
+    else if (isInteraction(lastMessageType))
+        ++unread;
+}
+
+std::map<std::string, std::string>
+ConvSummary::toMap() const
+{
+    return {{ConversationMapKeys::LAST_MESSAGE_ID, lastMessageId},
+            {ConversationMapKeys::LAST_MESSAGE_AUTHOR, lastMessageAuthor},
+            {ConversationMapKeys::LAST_MESSAGE_TYPE, lastMessageType},
+            {ConversationMapKeys::LAST_MESSAGE_BODY, lastMessageBody},
+            {ConversationMapKeys::LAST_ACTIVITY, std::to_string(lastActivity)},
+            {ConversationMapKeys::UNREAD, std::to_string(unread)}};
+}
+
 // ConversationRequest
 ConversationRequest::ConversationRequest(const Json::Value& json)
 {
@@ -206,6 +248,9 @@ public:
         auto ok = !commits.empty();
         auto lastId = ok ? commits.rbegin()->at(ConversationMapKeys::ID) : "";
         if (ok) {
+            // Update upper layers before clients get the messages
+            if (messagesAnnouncedCb_)
+                messagesAnnouncedCb_(convId, commits);
             bool announceMember = false;
             for (const auto& c : commits) {
                 // Announce member events
@@ -368,6 +413,7 @@ public:
     mutable std::mutex lastDisplayedMtx_ {}; // for lastDisplayed_
     mutable std::map<std::string, std::string> lastDisplayed_ {};
     std::function<void(const std::string&, const std::string&)> lastDisplayedUpdatedCb_ {};
+    OnMessagesAnnounced messagesAnnouncedCb_ {};
 };
 
 bool
@@ -377,12 +423,11 @@ Conversation::Impl::isAdmin() const
     if (!shared)
         return false;
 
-    auto adminsPath = repoPath() + DIR_SEPARATOR_STR + "admins";
     auto cert = shared->identity().second;
     if (!cert->issuer)
         return false;
     auto uri = cert->issuer->getId().toString();
-    return fileutils::isFile(fileutils::getFullPath(adminsPath, uri + ".crt"));
+    return repository_->memberRole(uri) == MemberRole::ADMIN;
 }
 
 std::string
@@ -580,6 +625,42 @@ Conversation::addMember(const std::string& contactUri, const OnDoneCb& cb)
     });
 }
 
+void
+Conversation::addMembers(const std::vector<std::string>& contactUris, OnMultiDoneCb&& cb)
+{
+    std::vector<std::string> uris;
+    try {
+        if (mode() == ConversationMode::ONE_TO_ONE) {
+            JAMI_WARN("Cannot add several members in one to one conversation");
+            if (cb)
+                cb({});
+            return;
+        }
+    } catch (const std::exception& e) {
+        JAMI_WARN("Cannot get mode: %s", e.what());
+        if (cb)
+            cb({});
+        return;
+    }
+    for (const auto& uri : contactUris) {
+        if (isMember(uri, true) || isBanned(uri)) {
+            JAMI_WARN("Could not add member %s: already a member or banned", uri.c_str());
+            continue;
+        }
+        uris.emplace_back(uri);
+    }
+    dht::ThreadPool::io().run([w = weak(), uris = std::move(uris), cb = std::move(cb)] {
+        if (auto sthis = w.lock()) {
+            std::unique_lock<std::mutex> lk(sthis->pimpl_->writeMtx_);
+            auto commits = sthis->pimpl_->repository_->addMembers(uris);
+            sthis->pimpl_->announce(commits);
+            lk.unlock();
+            if (cb)
+                cb(commits);
+        }
+    });
+}
+
 void
 Conversation::Impl::voteUnban(const std::string& contactUri,
                               const std::string& type,
@@ -729,44 +810,21 @@ Conversation::join()
 bool
 Conversation::isMember(const std::string& uri, bool includeInvited) const
 {
-    auto shared = pimpl_->account_.lock();
-    if (!shared)
-        return false;
-
-    auto invitedPath = pimpl_->repoPath() + DIR_SEPARATOR_STR + "invited";
-    auto adminsPath = pimpl_->repoPath() + DIR_SEPARATOR_STR + "admins";
-    auto membersPath = pimpl_->repoPath() + DIR_SEPARATOR_STR + "members";
-    std::vector<std::string> pathsToCheck = {adminsPath, membersPath};
-    if (includeInvited)
-        pathsToCheck.emplace_back(invitedPath);
-    for (const auto& path : pathsToCheck) {
-        for (const auto& certificate : fileutils::readDirectory(path)) {
-            if (path != invitedPath && certificate.find(".crt") == std::string::npos) {
-                JAMI_WARN("Incorrect file found: %s/%s", path.c_str(), certificate.c_str());
-                continue;
-            }
-            auto crtUri = certificate;
-            if (crtUri.find(".crt") != std::string::npos)
-                crtUri = crtUri.substr(0, crtUri.size() - std::string(".crt").size());
-            if (crtUri == uri)
-                return true;
-        }
-    }
-
-    if (includeInvited && mode() == ConversationMode::ONE_TO_ONE) {
-        for (const auto& member : getInitialMembers()) {
-            if (member == uri)
-                return true;
-        }
-    }
-
-    return false;
+    // NOTE: left members of one to one conversations are initial members, so they are
+    // accepted as invited members.
+    return pimpl_->repository_->isMember(uri, includeInvited);
 }
 
 bool
 Conversation::isBanned(const std::string& uri) const
 {
-    return !pimpl_->bannedType(uri).empty();
+    return pimpl_->repository_->isBanned(uri);
+}
+
+uint64_t
+Conversation::membersGeneration() const
+{
+    return pimpl_->repository_->membersGeneration();
 }
 
 void
@@ -846,6 +904,43 @@ Conversation::loadMessages(const OnLoadMessages& cb, const std::string& fromMess
     });
 }
 
+void
+Conversation::loadMessagesPaged(OnLoadMessagesPage&& cb,
+                                const std::string& fromMessage,
+                                size_t pageSize)
+{
+    if (!cb || pageSize == 0)
+        return;
+    dht::ThreadPool::io().run([w = weak(), cb = std::move(cb), fromMessage, pageSize] {
+        auto sthis = w.lock();
+        if (!sthis) {
+            // Let the caller know that nothing else will come
+            cb({}, {});
+            return;
+        }
+        // Commits are kept as they come from the walk (message not parsed, no signature)
+        // and only converted to maps when the page is sent.
+        std::vector<ConversationCommit> page;
+        page.reserve(pageSize);
+        auto stopped = false;
+        sthis->pimpl_->repository_->forEachCommit(fromMessage, [&](ConversationCommit&& commit) {
+            auto next = commit.linearized_parent;
+            page.emplace_back(std::move(commit));
+            // The last commit is sent with the last page
+            if (page.size() == pageSize && !next.empty()) {
+                if (!cb(sthis->pimpl_->convCommitToMap(page), next)) {
+                    stopped = true;
+                    return false;
+                }
+                page.clear();
+            }
+            return true;
+        });
+        if (!stopped)
+            cb(sthis->pimpl_->convCommitToMap(page), {});
+    });
+}
+
 std::optional<std::map<std::string, std::string>>
 Conversation::getCommit(const std::string& commitId) const
 {
@@ -897,6 +992,10 @@ Conversation::mergeHistory(const std::string& uri)
         return {};
     }
 
+    // Keep current HEAD to only refresh members touched by the merge
+    auto currentHead = pimpl_->repository_->logN("", 1);
+    auto oldHead = currentHead.empty() ? std::string() : currentHead.front().id;
+
     // Validate commit
     auto [newCommits, err] = pimpl_->repository_->validFetch(uri);
     if (newCommits.empty()) {
@@ -925,7 +1024,8 @@ Conversation::mergeHistory(const std::string& uri)
     for (const auto& commit : result) {
         auto it = commit.find("type");
         if (it != commit.end() && it->second == "member") {
-            pimpl_->repository_->refreshMembers();
+            pimpl_->repository_->updateMembers(oldHead);
+            break;
         }
     }
     return result;
@@ -1114,9 +1214,9 @@ Conversation::updateInfos(const std::map<std::string, std::string>& map, const O
 }
 
 std::map<std::string, std::string>
-Conversation::infos() const
+Conversation::infos(const std::vector<std::string>& fields) const
 {
-    return pimpl_->repository_->infos();
+    return pimpl_->repository_->infos(fields);
 }
 
 std::vector<uint8_t>
@@ -1312,6 +1412,12 @@ Conversation::onLastDisplayedUpdated(
     pimpl_->lastDisplayedUpdatedCb_ = std::move(lastDisplayedUpdatedCb);
 }
 
+void
+Conversation::onMessagesAnnounced(OnMessagesAnnounced&& messagesAnnouncedCb)
+{
+    pimpl_->messagesAnnouncedCb_ = std::move(messagesAnnouncedCb);
+}
+
 uint32_t
 Conversation::countInteractions(const std::string& toId,
                                 const std::string& fromId,
@@ -1321,4 +1427,31 @@ Conversation::countInteractions(const std::string& toId,
     return pimpl_->repository_->log(fromId, toId, false, true, authorUri).size();
 }
 
+uint32_t
+Conversation::countUnread(const std::string& lastDisplayed, const std::string& username) const
+{
+    uint32_t unread = 0;
+    Json::CharReaderBuilder rbuilder;
+    auto reader = std::unique_ptr<Json::CharReader>(rbuilder.newCharReader());
+    pimpl_->repository_->forEachCommit("", [&](ConversationCommit&& commit) {
+        if (commit.id == lastDisplayed)
+            return false;
+        // Our own messages mean that everything before was read
+        auto cert = tls::CertificateStore::instance().getCertificate(commit.author.email);
+        if (cert && cert->issuer && cert->issuer->getId().toString() == username)
+            return false;
+        if (commit.parents.size() > 1)
+            return true; // merge
+        Json::Value cm;
+        if (reader->parse(commit.commit_msg.data(),
+                          commit.commit_msg.data() + commit.commit_msg.size(),
+                          &cm,
+                          nullptr)
+            && isInteraction(cm["type"].asString()))
+            ++unread;
+        return true;
+    });
+    return unread;
+}
+
 } // namespace jami
\ No newline at end of file
@@ -45,6 +45,12 @@ static constexpr const char* DECLINED = "declined";
 static constexpr const char* FROM = "from";
 static constexpr const char* CONVERSATIONID = "conversationId";
 static constexpr const char* METADATAS = "metadatas";
+static constexpr const char* UNREAD = "unread";
+static constexpr const char* LAST_ACTIVITY = "lastActivity";
+static constexpr const char* LAST_MESSAGE_ID = "lastMessageId";
+static constexpr const char* LAST_MESSAGE_AUTHOR = "lastMessageAuthor";
+static constexpr const char* LAST_MESSAGE_TYPE = "lastMessageType";
+static constexpr const char* LAST_MESSAGE_BODY = "lastMessageBody";
 } // namespace ConversationMapKeys
 
 /**
@@ -78,6 +84,34 @@ struct ConversationRequest
     MSGPACK_DEFINE_MAP(from, conversationId, metadatas, received, declined)
 };
 
+/**
+ * Cached informations used by clients to display a conversation in a list
+ * (last message and interactions not displayed yet), so they don't have to
+ * walk the history of each conversation.
+ */
+struct ConvSummary
+{
+    std::string lastMessageId {};
+    std::string lastMessageAuthor {};
+    std::string lastMessageType {};
+    std::string lastMessageBody {};
+    time_t lastActivity {0};
+    // Same as countUnread(lastDisplayed, username)
+    uint32_t unread {0};
+
+    /**
+     * Update the summary with a new message (in the history order)
+     * @param message       The message as announced to clients
+     * @param username      Our uri, our own messages reset the unread count
+     */
+    void onMessage(const std::map<std::string, std::string>& message, std::string_view username);
+
+    std::map<std::string, std::string> toMap() const;
+
+    MSGPACK_DEFINE_MAP(
+        lastMessageId, lastMessageAuthor, lastMessageType, lastMessageBody, lastActivity, unread)
+};
+
 struct ConvInfo
 {
     std::string id {};
@@ -86,13 +120,14 @@ struct ConvInfo
     time_t erased {0};
     std::vector<std::string> members;
     std::string lastDisplayed {};
+    ConvSummary summary {};
 
     ConvInfo() = default;
     ConvInfo(const Json::Value& json);
 
     Json::Value toJson() const;
 
-    MSGPACK_DEFINE_MAP(id, created, removed, erased, members, lastDisplayed)
+    MSGPACK_DEFINE_MAP(id, created, removed, erased, members, lastDisplayed, summary)
 };
 
 class JamiAccount;
@@ -104,6 +139,18 @@ enum class ConversationMode;
 using OnPullCb = std::function<void(bool fetchOk)>;
 using OnLoadMessages
     = std::function<void(std::vector<std::map<std::string, std::string>>&& messages)>;
+/**
+ * Called for each page of messages
+ * @param messages      Messages of the page
+ * @param next          Id of the next message to load ("" if the whole history is loaded)
+ * @return false to stop the loading
+ */
+using OnLoadMessagesPage
+    = std::function<bool(std::vector<std::map<std::string, std::string>>&& messages,
+                         const std::string& next)>;
+using OnMessagesAnnounced
+    = std::function<void(const std::string& conversationId,
+                         const std::vector<std::map<std::string, std::string>>& messages)>;
 using OnDoneCb = std::function<void(bool, const std::string&)>;
 using OnMultiDoneCb = std::function<void(const std::vector<std::string>&)>;
 
@@ -126,6 +173,13 @@ public:
      */
     void onLastDisplayedUpdated(
         std::function<void(const std::string&, const std::string&)>&& lastDisplayedUpdatedCb);
+    /**
+     * Add a callback to update upper layers
+     * @note to call after the construction (and before ConversationReady)
+     * @param messagesAnnouncedCb   Triggered with new messages (sent or merged) in the
+     *                              history order, after they are announced to the client
+     */
+    void onMessagesAnnounced(OnMessagesAnnounced&& messagesAnnouncedCb);
 
     std::string id() const;
 
@@ -136,6 +190,12 @@ public:
      * @param cb    On done cb
      */
     void addMember(const std::string& contactUri, const OnDoneCb& cb = {});
+    /**
+     * Add several members in one operation (banned and current members are ignored)
+     * @param contactUris   Members to add
+     * @param cb            Called with the commits (empty on failure)
+     */
+    void addMembers(const std::vector<std::string>& contactUris, OnMultiDoneCb&& cb = {});
     void removeMember(const std::string& contactUri, bool isDevice, const OnDoneCb& cb = {});
     /**
      * @param includeInvited        If we want invited members
@@ -175,6 +235,11 @@ public:
      */
     bool isMember(const std::string& uri, bool includeInvited = false) const;
     bool isBanned(const std::string& uri) const;
+    /**
+     * Incremented each time members or devices of the conversation change
+     * @note can be used to know if something derived from members needs to be recomputed
+     */
+    uint64_t membersGeneration() const;
 
     // Message send
     void sendMessage(std::string&& message,
@@ -202,6 +267,17 @@ public:
     void loadMessages(const OnLoadMessages& cb,
                       const std::string& fromMessage = "",
                       const std::string& toMessage = "");
+    /**
+     * Get messages by pages of fixed size. Only one page is in memory at a time.
+     * @param cb            Called for each page, the last one is called with an empty next id
+     *                      (also if the conversation is destroyed before the loading starts)
+     * @note a page can contain less than pageSize messages if some commits can't be read
+     * @param fromMessage   The most recent message ("" = last)
+     * @param pageSize      Number of messages per page
+     */
+    void loadMessagesPaged(OnLoadMessagesPage&& cb,
+                           const std::string& fromMessage,
+                           size_t pageSize);
     /**
      * Retrieve one commit
      * @param   commitId
@@ -298,9 +374,10 @@ public:
 
     /**
      * Retrieve current infos (title, description, avatar, mode)
+     * @param fields    Infos to return, all of them if empty
      * @return infos
      */
-    std::map<std::string, std::string> infos() const;
+    std::map<std::string, std::string> infos(const std::vector<std::string>& fields = {}) const;
     std::vector<uint8_t> vCard() const;
 
     /////// File transfer
@@ -379,6 +456,15 @@ public:
                                const std::string& fromId = "",
                                const std::string& authorUri = "") const;
 
+    /**
+     * Count the interactions not displayed yet, member events and other
+     * non interaction commits are ignored
+     * @param lastDisplayed     Last displayed interaction ("" for the whole history)
+     * @param username          Our uri, stop counting at our last interaction
+     * @return number of unread interactions
+     */
+    uint32_t countUnread(const std::string& lastDisplayed, const std::string& username) const;
+
 private:
     std::shared_ptr<Conversation> shared()
     {
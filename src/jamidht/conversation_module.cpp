@@ -20,7 +20,10 @@
 
 #include "conversation_module.h"
 
+#include <array>
+#include <chrono>
 #include <fstream>
+#include <optional>
 
 #include <opendht/thread_pool.h>
 
@@ -30,6 +33,7 @@
 #include "jamidht/account_manager.h"
 #include "jamidht/jamiaccount.h"
 #include "manager.h"
+#include "map_utils.h"
 #include "vcard.h"
 
 namespace jami {
@@ -44,6 +48,9 @@ struct PendingConversationFetch
     std::set<std::string> connectingTo {};
 };
 
+// Summaries updated by new messages are saved at most once per period
+constexpr std::chrono::seconds CONV_INFOS_SAVE_DELAY {5};
+
 class ConversationModule::Impl : public std::enable_shared_from_this<Impl>
 {
 public:
@@ -52,6 +59,12 @@ public:
          SengMsgCb&& sendMsgCb,
          NeedSocketCb&& onNeedSocket,
          UpdateConvReq&& updateConvReqCb);
+    ~Impl()
+    {
+        // Do not lose the last summaries
+        if (saveConvInfosPending_)
+            ConversationModule::saveConvInfos(accountId_, convInfos_);
+    }
 
     // Retrieving recent commits
     /**
@@ -113,8 +126,8 @@ public:
      */
     bool isConversation(const std::string& convId) const
     {
-        std::lock_guard<std::mutex> lk(conversationsMtx_);
-        return conversations_.find(convId) != conversations_.end();
+        auto snapshot = snapshotConversations();
+        return snapshot->find(convId) != snapshot->end();
     }
 
     void addConvInfo(const ConvInfo& info)
@@ -129,12 +142,27 @@ public:
      */
     void onLastDisplayedUpdated(const std::string& convId, const std::string& lastId)
     {
-        // must not lock as used in callback from a conversation,
-        // so convInfos_ cannot change for convId
-        auto itConv = convInfos_.find(convId);
-        if (itConv != convInfos_.end())
-            itConv->second.lastDisplayed = lastId;
-        saveConvInfos();
+        // The history is walked before locking, so other conversations are not blocked
+        std::optional<uint32_t> unread;
+        auto infos = snapshotConvInfos();
+        auto itInfo = infos->find(convId);
+        if (itInfo != infos->end() && lastId != itInfo->second.summary.lastMessageId)
+            if (auto conversation = getConversation(convId))
+                unread = conversation->countUnread(lastId, username_);
+        {
+            // Note: the conversation never calls this callback with convInfosMtx_ locked
+            std::lock_guard<std::mutex> lk(convInfosMtx_);
+            auto itConv = convInfos_.find(convId);
+            if (itConv != convInfos_.end()) {
+                itConv->second.lastDisplayed = lastId;
+                auto& summary = itConv->second.summary;
+                if (lastId == summary.lastMessageId)
+                    summary.unread = 0;
+                else if (unread)
+                    summary.unread = *unread;
+            }
+            saveConvInfos();
+        }
 
         // Updates info for client
         emitSignal<DRing::ConfigurationSignal::AccountMessageStatusChanged>(
@@ -145,6 +173,57 @@ public:
             static_cast<int>(DRing::Account::MessageStates::DISPLAYED));
     }
 
+    /**
+     * Updates the summary of a conversation with new messages
+     */
+    void onMessagesAnnounced(const std::string& convId,
+                             const std::vector<std::map<std::string, std::string>>& messages)
+    {
+        std::lock_guard<std::mutex> lk(convInfosMtx_);
+        auto itConv = convInfos_.find(convId);
+        if (itConv == convInfos_.end())
+            return;
+        for (const auto& message : messages)
+            itConv->second.summary.onMessage(message, username_);
+        // Clients read the snapshot, the file can wait for the next messages
+        publishConvInfos();
+        if (saveConvInfosPending_)
+            return;
+        saveConvInfosPending_ = true;
+        Manager::instance().scheduler().scheduleIn(
+            [w = weak()] {
+                if (auto sthis = w.lock()) {
+                    std::lock_guard<std::mutex> lk(sthis->convInfosMtx_);
+                    if (sthis->saveConvInfosPending_)
+                        sthis->saveConvInfos();
+                }
+            },
+            CONV_INFOS_SAVE_DELAY);
+    }
+
+    /**
+     * Compute a summary from the repository. Only used when a conversation
+     * is loaded or cloned without a cached summary, the summary is then
+     * updated incrementally
+     */
+    ConvSummary computeSummary(const Conversation& conversation,
+                               const std::string& lastDisplayed) const
+    {
+        ConvSummary summary;
+        if (auto commit = conversation.getCommit(conversation.lastCommitId()))
+            summary.onMessage(*commit, username_);
+        summary.unread = conversation.countUnread(lastDisplayed, username_);
+        return summary;
+    }
+
+    void initCallbacks(Conversation& conversation)
+    {
+        conversation.onLastDisplayedUpdated(
+            [this](auto convId, auto lastId) { onLastDisplayedUpdated(convId, lastId); });
+        conversation.onMessagesAnnounced(
+            [this](auto convId, const auto& messages) { onMessagesAnnounced(convId, messages); });
+    }
+
     std::weak_ptr<JamiAccount> account_;
     NeedsSyncingCb needsSyncingCb_;
     SengMsgCb sendMsgCb_;
@@ -160,8 +239,43 @@ public:
     std::map<std::string, ConversationRequest> conversationsRequests_;
 
     // Conversations
-    mutable std::mutex conversationsMtx_ {};
-    std::map<std::string, std::shared_ptr<Conversation>> conversations_;
+    using ConversationsMap = std::map<std::string, std::shared_ptr<Conversation>>;
+    mutable std::mutex conversationsMtx_ {}; // Serializes insertions and removals
+    ConversationsMap conversations_;
+    // Immutable copy of conversations_, replaced after each insertion or removal,
+    // so lookups from the client API never wait for sync operations.
+    // Mutations of one conversation (clone, fetch, removal) are serialized by convLock().
+    std::shared_ptr<const ConversationsMap> conversationsSnapshot_ {
+        std::make_shared<const ConversationsMap>()};
+    /**
+     * @note conversationsMtx_ should be locked
+     */
+    void publishConversations()
+    {
+        std::atomic_store(&conversationsSnapshot_,
+                          std::make_shared<const ConversationsMap>(conversations_));
+    }
+    std::shared_ptr<const ConversationsMap> snapshotConversations() const
+    {
+        return std::atomic_load(&conversationsSnapshot_);
+    }
+    std::shared_ptr<Conversation> getConversation(const std::string& convId) const
+    {
+        auto snapshot = snapshotConversations();
+        auto it = snapshot->find(convId);
+        return it != snapshot->end() ? it->second : nullptr;
+    }
+    /**
+     * Lock serializing the mutations of a conversation without blocking the others.
+     * Conversations are spread over a fixed set of locks.
+     * @note should be locked before conversationsMtx_ and convInfosMtx_, and never
+     * for two conversations at the same time
+     */
+    std::recursive_mutex& convLock(const std::string& convId) const
+    {
+        return convLocks_[std::hash<std::string> {}(convId) % convLocks_.size()];
+    }
+    mutable std::array<std::recursive_mutex, 16> convLocks_ {};
     std::mutex pendingConversationsFetchMtx_ {};
     std::map<std::string, PendingConversationFetch> pendingConversationsFetch_;
 
@@ -212,12 +326,33 @@ public:
 
     // The following informations are stored on the disk
     mutable std::mutex convInfosMtx_; // Note, should be locked after conversationsMtx_ if needed
-    std::map<std::string, ConvInfo> convInfos_;
+    ConvInfoMap convInfos_;
+    // Immutable copy of convInfos_, see conversationsSnapshot_
+    mutable std::shared_ptr<const ConvInfoMap> convInfosSnapshot_ {
+        std::make_shared<const ConvInfoMap>()};
+    /**
+     * @note convInfosMtx_ should be locked
+     */
+    void publishConvInfos() const
+    {
+        std::atomic_store(&convInfosSnapshot_, std::make_shared<const ConvInfoMap>(convInfos_));
+    }
+    std::shared_ptr<const ConvInfoMap> snapshotConvInfos() const
+    {
+        return std::atomic_load(&convInfosSnapshot_);
+    }
     // The following methods modify what is stored on the disk
     /**
      * @note convInfosMtx_ should be locked
      */
-    void saveConvInfos() const { ConversationModule::saveConvInfos(accountId_, convInfos_); }
+    void saveConvInfos() const
+    {
+        publishConvInfos();
+        saveConvInfosPending_ = false;
+        ConversationModule::saveConvInfos(accountId_, convInfos_);
+    }
+    // If a delayed save of convInfos_ is scheduled (see onMessagesAnnounced)
+    mutable bool saveConvInfosPending_ {false};
     /**
      * @note conversationsRequestsMtx_ should be locked
      */
@@ -253,6 +388,10 @@ public:
     // Replay conversations (after erasing/re-adding)
     std::mutex replayMtx_;
     std::map<std::string, std::vector<std::map<std::string, std::string>>> replay_;
+
+    // Running paged loads (cancellable)
+    std::mutex pagedLoadsMtx_;
+    std::set<uint32_t> pagedLoads_;
 };
 
 ConversationModule::Impl::Impl(std::weak_ptr<JamiAccount>&& account,
@@ -336,10 +475,8 @@ ConversationModule::Impl::cloneConversation(const std::string& deviceId,
         convInfos_[info.id] = std::move(info);
         saveConvInfos();
     } else {
-        std::unique_lock<std::mutex> lk(conversationsMtx_);
-        auto conversation = conversations_.find(convId);
-        if (conversation != conversations_.end() && conversation->second)
-            conversation->second->updateLastDisplayed(lastDisplayed);
+        if (auto conversation = getConversation(convId))
+            conversation->updateLastDisplayed(lastDisplayed);
         JAMI_INFO("[Account %s] Already have conversation %s", accountId_.c_str(), convId.c_str());
     }
 }
@@ -355,17 +492,17 @@ ConversationModule::Impl::fetchNewCommits(const std::string& peer,
              peer.c_str(),
              deviceId.c_str());
 
-    std::unique_lock<std::mutex> lk(conversationsMtx_);
-    auto conversation = conversations_.find(conversationId);
-    if (conversation != conversations_.end() && conversation->second) {
-        if (!conversation->second->isMember(peer, true)) {
+    std::lock_guard<std::recursive_mutex> lkConv(convLock(conversationId));
+    auto conversation = getConversation(conversationId);
+    if (conversation) {
+        if (!conversation->isMember(peer, true)) {
             JAMI_WARN("[Account %s] %s is not a member of %s",
                       accountId_.c_str(),
                       peer.c_str(),
                       conversationId.c_str());
             return;
         }
-        if (conversation->second->isBanned(deviceId)) {
+        if (conversation->isBanned(deviceId)) {
             JAMI_WARN("[Account %s] %s is a banned device in conversation %s",
                       accountId_.c_str(),
                       deviceId.c_str(),
@@ -374,7 +511,7 @@ ConversationModule::Impl::fetchNewCommits(const std::string& peer,
         }
 
         // Retrieve current last message
-        auto lastMessageId = conversation->second->lastCommitId();
+        auto lastMessageId = conversation->lastCommitId();
         if (lastMessageId.empty()) {
             JAMI_ERR("[Account %s] No message detected. This is a bug", accountId_.c_str());
             return;
@@ -393,16 +530,15 @@ ConversationModule::Impl::fetchNewCommits(const std::string& peer,
                        peer = std::move(peer),
                        deviceId = std::move(deviceId),
                        commitId = std::move(commitId)](const auto& channel) {
-                          auto conversation = conversations_.find(conversationId);
+                          auto conversation = getConversation(conversationId);
                           auto acc = account_.lock();
-                          if (!channel || !acc || conversation == conversations_.end()
-                              || !conversation->second) {
+                          if (!channel || !acc || !conversation) {
                               std::lock_guard<std::mutex> lk(pendingConversationsFetchMtx_);
                               stopFetch(conversationId, deviceId);
                               return false;
                           }
                           acc->addGitSocket(channel->deviceId(), conversationId, channel);
-                          conversation->second->sync(
+                          conversation->sync(
                               peer,
                               deviceId,
                               [this,
@@ -437,14 +573,8 @@ ConversationModule::Impl::fetchNewCommits(const std::string& peer,
             if (pendingConversationsFetch_.find(conversationId) != pendingConversationsFetch_.end())
                 return;
         }
-        bool clone = false;
-        {
-            std::lock_guard<std::mutex> lkCi(convInfosMtx_);
-            auto convIt = convInfos_.find(conversationId);
-            clone = convIt != convInfos_.end();
-        }
-        lk.unlock();
-        if (clone) {
+        auto infos = snapshotConvInfos();
+        if (infos->find(conversationId) != infos->end()) {
             cloneConversation(deviceId, peer, conversationId);
             return;
         }
@@ -486,8 +616,9 @@ ConversationModule::Impl::handlePendingConversation(const std::string& conversat
     };
     try {
         auto conversation = std::make_shared<Conversation>(account_, deviceId, conversationId);
-        conversation->onLastDisplayedUpdated(
-            std::move([&](auto convId, auto lastId) { onLastDisplayedUpdated(convId, lastId); }));
+        // Cloned, the insertion must not race with a removal of the same conversation
+        std::lock_guard<std::recursive_mutex> lkConv(convLock(conversationId));
+        initCallbacks(*conversation);
         if (!conversation->isMember(username_, true)) {
             JAMI_ERR("Conversation cloned but doesn't seems to be a valid member");
             conversation->erase();
@@ -499,13 +630,15 @@ ConversationModule::Impl::handlePendingConversation(const std::string& conversat
             std::lock_guard<std::mutex> lk(conversationsMtx_);
             // Note: a removeContact while cloning. In this case, the conversation
             // must not be announced and removed.
-            auto itConv = convInfos_.find(conversationId);
-            if (itConv != convInfos_.end() && itConv->second.removed)
+            auto infos = snapshotConvInfos();
+            auto itConv = infos->find(conversationId);
+            if (itConv != infos->end() && itConv->second.removed)
                 removeRepo = true;
-            if (itConv != convInfos_.end() && !itConv->second.lastDisplayed.empty()) {
+            if (itConv != infos->end() && !itConv->second.lastDisplayed.empty()) {
                 conversation->updateLastDisplayed(itConv->second.lastDisplayed);
             }
             conversations_.emplace(conversationId, conversation);
+            publishConversations();
         }
         if (removeRepo) {
             removeRepository(conversationId, false, true);
@@ -513,6 +646,18 @@ ConversationModule::Impl::handlePendingConversation(const std::string& conversat
             return;
         }
         auto commitId = conversation->join();
+        auto infos = snapshotConvInfos();
+        auto itInfo = infos->find(conversationId);
+        if (itInfo != infos->end()) {
+            // The history is walked before locking
+            auto summary = computeSummary(*conversation, itInfo->second.lastDisplayed);
+            std::lock_guard<std::mutex> lk(convInfosMtx_);
+            auto itConv = convInfos_.find(conversationId);
+            if (itConv != convInfos_.end()) {
+                itConv->second.summary = std::move(summary);
+                saveConvInfos();
+            }
+        }
         std::vector<std::map<std::string, std::string>> messages;
         {
             std::lock_guard<std::mutex> lk(replayMtx_);
@@ -599,6 +744,7 @@ ConversationModule::Impl::getRequest(const std::string& id) const
 void
 ConversationModule::Impl::removeRepository(const std::string& conversationId, bool sync, bool force)
 {
+    std::lock_guard<std::recursive_mutex> lkConv(convLock(conversationId));
     std::unique_lock<std::mutex> lk(conversationsMtx_);
     auto it = conversations_.find(conversationId);
     if (it != conversations_.end() && it->second && (force || it->second->isRemoving())) {
@@ -617,6 +763,7 @@ ConversationModule::Impl::removeRepository(const std::string& conversationId, bo
         JAMI_DBG() << "Remove conversation: " << conversationId;
         it->second->erase();
         conversations_.erase(it);
+        publishConversations();
         lk.unlock();
 
         if (!sync)
@@ -636,11 +783,8 @@ ConversationModule::Impl::sendMessageNotification(const std::string& conversatio
                                                   const std::string& commitId,
                                                   bool sync)
 {
-    std::lock_guard<std::mutex> lk(conversationsMtx_);
-    auto it = conversations_.find(conversationId);
-    if (it != conversations_.end() && it->second) {
-        sendMessageNotification(*it->second, commitId, sync);
-    }
+    if (auto conversation = getConversation(conversationId))
+        sendMessageNotification(*conversation, commitId, sync);
 }
 
 void
@@ -682,10 +826,8 @@ ConversationModule::Impl::sendMessage(const std::string& conversationId,
                                       bool announce,
                                       OnDoneCb&& cb)
 {
-    std::lock_guard<std::mutex> lk(conversationsMtx_);
-    auto conversation = conversations_.find(conversationId);
-    if (conversation != conversations_.end() && conversation->second) {
-        conversation->second->sendMessage(
+    if (auto conversation = getConversation(conversationId)) {
+        conversation->sendMessage(
             std::move(value),
             parent,
             [this, conversationId, announce, cb = std::move(cb)](bool ok,
@@ -765,21 +907,25 @@ ConversationModule::loadConversations()
         fileutils::get_data_dir() + DIR_SEPARATOR_STR + pimpl_->accountId_ + DIR_SEPARATOR_STR
         + "conversations");
     std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
-    pimpl_->convInfos_ = convInfos(pimpl_->accountId_);
+    {
+        std::lock_guard<std::mutex> lkCi(pimpl_->convInfosMtx_);
+        pimpl_->convInfos_ = convInfos(pimpl_->accountId_);
+        pimpl_->publishConvInfos();
+    }
     pimpl_->conversations_.clear();
     for (const auto& repository : conversationsRepositories) {
         try {
             auto conv = std::make_shared<Conversation>(pimpl_->account_, repository);
-            conv->onLastDisplayedUpdated(std::move(
-                [&](auto convId, auto lastId) { pimpl_->onLastDisplayedUpdated(convId, lastId); }));
-            auto convInfo = pimpl_->convInfos_.find(repository);
-            if (convInfo == pimpl_->convInfos_.end()) {
+            pimpl_->initCallbacks(*conv);
+            auto infos = pimpl_->snapshotConvInfos();
+            if (infos->find(repository) == infos->end()) {
                 JAMI_ERR() << "Missing conv info for " << repository << ". This is a bug!";
                 ConvInfo info;
                 info.id = repository;
                 info.created = std::time(nullptr);
                 info.members = conv->memberUris();
                 info.lastDisplayed = conv->infos()[ConversationMapKeys::LAST_DISPLAYED];
+                info.summary = pimpl_->computeSummary(*conv, info.lastDisplayed);
                 addConvInfo(info);
             }
             pimpl_->conversations_.emplace(repository, std::move(conv));
@@ -789,31 +935,41 @@ ConversationModule::loadConversations()
                       e.what());
         }
     }
+    pimpl_->publishConversations();
 
     // Prune any invalid conversations without members and
     // set the removed flag if needed
-    size_t oldConvInfosSize = pimpl_->convInfos_.size();
     std::set<std::string> removed;
-    for (auto itInfo = pimpl_->convInfos_.cbegin(); itInfo != pimpl_->convInfos_.cend();) {
-        const auto& info = itInfo->second;
-        if (info.members.empty()) {
-            itInfo = pimpl_->convInfos_.erase(itInfo);
-            continue;
+    {
+        std::lock_guard<std::mutex> lkCi(pimpl_->convInfosMtx_);
+        size_t oldConvInfosSize = pimpl_->convInfos_.size();
+        auto summariesUpdated = false;
+        for (auto itInfo = pimpl_->convInfos_.begin(); itInfo != pimpl_->convInfos_.end();) {
+            auto& info = itInfo->second;
+            if (info.members.empty()) {
+                itInfo = pimpl_->convInfos_.erase(itInfo);
+                continue;
+            }
+            if (info.removed)
+                removed.insert(info.id);
+            auto itConv = pimpl_->conversations_.find(info.id);
+            if (itConv != pimpl_->conversations_.end() && info.removed)
+                itConv->second->setRemovingFlag();
+            // Convinfos from older versions don't have any summary
+            if (itConv != pimpl_->conversations_.end() && info.summary.lastMessageId.empty()) {
+                info.summary = pimpl_->computeSummary(*itConv->second, info.lastDisplayed);
+                summariesUpdated = true;
+            }
+            ++itInfo;
         }
-        if (info.removed)
-            removed.insert(info.id);
-        auto itConv = pimpl_->conversations_.find(info.id);
-        if (itConv != pimpl_->conversations_.end() && info.removed)
-            itConv->second->setRemovingFlag();
-        ++itInfo;
+        // Save iff we've removed some invalid entries or computed missing summaries
+        if (oldConvInfosSize != pimpl_->convInfos_.size() || summariesUpdated)
+            pimpl_->saveConvInfos();
     }
     // On oldest version, removeConversation didn't update "appdata/contacts"
     // causing a potential incorrect state between "appdata/contacts" and "appdata/convInfos"
     if (!removed.empty())
         acc->unlinkConversations(removed);
-    // Save iff we've removed some invalid entries
-    if (oldConvInfosSize != pimpl_->convInfos_.size())
-        pimpl_->saveConvInfos();
 
     JAMI_INFO("[Account %s] Conversations loaded!", pimpl_->accountId_.c_str());
 }
@@ -822,9 +978,9 @@ std::vector<std::string>
 ConversationModule::getConversations() const
 {
     std::vector<std::string> result;
-    std::lock_guard<std::mutex> lk(pimpl_->convInfosMtx_);
-    result.reserve(pimpl_->convInfos_.size());
-    for (const auto& [key, conv] : pimpl_->convInfos_) {
+    auto infos = pimpl_->snapshotConvInfos();
+    result.reserve(infos->size());
+    for (const auto& [key, conv] : *infos) {
         if (conv.removed)
             continue;
         result.emplace_back(key);
@@ -832,6 +988,23 @@ ConversationModule::getConversations() const
     return result;
 }
 
+std::vector<std::map<std::string, std::string>>
+ConversationModule::getConversationSummaries() const
+{
+    std::vector<std::map<std::string, std::string>> result;
+    auto infos = pimpl_->snapshotConvInfos();
+    result.reserve(infos->size());
+    for (const auto& [key, conv] : *infos) {
+        if (conv.removed)
+            continue;
+        auto summary = conv.summary.toMap();
+        summary[ConversationMapKeys::ID] = key;
+        summary[ConversationMapKeys::LAST_DISPLAYED] = conv.lastDisplayed;
+        result.emplace_back(std::move(summary));
+    }
+    return result;
+}
+
 std::string
 ConversationModule::getOneToOneConversation(const std::string& uri) const noexcept
 {
@@ -872,15 +1045,11 @@ ConversationModule::onTrustRequest(const std::string& uri,
                   "clone the old one");
         return;
     }
-    {
-        std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
-        auto itConv = pimpl_->conversations_.find(conversationId);
-        if (itConv != pimpl_->conversations_.end()) {
-            JAMI_INFO("[Account %s] Received a request for a conversation "
-                      "already handled. Ignore",
-                      pimpl_->accountId_.c_str());
-            return;
-        }
+    if (pimpl_->isConversation(conversationId)) {
+        JAMI_INFO("[Account %s] Received a request for a conversation "
+                  "already handled. Ignore",
+                  pimpl_->accountId_.c_str());
+        return;
     }
     if (pimpl_->getRequest(conversationId) != std::nullopt) {
         JAMI_INFO("[Account %s] Received a request for a conversation "
@@ -940,10 +1109,9 @@ ConversationModule::onNeedConversationRequest(const std::string& from,
                                               const std::string& conversationId)
 {
     // Check if the conversation exists
-    std::unique_lock<std::mutex> lk(pimpl_->conversationsMtx_);
-    auto itConv = pimpl_->conversations_.find(conversationId);
-    if (itConv != pimpl_->conversations_.end() && !itConv->second->isRemoving()) {
-        if (!itConv->second->isMember(from, true)) {
+    auto conversation = pimpl_->getConversation(conversationId);
+    if (conversation && !conversation->isRemoving()) {
+        if (!conversation->isMember(from, true)) {
             JAMI_WARN("%s is asking a new invite for %s, but not a member",
                       from.c_str(),
                       conversationId.c_str());
@@ -951,8 +1119,7 @@ ConversationModule::onNeedConversationRequest(const std::string& from,
         }
 
         // Send new invite
-        auto invite = itConv->second->generateInvitation();
-        lk.unlock();
+        auto invite = conversation->generateInvitation();
         JAMI_DBG("%s is asking a new invite for %s", from.c_str(), conversationId.c_str());
         pimpl_->sendMsgCb_(from, std::move(invite));
     }
@@ -996,8 +1163,7 @@ ConversationModule::startConversation(ConversationMode mode, const std::string&
     std::shared_ptr<Conversation> conversation;
     try {
         conversation = std::make_shared<Conversation>(pimpl_->account_, mode, otherMember);
-        conversation->onLastDisplayedUpdated(std::move(
-            [&](auto convId, auto lastId) { pimpl_->onLastDisplayedUpdated(convId, lastId); }));
+        pimpl_->initCallbacks(*conversation);
     } catch (const std::exception& e) {
         JAMI_ERR("[Account %s] Error while generating a conversation %s",
                  pimpl_->accountId_.c_str(),
@@ -1008,6 +1174,7 @@ ConversationModule::startConversation(ConversationMode mode, const std::string&
     {
         std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
         pimpl_->conversations_[convId] = std::move(conversation);
+        pimpl_->publishConversations();
     }
 
     // Update convInfo
@@ -1017,6 +1184,8 @@ ConversationModule::startConversation(ConversationMode mode, const std::string&
     info.members.emplace_back(pimpl_->username_);
     if (!otherMember.empty())
         info.members.emplace_back(otherMember);
+    if (auto conversation = pimpl_->getConversation(convId))
+        info.summary = pimpl_->computeSummary(*conversation, "");
     addConvInfo(info);
 
     pimpl_->needsSyncingCb_();
@@ -1118,11 +1287,8 @@ ConversationModule::onMessageDisplayed(const std::string& peer,
                                        const std::string& conversationId,
                                        const std::string& interactionId)
 {
-    std::unique_lock<std::mutex> lk(pimpl_->conversationsMtx_);
-    auto conversation = pimpl_->conversations_.find(conversationId);
-    if (conversation != pimpl_->conversations_.end() && conversation->second) {
-        conversation->second->setMessageDisplayed(peer, interactionId);
-    }
+    if (auto conversation = pimpl_->getConversation(conversationId))
+        conversation->setMessageDisplayed(peer, interactionId);
 }
 
 uint32_t
@@ -1130,12 +1296,11 @@ ConversationModule::loadConversationMessages(const std::string& conversationId,
                                              const std::string& fromMessage,
                                              size_t n)
 {
-    std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
     auto acc = pimpl_->account_.lock();
-    auto conversation = pimpl_->conversations_.find(conversationId);
-    if (acc && conversation != pimpl_->conversations_.end() && conversation->second) {
+    auto conversation = pimpl_->getConversation(conversationId);
+    if (acc && conversation) {
         const uint32_t id = std::uniform_int_distribution<uint32_t> {}(acc->rand);
-        conversation->second->loadMessages(
+        conversation->loadMessages(
             [accountId = pimpl_->accountId_, conversationId, id](auto&& messages) {
                 emitSignal<DRing::ConversationSignal::ConversationLoaded>(id,
                                                                           accountId,
@@ -1149,13 +1314,71 @@ ConversationModule::loadConversationMessages(const std::string& conversationId,
     return 0;
 }
 
+uint32_t
+ConversationModule::loadConversationMessagesPaged(const std::string& conversationId,
+                                                  const std::string& fromMessage,
+                                                  size_t pageSize)
+{
+    auto acc = pimpl_->account_.lock();
+    auto conversation = pimpl_->getConversation(conversationId);
+    if (!acc || pageSize == 0 || !conversation)
+        return 0;
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lkLoads(pimpl_->pagedLoadsMtx_);
+        do {
+            id = std::uniform_int_distribution<uint32_t> {1}(acc->rand);
+        } while (!pimpl_->pagedLoads_.emplace(id).second);
+    }
+    // The id is released when the callback is destroyed, so on every path (last page,
+    // cancellation, conversation removed before the walk...)
+    std::shared_ptr<void> release(nullptr, [w = pimpl_->weak(), id](void*) {
+        if (auto sthis = w.lock()) {
+            std::lock_guard<std::mutex> lk(sthis->pagedLoadsMtx_);
+            sthis->pagedLoads_.erase(id);
+        }
+    });
+    conversation->loadMessagesPaged(
+        [w = pimpl_->weak(),
+         accountId = pimpl_->accountId_,
+         conversationId,
+         id,
+         release = std::move(release)](auto&& messages, const auto& next) {
+            auto sthis = w.lock();
+            if (!sthis)
+                return false;
+            {
+                std::lock_guard<std::mutex> lk(sthis->pagedLoadsMtx_);
+                auto it = sthis->pagedLoads_.find(id);
+                if (it == sthis->pagedLoads_.end())
+                    return false; // Cancelled
+                if (next.empty())
+                    sthis->pagedLoads_.erase(it);
+            }
+            emitSignal<DRing::ConversationSignal::ConversationMessagesPage>(id,
+                                                                          accountId,
+                                                                          conversationId,
+                                                                          messages,
+                                                                          next);
+            return true;
+        },
+        fromMessage,
+        pageSize);
+    return id;
+}
+
+bool
+ConversationModule::cancelLoadConversationMessages(uint32_t id)
+{
+    std::lock_guard<std::mutex> lk(pimpl_->pagedLoadsMtx_);
+    return pimpl_->pagedLoads_.erase(id) != 0;
+}
+
 std::shared_ptr<TransferManager>
 ConversationModule::dataTransfer(const std::string& id) const
 {
-    std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
-    auto conversation = pimpl_->conversations_.find(id);
-    if (conversation != pimpl_->conversations_.end() && conversation->second)
-        return conversation->second->dataTransfer();
+    if (auto conversation = pimpl_->getConversation(id))
+        return conversation->dataTransfer();
     return {};
 }
 
@@ -1165,10 +1388,8 @@ ConversationModule::onFileChannelRequest(const std::string& conversationId,
                                          const std::string& fileId,
                                          bool verifyShaSum) const
 {
-    std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
-    auto conversation = pimpl_->conversations_.find(conversationId);
-    if (conversation != pimpl_->conversations_.end() && conversation->second)
-        return conversation->second->onFileChannelRequest(member, fileId, verifyShaSum);
+    if (auto conversation = pimpl_->getConversation(conversationId))
+        return conversation->onFileChannelRequest(member, fileId, verifyShaSum);
     return false;
 }
 
@@ -1180,12 +1401,11 @@ ConversationModule::downloadFile(const std::string& conversationId,
                                  size_t start,
                                  size_t end)
 {
-    std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
-    auto conversation = pimpl_->conversations_.find(conversationId);
-    if (conversation == pimpl_->conversations_.end() || !conversation->second)
+    auto conversation = pimpl_->getConversation(conversationId);
+    if (!conversation)
         return false;
 
-    return conversation->second->downloadFile(interactionId, fileId, path, "", "", start, end);
+    return conversation->downloadFile(interactionId, fileId, path, "", "", start, end);
 }
 
 void
@@ -1195,11 +1415,11 @@ ConversationModule::syncConversations(const std::string& peer, const std::string
     std::set<std::string> toFetch;
     std::set<std::string> toClone;
     {
-        std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
-        std::lock_guard<std::mutex> lkCI(pimpl_->convInfosMtx_);
-        for (const auto& [key, ci] : pimpl_->convInfos_) {
-            auto it = pimpl_->conversations_.find(key);
-            if (it != pimpl_->conversations_.end() && it->second) {
+        auto conversations = pimpl_->snapshotConversations();
+        auto infos = pimpl_->snapshotConvInfos();
+        for (const auto& [key, ci] : *infos) {
+            auto it = conversations->find(key);
+            if (it != conversations->end() && it->second) {
                 if (!it->second->isRemoving() && it->second->isMember(peer, false))
                     toFetch.emplace(key);
             } else if (!ci.removed
@@ -1228,25 +1448,24 @@ ConversationModule::onSyncData(const SyncMsg& msg,
         if (not removed) {
             // If multi devices, it can detect a conversation that was already
             // removed, so just check if the convinfo contains a removed conv
-            auto itConv = pimpl_->convInfos_.find(convId);
-            if (itConv != pimpl_->convInfos_.end() && itConv->second.removed)
+            auto infos = pimpl_->snapshotConvInfos();
+            auto itConv = infos->find(convId);
+            if (itConv != infos->end() && itConv->second.removed)
                 continue;
             pimpl_->cloneConversation(deviceId, peerId, convId, convInfo.lastDisplayed);
         } else {
-            {
-                std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
-                auto itConv = pimpl_->conversations_.find(convId);
-                if (itConv != pimpl_->conversations_.end() && !itConv->second->isRemoving()) {
-                    emitSignal<DRing::ConversationSignal::ConversationRemoved>(pimpl_->accountId_,
-                                                                               convId);
-                    itConv->second->setRemovingFlag();
-                }
+            auto conversation = pimpl_->getConversation(convId);
+            if (conversation && !conversation->isRemoving()) {
+                emitSignal<DRing::ConversationSignal::ConversationRemoved>(pimpl_->accountId_,
+                                                                           convId);
+                conversation->setRemovingFlag();
             }
             std::unique_lock<std::mutex> lk(pimpl_->convInfosMtx_);
             auto& ci = pimpl_->convInfos_;
             auto itConv = ci.find(convId);
             if (itConv != ci.end()) {
                 itConv->second.removed = std::time(nullptr);
+                pimpl_->publishConvInfos();
                 if (convInfo.erased) {
                     itConv->second.erased = std::time(nullptr);
                     pimpl_->saveConvInfos();
@@ -1294,11 +1513,11 @@ bool
 ConversationModule::needsSyncingWith(const std::string& memberUri, const std::string& deviceId) const
 {
     // Check if a conversation needs to fetch remote or to be cloned
-    std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
-    std::lock_guard<std::mutex> lkCI(pimpl_->convInfosMtx_);
-    for (const auto& [key, ci] : pimpl_->convInfos_) {
-        auto it = pimpl_->conversations_.find(key);
-        if (it != pimpl_->conversations_.end() && it->second) {
+    auto conversations = pimpl_->snapshotConversations();
+    auto infos = pimpl_->snapshotConvInfos();
+    for (const auto& [key, ci] : *infos) {
+        auto it = conversations->find(key);
+        if (it != conversations->end() && it->second) {
             if (!it->second->isRemoving() && it->second->isMember(memberUri, false)
                 && it->second->needsFetch(deviceId))
                 return true;
@@ -1316,13 +1535,9 @@ void
 ConversationModule::setFetched(const std::string& conversationId, const std::string& deviceId)
 {
     auto remove = false;
-    {
-        std::unique_lock<std::mutex> lk(pimpl_->conversationsMtx_);
-        auto it = pimpl_->conversations_.find(conversationId);
-        if (it != pimpl_->conversations_.end() && it->second) {
-            remove = it->second->isRemoving();
-            it->second->hasFetched(deviceId);
-        }
+    if (auto conversation = pimpl_->getConversation(conversationId)) {
+        remove = conversation->isRemoving();
+        conversation->hasFetched(deviceId);
     }
     if (remove)
         pimpl_->removeRepository(conversationId, true);
@@ -1334,9 +1549,9 @@ ConversationModule::onNewCommit(const std::string& peer,
                                 const std::string& conversationId,
                                 const std::string& commitId)
 {
-    std::unique_lock<std::mutex> lk(pimpl_->conversationsMtx_);
-    auto itConv = pimpl_->convInfos_.find(conversationId);
-    if (itConv != pimpl_->convInfos_.end() && itConv->second.removed) {
+    auto infos = pimpl_->snapshotConvInfos();
+    auto itConv = infos->find(conversationId);
+    if (itConv != infos->end() && itConv->second.removed) {
         // If the conversation is removed and we receives a new commit,
         // it means that the contact was removed but not banned. So we can generate
         // a new trust request
@@ -1353,7 +1568,6 @@ ConversationModule::onNewCommit(const std::string& peer,
              peer.c_str(),
              conversationId.c_str(),
              commitId.c_str());
-    lk.unlock();
     pimpl_->fetchNewCommits(peer, deviceId, conversationId, commitId);
 }
 
@@ -1362,40 +1576,35 @@ ConversationModule::addConversationMember(const std::string& conversationId,
                                           const std::string& contactUri,
                                           bool sendRequest)
 {
-    std::unique_lock<std::mutex> lk(pimpl_->conversationsMtx_);
     // Add a new member in the conversation
-    auto it = pimpl_->conversations_.find(conversationId);
-    if (it == pimpl_->conversations_.end()) {
+    auto conversation = pimpl_->getConversation(conversationId);
+    if (!conversation) {
         JAMI_ERR("Conversation %s doesn't exist", conversationId.c_str());
         return;
     }
 
-    if (it->second->isMember(contactUri, true)) {
+    if (conversation->isMember(contactUri, true)) {
         JAMI_DBG("%s is already a member of %s, resend invite",
                  contactUri.c_str(),
                  conversationId.c_str());
         // Note: This should not be necessary, but if for whatever reason the other side didn't join
         // we should not forbid new invites
-        auto invite = it->second->generateInvitation();
-        lk.unlock();
+        auto invite = conversation->generateInvitation();
         pimpl_->sendMsgCb_(contactUri, std::move(invite));
         return;
     }
 
-    it->second
+    conversation
         ->addMember(contactUri,
                     [this, conversationId, sendRequest, contactUri](bool ok,
                                                                     const std::string& commitId) {
                         if (ok) {
-                            std::unique_lock<std::mutex> lk(pimpl_->conversationsMtx_);
-                            auto it = pimpl_->conversations_.find(conversationId);
-                            if (it != pimpl_->conversations_.end() && it->second) {
-                                pimpl_->sendMessageNotification(*it->second,
+                            if (auto conversation = pimpl_->getConversation(conversationId)) {
+                                pimpl_->sendMessageNotification(*conversation,
                                                                 commitId,
                                                                 true); // For the other members
                                 if (sendRequest) {
-                                    auto invite = it->second->generateInvitation();
-                                    lk.unlock();
+                                    auto invite = conversation->generateInvitation();
                                     pimpl_->sendMsgCb_(contactUri, std::move(invite));
                                 }
                             }
@@ -1408,33 +1617,28 @@ ConversationModule::removeConversationMember(const std::string& conversationId,
                                              const std::string& contactUri,
                                              bool isDevice)
 {
-    std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
-    auto it = pimpl_->conversations_.find(conversationId);
-    if (it != pimpl_->conversations_.end() && it->second) {
-        it->second->removeMember(contactUri,
-                                 isDevice,
-                                 [this, conversationId](bool ok, const std::string& commitId) {
-                                     if (ok) {
-                                         pimpl_->sendMessageNotification(conversationId,
-                                                                         commitId,
-                                                                         true);
-                                     }
-                                 });
+    if (auto conversation = pimpl_->getConversation(conversationId)) {
+        conversation->removeMember(contactUri,
+                                   isDevice,
+                                   [this, conversationId](bool ok, const std::string& commitId) {
+                                       if (ok) {
+                                           pimpl_->sendMessageNotification(conversationId,
+                                                                           commitId,
+                                                                           true);
+                                       }
+                                   });
     }
 }
 
 std::vector<std::map<std::string, std::string>>
 ConversationModule::getConversationMembers(const std::string& conversationId) const
 {
-    std::unique_lock<std::mutex> lk(pimpl_->conversationsMtx_);
-    auto conversation = pimpl_->conversations_.find(conversationId);
-    if (conversation != pimpl_->conversations_.end() && conversation->second)
-        return conversation->second->getMembers(true, true);
+    if (auto conversation = pimpl_->getConversation(conversationId))
+        return conversation->getMembers(true, true);
 
-    lk.unlock();
-    std::lock_guard<std::mutex> lkCI(pimpl_->convInfosMtx_);
-    auto convIt = pimpl_->convInfos_.find(conversationId);
-    if (convIt != pimpl_->convInfos_.end()) {
+    auto infos = pimpl_->snapshotConvInfos();
+    auto convIt = infos->find(conversationId);
+    if (convIt != infos->end()) {
         std::vector<std::map<std::string, std::string>> result;
         result.reserve(convIt->second.members.size());
         for (const auto& uri : convIt->second.members) {
@@ -1445,17 +1649,27 @@ ConversationModule::getConversationMembers(const std::string& conversationId) co
     return {};
 }
 
+std::vector<std::map<std::string, std::string>>
+ConversationModule::getConversationsMembers(const std::vector<std::string>& conversationIds) const
+{
+    std::vector<std::map<std::string, std::string>> result;
+    for (const auto& conversationId : conversationIds) {
+        for (auto& member : getConversationMembers(conversationId)) {
+            member[ConversationMapKeys::CONVERSATIONID] = conversationId;
+            result.emplace_back(std::move(member));
+        }
+    }
+    return result;
+}
+
 uint32_t
 ConversationModule::countInteractions(const std::string& convId,
                                       const std::string& toId,
                                       const std::string& fromId,
                                       const std::string& authorUri) const
 {
-    std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
-    auto conversation = pimpl_->conversations_.find(convId);
-    if (conversation != pimpl_->conversations_.end() && conversation->second) {
-        return conversation->second->countInteractions(toId, fromId, authorUri);
-    }
+    if (auto conversation = pimpl_->getConversation(convId))
+        return conversation->countInteractions(toId, fromId, authorUri);
     return 0;
 }
 
@@ -1464,69 +1678,78 @@ ConversationModule::updateConversationInfos(const std::string& conversationId,
                                             const std::map<std::string, std::string>& infos,
                                             bool sync)
 {
-    std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
-    // Add a new member in the conversation
-    auto it = pimpl_->conversations_.find(conversationId);
-    if (it == pimpl_->conversations_.end()) {
+    auto conversation = pimpl_->getConversation(conversationId);
+    if (!conversation) {
         JAMI_ERR("Conversation %s doesn't exist", conversationId.c_str());
         return;
     }
 
-    it->second->updateInfos(infos,
-                            [this, conversationId, sync](bool ok, const std::string& commitId) {
-                                if (ok && sync) {
-                                    pimpl_->sendMessageNotification(conversationId, commitId, true);
-                                } else if (sync)
-                                    JAMI_WARN("Couldn't update infos on %s", conversationId.c_str());
-                            });
+    conversation->updateInfos(infos,
+                              [this, conversationId, sync](bool ok, const std::string& commitId) {
+                                  if (ok && sync) {
+                                      pimpl_->sendMessageNotification(conversationId,
+                                                                      commitId,
+                                                                      true);
+                                  } else if (sync)
+                                      JAMI_WARN("Couldn't update infos on %s",
+                                                conversationId.c_str());
+                              });
 }
 
 std::map<std::string, std::string>
-ConversationModule::conversationInfos(const std::string& conversationId) const
+ConversationModule::conversationInfos(const std::string& conversationId,
+                                      const std::vector<std::string>& fields) const
 {
     {
         std::lock_guard<std::mutex> lk(pimpl_->conversationsRequestsMtx_);
         auto itReq = pimpl_->conversationsRequests_.find(conversationId);
-        if (itReq != pimpl_->conversationsRequests_.end())
-            return itReq->second.metadatas;
+        if (itReq != pimpl_->conversationsRequests_.end()) {
+            auto metadatas = itReq->second.metadatas;
+            map_utils::filterKeys(metadatas, fields);
+            return metadatas;
+        }
     }
-    std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
-    // Add a new member in the conversation
-    auto it = pimpl_->conversations_.find(conversationId);
-    if (it == pimpl_->conversations_.end() or not it->second) {
-        std::lock_guard<std::mutex> lkCi(pimpl_->convInfosMtx_);
-        auto itConv = pimpl_->convInfos_.find(conversationId);
-        if (itConv == pimpl_->convInfos_.end()) {
+    auto conversation = pimpl_->getConversation(conversationId);
+    if (not conversation) {
+        auto infos = pimpl_->snapshotConvInfos();
+        if (infos->find(conversationId) == infos->end()) {
             JAMI_ERR("Conversation %s doesn't exist", conversationId.c_str());
             return {};
         }
         return {{"syncing", "true"}};
     }
 
-    return it->second->infos();
+    return conversation->infos(fields);
+}
+
+std::vector<std::map<std::string, std::string>>
+ConversationModule::conversationsInfos(const std::vector<std::string>& conversationIds,
+                                       const std::vector<std::string>& fields) const
+{
+    std::vector<std::map<std::string, std::string>> result;
+    result.reserve(conversationIds.size());
+    for (const auto& conversationId : conversationIds)
+        result.emplace_back(conversationInfos(conversationId, fields));
+    return result;
 }
 
 std::vector<uint8_t>
 ConversationModule::conversationVCard(const std::string& conversationId) const
 {
-    std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
-    // Add a new member in the conversation
-    auto it = pimpl_->conversations_.find(conversationId);
-    if (it == pimpl_->conversations_.end() || !it->second) {
+    auto conversation = pimpl_->getConversation(conversationId);
+    if (!conversation) {
         JAMI_ERR("Conversation %s doesn't exist", conversationId.c_str());
         return {};
     }
 
-    return it->second->vCard();
+    return conversation->vCard();
 }
 
 bool
 ConversationModule::isBannedDevice(const std::string& convId, const std::string& deviceId) const
 {
-    std::unique_lock<std::mutex> lk(pimpl_->conversationsMtx_);
-    auto conversation = pimpl_->conversations_.find(convId);
-    return conversation == pimpl_->conversations_.end() || !conversation->second
-           || conversation->second->isBanned(deviceId);
+    auto conversation = pimpl_->getConversation(convId);
+    return !conversation || conversation->isBanned(deviceId);
 }
 
 void
@@ -1604,40 +1827,42 @@ bool
 ConversationModule::removeConversation(const std::string& conversationId)
 {
     auto members = getConversationMembers(conversationId);
-    std::unique_lock<std::mutex> lk(pimpl_->conversationsMtx_);
-    // Update convInfos
-    std::unique_lock<std::mutex> lockCi(pimpl_->convInfosMtx_);
-    auto itConv = pimpl_->convInfos_.find(conversationId);
-    if (itConv == pimpl_->convInfos_.end()) {
-        JAMI_ERR("Conversation %s doesn't exist", conversationId.c_str());
-        return false;
-    }
-    auto it = pimpl_->conversations_.find(conversationId);
-    auto isSyncing = it == pimpl_->conversations_.end();
+    // Only this conversation is locked during the leave commit
+    std::lock_guard<std::recursive_mutex> lkConv(pimpl_->convLock(conversationId));
+    auto conversation = pimpl_->getConversation(conversationId);
+    auto isSyncing = !conversation;
     auto hasMembers = !isSyncing
                       && !(members.size() == 1 && pimpl_->username_ == members[0]["uri"]);
-    itConv->second.removed = std::time(nullptr);
-    if (isSyncing)
-        itConv->second.erased = std::time(nullptr);
-    // Sync now, because it can take some time to really removes the datas
-    if (hasMembers)
-        pimpl_->needsSyncingCb_();
-    pimpl_->saveConvInfos();
-    lockCi.unlock();
+    {
+        // Update convInfos
+        std::lock_guard<std::mutex> lockCi(pimpl_->convInfosMtx_);
+        auto itConv = pimpl_->convInfos_.find(conversationId);
+        if (itConv == pimpl_->convInfos_.end()) {
+            JAMI_ERR("Conversation %s doesn't exist", conversationId.c_str());
+            return false;
+        }
+        itConv->second.removed = std::time(nullptr);
+        if (isSyncing)
+            itConv->second.erased = std::time(nullptr);
+        // Sync now, because it can take some time to really removes the datas
+        if (hasMembers)
+            pimpl_->needsSyncingCb_();
+        pimpl_->saveConvInfos();
+    }
     emitSignal<DRing::ConversationSignal::ConversationRemoved>(pimpl_->accountId_, conversationId);
     if (isSyncing)
         return true;
-    if (it->second->mode() != ConversationMode::ONE_TO_ONE) {
+    if (conversation->mode() != ConversationMode::ONE_TO_ONE) {
         // For one to one, we do not notify the leave. The other can still generate request
         // and this is managed by the banned part. If we re-accept, the old conversation will be
         // retrieven
-        auto commitId = it->second->leave();
+        auto commitId = conversation->leave();
         if (hasMembers) {
             JAMI_DBG() << "Wait that someone sync that user left conversation " << conversationId;
             // Commit that we left
             if (!commitId.empty()) {
                 // Do not sync as it's synched by convInfos
-                pimpl_->sendMessageNotification(*it->second, commitId, false);
+                pimpl_->sendMessageNotification(*conversation, commitId, false);
             } else {
                 JAMI_ERR("Failed to send message to conversation %s", conversationId.c_str());
             }
@@ -1652,7 +1877,6 @@ ConversationModule::removeConversation(const std::string& conversationId)
             if (pimpl_->username_ != m.at("uri") && pimpl_->updateConvReqCb_)
                 pimpl_->updateConvReqCb_(conversationId, m.at("uri"), false);
     }
-    lk.unlock();
     // Else we are the last member, so we can remove
     pimpl_->removeRepository(conversationId, true);
     return true;
@@ -1664,32 +1888,29 @@ ConversationModule::checkIfRemoveForCompat(const std::string& peerUri)
     auto convId = getOneToOneConversation(peerUri);
     if (convId.empty())
         return;
-    std::unique_lock<std::mutex> lk(pimpl_->conversationsMtx_);
-    auto it = pimpl_->conversations_.find(convId);
-    if (it == pimpl_->conversations_.end()) {
+    auto conversation = pimpl_->getConversation(convId);
+    if (!conversation) {
         JAMI_ERR("Conversation %s doesn't exist", convId.c_str());
         return;
     }
     // We will only removes the conversation if the member is invited
     // the contact can have mutiple devices with only some with swarm
     // support, in this case, just go with recent versions.
-    if (it->second->isMember(peerUri))
+    if (conversation->isMember(peerUri))
         return;
-    lk.unlock();
     removeConversation(convId);
 }
 
 void
 ConversationModule::initReplay(const std::string& oldConvId, const std::string& newConvId)
 {
-    std::lock_guard<std::mutex> lk(pimpl_->conversationsMtx_);
     auto acc = pimpl_->account_.lock();
-    auto conversation = pimpl_->conversations_.find(oldConvId);
-    if (acc && conversation != pimpl_->conversations_.end() && conversation->second) {
+    auto conversation = pimpl_->getConversation(oldConvId);
+    if (acc && conversation) {
         std::promise<bool> waitLoad;
         std::future<bool> fut = waitLoad.get_future();
         // we should wait for loadMessage, because it will be deleted after this.
-        conversation->second->loadMessages(
+        conversation->loadMessages(
             [&](auto&& messages) {
                 std::reverse(messages.begin(),
                              messages.end()); // Log is inverted as we want to replay
@@ -63,6 +63,12 @@ public:
      * Return all conversation's id (including syncing ones)
      */
     std::vector<std::string> getConversations() const;
+    /**
+     * Return the cached summary of all conversations (last message, unread
+     * interactions and last activity), without reading the repositories
+     * @return a vector of summaries (one map per conversation, with "id")
+     */
+    std::vector<std::map<std::string, std::string>> getConversationSummaries() const;
 
     /**
      * Get related conversation with member
@@ -168,6 +174,23 @@ public:
     uint32_t loadConversationMessages(const std::string& conversationId,
                                       const std::string& fromMessage = "",
                                       size_t n = 0);
+    /**
+     * Load conversation's messages by pages. A ConversationMessagesPage signal is
+     * emitted for each page with the id of the next message to load (empty at the end).
+     * @param conversationId    Conversation to load
+     * @param fromMessage       Most recent message ("" = last), or a continuation id
+     * @param pageSize          Messages per page
+     * @return id of the operation
+     */
+    uint32_t loadConversationMessagesPaged(const std::string& conversationId,
+                                           const std::string& fromMessage,
+                                           size_t pageSize);
+    /**
+     * Stop a loading started with loadConversationMessagesPaged
+     * @param id        Id of the operation
+     * @return if the operation was still running
+     */
+    bool cancelLoadConversationMessages(uint32_t id);
 
     // File transfer
     /**
@@ -271,6 +294,13 @@ public:
      */
     std::vector<std::map<std::string, std::string>> getConversationMembers(
         const std::string& conversationId) const;
+    /**
+     * Get members of several conversations
+     * @param conversationIds
+     * @return the members of each conversation, with the conversationId key
+     */
+    std::vector<std::map<std::string, std::string>> getConversationsMembers(
+        const std::vector<std::string>& conversationIds) const;
     /**
      * Retrieve the number of interactions from interactionId to HEAD
      * @param convId
@@ -293,7 +323,18 @@ public:
     void updateConversationInfos(const std::string& conversationId,
                                  const std::map<std::string, std::string>& infos,
                                  bool sync = true);
-    std::map<std::string, std::string> conversationInfos(const std::string& conversationId) const;
+    /**
+     * @param conversationId
+     * @param fields        Infos to return, all of them if empty
+     */
+    std::map<std::string, std::string> conversationInfos(
+        const std::string& conversationId, const std::vector<std::string>& fields = {}) const;
+    /**
+     * Infos of several conversations, in the order of conversationIds (empty for unknown ones)
+     */
+    std::vector<std::map<std::string, std::string>> conversationsInfos(
+        const std::vector<std::string>& conversationIds,
+        const std::vector<std::string>& fields = {}) const;
     // Get the map into a VCard format for storing
     std::vector<uint8_t> conversationVCard(const std::string& conversationId) const;
 
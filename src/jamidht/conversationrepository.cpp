@@ -19,9 +19,11 @@
 
 #include "account_const.h"
 #include "base64.h"
+#include "cpu_accounting.h"
 #include "jamiaccount.h"
 #include "fileutils.h"
 #include "gittransport.h"
+#include "map_utils.h"
 #include "string_utils.h"
 #include "client/ring_signal.h"
 #include "vcard.h"
@@ -42,6 +44,160 @@ constexpr size_t MAX_FETCH_SIZE {256 * 1024 * 1024}; // 256Mb
 
 namespace jami {
 
+void
+ConversationMemberIndex::reset(std::vector<ConversationMember>&& members,
+                               std::map<std::string, bool>&& devices)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    members_ = std::move(members);
+    positions_.clear();
+    for (std::size_t i = 0; i < members_.size(); ++i)
+        positions_.emplace(members_[i].uri, i);
+    devices_.clear();
+    for (auto& [device, banned] : devices)
+        devices_.emplace(device, banned);
+    ++generation_;
+}
+
+void
+ConversationMemberIndex::setRole(const std::string& uri, MemberRole role)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto it = positions_.find(uri);
+    if (it != positions_.end()) {
+        auto& member = members_[it->second];
+        if (member.role == role)
+            return;
+        member.role = role;
+    } else {
+        positions_.emplace(uri, members_.size());
+        members_.emplace_back(ConversationMember {uri, role});
+    }
+    ++generation_;
+}
+
+void
+ConversationMemberIndex::remove(std::string_view uri)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto it = positions_.find(uri);
+    if (it == positions_.end())
+        return;
+    auto pos = it->second;
+    members_.erase(members_.begin() + pos);
+    positions_.erase(it);
+    for (auto& [_, p] : positions_)
+        if (p > pos)
+            --p;
+    ++generation_;
+}
+
+void
+ConversationMemberIndex::setDevice(const std::string& deviceId, bool banned)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto [it, inserted] = devices_.emplace(deviceId, banned);
+    if (!inserted) {
+        if (it->second == banned)
+            return;
+        it->second = banned;
+    }
+    ++generation_;
+}
+
+void
+ConversationMemberIndex::removeDevice(std::string_view deviceId)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto it = devices_.find(deviceId);
+    if (it == devices_.end())
+        return;
+    devices_.erase(it);
+    ++generation_;
+}
+
+std::optional<MemberRole>
+ConversationMemberIndex::role(std::string_view uri) const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto it = positions_.find(uri);
+    if (it == positions_.end())
+        return std::nullopt;
+    return members_[it->second].role;
+}
+
+bool
+ConversationMemberIndex::isMember(std::string_view uri, bool includeInvited) const
+{
+    auto r = role(uri);
+    if (!r)
+        return false;
+    switch (*r) {
+    case MemberRole::ADMIN:
+    case MemberRole::MEMBER:
+        return true;
+    case MemberRole::INVITED:
+    case MemberRole::LEFT:
+        return includeInvited;
+    default:
+        return false;
+    }
+}
+
+bool
+ConversationMemberIndex::isBanned(std::string_view uri) const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto it = positions_.find(uri);
+    if (it != positions_.end())
+        return members_[it->second].role == MemberRole::BANNED;
+    auto itDevice = devices_.find(uri);
+    return itDevice != devices_.end() && itDevice->second;
+}
+
+bool
+ConversationMemberIndex::hasDevice(std::string_view deviceId) const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto it = devices_.find(deviceId);
+    return it != devices_.end() && !it->second;
+}
+
+std::vector<ConversationMember>
+ConversationMemberIndex::members() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    return members_;
+}
+
+std::vector<std::string>
+ConversationMemberIndex::memberUris(std::string_view filter,
+                                    const std::set<MemberRole>& filteredRoles) const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    std::vector<std::string> ret;
+    ret.reserve(members_.size());
+    for (const auto& member : members_) {
+        if ((filteredRoles.find(member.role) != filteredRoles.end())
+            or (not filter.empty() and filter == member.uri))
+            continue;
+        ret.emplace_back(member.uri);
+    }
+    return ret;
+}
+
+std::size_t
+ConversationMemberIndex::size() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    return members_.size();
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+
+// Files to commit, relative to the working directory (true if removed)
+using StagedFiles = std::map<std::string, bool>;
+
 class ConversationRepository::Impl
 {
 public:
@@ -108,11 +264,39 @@ public:
                                  const std::string& commitid,
                                  const std::string& parentId) const;
 
+    /**
+     * Stage a file of the working directory for the next commit
+     * @note the tree of the commit is built in memory from HEAD and the staged files,
+     * the index is not used (see syncIndex)
+     */
     bool add(const std::string& path);
+    /**
+     * Stage the removal of a file or a directory for the next commit
+     */
+    void remove(const std::string& path);
     void addUserDevice();
     // Verify that the device in the repository is still valid
     bool validateDevice();
+    /**
+     * Commit the staged files. Staged files are dropped, even on failure
+     * @return the commit id or empty on failure
+     */
     std::string commit(const std::string& msg);
+    /**
+     * Write a chain of commits on top of HEAD, each one with its own files and message,
+     * then move main once to the last one.
+     * @return the ids of the commits, empty on failure (main is not moved)
+     */
+    std::vector<std::string> commitChain(
+        std::vector<std::pair<StagedFiles, std::string>>&& changes);
+    GitTree stagedTree(git_repository* repo,
+                       const git_tree* base,
+                       const StagedFiles& staged) const;
+    /**
+     * Commits do not update the index, so reset it to HEAD before an operation
+     * using it (merge, checkout)
+     */
+    void syncIndex(git_repository* repo);
     ConversationMode mode() const;
 
     // NOTE! GitDiff needs to be deteleted before repo
@@ -128,6 +312,9 @@ public:
                                         bool fastLog = false,
                                         const std::string& authorUri = "") const;
 
+    void forEachCommit(const std::string& from,
+                       const std::function<bool(ConversationCommit&&)>& cb) const;
+
     GitObject fileAtTree(const std::string& path, const GitTree& tree) const;
     GitObject memberCertificate(const std::string& memberUri, const GitTree& tree) const;
     // NOTE! GitDiff needs to be deteleted before repo
@@ -144,32 +331,52 @@ public:
     mutable std::optional<ConversationMode> mode_ {};
 
     // Members utils
-    mutable std::mutex membersMtx_ {};
-    std::vector<ConversationMember> members_ {};
-
-    std::vector<ConversationMember> members() const
+    ConversationMemberIndex members_ {};
+    StagedFiles staged_ {};
+    /**
+     * Drop the files staged by an operation when it ends, so an operation aborted
+     * before its commit does not leak files into the next commit
+     */
+    class StagingScope
     {
-        std::lock_guard<std::mutex> lk(membersMtx_);
-        return members_;
-    }
+    public:
+        StagingScope(Impl& impl)
+            : impl_(impl)
+        {}
+        ~StagingScope() { impl_.staged_.clear(); }
+
+    private:
+        Impl& impl_;
+    };
+    // If commits were done since the index was last written. Unknown on opening, as the
+    // commits of a previous session did not write it either
+    bool indexOutdated_ {true};
+
+    std::vector<ConversationMember> members() const { return members_.members(); }
 
     bool resolveConflicts(git_index* index, const std::string& other_id);
 
     std::vector<std::string> memberUris(std::string_view filter,
                                         const std::set<MemberRole>& filteredRoles) const
     {
-        std::lock_guard<std::mutex> lk(membersMtx_);
-        std::vector<std::string> ret;
-        for (const auto& member : members_) {
-            if ((filteredRoles.find(member.role) != filteredRoles.end())
-                or (not filter.empty() and filter == member.uri))
-                continue;
-            ret.emplace_back(member.uri);
-        }
-        return ret;
+        return members_.memberUris(filter, filteredRoles);
     }
 
+    /**
+     * Rebuild the members' index from the working tree
+     * @note banned/admins and banned/invited are read too, so a banned admin or a
+     * banned invite is reported with the BANNED role (previously only banned/members was)
+     */
     void initMembers();
+    void updateMembers(const std::string& oldCommit);
+    /**
+     * Compute the role of one member from the working tree
+     * @param repoPath      Working directory (with a trailing separator)
+     * @param uri           Member to check
+     * @return the role or nullopt if the member is unknown
+     */
+    std::optional<MemberRole> memberRoleFromFiles(const std::string& repoPath,
+                                                  const std::string& uri) const;
 
     // Permissions
     MemberRole updateProfilePermLvl_ {MemberRole::ADMIN};
@@ -745,19 +952,95 @@ ConversationRepository::Impl::add(const std::string& path)
     auto repo = repository();
     if (!repo)
         return false;
-    git_index* index_ptr = nullptr;
-    if (git_repository_index(&index_ptr, repo.get()) < 0) {
-        JAMI_ERR("Could not open repository index");
+    if (!fileutils::isFile(git_repository_workdir(repo.get()) + path)) {
+        JAMI_ERR("Error when adding file: %s not found", path.c_str());
         return false;
     }
-    GitIndex index {index_ptr, git_index_free};
-    if (git_index_add_bypath(index.get(), path.c_str()) != 0) {
+    staged_[path] = false;
+    return true;
+}
+
+void
+ConversationRepository::Impl::remove(const std::string& path)
+{
+    staged_[path] = true;
+}
+
+GitTree
+ConversationRepository::Impl::stagedTree(git_repository* repo,
+                                         const git_tree* base,
+                                         const StagedFiles& staged) const
+{
+    GitTree tree {nullptr, git_tree_free};
+    std::vector<git_tree_update> updates;
+    updates.reserve(staged.size());
+    for (const auto& [path, removed] : staged) {
+        git_tree_update update {};
+        update.path = path.c_str();
+        if (removed) {
+            // Ignore files that were never committed
+            git_tree_entry* entry_ptr = nullptr;
+            if (git_tree_entry_bypath(&entry_ptr, base, path.c_str()) < 0)
+                continue;
+            GitTreeEntry entry {entry_ptr, git_tree_entry_free};
+            update.action = GIT_TREE_UPDATE_REMOVE;
+        } else {
+            if (git_blob_create_from_workdir(&update.id, repo, path.c_str()) < 0) {
+                JAMI_ERR("Could not create blob for %s", path.c_str());
+                return tree;
+            }
+            update.action = GIT_TREE_UPDATE_UPSERT;
+            update.filemode = GIT_FILEMODE_BLOB;
+        }
+        updates.emplace_back(update);
+    }
+
+    git_oid tree_id;
+    if (git_tree_create_updated(&tree_id, repo, base, updates.size(), updates.data()) < 0) {
         const git_error* err = giterr_last();
         if (err)
-            JAMI_ERR("Error when adding file: %s", err->message);
-        return false;
+            JAMI_ERR("Unable to write tree: %s", err->message);
+        return tree;
+    }
+    git_tree* tree_ptr = nullptr;
+    if (git_tree_lookup(&tree_ptr, repo, &tree_id) < 0) {
+        JAMI_ERR("Could not look up tree");
+        return tree;
+    }
+    tree.reset(tree_ptr);
+    return tree;
+}
+
+void
+ConversationRepository::Impl::syncIndex(git_repository* repo)
+{
+    if (!indexOutdated_)
+        return;
+    git_oid head_id;
+    git_commit* head_ptr = nullptr;
+    if (git_reference_name_to_id(&head_id, repo, "HEAD") < 0
+        || git_commit_lookup(&head_ptr, repo, &head_id) < 0) {
+        JAMI_ERR("Could not look up HEAD commit");
+        return;
+    }
+    GitCommit head {head_ptr, git_commit_free};
+    git_tree* tree_ptr = nullptr;
+    if (git_commit_tree(&tree_ptr, head.get()) < 0) {
+        JAMI_ERR("Could not look up HEAD tree");
+        return;
+    }
+    GitTree tree {tree_ptr, git_tree_free};
+    git_index* index_ptr = nullptr;
+    if (git_repository_index(&index_ptr, repo) < 0) {
+        JAMI_ERR("Could not open repository index");
+        return;
+    }
+    GitIndex index {index_ptr, git_index_free};
+    if (git_index_read_tree(index.get(), tree.get()) < 0 || git_index_write(index.get()) < 0) {
+        JAMI_WARN("Could not update repository index");
+        return;
     }
-    return git_index_write(index.get()) == 0;
+    indexOutdated_ = false;
 }
 
 bool
@@ -1299,16 +1582,8 @@ ConversationRepository::Impl::checkValidProfileUpdate(const std::string& userDev
                                                       const std::string& parentId) const
 {
     auto userUri = uriFromDevice(userDevice);
-    auto valid = false;
-    {
-        std::lock_guard<std::mutex> lk(membersMtx_);
-        for (const auto& member : members_) {
-            if (member.uri == userUri) {
-                valid = member.role <= updateProfilePermLvl_;
-                break;
-            }
-        }
-    }
+    auto role = members_.role(userUri);
+    auto valid = role && *role <= updateProfilePermLvl_;
     if (!valid) {
         JAMI_ERR("Profile changed from unauthorized user: %s", userDevice.c_str());
         return false;
@@ -1581,7 +1856,23 @@ ConversationRepository::Impl::validateDevice()
 std::string
 ConversationRepository::Impl::commit(const std::string& msg)
 {
-    if (!validateDevice())
+    std::vector<std::pair<StagedFiles, std::string>> changes;
+    changes.emplace_back(std::move(staged_), msg);
+    staged_.clear();
+    auto ids = commitChain(std::move(changes));
+    return ids.empty() ? std::string {} : std::move(ids.front());
+}
+
+std::vector<std::string>
+ConversationRepository::Impl::commitChain(
+    std::vector<std::pair<StagedFiles, std::string>>&& changes)
+{
+    // validateDevice() can stage an updated certificate, it goes with the first commit
+    auto validDevice = validateDevice();
+    if (!changes.empty())
+        changes.front().first.merge(staged_);
+    staged_.clear();
+    if (changes.empty() || !validDevice)
         return {};
     auto account = account_.lock();
     if (!account)
@@ -1599,30 +1890,9 @@ ConversationRepository::Impl::commit(const std::string& msg)
     }
     GitSignature sig {sig_ptr, git_signature_free};
 
-    // Retrieve current index
-    git_index* index_ptr = nullptr;
     auto repo = repository();
     if (!repo)
         return {};
-    if (git_repository_index(&index_ptr, repo.get()) < 0) {
-        JAMI_ERR("Could not open repository index");
-        return {};
-    }
-    GitIndex index {index_ptr, git_index_free};
-
-    git_oid tree_id;
-    if (git_index_write_tree(&tree_id, index.get()) < 0) {
-        JAMI_ERR("Unable to write initial tree from index");
-        return {};
-    }
-
-    git_tree* tree_ptr = nullptr;
-    if (git_tree_lookup(&tree_ptr, repo.get(), &tree_id) < 0) {
-        JAMI_ERR("Could not look up initial tree");
-        return {};
-    }
-    GitTree tree = {tree_ptr, git_tree_free};
-
     git_oid commit_id;
     if (git_reference_name_to_id(&commit_id, repo.get(), "HEAD") < 0) {
         JAMI_ERR("Cannot get reference for HEAD");
@@ -1634,53 +1904,75 @@ ConversationRepository::Impl::commit(const std::string& msg)
         JAMI_ERR("Could not look up HEAD commit");
         return {};
     }
-    GitCommit head_commit {head_ptr, git_commit_free};
-
-    git_buf to_sign = {};
-    const git_commit* head_ref[1] = {head_commit.get()};
-    if (git_commit_create_buffer(&to_sign,
-                                 repo.get(),
-                                 sig.get(),
-                                 sig.get(),
-                                 nullptr,
-                                 msg.c_str(),
-                                 tree.get(),
-                                 1,
-                                 &head_ref[0])
-        < 0) {
-        JAMI_ERR("Could not create commit buffer");
+    GitCommit parent {head_ptr, git_commit_free};
+    git_tree* head_tree_ptr = nullptr;
+    if (git_commit_tree(&head_tree_ptr, parent.get()) < 0) {
+        JAMI_ERR("Could not look up HEAD tree");
         return {};
     }
+    GitTree tree {head_tree_ptr, git_tree_free};
 
-    // git commit -S
-    auto to_sign_vec = std::vector<uint8_t>(to_sign.ptr, to_sign.ptr + to_sign.size);
-    auto signed_buf = account->identity().first->sign(to_sign_vec);
-    std::string signed_str = base64::encode(signed_buf);
-    if (git_commit_create_with_signature(&commit_id,
-                                         repo.get(),
-                                         to_sign.ptr,
-                                         signed_str.c_str(),
-                                         "signature")
-        < 0) {
-        JAMI_ERR("Could not sign commit");
+    std::vector<std::string> ids;
+    ids.reserve(changes.size());
+    for (const auto& [staged, msg] : changes) {
+        // Apply staged files on the parent's tree, in memory
+        tree = stagedTree(repo.get(), tree.get(), staged);
+        if (!tree)
+            return {};
+
+        git_buf to_sign = {};
+        const git_commit* parent_ref[1] = {parent.get()};
+        if (git_commit_create_buffer(&to_sign,
+                                     repo.get(),
+                                     sig.get(),
+                                     sig.get(),
+                                     nullptr,
+                                     msg.c_str(),
+                                     tree.get(),
+                                     1,
+                                     &parent_ref[0])
+            < 0) {
+            JAMI_ERR("Could not create commit buffer");
+            return {};
+        }
+
+        // git commit -S
+        auto to_sign_vec = std::vector<uint8_t>(to_sign.ptr, to_sign.ptr + to_sign.size);
+        auto signed_buf = account->identity().first->sign(to_sign_vec);
+        std::string signed_str = base64::encode(signed_buf);
+        if (git_commit_create_with_signature(&commit_id,
+                                             repo.get(),
+                                             to_sign.ptr,
+                                             signed_str.c_str(),
+                                             "signature")
+            < 0) {
+            JAMI_ERR("Could not sign commit");
+            git_buf_dispose(&to_sign);
+            return {};
+        }
         git_buf_dispose(&to_sign);
-        return {};
+
+        git_commit* commit_ptr = nullptr;
+        if (git_commit_lookup(&commit_ptr, repo.get(), &commit_id) < 0) {
+            JAMI_ERR("Could not look up new commit");
+            return {};
+        }
+        parent.reset(commit_ptr);
+        ids.emplace_back(git_oid_tostr_s(&commit_id));
     }
-    git_buf_dispose(&to_sign);
 
-    // Move commit to main branch
+    // Move the last commit to main branch
     git_reference* ref_ptr = nullptr;
     if (git_reference_create(&ref_ptr, repo.get(), "refs/heads/main", &commit_id, true, nullptr)
         < 0) {
         JAMI_WARN("Could not move commit to main");
     }
     git_reference_free(ref_ptr);
+    indexOutdated_ = true;
 
-    auto commit_str = git_oid_tostr_s(&commit_id);
-    if (commit_str) {
-        JAMI_INFO("New message added with id: %s", commit_str);
-    }
-    return commit_str ? commit_str : "";
+    for (const auto& id : ids)
+        JAMI_INFO("New message added with id: %s", id.c_str());
+    return ids;
 }
 
 ConversationMode
@@ -1983,6 +2275,79 @@ ConversationRepository::Impl::log(const std::string& from,
     return commits;
 }
 
+void
+ConversationRepository::Impl::forEachCommit(
+    const std::string& from, const std::function<bool(ConversationCommit&&)>& cb) const
+{
+    git_oid oid, oidFrom, oidMerge;
+
+    // Note: Start from head to get all merge possibilities and correct linearized parent.
+    auto repo = repository();
+    if (!repo or git_reference_name_to_id(&oid, repo.get(), "HEAD") < 0) {
+        JAMI_ERR("Cannot get reference for HEAD");
+        return;
+    }
+
+    if (from != "" && git_oid_fromstr(&oidFrom, from.c_str()) == 0) {
+        auto isMergeBase = git_merge_base(&oidMerge, repo.get(), &oid, &oidFrom) == 0
+                           && git_oid_equal(&oidMerge, &oidFrom);
+        if (!isMergeBase) {
+            // We're logging a non merged branch, so, take this one instead of HEAD
+            oid = oidFrom;
+        }
+    }
+
+    git_revwalk* walker_ptr = nullptr;
+    if (git_revwalk_new(&walker_ptr, repo.get()) < 0 || git_revwalk_push(walker_ptr, &oid) < 0) {
+        GitRevWalker walker {walker_ptr, git_revwalk_free};
+        JAMI_DBG("Couldn't init revwalker for conversation %s", id_.c_str());
+        return;
+    }
+    GitRevWalker walker {walker_ptr, git_revwalk_free};
+    git_revwalk_sorting(walker.get(), GIT_SORT_TOPOLOGICAL | GIT_SORT_TIME);
+
+    // Only one commit is kept, waiting for its linearized parent
+    std::optional<ConversationCommit> previous;
+    auto startLogging = from == "";
+    while (!git_revwalk_next(&oid, walker.get())) {
+        std::string id = git_oid_tostr_s(&oid);
+        if (!startLogging && from == id)
+            startLogging = true;
+        if (!startLogging)
+            continue;
+        if (previous) {
+            previous->linearized_parent = id;
+            if (!cb(std::move(*previous)))
+                return;
+            previous.reset();
+        }
+
+        git_commit* commit_ptr = nullptr;
+        if (git_commit_lookup(&commit_ptr, repo.get(), &oid) < 0) {
+            JAMI_WARN("Failed to look up commit %s", id.c_str());
+            return;
+        }
+        GitCommit commit {commit_ptr, git_commit_free};
+
+        ConversationCommit cc;
+        const git_signature* sig = git_commit_author(commit.get());
+        cc.author.name = sig->name;
+        cc.author.email = sig->email;
+        auto parentsCount = git_commit_parentcount(commit.get());
+        cc.parents.reserve(parentsCount);
+        for (unsigned int p = 0; p < parentsCount; ++p) {
+            if (const git_oid* pid = git_commit_parent_id(commit.get(), p))
+                cc.parents.emplace_back(git_oid_tostr_s(pid));
+        }
+        cc.id = std::move(id);
+        cc.commit_msg = git_commit_message(commit.get());
+        cc.timestamp = git_commit_time(commit.get());
+        previous = std::move(cc);
+    }
+    if (previous)
+        cb(std::move(*previous));
+}
+
 GitObject
 ConversationRepository::Impl::fileAtTree(const std::string& path, const GitTree& tree) const
 {
@@ -2146,19 +2511,22 @@ ConversationRepository::Impl::initMembers()
     if (!repo)
         throw std::logic_error("Invalid git repository");
 
-    std::vector<std::string> uris;
-    std::lock_guard<std::mutex> lk(membersMtx_);
-    members_.clear();
+    std::vector<ConversationMember> members;
+    std::set<std::string> uris;
     std::string repoPath = git_repository_workdir(repo.get());
     std::vector<std::string> paths = {repoPath + "/" + "admins",
                                       repoPath + "/" + "members",
                                       repoPath + "/" + "invited",
-                                      repoPath + "/" + "banned" + "/" + "members"};
+                                      repoPath + "/" + "banned" + "/" + "members",
+                                      repoPath + "/" + "banned" + "/" + "admins",
+                                      repoPath + "/" + "banned" + "/" + "invited"};
     std::vector<MemberRole> roles = {
         MemberRole::ADMIN,
         MemberRole::MEMBER,
         MemberRole::INVITED,
         MemberRole::BANNED,
+        MemberRole::BANNED,
+        MemberRole::BANNED,
     };
 
     auto i = 0;
@@ -2166,24 +2534,95 @@ ConversationRepository::Impl::initMembers()
         for (const auto& f : fileutils::readDirectory(p)) {
             auto pos = f.find(".crt");
             auto uri = f.substr(0, pos);
-            auto it = std::find(uris.begin(), uris.end(), uri);
-            if (it == uris.end()) {
-                members_.emplace_back(ConversationMember {uri, roles[i]});
-                uris.emplace_back(uri);
-            }
+            if (uris.emplace(uri).second)
+                members.emplace_back(ConversationMember {uri, roles[i]});
         }
         ++i;
     }
 
     if (mode() == ConversationMode::ONE_TO_ONE) {
         for (const auto& member : getInitialMembers()) {
-            auto it = std::find(uris.begin(), uris.end(), member);
-            if (it == uris.end()) {
+            if (uris.emplace(member).second) {
                 // If member is in initial commit, but not in invited, this means that user left.
-                members_.emplace_back(ConversationMember {member, MemberRole::LEFT});
+                members.emplace_back(ConversationMember {member, MemberRole::LEFT});
             }
         }
     }
+
+    std::map<std::string, bool> devices;
+    for (const auto& f : fileutils::readDirectory(repoPath + "devices"))
+        devices.emplace(f.substr(0, f.find(".crt")), false);
+    for (const auto& f : fileutils::readDirectory(repoPath + "banned/devices"))
+        devices[f.substr(0, f.find(".crt"))] = true;
+
+    members_.reset(std::move(members), std::move(devices));
+}
+
+std::optional<MemberRole>
+ConversationRepository::Impl::memberRoleFromFiles(const std::string& repoPath,
+                                                  const std::string& uri) const
+{
+    if (fileutils::isFile(fmt::format("{}admins/{}.crt", repoPath, uri)))
+        return MemberRole::ADMIN;
+    if (fileutils::isFile(fmt::format("{}members/{}.crt", repoPath, uri)))
+        return MemberRole::MEMBER;
+    if (fileutils::isFile(fmt::format("{}invited/{}", repoPath, uri)))
+        return MemberRole::INVITED;
+    if (fileutils::isFile(fmt::format("{}banned/members/{}.crt", repoPath, uri))
+        || fileutils::isFile(fmt::format("{}banned/admins/{}.crt", repoPath, uri))
+        || fileutils::isFile(fmt::format("{}banned/invited/{}", repoPath, uri)))
+        return MemberRole::BANNED;
+    if (mode() == ConversationMode::ONE_TO_ONE) {
+        auto initialMembers = getInitialMembers();
+        if (std::find(initialMembers.begin(), initialMembers.end(), uri) != initialMembers.end())
+            return MemberRole::LEFT;
+    }
+    return std::nullopt;
+}
+
+void
+ConversationRepository::Impl::updateMembers(const std::string& oldCommit)
+{
+    if (oldCommit.empty()) {
+        initMembers();
+        return;
+    }
+    auto repo = repository();
+    if (!repo)
+        return;
+    std::string repoPath = git_repository_workdir(repo.get());
+
+    // Only re-evaluate what the diff touched
+    std::set<std::string> uris, devices;
+    for (const auto& file : ConversationRepository::changedFiles(diffStats("HEAD", oldCommit))) {
+        auto parts = split_string(file, '/');
+        if (parts.size() < 2)
+            continue;
+        auto dir = parts[parts.size() - 2];
+        auto name = std::string(parts.back());
+        auto pos = name.find(".crt");
+        if (pos != std::string::npos)
+            name = name.substr(0, pos);
+        if (dir == "devices")
+            devices.emplace(std::move(name));
+        else if (dir == "admins" || dir == "members" || dir == "invited")
+            uris.emplace(std::move(name));
+    }
+
+    for (const auto& uri : uris) {
+        if (auto role = memberRoleFromFiles(repoPath, uri))
+            members_.setRole(uri, *role);
+        else
+            members_.remove(uri);
+    }
+    for (const auto& device : devices) {
+        if (fileutils::isFile(fmt::format("{}devices/{}.crt", repoPath, device)))
+            members_.setDevice(device);
+        else if (fileutils::isFile(fmt::format("{}banned/devices/{}.crt", repoPath, device)))
+            members_.setDevice(device, true);
+        else
+            members_.removeDevice(device);
+    }
 }
 
 std::string
@@ -2327,6 +2766,7 @@ bool
 ConversationRepository::Impl::validCommits(
     const std::vector<ConversationCommit>& commitsToValidate) const
 {
+    JAMI_CPU_PROBE("git.validate_commits");
     for (const auto& commit : commitsToValidate) {
         auto userDevice = commit.author.email;
         auto validUserAtCommit = commit.id;
@@ -2528,51 +2968,57 @@ ConversationRepository::id() const
 std::string
 ConversationRepository::addMember(const std::string& uri)
 {
-    auto account = pimpl_->account_.lock();
+    auto commits = addMembers({uri});
+    return commits.empty() ? std::string {} : std::move(commits.front());
+}
+
+std::vector<std::string>
+ConversationRepository::addMembers(const std::vector<std::string>& uris)
+{
     auto repo = pimpl_->repository();
-    if (!account or not repo)
+    if (not repo)
         return {};
-    auto deviceId = account->currentDeviceId();
-    auto name = account->getUsername();
-    if (name.empty())
-        name = deviceId;
 
-    // First, we need to add the member file to the repository if not present
-    std::string repoPath = git_repository_workdir(repo.get());
-
-    std::string invitedPath = repoPath + "invited";
+    // First, we need to add the member files to the repository if not present
+    std::string invitedPath = std::string(git_repository_workdir(repo.get())) + "invited";
     if (!fileutils::recursive_mkdir(invitedPath, 0700)) {
         JAMI_ERR("Error when creating %s.", invitedPath.c_str());
         return {};
     }
-    std::string devicePath = invitedPath + "/" + uri;
-    if (fileutils::isFile(devicePath)) {
-        JAMI_WARN("Member %s already present!", uri.c_str());
-        return {};
-    }
-
-    auto file = fileutils::ofstream(devicePath, std::ios::trunc | std::ios::binary);
-    if (!file.is_open()) {
-        JAMI_ERR("Could not write data to %s", devicePath.c_str());
-        return {};
-    }
-    std::string path = "invited/" + uri;
-    if (!pimpl_->add(path.c_str()))
-        return {};
-
-    {
-        std::lock_guard<std::mutex> lk(pimpl_->membersMtx_);
-        pimpl_->members_.emplace_back(ConversationMember {uri, MemberRole::INVITED});
-    }
 
-    Json::Value json;
-    json["action"] = "add";
-    json["uri"] = uri;
-    json["type"] = "member";
     Json::StreamWriterBuilder wbuilder;
     wbuilder["commentStyle"] = "None";
     wbuilder["indentation"] = "";
-    return pimpl_->commit(Json::writeString(wbuilder, json));
+    std::vector<std::pair<StagedFiles, std::string>> changes;
+    std::vector<std::string> added;
+    for (const auto& uri : uris) {
+        std::string devicePath = invitedPath + "/" + uri;
+        if (fileutils::isFile(devicePath)) {
+            JAMI_WARN("Member %s already present!", uri.c_str());
+            continue;
+        }
+        auto file = fileutils::ofstream(devicePath, std::ios::trunc | std::ios::binary);
+        if (!file.is_open()) {
+            JAMI_ERR("Could not write data to %s", devicePath.c_str());
+            continue;
+        }
+        // One commit per member, as validated by peers (see checkValidAdd)
+        Json::Value json;
+        json["action"] = "add";
+        json["uri"] = uri;
+        json["type"] = "member";
+        changes.emplace_back(StagedFiles {{"invited/" + uri, false}},
+                             Json::writeString(wbuilder, json));
+        added.emplace_back(uri);
+    }
+    if (changes.empty())
+        return {};
+
+    auto commits = pimpl_->commitChain(std::move(changes));
+    if (!commits.empty())
+        for (const auto& uri : added)
+            pimpl_->members_.setRole(uri, MemberRole::INVITED);
+    return commits;
 }
 
 std::string
@@ -2749,6 +3195,7 @@ ConversationRepository::Impl::addUserDevice()
 
         if (!add(path))
             JAMI_WARN("Couldn't add file %s", devicePath.c_str());
+        members_.setDevice(account->currentDeviceId());
     }
 }
 
@@ -2786,6 +3233,13 @@ ConversationRepository::log(const std::string& from,
     return pimpl_->log(from, to, 0, logIfNotFound, fastLog, authorUri);
 }
 
+void
+ConversationRepository::forEachCommit(const std::string& from,
+                                      const std::function<bool(ConversationCommit&&)>& cb) const
+{
+    pimpl_->forEachCommit(from, cb);
+}
+
 std::optional<ConversationCommit>
 ConversationRepository::getCommit(const std::string& commitId, bool logIfNotFound) const
 {
@@ -2809,6 +3263,8 @@ ConversationRepository::merge(const std::string& merge_id)
         JAMI_ERR("Merge operation aborted: repository is in unexpected state %d", state);
         return {false, ""};
     }
+    // The checkout compares the working tree with the index
+    pimpl_->syncIndex(repo.get());
     // Checkout main (to do a `git_merge branch`)
     if (git_repository_set_head(repo.get(), "refs/heads/main") < 0) {
         JAMI_ERR("Merge operation aborted: couldn't checkout main branch");
@@ -2929,6 +3385,7 @@ ConversationRepository::changedFiles(const std::string_view& diffStats)
 std::string
 ConversationRepository::join()
 {
+    Impl::StagingScope staging {*pimpl_};
     // Check that not already member
     auto repo = pimpl_->repository();
     if (!repo)
@@ -2954,6 +3411,7 @@ ConversationRepository::join()
     // Remove invited/uri.crt
     std::string invitedPath = repoPath + "invited";
     fileutils::remove(fileutils::getFullPath(invitedPath, uri));
+    pimpl_->remove(fmt::format("invited/{}", uri));
     // Add members/uri.crt
     if (!fileutils::recursive_mkdir(membersPath, 0700)) {
         JAMI_ERR("Error when creating %s. Abort create conversations", membersPath.c_str());
@@ -2966,10 +3424,8 @@ ConversationRepository::join()
     }
     file << parentCert->toString(true);
     file.close();
-    // git add -A
-    if (!git_add_all(repo.get())) {
+    if (!pimpl_->add(fmt::format("members/{}.crt", uri)))
         return {};
-    }
     Json::Value json;
     json["action"] = "join";
     json["uri"] = uri;
@@ -2978,20 +3434,7 @@ ConversationRepository::join()
     wbuilder["commentStyle"] = "None";
     wbuilder["indentation"] = "";
 
-    {
-        std::lock_guard<std::mutex> lk(pimpl_->membersMtx_);
-        auto updated = false;
-
-        for (auto& member : pimpl_->members_) {
-            if (member.uri == uri) {
-                updated = true;
-                member.role = MemberRole::MEMBER;
-                break;
-            }
-        }
-        if (!updated)
-            pimpl_->members_.emplace_back(ConversationMember {uri, MemberRole::MEMBER});
-    }
+    pimpl_->members_.setRole(uri, MemberRole::MEMBER);
 
     return commitMessage(Json::writeString(wbuilder, json));
 }
@@ -2999,6 +3442,7 @@ ConversationRepository::join()
 std::string
 ConversationRepository::leave()
 {
+    Impl::StagingScope staging {*pimpl_};
     // TODO simplify
     auto account = pimpl_->account_.lock();
     auto repo = pimpl_->repository();
@@ -3023,10 +3467,12 @@ ConversationRepository::leave()
 
     if (fileutils::isFile(adminFile)) {
         fileutils::removeAll(adminFile, true);
+        pimpl_->remove(fmt::format("admins/{}.crt", uri));
     }
 
     if (fileutils::isFile(memberFile)) {
         fileutils::removeAll(memberFile, true);
+        pimpl_->remove(fmt::format("members/{}.crt", uri));
     }
 
     // /CRLs
@@ -3042,6 +3488,7 @@ ConversationRepository::leave()
 
         if (fileutils::isFile(crlPath)) {
             fileutils::removeAll(crlPath, true);
+            pimpl_->remove(fmt::format("CRLs/{}/{}.crl", deviceId, ss.str()));
         }
     }
 
@@ -3050,13 +3497,10 @@ ConversationRepository::leave()
         std::string deviceFile = fmt::format("{}/devices/{}.crt", repoPath, d.first);
         if (fileutils::isFile(deviceFile)) {
             fileutils::removeAll(deviceFile, true);
+            pimpl_->remove(fmt::format("devices/{}.crt", d.first));
         }
     }
 
-    if (!git_add_all(repo.get())) {
-        return {};
-    }
-
     Json::Value json;
     json["action"] = "remove";
     json["uri"] = uri;
@@ -3065,12 +3509,7 @@ ConversationRepository::leave()
     wbuilder["commentStyle"] = "None";
     wbuilder["indentation"] = "";
 
-    {
-        std::lock_guard<std::mutex> lk(pimpl_->membersMtx_);
-        std::remove_if(pimpl_->members_.begin(), pimpl_->members_.end(), [&](auto& member) {
-            return member.uri == account->getUsername();
-        });
-    }
+    pimpl_->members_.remove(account->getUsername());
 
     return commitMessage(Json::writeString(wbuilder, json));
 }
@@ -3095,6 +3534,7 @@ ConversationRepository::mode() const
 std::string
 ConversationRepository::voteKick(const std::string& uri, const std::string& type)
 {
+    Impl::StagingScope staging {*pimpl_};
     auto repo = pimpl_->repository();
     auto account = pimpl_->account_.lock();
     if (!account || !repo)
@@ -3145,6 +3585,7 @@ ConversationRepository::voteKick(const std::string& uri, const std::string& type
 std::string
 ConversationRepository::voteUnban(const std::string& uri, const std::string& type)
 {
+    Impl::StagingScope staging {*pimpl_};
     auto repo = pimpl_->repository();
     auto account = pimpl_->account_.lock();
     if (!account || !repo)
@@ -3206,6 +3647,9 @@ ConversationRepository::Impl::resolveBan(const std::string& type, const std::str
                  destFilePath.c_str());
         return false;
     }
+    remove(fmt::format("{}/{}{}", type, uri, crtStr));
+    if (!add(fmt::format("banned/{}/{}{}", type, uri, crtStr)))
+        return false;
 
     // If members, remove related devices and mark as banned
     if (type != "devices") {
@@ -3215,24 +3659,18 @@ ConversationRepository::Impl::resolveBan(const std::string& type, const std::str
             try {
                 crypto::Certificate cert(deviceCert);
                 if (auto issuer = cert.issuer)
-                    if (issuer->toString() == uri)
+                    if (issuer->toString() == uri) {
                         fileutils::remove(certPath, true);
+                        remove(fmt::format("devices/{}", certificate));
+                        members_.removeDevice(certificate.substr(0, certificate.find(".crt")));
+                    }
             } catch (...) {
                 continue;
             }
         }
-        std::lock_guard<std::mutex> lk(membersMtx_);
-        auto updated = false;
-
-        for (auto& member : members_) {
-            if (member.uri == uri) {
-                updated = true;
-                member.role = MemberRole::BANNED;
-                break;
-            }
-        }
-        if (!updated)
-            members_.emplace_back(ConversationMember {uri, MemberRole::BANNED});
+        members_.setRole(uri, MemberRole::BANNED);
+    } else {
+        members_.setDevice(uri, true);
     }
     return true;
 }
@@ -3257,25 +3695,21 @@ ConversationRepository::Impl::resolveUnban(const std::string& type, const std::s
                  destFilePath.c_str());
         return false;
     }
+    remove(fmt::format("banned/{}/{}{}", type, uri, crtStr));
+    if (!add(fmt::format("{}/{}{}", type, uri, crtStr)))
+        return false;
 
-    std::lock_guard<std::mutex> lk(membersMtx_);
-    auto updated = false;
+    if (type == "devices") {
+        members_.setDevice(uri);
+        return true;
+    }
 
     auto role = MemberRole::MEMBER;
     if (type == "invited")
         role = MemberRole::INVITED;
     else if (type == "admins")
         role = MemberRole::ADMIN;
-
-    for (auto& member : members_) {
-        if (member.uri == uri) {
-            updated = true;
-            member.role = role;
-            break;
-        }
-    }
-    if (!updated)
-        members_.emplace_back(ConversationMember {uri, role});
+    members_.setRole(uri, role);
     return true;
 }
 
@@ -3284,6 +3718,7 @@ ConversationRepository::resolveVote(const std::string& uri,
                                     const std::string& type,
                                     const std::string& voteType)
 {
+    Impl::StagingScope staging {*pimpl_};
     // Count ratio admin/votes
     auto nbAdmins = 0, nbVotes = 0;
     // For each admin, check if voted
@@ -3311,6 +3746,7 @@ ConversationRepository::resolveVote(const std::string& uri,
 
         // Remove vote directory
         fileutils::removeAll(voteDirectory, true);
+        pimpl_->remove(fmt::format("votes/{}/{}", votePath, uri));
 
         if (voteType == "ban") {
             if (!pimpl_->resolveBan(type, uri))
@@ -3321,9 +3757,6 @@ ConversationRepository::resolveVote(const std::string& uri,
         }
 
         // Commit
-        if (!git_add_all(repo.get()))
-            return {};
-
         Json::Value json;
         json["action"] = voteType;
         json["uri"] = uri;
@@ -3391,6 +3824,30 @@ ConversationRepository::memberUris(std::string_view filter,
     return pimpl_->memberUris(filter, filteredRoles);
 }
 
+std::optional<MemberRole>
+ConversationRepository::memberRole(std::string_view uri) const
+{
+    return pimpl_->members_.role(uri);
+}
+
+bool
+ConversationRepository::isMember(std::string_view uri, bool includeInvited) const
+{
+    return pimpl_->members_.isMember(uri, includeInvited);
+}
+
+bool
+ConversationRepository::isBanned(std::string_view uri) const
+{
+    return pimpl_->members_.isBanned(uri);
+}
+
+uint64_t
+ConversationRepository::membersGeneration() const
+{
+    return pimpl_->members_.generation();
+}
+
 void
 ConversationRepository::refreshMembers() const
 {
@@ -3400,6 +3857,25 @@ ConversationRepository::refreshMembers() const
     }
 }
 
+void
+ConversationRepository::updateMembers(const std::string& oldCommit) const
+{
+    try {
+        pimpl_->updateMembers(oldCommit);
+        return;
+    } catch (const std::exception& e) {
+        JAMI_WARN("[conv %s] Unable to update members from %s: %s. Rebuilding the index",
+                  pimpl_->id_.c_str(),
+                  oldCommit.c_str(),
+                  e.what());
+    }
+    try {
+        pimpl_->initMembers();
+    } catch (const std::exception& e) {
+        JAMI_ERR("[conv %s] Unable to rebuild members: %s", pimpl_->id_.c_str(), e.what());
+    }
+}
+
 void
 ConversationRepository::pinCertificates(bool blocking)
 {
@@ -3429,20 +3905,13 @@ ConversationRepository::pinCertificates(bool blocking)
 std::string
 ConversationRepository::updateInfos(const std::map<std::string, std::string>& profile)
 {
+    Impl::StagingScope staging {*pimpl_};
     auto account = pimpl_->account_.lock();
     if (!account)
         return {};
     auto uri = std::string(account->getUsername());
-    auto valid = false;
-    {
-        std::lock_guard<std::mutex> lk(pimpl_->membersMtx_);
-        for (const auto& member : pimpl_->members_) {
-            if (member.uri == uri) {
-                valid = member.role <= pimpl_->updateProfilePermLvl_;
-                break;
-            }
-        }
-    }
+    auto role = pimpl_->members_.role(uri);
+    auto valid = role && *role <= pimpl_->updateProfilePermLvl_;
     if (!valid) {
         JAMI_ERR("Not enough authorization for updating infos");
         emitSignal<DRing::ConversationSignal::OnConversationError>(
@@ -3511,18 +3980,24 @@ ConversationRepository::updateInfos(const std::map<std::string, std::string>& pr
 }
 
 std::map<std::string, std::string>
-ConversationRepository::infos() const
+ConversationRepository::infos(const std::vector<std::string>& fields) const
 {
+    auto wanted = [&](std::string_view field) {
+        return fields.empty() or std::find(fields.begin(), fields.end(), field) != fields.end();
+    };
     if (auto repo = pimpl_->repository()) {
         try {
             std::string repoPath = git_repository_workdir(repo.get());
             auto profilePath = repoPath + "profile.vcf";
             std::map<std::string, std::string> result;
-            if (fileutils::isFile(profilePath)) {
+            if ((wanted("title") or wanted("description") or wanted("avatar"))
+                and fileutils::isFile(profilePath)) {
                 auto content = fileutils::loadTextFile(profilePath);
                 result = ConversationRepository::infosFromVCard(vCard::utils::toMap(content));
             }
-            result["mode"] = std::to_string(static_cast<int>(mode()));
+            if (wanted("mode"))
+                result["mode"] = std::to_string(static_cast<int>(mode()));
+            map_utils::filterKeys(result, fields);
             return result;
         } catch (...) {
         }
@@ -17,10 +17,15 @@
  */
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <optional>
 #include <git2.h>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <opendht/default_types.h>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -34,6 +39,7 @@ using GitAnnotatedCommit
     = std::unique_ptr<git_annotated_commit, decltype(&git_annotated_commit_free)>;
 using GitIndex = std::unique_ptr<git_index, decltype(&git_index_free)>;
 using GitTree = std::unique_ptr<git_tree, decltype(&git_tree_free)>;
+using GitTreeEntry = std::unique_ptr<git_tree_entry, decltype(&git_tree_entry_free)>;
 using GitRemote = std::unique_ptr<git_remote, decltype(&git_remote_free)>;
 using GitReference = std::unique_ptr<git_reference, decltype(&git_reference_free)>;
 using GitSignature = std::unique_ptr<git_signature, decltype(&git_signature_free)>;
@@ -99,6 +105,58 @@ struct ConversationMember
     }
 };
 
+/**
+ * In-memory view of the members of a conversation, indexed by uri and by device.
+ * The repository keeps it up to date from the files touched by commits, so that
+ * permission checks (isMember, isBanned, role...) never have to read the working tree.
+ * generation() is increased on each modification and can be used by callers to
+ * know if a cached result derived from the members is still valid.
+ */
+class DRING_TESTABLE ConversationMemberIndex
+{
+public:
+    /**
+     * Replace the whole content of the index
+     * @param members       Members, in the order to return them
+     * @param devices       Known devices (true if banned)
+     */
+    void reset(std::vector<ConversationMember>&& members, std::map<std::string, bool>&& devices);
+    /**
+     * Add or update a member. New members are appended.
+     */
+    void setRole(const std::string& uri, MemberRole role);
+    void remove(std::string_view uri);
+    void setDevice(const std::string& deviceId, bool banned = false);
+    void removeDevice(std::string_view deviceId);
+
+    std::optional<MemberRole> role(std::string_view uri) const;
+    /**
+     * @param uri               Member to check
+     * @param includeInvited    If invited (or left for one to one conversations) are accepted
+     */
+    bool isMember(std::string_view uri, bool includeInvited = false) const;
+    /**
+     * @param uri       A member's uri or a device id
+     * @return if the member or the device is banned
+     */
+    bool isBanned(std::string_view uri) const;
+    bool hasDevice(std::string_view deviceId) const;
+
+    std::vector<ConversationMember> members() const;
+    std::vector<std::string> memberUris(std::string_view filter,
+                                        const std::set<MemberRole>& filteredRoles) const;
+    std::size_t size() const;
+
+    uint64_t generation() const { return generation_.load(); }
+
+private:
+    mutable std::mutex mtx_ {};
+    std::vector<ConversationMember> members_ {};
+    std::map<std::string, std::size_t, std::less<>> positions_ {};
+    std::map<std::string, bool, std::less<>> devices_ {};
+    std::atomic<uint64_t> generation_ {0};
+};
+
 /**
  * This class gives access to the git repository that represents the conversation
  */
@@ -144,6 +202,13 @@ public:
      * @return the commit id if successful
      */
     std::string addMember(const std::string& uri);
+    /**
+     * Invite several members in one operation: one commit per member (as peers
+     * validate them), all written on top of each other before main is moved once
+     * @param uris   Members to add (already present members are ignored)
+     * @return the commit ids, empty on failure
+     */
+    std::vector<std::string> addMembers(const std::vector<std::string>& uris);
 
     /**
      * Fetch a remote repository via the given socket
@@ -205,6 +270,15 @@ public:
     std::optional<ConversationCommit> getCommit(const std::string& commitId,
                                                 bool logIfNotFound = true) const;
 
+    /**
+     * Walk the history from a commit without storing it
+     * @param from      Most recent commit to give ("" = HEAD)
+     * @param cb        Called for each commit (linearized parent included), return false to stop
+     * @note commits are given without their signature, as only needed for validation
+     */
+    void forEachCommit(const std::string& from,
+                       const std::function<bool(ConversationCommit&&)>& cb) const;
+
     /**
      * Get parent via topological + date sort in branch main of a commit
      * @param commitId      id to choice
@@ -313,6 +387,8 @@ public:
     /**
      * Get conversation's members
      * @return members
+     * @note members found in banned/members, banned/admins or banned/invited are returned
+     * with the BANNED role
      */
     std::vector<ConversationMember> members() const;
 
@@ -324,11 +400,46 @@ public:
     std::vector<std::string> memberUris(std::string_view filter,
                                         const std::set<MemberRole>& filteredRoles) const;
 
+    /**
+     * Get the role of a member
+     * @param uri       Member to check
+     * @return the role if the uri is known in the conversation
+     */
+    std::optional<MemberRole> memberRole(std::string_view uri) const;
+
+    /**
+     * Test if an URI is a member
+     * @param uri               URI to test
+     * @param includeInvited    If invited members (or left members in one to one) are accepted
+     * @note uses the in-memory index, no access to the working tree
+     */
+    bool isMember(std::string_view uri, bool includeInvited = false) const;
+
+    /**
+     * @param uri   Member's uri or device id
+     * @return if banned
+     */
+    bool isBanned(std::string_view uri) const;
+
+    /**
+     * Incremented each time the members' knowledge changes.
+     * Can be used to invalidate data derived from members.
+     */
+    uint64_t membersGeneration() const;
+
     /**
      * To use after a merge with member's events, refresh members knowledge
      */
     void refreshMembers() const;
 
+    /**
+     * Incrementally refresh members knowledge from the files changed between a commit and HEAD
+     * @param oldCommit     Previous HEAD (empty to reload everything)
+     * @note only the members and devices touched by the diff are re-evaluated. If this fails,
+     * the whole index is rebuilt
+     */
+    void updateMembers(const std::string& oldCommit) const;
+
     /**
      * Because conversations can contains non contacts certificates, this methods
      * loads certificates in conversations into the cert store
@@ -345,9 +456,11 @@ public:
 
     /**
      * Retrieve current infos (title, description, avatar, mode)
+     * @param fields    Infos to return, all of them if empty. The profile isn't read
+     *                  if none of its fields is requested.
      * @return infos
      */
-    std::map<std::string, std::string> infos() const;
+    std::map<std::string, std::string> infos(const std::vector<std::string>& fields = {}) const;
     static std::map<std::string, std::string> infosFromVCard(
         const std::map<std::string, std::string>& details);
 
@@ -39,6 +39,7 @@
 #include "jamidht/channeled_transport.h"
 #include "multiplexed_socket.h"
 #include "conversation_channel_handler.h"
+#include "media_channel_handler.h"
 #include "sync_channel_handler.h"
 #include "transfer_channel_handler.h"
 
@@ -74,6 +75,7 @@
 #endif
 #include "fileutils.h"
 #include "string_utils.h"
+#include "map_utils.h"
 #include "archiver.h"
 #include "data_transfer.h"
 #include "conversation.h"
@@ -101,6 +103,7 @@
 #include <cstdarg>
 #include <initializer_list>
 #include <memory>
+#include <numeric>
 #include <regex>
 #include <sstream>
 #include <string>
@@ -121,6 +124,9 @@ static constexpr const char VCARD_URI[] {"vcard://"};
 static constexpr const char DATA_TRANSFER_URI[] {"data-transfer://"};
 static constexpr const char DEVICE_ID_PATH[] {"ring_device"};
 static constexpr std::chrono::steady_clock::duration COMPOSING_TIMEOUT {std::chrono::seconds(12)};
+// Accounts activated on demand go back to standby after this time without activity
+static constexpr std::chrono::steady_clock::duration IDLE_TIMEOUT {std::chrono::minutes(10)};
+static constexpr std::chrono::steady_clock::duration IDLE_CHECK_PERIOD {std::chrono::minutes(1)};
 
 struct PendingConfirmation
 {
@@ -227,6 +233,10 @@ struct JamiAccount::DiscoveredPeer
 };
 
 static constexpr int ICE_COMP_ID_SIP_TRANSPORT {1};
+// Maximum number of pre-gathered ICE transports kept per account, when in demand
+static constexpr std::size_t CONNECTION_ICE_POOL_MAX_SIZE {2};
+static constexpr std::size_t CALL_ICE_POOL_MAX_SIZE {1};
+static constexpr unsigned CALL_ICE_COMP_COUNT_PER_STREAM {2}; // RTP + RTCP
 
 static constexpr const char* const RING_URI_PREFIX = "ring:";
 static constexpr const char* const JAMI_URI_PREFIX = "jami:";
@@ -336,6 +346,7 @@ JamiAccount::JamiAccount(const std::string& accountID, bool /* presenceEnabled *
 
 JamiAccount::~JamiAccount() noexcept
 {
+    stopIcePools();
     if (peerDiscovery_) {
         peerDiscovery_->stopPublish(PEER_DISCOVERY_JAMI_SERVICE);
         peerDiscovery_->stopDiscovery(PEER_DISCOVERY_JAMI_SERVICE);
@@ -356,6 +367,12 @@ JamiAccount::shutdownConnections()
     }
     for (auto& [_id, gs] : gservers)
         gs->stop();
+    stopServices();
+}
+
+void
+JamiAccount::stopServices()
+{
     {
         std::lock_guard<std::mutex> lk(connManagerMtx_);
         // Just move destruction on another thread.
@@ -420,6 +437,7 @@ JamiAccount::newOutgoingCall(std::string_view toUrl, const std::vector<DRing::Me
 {
     auto suffix = stripPrefix(toUrl);
     JAMI_DBG() << *this << "Calling peer " << suffix;
+    wakeUp("outgoing call");
 
     auto& manager = Manager::instance();
     std::shared_ptr<SIPCall> call;
@@ -802,6 +820,7 @@ JamiAccount::SIPStartCall(SIPCall& call, const IpAddr& target)
         JAMI_ERR("Unable to send invite message for this call");
         return false;
     }
+    call.markSetupPhase(Call::SetupPhase::SIP_INVITE);
 
     call.setState(Call::CallState::ACTIVE, Call::ConnectionState::PROGRESSING);
 
@@ -846,6 +865,12 @@ JamiAccount::serialize(YAML::Emitter& out) const
         << accountPeerDiscovery_;
     out << YAML::Key << DRing::Account::ConfProperties::ACCOUNT_PUBLISH << YAML::Value
         << accountPublish_;
+    out << YAML::Key << DRing::Account::ConfProperties::PEER_CONNECTIONS_OVER_UDP << YAML::Value
+        << peerConnectionsOverUdp_;
+    out << YAML::Key << DRing::Account::ConfProperties::MEDIA_OVER_PEER_CONNECTIONS << YAML::Value
+        << mediaOverPeerConnections_;
+    out << YAML::Key << DRing::Account::ConfProperties::ACTIVATE_ON_DEMAND << YAML::Value
+        << activateOnDemand_;
 
     out << YAML::Key << Conf::PROXY_ENABLED_KEY << YAML::Value << proxyEnabled_;
     out << YAML::Key << Conf::PROXY_SERVER_KEY << YAML::Value << proxyServer_;
@@ -943,6 +968,15 @@ JamiAccount::unserialize(const YAML::Node& node)
                        DRing::Account::ConfProperties::ACCOUNT_PEER_DISCOVERY,
                        accountPeerDiscovery_);
     parseValueOptional(node, DRing::Account::ConfProperties::ACCOUNT_PUBLISH, accountPublish_);
+    parseValueOptional(node,
+                       DRing::Account::ConfProperties::PEER_CONNECTIONS_OVER_UDP,
+                       peerConnectionsOverUdp_);
+    parseValueOptional(node,
+                       DRing::Account::ConfProperties::MEDIA_OVER_PEER_CONNECTIONS,
+                       mediaOverPeerConnections_);
+    parseValueOptional(node,
+                       DRing::Account::ConfProperties::ACTIVATE_ON_DEMAND,
+                       activateOnDemand_);
 
 #if HAVE_RINGNS
     parseValueOptional(node, DRing::Account::ConfProperties::RingNS::URI, nameServer_);
@@ -1381,6 +1415,13 @@ JamiAccount::setAccountDetails(const std::map<std::string, std::string>& details
               DRing::Account::ConfProperties::ACCOUNT_PEER_DISCOVERY,
               accountPeerDiscovery_);
     parseBool(details, DRing::Account::ConfProperties::ACCOUNT_PUBLISH, accountPublish_);
+    parseBool(details,
+              DRing::Account::ConfProperties::PEER_CONNECTIONS_OVER_UDP,
+              peerConnectionsOverUdp_);
+    parseBool(details,
+              DRing::Account::ConfProperties::MEDIA_OVER_PEER_CONNECTIONS,
+              mediaOverPeerConnections_);
+    parseBool(details, DRing::Account::ConfProperties::ACTIVATE_ON_DEMAND, activateOnDemand_);
     parseBool(details,
               DRing::Account::ConfProperties::ALLOW_CERT_FROM_HISTORY,
               allowPeersFromHistory_);
@@ -1451,6 +1492,12 @@ JamiAccount::getAccountDetails() const
               accountPeerDiscovery_ ? TRUE_STR : FALSE_STR);
     a.emplace(DRing::Account::ConfProperties::ACCOUNT_PUBLISH,
               accountPublish_ ? TRUE_STR : FALSE_STR);
+    a.emplace(DRing::Account::ConfProperties::PEER_CONNECTIONS_OVER_UDP,
+              peerConnectionsOverUdp_ ? TRUE_STR : FALSE_STR);
+    a.emplace(DRing::Account::ConfProperties::MEDIA_OVER_PEER_CONNECTIONS,
+              mediaOverPeerConnections_ ? TRUE_STR : FALSE_STR);
+    a.emplace(DRing::Account::ConfProperties::ACTIVATE_ON_DEMAND,
+              activateOnDemand_ ? TRUE_STR : FALSE_STR);
     if (accountManager_) {
         if (auto info = accountManager_->getInfo()) {
             a.emplace(DRing::Account::ConfProperties::DEVICE_ID, info->deviceId);
@@ -1512,6 +1559,7 @@ JamiAccount::getVolatileAccountDetails() const
 #endif
     a.emplace(DRing::Account::VolatileProperties::DEVICE_ANNOUNCED,
               deviceAnnounced_ ? TRUE_STR : FALSE_STR);
+    a.emplace(DRing::Account::VolatileProperties::STANDBY, standby_ ? TRUE_STR : FALSE_STR);
 
     return a;
 }
@@ -1625,6 +1673,19 @@ JamiAccount::registerAsyncOps()
 
     loadCachedProxyServer([onLoad](const std::string&) { onLoad(); });
 
+    // In standby, the port is mapped on wake up
+    if (upnpCtrl_ and not standby_) {
+        requestDhtMapping(std::move(onLoad));
+    } else {
+        // No UPNP. Load the account and start the DHT. The local DHT
+        // might not be reachable for peers if we are behind a NAT.
+        onLoad();
+    }
+}
+
+void
+JamiAccount::requestDhtMapping(std::function<void()>&& onMapped)
+{
     if (upnpCtrl_) {
         JAMI_DBG("UPnP: Attempting to map ports for Jami account");
 
@@ -1637,7 +1698,7 @@ JamiAccount::registerAsyncOps()
 
         // Set the notify callback.
         dhtUpnpMapping_.setNotifyCallback([w = weak(),
-                                           onLoad,
+                                           onMapped,
                                            update = std::make_shared<bool>(false)](
                                               upnp::Mapping::sharedPtr_t mapRes) {
             if (auto accPtr = w.lock()) {
@@ -1689,7 +1750,7 @@ JamiAccount::registerAsyncOps()
                     }
 
                     // Load the account and start the DHT.
-                    onLoad();
+                    onMapped();
                 }
             }
         });
@@ -1699,13 +1760,8 @@ JamiAccount::registerAsyncOps()
         // The returned mapping is invalid. Load the account now since
         // we may never receive the callback.
         if (not map or not map->isValid()) {
-            onLoad();
+            onMapped();
         }
-
-    } else {
-        // No UPNP. Load the account and start the DHT. The local DHT
-        // might not be reachable for peers if we are behind a NAT.
-        onLoad();
     }
 }
 
@@ -1731,9 +1787,18 @@ JamiAccount::doRegister()
         generateDhParams();
     }
 
+    // Without the proxy, a full DHT node would keep running in standby
+    if (activateOnDemand_ and not proxyEnabled_)
+        JAMI_WARN("[Account %s] activateOnDemand needs the DHT proxy, staying active",
+                  getAccountID().c_str());
+    standby_ = canStandby();
+    {
+        std::lock_guard<std::mutex> lk(activityMtx_);
+        lastActivity_ = std::chrono::steady_clock::now();
+    }
     setRegistrationState(RegistrationState::TRYING);
     /* if UPnP is enabled, then wait for IGD to complete registration */
-    if (upnpCtrl_ or proxyServerCached_.empty()) {
+    if ((upnpCtrl_ and not standby_) or proxyServerCached_.empty()) {
         registerAsyncOps();
     } else {
         doRegister_();
@@ -2063,21 +2128,10 @@ JamiAccount::doRegister_()
                     auto deviceId = crt->getLongId().toString();
                     if (accountManager_->getInfo()->deviceId == deviceId)
                         return;
-
-                    std::unique_lock<std::mutex> lk(connManagerMtx_);
-                    initConnectionManager();
-                    channelHandlers_[Uri::Scheme::SYNC]
-                        ->connect(crt->getLongId(),
-                                  "",
-                                  [this](std::shared_ptr<ChannelSocket> socket,
-                                         const DeviceId& deviceId) {
-                                      if (socket)
-                                          syncModule()->syncWith(deviceId, socket);
-                                  });
-                    lk.unlock();
-                    requestSIPConnection(
-                        getUsername(),
-                        crt->getLongId()); // For git notifications, will use the same socket as sync
+                    // In standby, known devices are synced on wake up
+                    if (standby_)
+                        return;
+                    syncWithDevice(crt);
                 },
                 [this] {
                     deviceAnnounced_ = true;
@@ -2094,160 +2148,23 @@ JamiAccount::doRegister_()
 
         accountManager_->setDht(dht_);
 
-        std::unique_lock<std::mutex> lkCM(connManagerMtx_);
-        initConnectionManager();
-        connectionManager_->onDhtConnected(*accountManager_->getInfo()->devicePk);
-        connectionManager_->onICERequest([this](const DeviceId& deviceId) {
-            std::promise<bool> accept;
-            std::future<bool> fut = accept.get_future();
-            accountManager_->findCertificate(
-                deviceId, [this, &accept](const std::shared_ptr<dht::crypto::Certificate>& cert) {
-                    dht::InfoHash peer_account_id;
-                    auto res = accountManager_->onPeerCertificate(cert,
-                                                                  dhtPublicInCalls_,
-                                                                  peer_account_id);
-                    if (res)
-                        JAMI_INFO("Accepting ICE request from account %s",
-                                  peer_account_id.toString().c_str());
-                    else
-                        JAMI_INFO("Discarding ICE request from account %s",
-                                  peer_account_id.toString().c_str());
-                    accept.set_value(res);
-                });
-            fut.wait();
-            auto result = fut.get();
-            return result;
-        });
-        connectionManager_->onChannelRequest(
-            [this](const std::shared_ptr<dht::crypto::Certificate>& cert, const std::string& name) {
-                JAMI_WARN("[Account %s] New channel asked with name %s",
-                          getAccountID().c_str(),
-                          name.c_str());
-
-                auto uri = Uri(name);
-                auto itHandler = channelHandlers_.find(uri.scheme());
-                if (itHandler != channelHandlers_.end() && itHandler->second)
-                    return itHandler->second->onRequest(cert, name);
-                // TODO replace
-                auto isFile = name.substr(0, 7) == FILE_URI;
-                auto isVCard = name.substr(0, 8) == VCARD_URI;
-
-                if (name == "sip") {
-                    return true;
-                } else if (isFile or isVCard) {
-                    auto tid = isFile ? name.substr(7) : name.substr(8);
-                    std::lock_guard<std::mutex> lk(transfersMtx_);
-                    incomingFileTransfers_.emplace(tid);
-                    return true;
-                }
-                return false;
-            });
-        connectionManager_->onConnectionReady([this](const DeviceId& deviceId,
-                                                     const std::string& name,
-                                                     std::shared_ptr<ChannelSocket> channel) {
-            if (channel) {
-                auto cert = channel->peerCertificate();
-                if (!cert || !cert->issuer)
-                    return;
-                auto peerId = cert->issuer->getId().toString();
-                auto isFile = name.substr(0, 7) == FILE_URI;
-                auto isVCard = name.substr(0, 8) == VCARD_URI;
-                if (name == "sip") {
-                    cacheSIPConnection(std::move(channel), peerId, deviceId);
-                } else if (isFile or isVCard) {
-                    auto tid = isFile ? name.substr(7) : name.substr(8);
-                    std::unique_lock<std::mutex> lk(transfersMtx_);
-                    auto it = incomingFileTransfers_.find(tid);
-                    // Note, outgoing file transfers are ignored.
-                    if (it == incomingFileTransfers_.end())
-                        return;
-                    incomingFileTransfers_.erase(it);
-                    lk.unlock();
-                    InternalCompletionCb cb;
-                    if (isVCard)
-                        cb = [peerId, accountId = getAccountID()](const std::string& path) {
-                            emitSignal<DRing::ConfigurationSignal::ProfileReceived>(accountId,
-                                                                                    peerId,
-                                                                                    path);
-                        };
-
-                    DRing::DataTransferInfo info;
-                    info.accountId = getAccountID();
-                    info.peer = peerId;
-                    try {
-                        dhtPeerConnector_->onIncomingConnection(info,
-                                                                std::stoull(tid),
-                                                                std::move(channel),
-                                                                std::move(cb));
-                    } catch (...) {
-                        JAMI_ERR() << "Invalid tid: " << tid;
-                    }
-
-                } else if (name.find("git://") == 0) {
-                    auto sep = name.find_last_of('/');
-                    auto conversationId = name.substr(sep + 1);
-                    auto remoteDevice = name.substr(6, sep - 6);
-
-                    if (channel->isInitiator()) {
-                        // Check if wanted remote it's our side (git://remoteDevice/conversationId)
-                        return;
-                    }
-
-                    // Check if pull from banned device
-                    if (convModule()->isBannedDevice(conversationId, remoteDevice)) {
-                        JAMI_WARN("[Account %s] Git server requested for conversation %s, but the "
-                                  "device is "
-                                  "unauthorized (%s) ",
-                                  getAccountID().c_str(),
-                                  conversationId.c_str(),
-                                  remoteDevice.c_str());
-                        channel->shutdown();
-                        return;
-                    }
-
-                    auto sock = gitSocket(deviceId, conversationId);
-                    if (sock != std::nullopt && sock->lock() == channel) {
-                        // The onConnectionReady is already used as client (for retrieving messages)
-                        // So it's not the server socket
-                        return;
-                    }
-                    auto accountId = this->accountID_;
-                    JAMI_WARN("[Account %s] Git server requested for conversation %s, device %s, "
-                              "channel %u",
-                              accountId.c_str(),
-                              conversationId.c_str(),
-                              deviceId.to_c_str(),
-                              channel->channel());
-                    auto gs = std::make_unique<GitServer>(accountId, conversationId, channel);
-                    gs->setOnFetched([w = weak(), conversationId, deviceId](const std::string&) {
-                        if (auto shared = w.lock())
-                            shared->convModule()->setFetched(conversationId, deviceId.toString());
-                    });
-                    const dht::Value::Id serverId = ValueIdDist()(rand);
-                    {
-                        std::lock_guard<std::mutex> lk(gitServersMtx_);
-                        gitServers_[serverId] = std::move(gs);
+        {
+            std::lock_guard<std::mutex> lk(activationMtx_);
+            if (standby_)
+                listenForWakeUp();
+            else
+                startServices();
+        }
+        if (canStandby() and not idleTask_)
+            idleTask_ = Manager::instance().scheduler().scheduleAtFixedRate(
+                [w = weak()] {
+                    if (auto shared = w.lock()) {
+                        shared->checkIdle(IDLE_TIMEOUT);
+                        return true;
                     }
-                    channel->onShutdown([w = weak(), serverId]() {
-                        // Run on main thread to avoid to be in mxSock's eventLoop
-                        runOnMainThread([serverId, w]() {
-                            auto shared = w.lock();
-                            if (!shared)
-                                return;
-                            std::lock_guard<std::mutex> lk(shared->gitServersMtx_);
-                            shared->gitServers_.erase(serverId);
-                        });
-                    });
-                } else {
-                    // TODO move git://
-                    auto uri = Uri(name);
-                    auto itHandler = channelHandlers_.find(uri.scheme());
-                    if (itHandler != channelHandlers_.end() && itHandler->second)
-                        itHandler->second->onReady(cert, name, std::move(channel));
-                }
-            }
-        });
-        lkCM.unlock();
+                    return false;
+                },
+                IDLE_CHECK_PERIOD);
 
         // Note: this code should be unused unless for DHT text messages
         auto inboxDeviceKey = dht::InfoHash::get(
@@ -2284,21 +2201,392 @@ JamiAccount::doRegister_()
                                 });
             return true;
         });
-
-        if (!dhtPeerConnector_)
-            dhtPeerConnector_ = std::make_unique<DhtPeerConnector>(*this);
-
-        std::lock_guard<std::mutex> lock(buddyInfoMtx);
-        for (auto& buddy : trackedBuddies_) {
-            buddy.second.devices_cnt = 0;
-            trackPresence(buddy.first, buddy.second);
-        }
     } catch (const std::exception& e) {
         JAMI_ERR("Error registering DHT account: %s", e.what());
         setRegistrationState(RegistrationState::ERROR_GENERIC);
     }
 }
 
+void
+JamiAccount::startServices()
+{
+    std::unique_lock<std::mutex> lkCM(connManagerMtx_);
+    initConnectionManager();
+    connectionManager_->onDhtConnected(*accountManager_->getInfo()->devicePk);
+    connectionManager_->onICERequest([this](const DeviceId& deviceId) {
+        std::promise<bool> accept;
+        std::future<bool> fut = accept.get_future();
+        accountManager_->findCertificate(
+            deviceId, [this, &accept](const std::shared_ptr<dht::crypto::Certificate>& cert) {
+                dht::InfoHash peer_account_id;
+                auto res = accountManager_->onPeerCertificate(cert,
+                                                              dhtPublicInCalls_,
+                                                              peer_account_id);
+                if (res)
+                    JAMI_INFO("Accepting ICE request from account %s",
+                              peer_account_id.toString().c_str());
+                else
+                    JAMI_INFO("Discarding ICE request from account %s",
+                              peer_account_id.toString().c_str());
+                accept.set_value(res);
+            });
+        fut.wait();
+        auto result = fut.get();
+        return result;
+    });
+    connectionManager_->onChannelRequest(
+        [this](const std::shared_ptr<dht::crypto::Certificate>& cert, const std::string& name) {
+            JAMI_WARN("[Account %s] New channel asked with name %s",
+                      getAccountID().c_str(),
+                      name.c_str());
+
+            auto uri = Uri(name);
+            auto itHandler = channelHandlers_.find(uri.scheme());
+            if (itHandler != channelHandlers_.end() && itHandler->second)
+                return itHandler->second->onRequest(cert, name);
+            // TODO replace
+            auto isFile = name.substr(0, 7) == FILE_URI;
+            auto isVCard = name.substr(0, 8) == VCARD_URI;
+
+            if (name == "sip") {
+                return true;
+            } else if (isFile or isVCard) {
+                auto tid = isFile ? name.substr(7) : name.substr(8);
+                std::lock_guard<std::mutex> lk(transfersMtx_);
+                incomingFileTransfers_.emplace(tid);
+                return true;
+            }
+            return false;
+        });
+    connectionManager_->onConnectionReady([this](const DeviceId& deviceId,
+                                                 const std::string& name,
+                                                 std::shared_ptr<ChannelSocket> channel) {
+        // Keep the account active while channels are opened
+        wakeUp("channel");
+        if (channel) {
+            auto cert = channel->peerCertificate();
+            if (!cert || !cert->issuer)
+                return;
+            auto peerId = cert->issuer->getId().toString();
+            auto isFile = name.substr(0, 7) == FILE_URI;
+            auto isVCard = name.substr(0, 8) == VCARD_URI;
+            if (name == "sip") {
+                cacheSIPConnection(std::move(channel), peerId, deviceId);
+            } else if (isFile or isVCard) {
+                auto tid = isFile ? name.substr(7) : name.substr(8);
+                std::unique_lock<std::mutex> lk(transfersMtx_);
+                auto it = incomingFileTransfers_.find(tid);
+                // Note, outgoing file transfers are ignored.
+                if (it == incomingFileTransfers_.end())
+                    return;
+                incomingFileTransfers_.erase(it);
+                lk.unlock();
+                InternalCompletionCb cb;
+                if (isVCard)
+                    cb = [peerId, accountId = getAccountID()](const std::string& path) {
+                        emitSignal<DRing::ConfigurationSignal::ProfileReceived>(accountId,
+                                                                                peerId,
+                                                                                path);
+                    };
+
+                DRing::DataTransferInfo info;
+                info.accountId = getAccountID();
+                info.peer = peerId;
+                try {
+                    dhtPeerConnector_->onIncomingConnection(info,
+                                                            std::stoull(tid),
+                                                            std::move(channel),
+                                                            std::move(cb));
+                } catch (...) {
+                    JAMI_ERR() << "Invalid tid: " << tid;
+                }
+
+            } else if (name.find("git://") == 0) {
+                auto sep = name.find_last_of('/');
+                auto conversationId = name.substr(sep + 1);
+                auto remoteDevice = name.substr(6, sep - 6);
+
+                if (channel->isInitiator()) {
+                    // Check if wanted remote it's our side (git://remoteDevice/conversationId)
+                    return;
+                }
+
+                // Check if pull from banned device
+                if (convModule()->isBannedDevice(conversationId, remoteDevice)) {
+                    JAMI_WARN("[Account %s] Git server requested for conversation %s, but the "
+                              "device is "
+                              "unauthorized (%s) ",
+                              getAccountID().c_str(),
+                              conversationId.c_str(),
+                              remoteDevice.c_str());
+                    channel->shutdown();
+                    return;
+                }
+
+                auto sock = gitSocket(deviceId, conversationId);
+                if (sock != std::nullopt && sock->lock() == channel) {
+                    // The onConnectionReady is already used as client (for retrieving messages)
+                    // So it's not the server socket
+                    return;
+                }
+                auto accountId = this->accountID_;
+                JAMI_WARN("[Account %s] Git server requested for conversation %s, device %s, "
+                          "channel %u",
+                          accountId.c_str(),
+                          conversationId.c_str(),
+                          deviceId.to_c_str(),
+                          channel->channel());
+                auto gs = std::make_unique<GitServer>(accountId, conversationId, channel);
+                gs->setOnFetched([w = weak(), conversationId, deviceId](const std::string&) {
+                    if (auto shared = w.lock())
+                        shared->convModule()->setFetched(conversationId, deviceId.toString());
+                });
+                const dht::Value::Id serverId = ValueIdDist()(rand);
+                {
+                    std::lock_guard<std::mutex> lk(gitServersMtx_);
+                    gitServers_[serverId] = std::move(gs);
+                }
+                channel->onShutdown([w = weak(), serverId]() {
+                    // Run on main thread to avoid to be in mxSock's eventLoop
+                    runOnMainThread([serverId, w]() {
+                        auto shared = w.lock();
+                        if (!shared)
+                            return;
+                        std::lock_guard<std::mutex> lk(shared->gitServersMtx_);
+                        shared->gitServers_.erase(serverId);
+                    });
+                });
+            } else {
+                // TODO move git://
+                auto uri = Uri(name);
+                auto itHandler = channelHandlers_.find(uri.scheme());
+                if (itHandler != channelHandlers_.end() && itHandler->second)
+                    itHandler->second->onReady(cert, name, std::move(channel));
+            }
+        }
+    });
+    lkCM.unlock();
+
+    if (!dhtPeerConnector_)
+        dhtPeerConnector_ = std::make_unique<DhtPeerConnector>(*this);
+
+    std::lock_guard<std::mutex> lock(buddyInfoMtx);
+    for (auto& buddy : trackedBuddies_) {
+        buddy.second.devices_cnt = 0;
+        trackPresence(buddy.first, buddy.second);
+    }
+}
+
+void
+JamiAccount::listenForWakeUp()
+{
+    JAMI_DBG("[Account %s] Standby: waiting for connection requests", getAccountID().c_str());
+    // Same key as ConnectionManager::onDhtConnected. Requests stay on the DHT, so the
+    // connection manager gets the request that woke us up when it starts listening.
+    wakeListenKey_ = dht::InfoHash::get(PeerConnectionRequest::key_prefix
+                                        + accountManager_->getInfo()->devicePk->getId().toString());
+    wakeListenToken_ = dht_->listen<PeerConnectionRequest>(
+        wakeListenKey_, [w = weak()](PeerConnectionRequest&& req) {
+            auto shared = w.lock();
+            if (!shared)
+                return false;
+            if (req.isAnswer)
+                return true;
+            {
+                // Only check, the connection manager marks the request as treated
+                std::lock_guard<std::mutex> lock(shared->messageMutex_);
+                if (shared->treatedMessages_.find(to_hex_string(req.id))
+                    != shared->treatedMessages_.end())
+                    return true;
+            }
+            runOnMainThread([w] {
+                if (auto shared = w.lock())
+                    shared->wakeUp("connection request");
+            });
+            return false;
+        });
+}
+
+void
+JamiAccount::wakeUp(std::string_view reason)
+{
+    {
+        std::lock_guard<std::mutex> lk(activityMtx_);
+        lastActivity_ = std::chrono::steady_clock::now();
+    }
+    if (not standby_)
+        return;
+
+    std::unique_lock<std::mutex> lk(activationMtx_);
+    if (not standby_)
+        return;
+    JAMI_WARN("[Account %s] Leaving standby (%.*s)",
+              getAccountID().c_str(),
+              (int) reason.size(),
+              reason.data());
+    standby_ = false;
+    if (wakeListenToken_.valid())
+        dht_->cancelListen(wakeListenKey_, std::move(wakeListenToken_));
+    // Else, doRegister_ is in progress and will start the services
+    if (dht_->isRunning())
+        startServices();
+    lk.unlock();
+    {
+        std::lock_guard<std::mutex> lock(activityMtx_);
+        lastWakeReason_ = reason;
+        ++wakeCount_;
+    }
+
+    if (registrationState_ == RegistrationState::REGISTERED)
+        startIcePools();
+    requestDhtMapping([w = weak()] {
+        if (auto shared = w.lock())
+            shared->dht_->connectivityChanged();
+    });
+    runOnMainThread([w = weak()] {
+        auto shared = w.lock();
+        if (!shared)
+            return;
+        std::vector<std::shared_ptr<dht::crypto::Certificate>> devices;
+        {
+            std::lock_guard<std::recursive_mutex> lock(shared->configurationMutex_);
+            if (not shared->accountManager_ or not shared->accountManager_->getInfo())
+                return;
+            const auto& deviceId = shared->accountManager_->getInfo()->deviceId;
+            for (const auto& [id, device] : shared->accountManager_->getKnownDevices())
+                if (device.certificate and id.toString() != deviceId)
+                    devices.emplace_back(device.certificate);
+        }
+        for (const auto& crt : devices)
+            shared->syncWithDevice(crt);
+    });
+    emitSignal<DRing::ConfigurationSignal::VolatileDetailsChanged>(accountID_,
+                                                                   getVolatileAccountDetails());
+}
+
+void
+JamiAccount::syncWithDevice(const std::shared_ptr<dht::crypto::Certificate>& crt)
+{
+    std::unique_lock<std::mutex> lk(connManagerMtx_);
+    initConnectionManager();
+    channelHandlers_[Uri::Scheme::SYNC]->connect(crt->getLongId(),
+                                                 "",
+                                                 [this](std::shared_ptr<ChannelSocket> socket,
+                                                        const DeviceId& deviceId) {
+                                                     if (socket)
+                                                         syncModule()->syncWith(deviceId, socket);
+                                                 });
+    lk.unlock();
+    // For git notifications, will use the same socket as sync
+    requestSIPConnection(getUsername(), crt->getLongId());
+}
+
+bool
+JamiAccount::checkIdle(std::chrono::steady_clock::duration timeout)
+{
+    if (standby_ or not canStandby() or registrationState_ != RegistrationState::REGISTERED)
+        return standby_;
+    // A wake up can't happen between the check and the stop
+    std::unique_lock<std::mutex> lk(activationMtx_);
+    if (standby_)
+        return true;
+    std::chrono::steady_clock::duration idle;
+    {
+        std::lock_guard<std::mutex> lock(activityMtx_);
+        idle = std::chrono::steady_clock::now() - lastActivity_;
+    }
+    if (idle < timeout or not getCallList().empty())
+        return false;
+    {
+        // The activity time is not updated while data flows (transfers, SIP channels)
+        std::lock_guard<std::mutex> lkCM(connManagerMtx_);
+        if (connectionManager_ and connectionManager_->activeSockets() > 0)
+            return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(gitServersMtx_);
+        if (not gitServers_.empty())
+            return false;
+    }
+
+    JAMI_WARN("[Account %s] Idle for %lld s, going back to standby",
+              getAccountID().c_str(),
+              (long long) std::chrono::duration_cast<std::chrono::seconds>(idle).count());
+    // The DHT and the registration are kept, only what wakeUp started is stopped
+    standby_ = true;
+    stopServices();
+    stopIcePools();
+    {
+        std::lock_guard<std::mutex> lock(buddyInfoMtx);
+        for (auto& [h, buddy] : trackedBuddies_)
+            if (buddy.listenToken.valid())
+                dht_->cancelListen(h, std::move(buddy.listenToken));
+    }
+    if (upnpCtrl_ and dhtUpnpMapping_.isValid())
+        upnpCtrl_->releaseMapping(dhtUpnpMapping_);
+    listenForWakeUp();
+    lk.unlock();
+
+    emitSignal<DRing::ConfigurationSignal::VolatileDetailsChanged>(accountID_,
+                                                                   getVolatileAccountDetails());
+    return true;
+}
+
+std::map<std::string, std::string>
+JamiAccount::getActivityStats() const
+{
+    std::map<std::string, std::string> stats;
+    stats.emplace("mode",
+                  not canStandby() ? "always" : (standby_ ? "standby" : "active"));
+
+    auto dht = dht_;
+    bool running = dht and dht->isRunning();
+    stats.emplace("dht.running", running ? TRUE_STR : FALSE_STR);
+    if (running) {
+        stats.emplace("dht.proxy", proxyEnabled_ ? TRUE_STR : FALSE_STR);
+        auto nodes4 = dht->getNodesStats(AF_INET);
+        auto nodes6 = dht->getNodesStats(AF_INET6);
+        stats.emplace("dht.nodes",
+                      std::to_string(nodes4.getKnownNodes() + nodes6.getKnownNodes()));
+        auto storage = dht->getStoreSize();
+        stats.emplace("dht.storage.bytes", std::to_string(storage.first));
+        stats.emplace("dht.storage.values", std::to_string(storage.second));
+        // Per type counters: ping, find, get, listen, put
+        auto count = [](const std::vector<unsigned>& messages) {
+            return std::to_string(std::accumulate(messages.begin(), messages.end(), 0ull));
+        };
+        stats.emplace("dht.messages.in", count(dht->getNodeMessageStats(true)));
+        stats.emplace("dht.messages.out", count(dht->getNodeMessageStats(false)));
+    }
+
+    std::size_t sockets = 0;
+    {
+        std::lock_guard<std::mutex> lkCM(connManagerMtx_);
+        if (connectionManager_)
+            sockets = connectionManager_->activeSockets();
+    }
+    stats.emplace("connections", std::to_string(sockets));
+
+    std::size_t pooled = 0;
+    {
+        std::lock_guard<std::mutex> lk(icePoolsMtx_);
+        if (connectionIcePool_)
+            pooled += connectionIcePool_->stats().ready;
+        if (callIcePool_)
+            pooled += callIcePool_->stats().ready;
+    }
+    stats.emplace("ice.pooled", std::to_string(pooled));
+
+    std::lock_guard<std::mutex> lk(activityMtx_);
+    stats.emplace("wakeUps", std::to_string(wakeCount_));
+    stats.emplace("lastWakeUpReason", lastWakeReason_);
+    stats.emplace("idleSeconds",
+                  std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
+                                     std::chrono::steady_clock::now() - lastActivity_)
+                                     .count()));
+    return stats;
+}
+
 ConversationModule*
 JamiAccount::convModule()
 {
@@ -2337,6 +2625,7 @@ JamiAccount::convModule()
                             return;
                         }
                     }
+                    shared->wakeUp("conversation");
                     std::lock_guard<std::mutex> lkCM(shared->connManagerMtx_);
                     if (!shared->connectionManager_) {
                         cb({});
@@ -2426,6 +2715,14 @@ JamiAccount::doUnregister(std::function<void(bool)> released_cb)
         std::lock_guard<std::mutex> lk(pendingCallsMutex_);
         pendingCalls_.clear();
     }
+    if (idleTask_) {
+        idleTask_->cancel();
+        idleTask_.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lk(activationMtx_);
+        wakeListenToken_ = {};
+    }
 
     // Stop all current p2p connections if account is disabled
     // Else, we let the system managing if the co is down or not
@@ -2465,11 +2762,14 @@ JamiAccount::setRegistrationState(RegistrationState state,
             JAMI_WARN("[Account %s] connected", getAccountID().c_str());
             cacheTurnServers();
             storeActiveIpAddress();
+            if (not standby_)
+                startIcePools();
         } else if (state == RegistrationState::TRYING) {
             JAMI_WARN("[Account %s] connecting…", getAccountID().c_str());
         } else {
             deviceAnnounced_ = false;
             JAMI_WARN("[Account %s] disconnected", getAccountID().c_str());
+            stopIcePools();
         }
     }
     // Update registrationState_ & emit signals
@@ -2492,6 +2792,107 @@ JamiAccount::connectivityChanged()
     }
     // reset cache
     setPublishedAddress({});
+    // Gathered candidates are now stale
+    flushIcePools();
+}
+
+void
+JamiAccount::startIcePools()
+{
+    std::lock_guard<std::mutex> lk(icePoolsMtx_);
+    auto provider = [w = weak()](std::function<void(IceTransportOptions&&)>&& cb) {
+        if (auto shared = w.lock())
+            shared->getIceOptions(std::move(cb));
+    };
+    if (!connectionIcePool_)
+        connectionIcePool_ = std::make_shared<IceTransportPool>(getAccountID(),
+                                                                ICE_STREAMS_COUNT,
+                                                                ICE_COMP_COUNT_PER_STREAM,
+                                                                true,
+                                                                CONNECTION_ICE_POOL_MAX_SIZE,
+                                                                provider);
+    // Sized for the default media of a call
+    auto callStreams = static_cast<unsigned>(createDefaultMediaList(isVideoEnabled()).size());
+    if (!callIcePool_)
+        callIcePool_ = std::make_shared<IceTransportPool>(getAccountID(),
+                                                          callStreams,
+                                                          CALL_ICE_COMP_COUNT_PER_STREAM,
+                                                          false,
+                                                          CALL_ICE_POOL_MAX_SIZE,
+                                                          provider);
+    connectionIcePool_->start();
+    callIcePool_->start();
+}
+
+void
+JamiAccount::stopIcePools()
+{
+    std::lock_guard<std::mutex> lk(icePoolsMtx_);
+    if (auto pool = std::move(connectionIcePool_))
+        pool->stop();
+    if (auto pool = std::move(callIcePool_))
+        pool->stop();
+}
+
+void
+JamiAccount::flushIcePools()
+{
+    std::lock_guard<std::mutex> lk(icePoolsMtx_);
+    if (connectionIcePool_)
+        connectionIcePool_->flush();
+    if (callIcePool_)
+        callIcePool_->flush();
+}
+
+bool
+JamiAccount::initPooledIceTransport(IceTransport& ice, const IceTransportOptions& options)
+{
+    std::shared_ptr<IceTransportPool> connectionPool, callPool;
+    {
+        std::lock_guard<std::mutex> lk(icePoolsMtx_);
+        connectionPool = connectionIcePool_;
+        callPool = callIcePool_;
+    }
+    return (connectionPool and connectionPool->initTransport(ice, options))
+           or (callPool and callPool->initTransport(ice, options));
+}
+
+void
+JamiAccount::acceptMediaChannels(const std::string& token, std::string_view deviceId)
+{
+    std::lock_guard<std::mutex> lk(connManagerMtx_);
+    auto it = channelHandlers_.find(Uri::Scheme::MEDIA);
+    if (it == channelHandlers_.end())
+        return;
+    static_cast<MediaChannelHandler*>(it->second.get())
+        ->accept(token, DeviceId(std::string(deviceId)));
+}
+
+#ifdef DRING_TESTABLE
+void
+JamiAccount::refuseMediaChannels(bool refuse)
+{
+    std::lock_guard<std::mutex> lk(connManagerMtx_);
+    auto it = channelHandlers_.find(Uri::Scheme::MEDIA);
+    if (it != channelHandlers_.end())
+        static_cast<MediaChannelHandler*>(it->second.get())->refuse(refuse);
+}
+#endif
+
+bool
+JamiAccount::getMediaChannels(const std::string& token,
+                              std::string_view deviceId,
+                              const std::vector<unsigned>& compIds,
+                              bool initiator,
+                              std::function<void(MediaChannels&&)>&& cb)
+{
+    std::lock_guard<std::mutex> lk(connManagerMtx_);
+    auto it = channelHandlers_.find(Uri::Scheme::MEDIA);
+    if (it == channelHandlers_.end())
+        return false;
+    static_cast<MediaChannelHandler*>(it->second.get())
+        ->getChannels(token, DeviceId(std::string(deviceId)), compIds, initiator, std::move(cb));
+    return true;
 }
 
 bool
@@ -3016,6 +3417,22 @@ JamiAccount::getContactDetails(const std::string& uri) const
                : std::map<std::string, std::string> {};
 }
 
+std::vector<std::map<std::string, std::string>>
+JamiAccount::getContactsDetails(const std::vector<std::string>& uris,
+                                const std::vector<std::string>& fields) const
+{
+    std::vector<std::map<std::string, std::string>> result;
+    result.reserve(uris.size());
+    std::lock_guard<std::recursive_mutex> lock(configurationMutex_);
+    auto loaded = accountManager_ and accountManager_->getInfo();
+    for (const auto& uri : uris) {
+        result.emplace_back(loaded ? accountManager_->getContactDetails(uri)
+                                   : std::map<std::string, std::string> {});
+        map_utils::filterKeys(result.back(), fields);
+    }
+    return result;
+}
+
 std::vector<std::map<std::string, std::string>>
 JamiAccount::getContacts() const
 {
@@ -3497,6 +3914,7 @@ JamiAccount::pushNotificationReceived(const std::string& from,
 {
     JAMI_WARN("[Account %s] pushNotificationReceived: %s", getAccountID().c_str(), from.c_str());
     dht_->pushNotificationReceived(data);
+    wakeUp("push notification");
 }
 
 std::string
@@ -3861,6 +4279,7 @@ JamiAccount::requestSIPConnection(const std::string& peerId, const DeviceId& dev
              getAccountID().c_str(),
              peerId.c_str(),
              deviceId.to_c_str());
+    wakeUp("SIP connection");
 
     // If a connection already exists or is in progress, no need to do this
     std::lock_guard<std::mutex> lk(sipConnsMtx_);
@@ -4114,6 +4533,14 @@ JamiAccount::cacheSIPConnection(std::shared_ptr<ChannelSocket>&& socket,
             return;
         pc->setSipTransport(sip_tr, getContactHeader(sip_tr));
         pc->setState(Call::ConnectionState::PROGRESSING);
+        if (auto sock = socket->underlyingSocket()) {
+            // Phases before the call creation are ignored (connection reused)
+            auto timeline = sock->timeline();
+            pc->markSetupPhase(Call::SetupPhase::ICE_GATHER, timeline.iceGathered);
+            pc->markSetupPhase(Call::SetupPhase::DHT_REQUEST, timeline.dhtAnswered);
+            pc->markSetupPhase(Call::SetupPhase::ICE_CHECK, timeline.iceConnected);
+            pc->markSetupPhase(Call::SetupPhase::TLS_HANDSHAKE, timeline.tlsReady);
+        }
         if (auto ice = socket->underlyingICE()) {
             auto remoted_address = ice->getRemoteAddress(ICE_COMP_ID_SIP_TRANSPORT);
             try {
@@ -4172,6 +4599,8 @@ void
 JamiAccount::monitor() const
 {
     JAMI_DBG("[Account %s] Monitor connections", getAccountID().c_str());
+    for (const auto& [key, value] : getActivityStats())
+        JAMI_DBG("[Account %s] %s: %s", getAccountID().c_str(), key.c_str(), value.c_str());
 
     std::lock_guard<std::mutex> lkCM(connManagerMtx_);
     if (connectionManager_)
@@ -4250,6 +4679,7 @@ JamiAccount::transferFile(const std::string& conversationId,
                           size_t end)
 {
     auto channelName = DATA_TRANSFER_URI + conversationId + "/" + currentDeviceId() + "/" + fileId;
+    wakeUp("file transfer");
     std::lock_guard<std::mutex> lkCM(connManagerMtx_);
     if (!connectionManager_)
         return;
@@ -4283,6 +4713,7 @@ JamiAccount::askForFileChannel(const std::string& conversationId,
                                size_t start,
                                size_t end)
 {
+    wakeUp("file transfer");
     auto tryDevice = [=](const auto& did) {
         std::lock_guard<std::mutex> lkCM(connManagerMtx_);
         if (!connectionManager_)
@@ -4340,6 +4771,7 @@ JamiAccount::askForProfile(const std::string& conversationId,
                            const std::string& deviceId,
                            const std::string& memberUri)
 {
+    wakeUp("profile");
     std::lock_guard<std::mutex> lkCM(connManagerMtx_);
     if (!connectionManager_)
         return;
@@ -4373,6 +4805,8 @@ JamiAccount::initConnectionManager()
             = std::make_unique<SyncChannelHandler>(shared(), *connectionManager_.get());
         channelHandlers_[Uri::Scheme::DATA_TRANSFER]
             = std::make_unique<TransferChannelHandler>(shared(), *connectionManager_.get());
+        channelHandlers_[Uri::Scheme::MEDIA]
+            = std::make_unique<MediaChannelHandler>(shared(), *connectionManager_.get());
     }
 }
 
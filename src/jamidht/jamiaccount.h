@@ -82,6 +82,7 @@ using Address = h160;
 namespace jami {
 
 class IceTransport;
+class IceTransportPool;
 struct Contact;
 struct AccountArchive;
 class DhtPeerConnector;
@@ -330,6 +331,12 @@ public:
     /// Obtain details about one account contact in serializable form.
     ///
     std::map<std::string, std::string> getContactDetails(const std::string& uri) const;
+    ///
+    /// Details of several contacts, in the order of \a uris (empty for unknown ones).
+    /// Only \a fields are returned, all of them if empty.
+    ///
+    std::vector<std::map<std::string, std::string>> getContactsDetails(
+        const std::vector<std::string>& uris, const std::vector<std::string>& fields = {}) const;
 
     void sendTrustRequest(const std::string& to, const std::vector<uint8_t>& payload);
     void sendTextMessage(const std::string& to,
@@ -426,6 +433,31 @@ public:
     void pushNotificationReceived(const std::string& from,
                                   const std::map<std::string, std::string>& data);
 
+    /**
+     * With activateOnDemand, the account is registered in standby: the DHT (or the proxy
+     * and push notifications) only listens for device announcements, trust requests,
+     * DHT messages and incoming connection requests. The connection manager, ICE pools,
+     * UPnP mapping and presence tracking are started by wakeUp(), when needed by a client
+     * request or an incoming request, and stopped after a while without activity.
+     * Standby needs the DHT proxy, else the account stays active.
+     * Without standby, only record the activity.
+     */
+    void wakeUp(std::string_view reason);
+    bool isStandby() const { return standby_; }
+
+    /**
+     * Go back to standby if the account was not used for timeout, without calls,
+     * connections and git servers. The DHT and the registration state are kept.
+     * @return true if the account is in standby
+     */
+    bool checkIdle(std::chrono::steady_clock::duration timeout);
+
+    /**
+     * Resources used by the account: mode, DHT nodes, storage and messages, connections,
+     * pooled ICE transports and wake-ups.
+     */
+    std::map<std::string, std::string> getActivityStats() const;
+
     std::string getUserUri() const override;
 
     /**
@@ -461,6 +493,21 @@ public:
      */
     void getIceOptions(std::function<void(IceTransportOptions&&)> cb) noexcept;
 
+    bool initPooledIceTransport(IceTransport& ice, const IceTransportOptions& options) override;
+
+    /**
+     * Calls carry their media in datagrams over the peer connection used for SIP when it
+     * runs over ICE-UDP (see peerConnectionsOverUdp), instead of a dedicated ICE session.
+     * Off by default.
+     */
+    bool mediaChannelsSupported() const override { return mediaOverPeerConnections_; }
+    void acceptMediaChannels(const std::string& token, std::string_view deviceId) override;
+    bool getMediaChannels(const std::string& token,
+                          std::string_view deviceId,
+                          const std::vector<unsigned>& compIds,
+                          bool initiator,
+                          std::function<void(MediaChannels&&)>&& cb) override;
+
 #ifdef DRING_TESTABLE
     ConnectionManager& connectionManager() { return *connectionManager_; }
 
@@ -469,6 +516,11 @@ public:
      * @param newValue
      */
     void noSha3sumVerification(bool newValue) { noSha3sumVerification_ = newValue; }
+
+    /**
+     * Only used for tests, refuse the media channels asked by peers
+     */
+    void refuseMediaChannels(bool refuse);
 #endif
 
     /**
@@ -585,6 +637,12 @@ public:
 
     bool sha3SumVerify() const { return !noSha3sumVerification_; }
 
+    /**
+     * Open new peer connections over ICE-UDP (DTLS and per-channel reliable streams)
+     * instead of ICE-TCP. The peer follows the choice of the initiator.
+     */
+    bool peerConnectionsOverUdp() const { return peerConnectionsOverUdp_; }
+
     /**
      * Change certificate's validity period
      * @param pwd       Password for the archive
@@ -631,6 +689,14 @@ private:
 
     void doRegister_();
 
+    /** Start connection manager, peer connector and presence tracking (see wakeUp) */
+    void startServices();
+    /** Stop connection manager, peer connector and SIP connections */
+    void stopServices();
+    /** In standby, wake up on the first incoming connection request */
+    void listenForWakeUp();
+    void syncWithDevice(const std::shared_ptr<dht::crypto::Certificate>& crt);
+
     const dht::ValueType USER_PROFILE_TYPE = {9, "User profile", std::chrono::hours(24 * 7)};
 
     void startOutgoingCall(const std::shared_ptr<SIPCall>& call, const std::string& toUri);
@@ -667,6 +733,11 @@ private:
      * Maps require port via UPnP and other async ops
      */
     void registerAsyncOps();
+    /**
+     * Request the UPnP mapping of the DHT port, onMapped is called once the
+     * first mapping request is answered.
+     */
+    void requestDhtMapping(std::function<void()>&& onMapped);
     /**
      * Add port mapping callback function.
      */
@@ -773,6 +844,23 @@ private:
     upnp::Mapping dhtUpnpMapping_ {upnp::PortType::UDP};
 
     bool dhtPeerDiscovery_ {false};
+    bool peerConnectionsOverUdp_ {false};
+    bool mediaOverPeerConnections_ {false};
+
+    /**
+     * Activity mode (see wakeUp)
+     */
+    bool activateOnDemand_ {false};
+    bool canStandby() const { return activateOnDemand_ and proxyEnabled_; }
+    std::atomic_bool standby_ {false};
+    std::mutex activationMtx_ {};
+    dht::InfoHash wakeListenKey_ {};
+    std::future<size_t> wakeListenToken_ {};
+    std::shared_ptr<RepeatedTask> idleTask_ {};
+    mutable std::mutex activityMtx_ {};
+    std::chrono::steady_clock::time_point lastActivity_ {};
+    unsigned wakeCount_ {0};
+    std::string lastWakeReason_ {};
 
     /**
      * Proxy
@@ -803,6 +891,14 @@ private:
     std::unique_ptr<DhtPeerConnector> dhtPeerConnector_;
     mutable std::mutex connManagerMtx_ {};
     std::unique_ptr<ConnectionManager> connectionManager_;
+
+    // Pre-gathered ICE transports for connections and calls
+    mutable std::mutex icePoolsMtx_ {};
+    std::shared_ptr<IceTransportPool> connectionIcePool_ {};
+    std::shared_ptr<IceTransportPool> callIcePool_ {};
+    void startIcePools();
+    void stopIcePools();
+    void flushIcePools();
     GitSocketList gitSocketList_ {};
 
     std::mutex discoveryMapMtx_;
@@ -0,0 +1,235 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "jamidht/media_channel_handler.h"
+
+#include "manager.h"
+#include "logger.h"
+
+#include <fmt/core.h>
+
+#include <charconv>
+
+static constexpr const char MEDIA_URI[] {"media://"};
+// The callee may answer long after its SDP answer is ready
+static constexpr std::chrono::seconds ACCEPT_TIMEOUT {60};
+// After that, the caller falls back to a dedicated ICE session (re-invite)
+static constexpr std::chrono::seconds CHANNELS_TIMEOUT {5};
+
+namespace jami {
+
+MediaChannelHandler::MediaChannelHandler(const std::shared_ptr<JamiAccount>& acc,
+                                         ConnectionManager& cm)
+    : ChannelHandlerInterface()
+    , account_(acc)
+    , connectionManager_(cm)
+    , state_(std::make_shared<State>())
+{}
+
+MediaChannelHandler::~MediaChannelHandler()
+{
+    std::map<std::string, Pending> pending;
+    {
+        std::lock_guard<std::mutex> lk(state_->mutex);
+        pending = std::move(state_->pending);
+    }
+    for (auto& [token, p] : pending) {
+        if (p.timeout)
+            p.timeout->cancel();
+        if (p.cb)
+            p.cb({});
+    }
+}
+
+std::pair<std::string, unsigned>
+MediaChannelHandler::parseName(std::string_view name)
+{
+    std::string_view prefix {MEDIA_URI};
+    if (name.substr(0, prefix.size()) != prefix)
+        return {};
+    name.remove_prefix(prefix.size());
+    auto sep = name.find('/');
+    if (sep == std::string_view::npos)
+        return {};
+    unsigned compId = 0;
+    auto compIdStr = name.substr(sep + 1);
+    std::from_chars(compIdStr.data(), compIdStr.data() + compIdStr.size(), compId);
+    return {std::string(name.substr(0, sep)), compId};
+}
+
+void
+MediaChannelHandler::expire(const std::weak_ptr<State>& state,
+                            const std::string& token,
+                            std::chrono::seconds delay,
+                            Pending& pending)
+{
+    if (pending.timeout)
+        pending.timeout->cancel();
+    pending.timeout = Manager::instance().scheduler().scheduleIn(
+        [state, token] {
+            auto s = state.lock();
+            if (!s)
+                return;
+            std::unique_lock<std::mutex> lk(s->mutex);
+            auto it = s->pending.find(token);
+            if (it == s->pending.end())
+                return;
+            auto pending = std::move(it->second);
+            s->pending.erase(it);
+            lk.unlock();
+            JAMI_WARN("Media channels %s timed out", token.c_str());
+            for (auto& [compId, channel] : pending.channels)
+                channel->shutdown();
+            if (pending.cb)
+                pending.cb({});
+        },
+        delay);
+}
+
+void
+MediaChannelHandler::connect(const DeviceId& deviceId, const std::string& name, ConnectCb&& cb)
+{
+    connectionManager_.connectDevice(deviceId, name, std::move(cb));
+}
+
+bool
+MediaChannelHandler::onRequest(const std::shared_ptr<dht::crypto::Certificate>& cert,
+                               const std::string& name)
+{
+    if (!cert)
+        return false;
+    auto [token, compId] = parseName(name);
+    if (token.empty() or compId == 0)
+        return false;
+    std::lock_guard<std::mutex> lk(state_->mutex);
+#ifdef DRING_TESTABLE
+    if (state_->refuse)
+        return false;
+#endif
+    auto it = state_->pending.find(token);
+    return it != state_->pending.end() and it->second.deviceId == cert->getLongId();
+}
+
+void
+MediaChannelHandler::onReady(const std::shared_ptr<dht::crypto::Certificate>&,
+                             const std::string& name,
+                             std::shared_ptr<ChannelSocket> channel)
+{
+    auto [token, compId] = parseName(name);
+    onChannel(state_, token, compId, std::move(channel));
+}
+
+void
+MediaChannelHandler::onChannel(const std::shared_ptr<State>& state,
+                               const std::string& token,
+                               unsigned compId,
+                               std::shared_ptr<ChannelSocket> channel)
+{
+    if (channel and channel->isReliable()) {
+        // Media is only carried in datagrams, never behind a lost TCP segment
+        JAMI_WARN("Media channels %s refused over a reliable connection", token.c_str());
+        channel->shutdown();
+        channel.reset();
+    }
+    std::unique_lock<std::mutex> lk(state->mutex);
+    auto it = state->pending.find(token);
+    if (it == state->pending.end()) {
+        lk.unlock();
+        if (channel)
+            channel->shutdown();
+        return;
+    }
+    auto& pending = it->second;
+    if (channel) {
+        channel->setDatagram(true);
+        // The peer gave up (e.g. falling back to ICE): fail now rather than on timeout
+        channel->onShutdown([w = std::weak_ptr<State>(state), token, compId] {
+            if (auto state = w.lock())
+                onChannel(state, token, compId, nullptr);
+        });
+    } else {
+        // Failed to open a channel, give up
+        auto failed = std::move(pending);
+        state->pending.erase(it);
+        lk.unlock();
+        if (failed.timeout)
+            failed.timeout->cancel();
+        for (auto& [id, c] : failed.channels)
+            c->shutdown();
+        if (failed.cb)
+            failed.cb({});
+        return;
+    }
+    pending.channels[compId] = std::move(channel);
+    if (not pending.cb or pending.channels.size() < pending.compIds.size())
+        return;
+    auto ready = std::move(pending);
+    state->pending.erase(it);
+    lk.unlock();
+    if (ready.timeout)
+        ready.timeout->cancel();
+    ready.cb(std::move(ready.channels));
+}
+
+void
+MediaChannelHandler::accept(const std::string& token, const DeviceId& deviceId)
+{
+    std::lock_guard<std::mutex> lk(state_->mutex);
+    auto& pending = state_->pending[token];
+    pending.deviceId = deviceId;
+    expire(state_, token, ACCEPT_TIMEOUT, pending);
+}
+
+void
+MediaChannelHandler::getChannels(const std::string& token,
+                                 const DeviceId& deviceId,
+                                 const std::vector<unsigned>& compIds,
+                                 bool initiator,
+                                 OnChannels&& cb)
+{
+    {
+        std::unique_lock<std::mutex> lk(state_->mutex);
+        auto& pending = state_->pending[token];
+        pending.deviceId = deviceId;
+        pending.compIds = compIds;
+        pending.cb = std::move(cb);
+        expire(state_, token, CHANNELS_TIMEOUT, pending);
+        if (not initiator and pending.channels.size() >= compIds.size()) {
+            // All channels were opened before the media negotiation ended
+            auto ready = std::move(pending);
+            state_->pending.erase(token);
+            lk.unlock();
+            ready.timeout->cancel();
+            ready.cb(std::move(ready.channels));
+            return;
+        }
+    }
+    if (not initiator)
+        return;
+    for (auto compId : compIds) {
+        connect(deviceId,
+                fmt::format("{}{}/{}", MEDIA_URI, token, compId),
+                [w = std::weak_ptr<State>(state_), token, compId](std::shared_ptr<ChannelSocket> socket,
+                                                                  const DeviceId&) {
+                    if (auto state = w.lock())
+                        onChannel(state, token, compId, std::move(socket));
+                });
+    }
+}
+
+} // namespace jami
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#pragma once
+
+#include "jamidht/channel_handler.h"
+#include "jamidht/connectionmanager.h"
+#include "jamidht/jamiaccount.h"
+
+namespace jami {
+
+/**
+ * Manages the channels carrying the media of a call (one per RTP/RTCP component)
+ * over the connection already used for its SIP channel.
+ * Channels are named media://<token>/<compId>, the token being negotiated in SDP.
+ * They send unreliable datagrams, so they are refused over a reliable (ICE-TCP) connection.
+ */
+class MediaChannelHandler : public ChannelHandlerInterface
+{
+public:
+    using OnChannels = std::function<void(SIPAccountBase::MediaChannels&&)>;
+
+    MediaChannelHandler(const std::shared_ptr<JamiAccount>& acc, ConnectionManager& cm);
+    ~MediaChannelHandler();
+
+    /**
+     * Open a media channel
+     * @param deviceId      The device to connect
+     * @param name          media://<token>/<compId>
+     * @param cb            The callback to call when connected
+     */
+    void connect(const DeviceId& deviceId, const std::string& name, ConnectCb&& cb) override;
+
+    /**
+     * Accept channels only for tokens announced with accept() or getChannels()
+     * @param peer          Peer who asked
+     * @param name          Name asked
+     */
+    bool onRequest(const std::shared_ptr<dht::crypto::Certificate>& peer,
+                   const std::string& name) override;
+
+    /**
+     * Give the channel to the call waiting for it
+     * @param peer          Connected peer
+     * @param name          Name asked
+     * @param channel       Media channel
+     */
+    void onReady(const std::shared_ptr<dht::crypto::Certificate>& peer,
+                 const std::string& name,
+                 std::shared_ptr<ChannelSocket> channel) override;
+
+    /**
+     * Allow deviceId to open the channels of token
+     * @note must be called before the peer knows the token (i.e. before sending the SDP)
+     */
+    void accept(const std::string& token, const DeviceId& deviceId);
+
+    /**
+     * Open (initiator) or wait for the channels of token
+     * @param cb    called once, with all the channels or with none on failure/timeout
+     */
+    void getChannels(const std::string& token,
+                     const DeviceId& deviceId,
+                     const std::vector<unsigned>& compIds,
+                     bool initiator,
+                     OnChannels&& cb);
+
+#ifdef DRING_TESTABLE
+    /**
+     * Refuse the channels asked by peers, so that calls fall back to ICE
+     */
+    void refuse(bool refuse) { state_->refuse = refuse; }
+#endif
+
+private:
+    struct Pending
+    {
+        DeviceId deviceId;
+        std::vector<unsigned> compIds {};
+        SIPAccountBase::MediaChannels channels {};
+        OnChannels cb {};
+        std::shared_ptr<Task> timeout {};
+    };
+    struct State
+    {
+        std::mutex mutex;
+        std::map<std::string, Pending> pending;
+#ifdef DRING_TESTABLE
+        std::atomic_bool refuse {false};
+#endif
+    };
+
+    static std::pair<std::string, unsigned> parseName(std::string_view name);
+    static void expire(const std::weak_ptr<State>& state,
+                       const std::string& token,
+                       std::chrono::seconds delay,
+                       Pending& pending);
+    static void onChannel(const std::shared_ptr<State>& state,
+                          const std::string& token,
+                          unsigned compId,
+                          std::shared_ptr<ChannelSocket> channel);
+
+    std::weak_ptr<JamiAccount> account_;
+    ConnectionManager& connectionManager_;
+    std::shared_ptr<State> state_;
+};
+
+} // namespace jami
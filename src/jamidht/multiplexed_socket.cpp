@@ -17,10 +17,13 @@
  */
 
 #include "logger.h"
+#include "cpu_accounting.h"
+#include "memory_accounting.h"
 #include "manager.h"
 #include "multiplexed_socket.h"
 #include "peer_connection.h"
 #include "ice_transport.h"
+#include "reliable_streams.h"
 #include "security/certstore.h"
 
 #include <deque>
@@ -62,7 +65,9 @@ public:
         : parent_(parent)
         , deviceId(deviceId)
         , endpoint(std::move(endpoint))
+        , streams_(makeStreams())
         , eventLoopThread_ {[this] {
+            CpuAccounting::getInstance().registerThread("tls", "mxsock");
             try {
                 eventLoop();
             } catch (const std::exception& e) {
@@ -72,7 +77,39 @@ public:
         }}
     {}
 
-    ~Impl() {}
+    ~Impl()
+    {
+        if (streams_)
+            streams_->close();
+    }
+
+    /**
+     * Over DTLS (ICE-UDP), each channel is a reliable stream of its own, so that a lost
+     * datagram only delays the channel it belongs to.
+     */
+    std::shared_ptr<ReliableStreams> makeStreams()
+    {
+        if (!endpoint || endpoint->isReliable())
+            return {};
+        return std::make_shared<ReliableStreams>(
+            Manager::instance().scheduler(),
+            [this](const uint8_t* data, std::size_t size) {
+                std::error_code ec;
+                std::lock_guard<std::mutex> lk(writeMtx);
+                // Errors are handled as losses, a dead session is detected by the reader
+                return endpoint->write(data, size, ec) == size and not ec;
+            },
+            [this] {
+                try {
+                    return endpoint->maxPayload();
+                } catch (const std::exception&) {
+                    return 0;
+                }
+            },
+            [this](uint16_t channel, std::vector<uint8_t>&& data) {
+                handleMessage(channel, std::move(data));
+            });
+    }
 
     void join()
     {
@@ -109,6 +146,8 @@ public:
             return;
         stop.store(true);
         isShutdown_ = true;
+        if (streams_)
+            streams_->close();
         if (beaconTask_)
             beaconTask_->cancel();
         if (onShutdown_)
@@ -152,6 +191,7 @@ public:
      * Triggered when a new packet on a channel is received
      */
     void handleChannelPacket(uint16_t channel, std::vector<uint8_t>&& pkt);
+    void handleMessage(uint16_t channel, std::vector<uint8_t>&& pkt);
     void onRequest(const std::string& name, uint16_t channel);
     void onAccept(const std::string& name, uint16_t channel);
 
@@ -177,6 +217,8 @@ public:
     DeviceId deviceId {};
     // Main socket
     std::unique_ptr<TlsSocketEndpoint> endpoint {};
+    // Per-channel streams, when the endpoint is not reliable
+    std::shared_ptr<ReliableStreams> streams_ {};
 
     std::mutex socketsMutex {};
     std::map<uint16_t, std::shared_ptr<ChannelSocket>> sockets {};
@@ -190,6 +232,8 @@ public:
     std::mutex writeMtx {};
 
     time_point start_ {clock::now()};
+    mutable std::mutex timelineMtx_ {};
+    ConnectionTimeline timeline_ {};
     std::shared_ptr<Task> beaconTask_ {};
 
     // version related stuff
@@ -233,17 +277,18 @@ MultiplexedSocket::Impl::eventLoop()
             break;
         }
 
+        if (streams_) {
+            // One DTLS record per read
+            streams_->onDatagram(reinterpret_cast<const uint8_t*>(pac_.buffer()), size);
+            continue;
+        }
+
         pac_.buffer_consumed(size);
         msgpack::object_handle oh;
         while (pac_.next(oh) && !stop) {
             try {
                 auto msg = oh.get().as<ChanneledMessage>();
-                if (msg.channel == CONTROL_CHANNEL)
-                    handleControlPacket(std::move(msg.data));
-                else if (msg.channel == PROTOCOL_CHANNEL)
-                    handleProtocolPacket(std::move(msg.data));
-                else
-                    handleChannelPacket(msg.channel, std::move(msg.data));
+                handleMessage(msg.channel, std::move(msg.data));
             } catch (const std::exception& E) {
                 JAMI_WARN("Failed to unpacked message of %d bytes: %s", size, E.what());
             } catch (...) {
@@ -253,6 +298,17 @@ MultiplexedSocket::Impl::eventLoop()
     }
 }
 
+void
+MultiplexedSocket::Impl::handleMessage(uint16_t channel, std::vector<uint8_t>&& pkt)
+{
+    if (channel == CONTROL_CHANNEL)
+        handleControlPacket(std::move(pkt));
+    else if (channel == PROTOCOL_CHANNEL)
+        handleProtocolPacket(std::move(pkt));
+    else
+        handleChannelPacket(channel, std::move(pkt));
+}
+
 void
 MultiplexedSocket::Impl::onAccept(const std::string& name, uint16_t channel)
 {
@@ -268,9 +324,11 @@ MultiplexedSocket::Impl::onAccept(const std::string& name, uint16_t channel)
     // Due to the callbacks that can take some time, onAccept can arrive after
     // receiving all the data. In this case, the socket should be removed here
     // as handle by onChannelReady_
-    if (socket->isRemovable())
+    if (socket->isRemovable()) {
         sockets.erase(channel);
-    else
+        if (streams_)
+            streams_->closeChannel(channel);
+    } else
         socket->answered();
 }
 
@@ -424,6 +482,8 @@ MultiplexedSocket::Impl::handleControlPacket(std::vector<uint8_t>&& pkt)
                     if (channel != pimpl.sockets.end()) {
                         channel->second->stop();
                         pimpl.sockets.erase(channel);
+                        if (pimpl.streams_)
+                            pimpl.streams_->closeChannel(req.channel);
                     }
                 } else if (pimpl.onRequest_) {
                     pimpl.onRequest(req.name, req.channel);
@@ -438,22 +498,32 @@ MultiplexedSocket::Impl::handleControlPacket(std::vector<uint8_t>&& pkt)
 void
 MultiplexedSocket::Impl::handleChannelPacket(uint16_t channel, std::vector<uint8_t>&& pkt)
 {
-    std::lock_guard<std::mutex> lkSockets(socketsMutex);
-    auto sockIt = sockets.find(channel);
-    if (channel > 0 && sockIt->second) {
-        if (pkt.size() == 0) {
-            sockIt->second->stop();
-            if (sockIt->second->isAnswered())
-                sockets.erase(sockIt);
-            else
-                sockIt->second->removable(); // This means that onAccept didn't happen yet, will be
-                                             // removed later.
-        } else {
-            sockIt->second->onRecv(std::move(pkt));
+    std::shared_ptr<ChannelSocket> socket;
+    {
+        std::lock_guard<std::mutex> lkSockets(socketsMutex);
+        auto sockIt = sockets.find(channel);
+        if (channel > 0 && sockIt != sockets.end() && sockIt->second) {
+            if (pkt.size() == 0) {
+                sockIt->second->stop();
+                if (sockIt->second->isAnswered()) {
+                    sockets.erase(sockIt);
+                    if (streams_)
+                        streams_->closeChannel(channel);
+                } else {
+                    sockIt->second->removable(); // This means that onAccept didn't happen yet, will
+                                                 // be removed later.
+                }
+                return;
+            }
+            socket = sockIt->second;
+        } else if (pkt.size() != 0) {
+            JAMI_WARN("Non existing channel: %u", channel);
+            return;
         }
-    } else if (pkt.size() != 0) {
-        JAMI_WARN("Non existing channel: %u", channel);
     }
+    // Outside of socketsMutex, as it may wait for the reader (backpressure)
+    if (socket)
+        socket->onRecv(std::move(pkt));
 }
 
 bool
@@ -597,6 +667,15 @@ MultiplexedSocket::write(const uint16_t& channel,
         ec = std::make_error_code(std::errc::message_size);
         return -1;
     }
+    if (pimpl_->streams_) {
+        if (not pimpl_->streams_->send(channel, buf, len, ec)) {
+            if (ec)
+                JAMI_ERR("Error when writing on socket: %s", ec.message().c_str());
+            shutdown();
+            return -1;
+        }
+        return len;
+    }
     bool oneShot = len < 8192;
     msgpack::sbuffer buffer(oneShot ? 16 + len : 16);
     msgpack::packer<msgpack::sbuffer> pk(&buffer);
@@ -624,6 +703,25 @@ MultiplexedSocket::write(const uint16_t& channel,
     return res;
 }
 
+std::size_t
+MultiplexedSocket::writeDatagram(const uint16_t& channel,
+                                 const uint8_t* buf,
+                                 std::size_t len,
+                                 std::error_code& ec)
+{
+    if (pimpl_->isShutdown_) {
+        ec = std::make_error_code(std::errc::broken_pipe);
+        return -1;
+    }
+    if (not pimpl_->streams_) {
+        ec = std::make_error_code(std::errc::operation_not_supported);
+        return -1;
+    }
+    if (not pimpl_->streams_->sendDatagram(channel, buf, len, ec))
+        return -1;
+    return len;
+}
+
 void
 MultiplexedSocket::shutdown()
 {
@@ -665,6 +763,27 @@ MultiplexedSocket::monitor() const
     const auto& ice = underlyingICE();
     if (ice)
         JAMI_DBG("\t- Ice connection: %s", ice->link().c_str());
+    if (const auto& streams = pimpl_->streams_)
+        JAMI_DBG("\t- Streams over DTLS: cwnd %zu, srtt %ld ms, %lu retransmissions, "
+                 "%lu datagrams dropped",
+                 streams->congestionWindow(),
+                 std::chrono::duration_cast<std::chrono::milliseconds>(streams->smoothedRtt())
+                     .count(),
+                 streams->retransmissions(),
+                 streams->datagramsDropped());
+    auto tl = timeline();
+    if (tl.start != time_point {} and tl.tlsReady != time_point {}) {
+        auto ms = [&](time_point t) -> long {
+            if (t == time_point {})
+                return -1;
+            return std::chrono::duration_cast<std::chrono::milliseconds>(t - tl.start).count();
+        };
+        JAMI_DBG("\t- Setup (ms): ICE gather %ld, DHT answer %ld, ICE check %ld, TLS %ld",
+                 ms(tl.iceGathered),
+                 ms(tl.dhtAnswered),
+                 ms(tl.iceConnected),
+                 ms(tl.tlsReady));
+    }
     std::lock_guard<std::mutex> lk(pimpl_->socketsMutex);
     for (const auto& [_, channel] : pimpl_->sockets) {
         if (channel)
@@ -672,6 +791,20 @@ MultiplexedSocket::monitor() const
     }
 }
 
+void
+MultiplexedSocket::setTimeline(const ConnectionTimeline& timeline)
+{
+    std::lock_guard<std::mutex> lk(pimpl_->timelineMtx_);
+    pimpl_->timeline_ = timeline;
+}
+
+ConnectionTimeline
+MultiplexedSocket::timeline() const
+{
+    std::lock_guard<std::mutex> lk(pimpl_->timelineMtx_);
+    return pimpl_->timeline_;
+}
+
 void
 MultiplexedSocket::sendBeacon(const std::chrono::milliseconds& timeout)
 {
@@ -749,8 +882,10 @@ public:
 
     bool isAnswered_ {false};
     bool isRemovable_ {false};
+    std::atomic_bool datagram_ {false};
 
     std::vector<uint8_t> buf {};
+    TrackedBytes<MemoryPool::CHANNEL_RX> bufMemory {};
     std::mutex mutex {};
     std::condition_variable cv {};
     GenericSocket<uint8_t>::RecvCb cb {};
@@ -814,6 +949,12 @@ ChannelSocket::maxPayload() const
     return -1;
 }
 
+void
+ChannelSocket::setDatagram(bool datagram)
+{
+    pimpl_->datagram_ = datagram;
+}
+
 void
 ChannelSocket::setOnRecv(RecvCb&& cb)
 {
@@ -822,13 +963,33 @@ ChannelSocket::setOnRecv(RecvCb&& cb)
     if (!pimpl_->buf.empty() && pimpl_->cb) {
         pimpl_->cb(pimpl_->buf.data(), pimpl_->buf.size());
         pimpl_->buf.clear();
+        pimpl_->buf.shrink_to_fit();
+        pimpl_->bufMemory.update(0);
     }
 }
 
 void
 ChannelSocket::onRecv(std::vector<uint8_t>&& pkt)
 {
-    std::lock_guard<std::mutex> lkSockets(pimpl_->mutex);
+    std::unique_lock<std::mutex> lkSockets(pimpl_->mutex);
+    if (pimpl_->datagram_) {
+        // Datagrams are not merged in a byte stream, nor kept for a later reader
+        if (pimpl_->cb)
+            pimpl_->cb(&pkt[0], pkt.size());
+        return;
+    }
+    // Over budget: the event loop is shared by all channels and can't wait for
+    // this reader, and a byte stream can't skip data, so the channel is closed
+    auto limit = MemoryAccounting::softLimit(MemoryPool::CHANNEL_RX);
+    if (limit && !pimpl_->cb && pimpl_->buf.size() + pkt.size() > limit) {
+        MemoryAccounting::dropped(MemoryPool::CHANNEL_RX, pkt.size());
+        lkSockets.unlock();
+        JAMI_WARN("Channel %s is not read, its buffer exceeds %zu bytes",
+                  pimpl_->name.c_str(),
+                  limit);
+        shutdown();
+        return;
+    }
     if (pimpl_->cb) {
         pimpl_->cb(&pkt[0], pkt.size());
         return;
@@ -836,6 +997,7 @@ ChannelSocket::onRecv(std::vector<uint8_t>&& pkt)
     pimpl_->buf.insert(pimpl_->buf.end(),
                        std::make_move_iterator(pkt.begin()),
                        std::make_move_iterator(pkt.end()));
+    pimpl_->bufMemory.update(pimpl_->buf.capacity());
     pimpl_->cv.notify_all();
 }
 
@@ -933,6 +1095,8 @@ ChannelSocket::write(const ValueType* buf, std::size_t len, std::error_code& ec)
         return -1;
     }
     if (auto ep = pimpl_->endpoint.lock()) {
+        if (pimpl_->datagram_)
+            return ep->writeDatagram(pimpl_->channel, buf, len, ec);
         std::size_t sent = 0;
         do {
             std::size_t toSend = std::min(static_cast<std::size_t>(UINT16_MAX), len - sent);
@@ -59,6 +59,19 @@ struct ChannelRequest
     MSGPACK_DEFINE(name, channel, state)
 };
 
+/**
+ * When each step of the setup of a connection was reached (unset if skipped)
+ */
+struct ConnectionTimeline
+{
+    using time_point = std::chrono::steady_clock::time_point;
+    time_point start {};        // Connection requested or peer request received
+    time_point iceGathered {};  // Local ICE candidates ready
+    time_point dhtAnswered {};  // Peer answer received or our answer sent through the DHT
+    time_point iceConnected {}; // ICE negotiation succeeded
+    time_point tlsReady {};     // TLS handshake done
+};
+
 /**
  * A socket divided in channels over a TLS session
  */
@@ -104,6 +117,15 @@ public:
                       const uint8_t* buf,
                       std::size_t len,
                       std::error_code& ec);
+    /**
+     * Send buf in one unreliable datagram, only over a datagram (DTLS) connection.
+     * Datagrams that the connection fails to send are dropped, never retried.
+     * @return len, or -1 with ec set if not supported or if buf does not fit
+     */
+    std::size_t writeDatagram(const uint16_t& channel,
+                              const uint8_t* buf,
+                              std::size_t len,
+                              std::error_code& ec);
 
     /**
      * This will close all channels and send a TLS EOF on the main socket.
@@ -120,6 +142,12 @@ public:
 
     std::shared_ptr<IceTransport> underlyingICE() const;
 
+    /**
+     * Setup steps of the connection, set by the ConnectionManager before use
+     */
+    void setTimeline(const ConnectionTimeline& timeline);
+    ConnectionTimeline timeline() const;
+
     /**
      * Get informations from socket (channels opened)
      */
@@ -193,6 +221,11 @@ public:
     bool isReliable() const override;
     bool isInitiator() const override;
     int maxPayload() const override;
+    /**
+     * Send each write in one unreliable datagram (e.g. for RTP), without retransmission
+     * or ordering. Only valid if the connection is not reliable (see isReliable()).
+     */
+    void setDatagram(bool datagram);
     /**
      * Like shutdown, but don't send any packet on the socket.
      * Used by Multiplexed Socket when the TLS endpoint is already shutting down
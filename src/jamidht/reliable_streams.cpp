@@ -0,0 +1,740 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+#include "reliable_streams.h"
+
+#include "logger.h"
+#include "scheduled_executor.h"
+
+#include <opendht/thread_pool.h>
+
+#include <algorithm>
+
+namespace jami {
+
+static constexpr uint8_t FRAME_DATA {1};
+static constexpr uint8_t FRAME_ACK {2};
+static constexpr uint8_t FRAME_DATAGRAM {3};
+static constexpr std::size_t DATA_HEADER {1 + 2 + 8};
+static constexpr std::size_t DATAGRAM_HEADER {1 + 2};
+static constexpr std::size_t ACK_HEADER {1 + 2 + 8 + 1};
+static constexpr std::size_t MIN_SEGMENT {256};
+static constexpr int DEFAULT_DATAGRAM {1200};
+static constexpr std::size_t INITIAL_WINDOW {10};    // segments
+static constexpr std::size_t MAX_WINDOW {8 * 1024 * 1024};
+static constexpr unsigned DUP_THRESHOLD {3};         // later ranges acknowledged to declare a loss
+static constexpr unsigned ACK_EVERY {2};             // data frames
+
+static void
+put16(std::vector<uint8_t>& out, uint16_t v)
+{
+    out.push_back(v >> 8);
+    out.push_back(v);
+}
+
+static void
+put64(std::vector<uint8_t>& out, uint64_t v)
+{
+    for (int shift = 56; shift >= 0; shift -= 8)
+        out.push_back(v >> shift);
+}
+
+// Set while a thread delivers the messages of a ReliableStreams
+static thread_local const ReliableStreams* deliveringStreams {nullptr};
+
+static uint16_t
+get16(const uint8_t* p)
+{
+    return (uint16_t(p[0]) << 8) | p[1];
+}
+
+static uint64_t
+get64(const uint8_t* p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+ReliableStreams::ReliableStreams(ScheduledExecutor& executor,
+                                 SendFunc&& send,
+                                 MaxPayloadFunc&& maxPayload,
+                                 OnMessage&& onMessage)
+    : executor_(executor)
+    , send_(std::move(send))
+    , maxPayload_(std::move(maxPayload))
+    , onMessage_(std::move(onMessage))
+{}
+
+ReliableStreams::~ReliableStreams()
+{
+    close();
+}
+
+void
+ReliableStreams::close()
+{
+    std::shared_ptr<RepeatedTask> timer;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        closed_ = true;
+        timer = std::move(timer_);
+        timerActive_ = false;
+    }
+    cv_.notify_all();
+    if (timer)
+        timer->cancel();
+    {
+        // Wait for the handlers, unless closed by one of them
+        std::unique_lock<std::mutex> lk(deliveryMutex_);
+        unsigned self = deliveringStreams == this ? 1 : 0;
+        deliveryCv_.wait(lk, [&] { return delivering_ == self; });
+        deliveries_.clear();
+    }
+    // Wait for datagrams being sent
+    std::lock_guard<std::mutex> lk(sendMutex_);
+    std::lock_guard<std::mutex> lkd(datagramMutex_);
+}
+
+bool
+ReliableStreams::send(uint16_t channel, const uint8_t* data, std::size_t size, std::error_code& ec)
+{
+    if (size > UINT16_MAX) {
+        ec = std::make_error_code(std::errc::message_size);
+        return false;
+    }
+    Datagrams out;
+    {
+        std::unique_lock<std::mutex> lk(mutex_);
+        // A closed channel number is reused once its last bytes are acknowledged
+        cv_.wait(lk, [&] {
+            auto it = streams_.find(channel);
+            return closed_ or it == streams_.end() or not it->second.closing;
+        });
+        closedChannels_.erase(channel);
+        auto& stream = streams_[channel];
+        cv_.wait(lk, [&] { return closed_ or stream.sndEnd - stream.sndUna < SEND_BUFFER; });
+        if (closed_) {
+            ec = std::make_error_code(std::errc::broken_pipe);
+            return false;
+        }
+        std::vector<uint8_t> chunk;
+        chunk.reserve(2 + size);
+        put16(chunk, size);
+        chunk.insert(chunk.end(), data, data + size);
+        auto len = chunk.size();
+        stream.chunks.emplace_back(stream.sndEnd, std::move(chunk));
+        stream.sndEnd += len;
+        sendable_.emplace(channel);
+        transmit(out);
+        ensureTimer();
+    }
+    flush(out);
+    ec.clear();
+    return true;
+}
+
+bool
+ReliableStreams::sendDatagram(uint16_t channel,
+                              const uint8_t* data,
+                              std::size_t size,
+                              std::error_code& ec)
+{
+    auto mtu = maxPayload_ ? maxPayload_() : 0;
+    if (mtu <= 0)
+        mtu = DEFAULT_DATAGRAM;
+    if (size == 0 or size + DATAGRAM_HEADER > static_cast<std::size_t>(mtu)) {
+        ec = std::make_error_code(std::errc::message_size);
+        return false;
+    }
+    std::vector<uint8_t> frame;
+    frame.reserve(DATAGRAM_HEADER + size);
+    frame.emplace_back(FRAME_DATAGRAM);
+    put16(frame, channel);
+    frame.insert(frame.end(), data, data + size);
+
+    std::lock_guard<std::mutex> lk(datagramMutex_);
+    if (closed_) {
+        ec = std::make_error_code(std::errc::broken_pipe);
+        return false;
+    }
+    if (not send_(frame.data(), frame.size()))
+        datagramsDropped_++;
+    ec.clear();
+    return true;
+}
+
+void
+ReliableStreams::onDatagram(const uint8_t* data, std::size_t size)
+{
+    if (size > DATAGRAM_HEADER and data[0] == FRAME_DATAGRAM) {
+        if (not closed_)
+            onMessage_(get16(data + 1),
+                       std::vector<uint8_t>(data + DATAGRAM_HEADER, data + size));
+        return;
+    }
+    if (size < DATA_HEADER)
+        return;
+    auto type = data[0];
+    auto channel = get16(data + 1);
+    auto offset = get64(data + 3);
+
+    Datagrams out;
+    std::vector<std::vector<uint8_t>> messages;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (closed_)
+            return;
+        if (type == FRAME_DATA) {
+            onData(channel, offset, data + DATA_HEADER, size - DATA_HEADER, out, messages);
+        } else if (type == FRAME_ACK and size >= ACK_HEADER) {
+            std::size_t count = data[ACK_HEADER - 1];
+            if (size < ACK_HEADER + count * 16)
+                return;
+            std::vector<std::pair<uint64_t, uint64_t>> sack;
+            sack.reserve(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                auto p = data + ACK_HEADER + i * 16;
+                sack.emplace_back(get64(p), get64(p + 8));
+            }
+            auto stream = streams_.find(channel);
+            if (stream != streams_.end()) {
+                onAck(stream->second, offset, sack);
+                eraseIfClosed(stream);
+            }
+        } else {
+            return;
+        }
+        transmit(out);
+        ensureTimer();
+    }
+    flush(out);
+    if (not messages.empty())
+        deliver(channel, std::move(messages));
+}
+
+void
+ReliableStreams::deliver(uint16_t channel, std::vector<std::vector<uint8_t>>&& messages)
+{
+    std::lock_guard<std::mutex> lk(deliveryMutex_);
+    if (closed_)
+        return;
+    auto [it, idle] = deliveries_.try_emplace(channel);
+    it->second.insert(it->second.end(),
+                      std::make_move_iterator(messages.begin()),
+                      std::make_move_iterator(messages.end()));
+    if (idle)
+        dht::ThreadPool::io().run([w = weak_from_this(), channel] {
+            if (auto shared = w.lock())
+                shared->drain(channel);
+        });
+}
+
+void
+ReliableStreams::drain(uint16_t channel)
+{
+    std::unique_lock<std::mutex> lk(deliveryMutex_);
+    if (closed_)
+        return;
+    ++delivering_;
+    auto previous = deliveringStreams;
+    deliveringStreams = this;
+    while (not closed_) {
+        auto it = deliveries_.find(channel);
+        if (it == deliveries_.end())
+            break;
+        if (it->second.empty()) {
+            deliveries_.erase(it);
+            break;
+        }
+        auto message = std::move(it->second.front());
+        it->second.pop_front();
+        lk.unlock();
+        onMessage_(channel, std::move(message));
+        lk.lock();
+    }
+    deliveringStreams = previous;
+    --delivering_;
+    deliveryCv_.notify_all();
+}
+
+void
+ReliableStreams::closeChannel(uint16_t channel)
+{
+    Datagrams out;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = streams_.find(channel);
+        if (closed_ or it == streams_.end())
+            return;
+        if (it->second.ackDeadline != clock::time_point {})
+            makeAck(channel, it->second, out);
+        it->second.closing = true;
+        eraseIfClosed(it);
+        // Expires the closed channel
+        ensureTimer();
+    }
+    flush(out);
+}
+
+bool
+ReliableStreams::eraseIfClosed(std::map<uint16_t, Stream>::iterator it)
+{
+    auto& stream = it->second;
+    if (not stream.closing or stream.sndUna != stream.sndEnd)
+        return false;
+    closedChannels_[it->first] = {stream.rcvNxt, clock::now() + CLOSE_LINGER};
+    streams_.erase(it);
+    cv_.notify_all();
+    return true;
+}
+
+std::size_t
+ReliableStreams::congestionWindow() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return cwnd_;
+}
+
+ReliableStreams::clock::duration
+ReliableStreams::smoothedRtt() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return srtt_;
+}
+
+uint64_t
+ReliableStreams::datagramsDropped() const
+{
+    return datagramsDropped_;
+}
+
+uint64_t
+ReliableStreams::retransmissions() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return retransmissions_;
+}
+
+std::size_t
+ReliableStreams::segmentSize() const
+{
+    auto mtu = maxPayload_ ? maxPayload_() : 0;
+    if (mtu <= 0)
+        mtu = DEFAULT_DATAGRAM;
+    return std::max(static_cast<std::size_t>(mtu) - std::min<std::size_t>(mtu, DATA_HEADER),
+                    MIN_SEGMENT);
+}
+
+void
+ReliableStreams::copyRange(const Stream& stream,
+                           uint64_t begin,
+                           uint64_t end,
+                           std::vector<uint8_t>& out) const
+{
+    // Last chunk starting at or before begin
+    auto it = std::upper_bound(stream.chunks.begin(),
+                               stream.chunks.end(),
+                               begin,
+                               [](uint64_t offset, const auto& chunk) {
+                                   return offset < chunk.first;
+                               });
+    --it;
+    while (begin < end) {
+        auto skip = begin - it->first;
+        auto count = std::min<uint64_t>(it->second.size() - skip, end - begin);
+        out.insert(out.end(), it->second.begin() + skip, it->second.begin() + skip + count);
+        begin += count;
+        ++it;
+    }
+}
+
+void
+ReliableStreams::sendData(
+    uint16_t channel, Stream& stream, uint64_t begin, uint64_t end, Datagrams& out)
+{
+    std::vector<uint8_t> datagram;
+    datagram.reserve(DATA_HEADER + end - begin);
+    datagram.push_back(FRAME_DATA);
+    put16(datagram, channel);
+    put64(datagram, begin);
+    copyRange(stream, begin, end, datagram);
+    out.emplace_back(std::move(datagram));
+}
+
+void
+ReliableStreams::makeAck(uint16_t channel, Stream& stream, Datagrams& out)
+{
+    // Received ranges above rcvNxt, merged
+    std::vector<std::pair<uint64_t, uint64_t>> sack;
+    for (const auto& [begin, data] : stream.outOfOrder) {
+        auto end = begin + data.size();
+        if (not sack.empty() and begin <= sack.back().second)
+            sack.back().second = std::max(sack.back().second, end);
+        else if (sack.size() < MAX_SACK_RANGES)
+            sack.emplace_back(begin, end);
+        else
+            break;
+    }
+    std::vector<uint8_t> datagram;
+    datagram.reserve(ACK_HEADER + sack.size() * 16);
+    datagram.push_back(FRAME_ACK);
+    put16(datagram, channel);
+    put64(datagram, stream.rcvNxt);
+    datagram.push_back(sack.size());
+    for (const auto& [begin, end] : sack) {
+        put64(datagram, begin);
+        put64(datagram, end);
+    }
+    out.emplace_back(std::move(datagram));
+    stream.unacked = 0;
+    stream.ackDeadline = {};
+}
+
+void
+ReliableStreams::onData(uint16_t channel,
+                        uint64_t offset,
+                        const uint8_t* data,
+                        std::size_t size,
+                        Datagrams& out,
+                        std::vector<std::vector<uint8_t>>& messages)
+{
+    auto it = streams_.find(channel);
+    if (it == streams_.end()) {
+        auto closed = closedChannels_.find(channel);
+        if (closed != closedChannels_.end()) {
+            // A new stream starts at 0: a range of it is never taken for a retransmission
+            if (offset > 0 and offset + size <= closed->second.rcvNxt) {
+                // Retransmitted after the close: our last ACK was lost
+                Stream acked;
+                acked.rcvNxt = closed->second.rcvNxt;
+                makeAck(channel, acked, out);
+                return;
+            }
+            // The peer opened a new channel with the same number
+            closedChannels_.erase(closed);
+        }
+        it = streams_.emplace(channel, Stream {}).first;
+    }
+    auto& stream = it->second;
+    auto end = offset + size;
+    bool ackNow = false;
+
+    if (end <= stream.rcvNxt or offset >= stream.rcvNxt + RECV_WINDOW or size == 0) {
+        // Duplicate (our ACK was lost) or beyond the window
+        ackNow = true;
+    } else if (offset > stream.rcvNxt) {
+        auto& stored = stream.outOfOrder[offset];
+        if (stored.size() < size)
+            stored.assign(data, data + size);
+        ackNow = true;
+    } else {
+        auto skip = stream.rcvNxt - offset;
+        stream.pending.insert(stream.pending.end(), data + skip, data + size);
+        stream.rcvNxt = end;
+        // Filled a gap?
+        while (not stream.outOfOrder.empty()) {
+            auto it = stream.outOfOrder.begin();
+            if (it->first > stream.rcvNxt)
+                break;
+            auto itEnd = it->first + it->second.size();
+            if (itEnd > stream.rcvNxt) {
+                stream.pending.insert(stream.pending.end(),
+                                      it->second.end() - (itEnd - stream.rcvNxt),
+                                      it->second.end());
+                stream.rcvNxt = itEnd;
+            }
+            stream.outOfOrder.erase(it);
+            ackNow = true;
+        }
+
+        // Complete messages
+        std::size_t pos = 0;
+        while (stream.pending.size() - pos >= 2) {
+            std::size_t len = get16(stream.pending.data() + pos);
+            if (stream.pending.size() - pos - 2 < len)
+                break;
+            auto first = stream.pending.begin() + pos + 2;
+            messages.emplace_back(first, first + len);
+            pos += 2 + len;
+        }
+        stream.pending.erase(stream.pending.begin(), stream.pending.begin() + pos);
+        // Acknowledge the end of a message right away, so that the peer samples the RTT
+        ackNow |= ++stream.unacked >= ACK_EVERY or stream.pending.empty();
+    }
+
+    if (ackNow)
+        makeAck(channel, stream, out);
+    else if (stream.ackDeadline == clock::time_point {})
+        stream.ackDeadline = clock::now() + ACK_DELAY;
+}
+
+void
+ReliableStreams::onAck(Stream& stream,
+                       uint64_t next,
+                       const std::vector<std::pair<uint64_t, uint64_t>>& sack)
+{
+    auto now = clock::now();
+    std::size_t acked = 0;
+    clock::time_point sampled {};
+
+    if (next > stream.sndUna and next <= stream.sndNxt) {
+        for (auto it = stream.inFlight.begin();
+             it != stream.inFlight.end() and it->first < next;) {
+            auto begin = it->first;
+            auto range = it->second;
+            it = stream.inFlight.erase(it);
+            if (range.end > next)
+                it = stream.inFlight.emplace_hint(it, next, range);
+            auto count = std::min(range.end, next) - begin;
+            if (not range.sacked and not range.lost) {
+                inFlightBytes_ -= count;
+                acked += count;
+            }
+            if (range.transmissions == 1 and not range.sacked)
+                sampled = std::max(sampled, range.sent);
+        }
+        stream.sndUna = next;
+        while (not stream.chunks.empty()
+               and stream.chunks.front().first + stream.chunks.front().second.size() <= next)
+            stream.chunks.pop_front();
+        cv_.notify_all();
+    }
+
+    for (const auto& [begin, end] : sack) {
+        for (auto it = stream.inFlight.lower_bound(begin);
+             it != stream.inFlight.end() and it->first < end;
+             ++it) {
+            auto& range = it->second;
+            if (range.sacked or range.end > end)
+                continue;
+            if (not range.lost) {
+                inFlightBytes_ -= range.end - it->first;
+                acked += range.end - it->first;
+            }
+            range.sacked = true;
+            range.lost = false;
+            if (range.transmissions == 1)
+                sampled = std::max(sampled, range.sent);
+        }
+    }
+
+    // Fast retransmit: ranges followed by enough acknowledged ranges were lost
+    bool congestion = false;
+    unsigned sackedAfter = 0;
+    for (auto it = stream.inFlight.rbegin(); it != stream.inFlight.rend(); ++it) {
+        auto& range = it->second;
+        if (range.sacked) {
+            ++sackedAfter;
+        } else if (not range.lost and sackedAfter >= DUP_THRESHOLD) {
+            congestion |= range.sent > recoveryStart_;
+            markLost(range, it->first);
+        }
+    }
+
+    if (sampled != clock::time_point {})
+        onRttSample(now - sampled);
+    if (congestion)
+        onCongestion(false);
+    else if (acked)
+        onAcked(acked);
+}
+
+void
+ReliableStreams::markLost(InFlight& range, uint64_t begin)
+{
+    if (range.lost or range.sacked)
+        return;
+    inFlightBytes_ -= range.end - begin;
+    range.lost = true;
+}
+
+void
+ReliableStreams::onCongestion(bool timeout)
+{
+    auto segment = segmentSize();
+    ssthresh_ = std::max(cwnd_ / 2, 2 * segment);
+    cwnd_ = timeout ? 2 * segment : ssthresh_;
+    recoveryStart_ = clock::now();
+}
+
+void
+ReliableStreams::onAcked(std::size_t bytes)
+{
+    if (cwnd_ < ssthresh_)
+        cwnd_ += bytes;
+    else
+        cwnd_ += std::max<std::size_t>(1, segmentSize() * bytes / cwnd_);
+    cwnd_ = std::min(cwnd_, MAX_WINDOW);
+}
+
+void
+ReliableStreams::onRttSample(clock::duration rtt)
+{
+    // RFC 6298
+    if (srtt_ == clock::duration::zero()) {
+        srtt_ = rtt;
+        rttvar_ = rtt / 2;
+    } else {
+        auto delta = srtt_ > rtt ? srtt_ - rtt : rtt - srtt_;
+        rttvar_ = (3 * rttvar_ + delta) / 4;
+        srtt_ = (7 * srtt_ + rtt) / 8;
+    }
+    rto_ = std::clamp<clock::duration>(srtt_ + std::max<clock::duration>(TICK, 4 * rttvar_),
+                                       MIN_RTO,
+                                       MAX_RTO);
+}
+
+void
+ReliableStreams::transmit(Datagrams& out)
+{
+    if (closed_)
+        return;
+    auto segment = segmentSize();
+    if (cwnd_ == 0)
+        cwnd_ = INITIAL_WINDOW * segment;
+    auto now = clock::now();
+
+    // Lost ranges first, in datagrams of the current size (the path MTU may have decreased).
+    // The first one goes even if the window is full.
+    bool first = true;
+    for (auto& [channel, stream] : streams_) {
+        for (auto it = stream.inFlight.begin(); it != stream.inFlight.end();) {
+            if (not it->second.lost or (not first and inFlightBytes_ >= cwnd_)) {
+                ++it;
+                continue;
+            }
+            first = false;
+            auto begin = it->first;
+            auto range = it->second;
+            it = stream.inFlight.erase(it);
+            while (begin < range.end) {
+                auto end = std::min(range.end, begin + segment);
+                sendData(channel, stream, begin, end, out);
+                InFlight resent {end, now, range.transmissions + 1};
+                it = std::next(stream.inFlight.emplace_hint(it, begin, resent));
+                inFlightBytes_ += end - begin;
+                ++retransmissions_;
+                begin = end;
+            }
+        }
+    }
+
+    // New data, one segment per channel in turn
+    bool progress = true;
+    while (progress and inFlightBytes_ < cwnd_ and not sendable_.empty()) {
+        progress = false;
+        std::vector<uint16_t> round(sendable_.lower_bound(nextServed_), sendable_.end());
+        round.insert(round.end(), sendable_.begin(), sendable_.lower_bound(nextServed_));
+        for (auto channel : round) {
+            if (inFlightBytes_ >= cwnd_)
+                break;
+            auto& stream = streams_[channel];
+            if (stream.sndNxt - stream.sndUna >= RECV_WINDOW)
+                continue;
+            auto end = std::min(stream.sndEnd, stream.sndNxt + segment);
+            sendData(channel, stream, stream.sndNxt, end, out);
+            stream.inFlight.emplace_hint(stream.inFlight.end(), stream.sndNxt, InFlight {end, now});
+            inFlightBytes_ += end - stream.sndNxt;
+            stream.sndNxt = end;
+            if (end == stream.sndEnd)
+                sendable_.erase(channel);
+            nextServed_ = channel + 1;
+            progress = true;
+        }
+    }
+}
+
+void
+ReliableStreams::ensureTimer()
+{
+    if (timerActive_ or closed_)
+        return;
+    timerActive_ = true;
+    timer_ = executor_.scheduleAtFixedRate(
+        [w = weak_from_this()] {
+            if (auto shared = w.lock())
+                return shared->tick();
+            return false;
+        },
+        TICK);
+}
+
+bool
+ReliableStreams::tick()
+{
+    Datagrams out;
+    bool busy = false;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (closed_)
+            return false;
+        auto now = clock::now();
+        bool timeout = false;
+        for (auto& [channel, stream] : streams_) {
+            for (auto& [begin, range] : stream.inFlight) {
+                if (not range.sacked and not range.lost and now - range.sent >= rto_) {
+                    markLost(range, begin);
+                    timeout = true;
+                }
+            }
+            if (stream.ackDeadline != clock::time_point {} and now >= stream.ackDeadline)
+                makeAck(channel, stream, out);
+        }
+        if (timeout) {
+            JAMI_DBG("[streams] retransmission timeout (%ld ms)",
+                     std::chrono::duration_cast<std::chrono::milliseconds>(rto_).count());
+            onCongestion(true);
+            rto_ = std::min<clock::duration>(rto_ * 2, MAX_RTO);
+        }
+        transmit(out);
+
+        for (auto it = closedChannels_.begin(); it != closedChannels_.end();) {
+            if (now >= it->second.expiry)
+                it = closedChannels_.erase(it);
+            else
+                ++it;
+        }
+
+        busy = not sendable_.empty() or not closedChannels_.empty();
+        for (const auto& [channel, stream] : streams_)
+            busy |= not stream.inFlight.empty() or stream.ackDeadline != clock::time_point {};
+        if (not busy) {
+            timerActive_ = false;
+            timer_.reset();
+        }
+    }
+    flush(out);
+    return busy;
+}
+
+void
+ReliableStreams::flush(Datagrams& out)
+{
+    if (out.empty())
+        return;
+    std::lock_guard<std::mutex> lk(sendMutex_);
+    for (const auto& datagram : out) {
+        if (closed_)
+            return;
+        // A failure is handled as a loss
+        send_(datagram.data(), datagram.size());
+    }
+}
+
+} // namespace jami
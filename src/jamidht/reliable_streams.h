@@ -0,0 +1,229 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <system_error>
+#include <vector>
+
+namespace jami {
+
+class ScheduledExecutor;
+class RepeatedTask;
+
+/**
+ * Reliable ordered streams, one per channel, over an unreliable datagram transport (DTLS).
+ *
+ * Each message sent on a channel is delivered once and in order on the same channel of the
+ * peer, but a lost datagram only delays the channel it belongs to. Streams are numbered in
+ * bytes, so that a range can be sent again in smaller datagrams if the path MTU decreases.
+ * Losses are detected from selective acknowledgements (three later ranges acknowledged) or
+ * from a retransmission timeout. A congestion window shared by all channels (Reno) bounds
+ * the bytes in flight, and channels with data to send are served in turn.
+ *
+ * Channels may also send unreliable datagrams (e.g. media), which are neither retransmitted
+ * nor ordered and do not count in the congestion window.
+ *
+ * Messages of a channel are delivered in turn by a thread of the io pool, not by the reader:
+ * a handler may write back and wait for the send buffer, whose ACKs are read by onDatagram().
+ *
+ * Wire format, big endian, one frame per datagram:
+ *   DATA:     type (1), channel (2), offset (8), payload
+ *   ACK:      type (1), channel (2), next expected offset (8), count (1), count * [begin, end) (16)
+ *   DATAGRAM: type (1), channel (2), payload
+ * Messages are framed in the stream by their length (2 bytes); an empty message is an EOF.
+ *
+ * Must be owned by a shared_ptr (the retransmission timer holds a weak reference).
+ */
+class ReliableStreams : public std::enable_shared_from_this<ReliableStreams>
+{
+public:
+    using clock = std::chrono::steady_clock;
+    /// Send one datagram, return false on error
+    using SendFunc = std::function<bool(const uint8_t* data, std::size_t size)>;
+    /// Largest datagram the transport sends in one piece
+    using MaxPayloadFunc = std::function<int()>;
+    using OnMessage = std::function<void(uint16_t channel, std::vector<uint8_t>&& message)>;
+
+    static constexpr std::size_t SEND_BUFFER {512 * 1024}; ///< per channel, unacknowledged
+    static constexpr std::size_t RECV_WINDOW {1024 * 1024}; ///< per channel, beyond is dropped
+    static constexpr std::size_t MAX_SACK_RANGES {16};
+    static constexpr auto TICK = std::chrono::milliseconds(10);
+    static constexpr auto ACK_DELAY = std::chrono::milliseconds(20);
+    static constexpr auto MIN_RTO = std::chrono::milliseconds(200);
+    static constexpr auto MAX_RTO = std::chrono::seconds(4);
+    static constexpr auto CLOSE_LINGER = 2 * MAX_RTO;
+
+    /**
+     * @param executor     runs the retransmission timer, may be shared as sends don't block
+     * @param send         called outside of any lock of this object, from any thread.
+     *                     It must not block (a datagram it can't send is lost) nor call close().
+     * @param onMessage    called by a thread of the io pool, in order for a channel. Unreliable
+     *                     datagrams are delivered by the thread that calls onDatagram().
+     */
+    ReliableStreams(ScheduledExecutor& executor,
+                    SendFunc&& send,
+                    MaxPayloadFunc&& maxPayload,
+                    OnMessage&& onMessage);
+    ~ReliableStreams();
+
+    /**
+     * Queue a message of at most UINT16_MAX bytes (empty for EOF) on channel.
+     * Blocks while the send buffer of the channel is full, or while the previous stream of a
+     * closed channel is not acknowledged.
+     * @return false and set ec if closed or if the message is too big
+     */
+    bool send(uint16_t channel, const uint8_t* data, std::size_t size, std::error_code& ec);
+
+    /**
+     * Send a non-empty message in one unreliable datagram, never blocking on the streams.
+     * The message is dropped (and counted) if the transport fails to send it.
+     * @return false and set ec if closed or if the message does not fit in a datagram
+     */
+    bool sendDatagram(uint16_t channel, const uint8_t* data, std::size_t size, std::error_code& ec);
+
+    /**
+     * Handle a datagram received from the transport. Not reentrant.
+     */
+    void onDatagram(const uint8_t* data, std::size_t size);
+
+    /**
+     * Forget a channel closed on both sides. Its state is kept until the queued bytes are
+     * acknowledged, then only its receive offset is kept for CLOSE_LINGER, to acknowledge
+     * the retransmissions of a peer that missed our last ACK.
+     */
+    void closeChannel(uint16_t channel);
+
+    /**
+     * Stop sending and unblock writers. Once it returns, send is not called anymore and
+     * onMessage is not running, except in the calling thread.
+     */
+    void close();
+
+    std::size_t congestionWindow() const;
+    clock::duration smoothedRtt() const;
+    uint64_t retransmissions() const;
+    uint64_t datagramsDropped() const;
+
+private:
+    struct InFlight
+    {
+        uint64_t end;
+        clock::time_point sent;
+        unsigned transmissions {1};
+        bool sacked {false};
+        bool lost {false};
+    };
+
+    struct Stream
+    {
+        // Sender: bytes from sndUna to sndEnd, by chunks (one per message)
+        std::deque<std::pair<uint64_t, std::vector<uint8_t>>> chunks;
+        uint64_t sndUna {0}; ///< oldest unacknowledged offset
+        uint64_t sndNxt {0}; ///< next offset sent for the first time
+        uint64_t sndEnd {0}; ///< end of the queued bytes
+        std::map<uint64_t, InFlight> inFlight; ///< by begin offset
+
+        // Receiver
+        uint64_t rcvNxt {0};
+        std::map<uint64_t, std::vector<uint8_t>> outOfOrder;
+        std::vector<uint8_t> pending; ///< in order bytes of an incomplete message
+        unsigned unacked {0};         ///< data frames received since the last ACK
+        clock::time_point ackDeadline {};
+
+        bool closing {false}; ///< erased once the queued bytes are acknowledged
+    };
+
+    struct ClosedChannel
+    {
+        uint64_t rcvNxt;
+        clock::time_point expiry;
+    };
+
+    using Datagrams = std::vector<std::vector<uint8_t>>;
+
+    std::size_t segmentSize() const;
+    void copyRange(const Stream& stream, uint64_t begin, uint64_t end, std::vector<uint8_t>& out)
+        const;
+    void sendData(uint16_t channel, Stream& stream, uint64_t begin, uint64_t end, Datagrams& out);
+    void makeAck(uint16_t channel, Stream& stream, Datagrams& out);
+    bool eraseIfClosed(std::map<uint16_t, Stream>::iterator it);
+    void transmit(Datagrams& out);
+    void onData(uint16_t channel,
+                uint64_t offset,
+                const uint8_t* data,
+                std::size_t size,
+                Datagrams& out,
+                std::vector<std::vector<uint8_t>>& messages);
+    void onAck(Stream& stream, uint64_t next, const std::vector<std::pair<uint64_t, uint64_t>>& sack);
+    void markLost(InFlight& range, uint64_t begin);
+    void onCongestion(bool timeout);
+    void onAcked(std::size_t bytes);
+    void onRttSample(clock::duration rtt);
+    void ensureTimer();
+    bool tick();
+    void flush(Datagrams& out);
+    void deliver(uint16_t channel, std::vector<std::vector<uint8_t>>&& messages);
+    void drain(uint16_t channel);
+
+    ScheduledExecutor& executor_;
+    const SendFunc send_;
+    const MaxPayloadFunc maxPayload_;
+    const OnMessage onMessage_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic_bool closed_ {false};
+    std::mutex sendMutex_;     ///< held while datagrams are sent
+    std::mutex datagramMutex_; ///< held while unreliable datagrams are sent
+    std::atomic<uint64_t> datagramsDropped_ {0};
+    std::map<uint16_t, Stream> streams_;
+    std::map<uint16_t, ClosedChannel> closedChannels_;
+    std::set<uint16_t> sendable_; ///< channels with bytes never sent
+    uint16_t nextServed_ {0};
+
+    // Messages received, waiting for onMessage, by channel
+    std::mutex deliveryMutex_;
+    std::condition_variable deliveryCv_;
+    std::map<uint16_t, std::deque<std::vector<uint8_t>>> deliveries_; ///< drain() scheduled
+    unsigned delivering_ {0};                                         ///< threads in drain()
+
+    // Congestion control (bytes) and RTT estimation, for all channels
+    std::size_t cwnd_ {0};
+    std::size_t ssthresh_ {SIZE_MAX};
+    std::size_t inFlightBytes_ {0}; ///< sent, neither acknowledged nor lost
+    clock::time_point recoveryStart_ {};
+    clock::duration srtt_ {};
+    clock::duration rttvar_ {};
+    clock::duration rto_ {std::chrono::seconds(1)};
+    uint64_t retransmissions_ {0};
+
+    std::shared_ptr<RepeatedTask> timer_;
+    bool timerActive_ {false};
+};
+
+} // namespace jami
@@ -415,13 +415,12 @@ ServerAccountManager::syncDevices()
                         if (not json.isArray()) {
                             JAMI_ERR("[Auth] Can't parse server response: not an array");
                         } else {
+                            std::map<dht::InfoHash, Contact> contacts;
                             for (unsigned i = 0, n = json.size(); i < n; i++) {
                                 const auto& e = json[i];
-                                Contact contact(e);
-                                this_.info_->contacts
-                                    ->updateContact(dht::InfoHash {e["uri"].asString()}, contact);
+                                contacts[dht::InfoHash {e["uri"].asString()}] = Contact(e);
                             }
-                            this_.info_->contacts->saveContacts();
+                            this_.info_->contacts->updateContacts(contacts);
                         }
                     } catch (const std::exception& e) {
                         JAMI_ERR("Error when iterating contact list: %s", e.what());
@@ -35,6 +35,7 @@
 #include "manager.h"
 
 #include "logger.h"
+#include "cpu_accounting.h"
 #include "account_schema.h"
 
 #include "fileutils.h"
@@ -295,6 +296,20 @@ setGnuTlsLogLevel()
     gnutls_global_set_log_function(tls_print_logs);
 }
 
+static std::string
+getRingtoneFile(const Account& account)
+{
+    std::string ringtone = account.getRingtonePath();
+    if (ringtone.find(DIR_SEPARATOR_CH) == std::string::npos) {
+        // A base file name was provided (such as the default); try to
+        // resolve it from Jami's data installation prefix.
+        static const char* const RINGDIR = "ringtones";
+        ringtone = std::string(JAMI_DATADIR) + DIR_SEPARATOR_STR + RINGDIR + DIR_SEPARATOR_STR
+                   + ringtone;
+    }
+    return ringtone;
+}
+
 //==============================================================================
 
 struct Manager::ManagerPimpl
@@ -357,6 +372,12 @@ struct Manager::ManagerPimpl
 
     void initAudioDriver();
 
+    /**
+     * Decode the ringtone of the account in the background, so that it starts
+     * without delay. Requires audioLayerMutex_.
+     */
+    void prewarmRingtone(const Account& account);
+
     void processIncomingCall(const std::string& accountId, Call& incomCall);
     static void stripSipPrefix(Call& incomCall);
 
@@ -461,6 +482,7 @@ Manager::ManagerPimpl::ManagerPimpl(Manager& base)
     jami::libav_utils::av_init();
 
     ioContextRunner_ = std::thread([context = ioContext_]() {
+        CpuAccounting::getInstance().registerThread("core", "io_context");
         try {
             auto work = asio::make_work_guard(*context);
             context->run();
@@ -850,6 +872,8 @@ Manager::init(const std::string& config_file)
         if (pimpl_->audiodriver_) {
             pimpl_->toneCtrl_.setSampleRate(pimpl_->audiodriver_->getSampleRate());
             pimpl_->dtmfKey_.reset(new DTMF(getRingBufferPool().getInternalSamplingRate()));
+            for (const auto& account : getAllAccounts())
+                pimpl_->prewarmRingtone(*account);
         }
     }
     registerAccounts();
@@ -944,6 +968,10 @@ Manager::monitor(bool continuous)
 #endif
 #endif
 
+    for (const auto& stat : CpuAccounting::getInstance().getStats())
+        if (stat.at("type") != "probe")
+            JAMI_DBG("CPU %s: %s ms", stat.at("name").c_str(), stat.at("cpu_ms").c_str());
+
     for (const auto& call : callFactory.getAllCalls())
         call->monitor();
     for (const auto& account : getAllAccounts())
@@ -2090,14 +2118,7 @@ Manager::playRingtone(const std::string& accountID)
         return;
     }
 
-    std::string ringtone = account->getRingtonePath();
-    if (ringtone.find(DIR_SEPARATOR_CH) == std::string::npos) {
-        // A base file name was provided (such as the default); try to
-        // resolve it from Jami's data installation prefix.
-        static const char* const RINGDIR = "ringtones";
-        ringtone = std::string(JAMI_DATADIR) + DIR_SEPARATOR_STR + RINGDIR + DIR_SEPARATOR_STR
-                   + ringtone;
-    }
+    auto ringtone = getRingtoneFile(*account);
 
     {
         std::lock_guard<std::mutex> lock(pimpl_->audioLayerMutex_);
@@ -2446,6 +2467,13 @@ Manager::setAGCState(bool state)
 /**
  * Initialization: Main Thread
  */
+void
+Manager::ManagerPimpl::prewarmRingtone(const Account& account)
+{
+    if (audiodriver_ and account.getRingtoneEnabled())
+        AudioFileCache::instance().prewarm(getRingtoneFile(account), audiodriver_->getSampleRate());
+}
+
 void
 Manager::ManagerPimpl::initAudioDriver()
 {
@@ -2676,6 +2704,10 @@ Manager::setAccountDetails(const std::string& accountID,
     // let client requiests them we needed.
     account->doUnregister([&](bool /* transport_free */) {
         account->setAccountDetails(details);
+        {
+            std::lock_guard<std::mutex> lock(pimpl_->audioLayerMutex_);
+            pimpl_->prewarmRingtone(*account);
+        }
         // Serialize configuration to disk once it is done
         if (auto ringAccount = std::dynamic_pointer_cast<JamiAccount>(account)) {
             saveConfig(ringAccount);
@@ -24,6 +24,7 @@
 #include <iterator>
 #include <algorithm>
 #include <tuple>
+#include <map>
 
 namespace jami {
 namespace map_utils {
@@ -62,5 +63,20 @@ extractValues(const M& map) -> decltype(extractElements<1>(map))
     return extractElements<1>(map);
 }
 
+///< Keep only the entries of \a map whose key is in \a keys. An empty \a keys keeps everything.
+template<typename K, typename V>
+inline void
+filterKeys(std::map<K, V>& map, const std::vector<K>& keys)
+{
+    if (keys.empty())
+        return;
+    for (auto it = map.begin(); it != map.end();) {
+        if (std::find(keys.begin(), keys.end(), it->first) == keys.end())
+            it = map.erase(it);
+        else
+            ++it;
+    }
+}
+
 } // namespace map_utils
 } // namespace jami
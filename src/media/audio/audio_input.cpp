@@ -51,6 +51,7 @@ AudioInput::AudioInput(const std::string& id)
     , deviceGuard_()
     , loop_([] { return true; }, [this] { process(); }, [] {})
 {
+    loop_.setName("media", "audio_input");
     JAMI_DBG() << "Creating audio input with id: " << id;
 }
 
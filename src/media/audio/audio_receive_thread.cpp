@@ -46,11 +46,14 @@ AudioReceiveThread::AudioReceiveThread(const std::string& id,
     , loop_(std::bind(&AudioReceiveThread::setup, this),
             std::bind(&AudioReceiveThread::process, this),
             std::bind(&AudioReceiveThread::cleanup, this))
-{}
+{
+    loop_.setName("media", "audio_receive");
+}
 
 AudioReceiveThread::~AudioReceiveThread()
 {
     onSuccessfulSetup_ = nullptr;
+    onFirstFrame_ = nullptr;
     loop_.join();
 }
 
@@ -58,6 +61,11 @@ bool
 AudioReceiveThread::setup()
 {
     audioDecoder_.reset(new MediaDecoder([this](std::shared_ptr<MediaFrame>&& frame) mutable {
+        if (not firstFrameDecoded_) {
+            firstFrameDecoded_ = true;
+            if (onFirstFrame_)
+                onFirstFrame_(MEDIA_AUDIO);
+        }
         notify(frame);
         ringbuffer_->put(std::static_pointer_cast<AudioFrame>(frame));
     }));
@@ -59,6 +59,8 @@ public:
         onSuccessfulSetup_ = cb;
     }
 
+    void setFirstFrameCb(const std::function<void(MediaType)>& cb) { onFirstFrame_ = cb; }
+
 private:
     NON_COPYABLE(AudioReceiveThread);
 
@@ -90,6 +92,8 @@ private:
     void cleanup();
 
     std::function<void(MediaType, bool)> onSuccessfulSetup_;
+    std::function<void(MediaType)> onFirstFrame_;
+    bool firstFrameDecoded_ {false};
 };
 
 } // namespace jami
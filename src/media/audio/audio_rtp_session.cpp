@@ -166,6 +166,7 @@ AudioRtpSession::startReceiver()
                                                 mtu_));
     receiveThread_->addIOContext(*socketPair_);
     receiveThread_->setSuccessfulSetupCb(onSuccessfulSetup_);
+    receiveThread_->setFirstFrameCb(onFirstFrame_);
     receiveThread_->startReceiver();
 }
 
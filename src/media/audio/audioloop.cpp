@@ -34,14 +34,11 @@
 namespace jami {
 
 AudioLoop::AudioLoop(unsigned int sampleRate)
-    : buffer_(new AudioBuffer(0, AudioFormat(sampleRate, 1)))
+    : buffer_(std::make_shared<AudioBuffer>(0, AudioFormat(sampleRate, 1)))
     , pos_(0)
 {}
 
-AudioLoop::~AudioLoop()
-{
-    delete buffer_;
-}
+AudioLoop::~AudioLoop() {}
 
 void
 AudioLoop::seek(double relative_position)
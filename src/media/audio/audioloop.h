@@ -26,6 +26,8 @@
 #include "noncopyable.h"
 #include "audiobuffer.h"
 
+#include <memory>
+
 /**
  * @file audioloop.h
  * @brief Loop on a sound file
@@ -74,8 +76,8 @@ public:
     AudioFormat getFormat() const { return buffer_->getFormat(); }
 
 protected:
-    /** The data buffer */
-    AudioBuffer* buffer_ {nullptr};
+    /** The data buffer, possibly shared with other loops (e.g. cached audio files) */
+    std::shared_ptr<AudioBuffer> buffer_;
 
     /** current position, set to 0, when initialize */
     size_t pos_ {0};
@@ -23,6 +23,7 @@
 #include "ringbuffer.h"
 #include "ring_types.h" // for SIZEBUF
 #include "logger.h"
+#include "cpu_accounting.h"
 
 #include <limits>
 #include <utility> // for std::pair
@@ -283,6 +284,7 @@ RingBufferPool::unBindAll(const std::string& call_id)
 std::shared_ptr<AudioFrame>
 RingBufferPool::getData(const std::string& call_id)
 {
+    JAMI_CPU_PROBE("media.audio_mix");
     std::lock_guard<std::recursive_mutex> lk(stateLock_);
 
     const auto bindings = getReadBindings(call_id);
@@ -25,21 +25,31 @@
 #include <cstring>
 #include <vector>
 #include <climits>
+#include <limits>
 
 #include "libav_deps.h"
 #include "audiofile.h"
 #include "audio/resampler.h"
+#include "fileutils.h"
 #include "manager.h"
 #include "media_decoder.h"
 #include "client/ring_signal.h"
 
 #include "logger.h"
 
+#include <opendht/thread_pool.h>
+
 namespace jami {
 
 void
 AudioFile::onBufferFinish()
 {
+    // Switch to the whole file once decoded, the beginning is a prefix of it
+    if (not complete_ and file_->complete()) {
+        buffer_ = file_->buffer();
+        complete_ = true;
+    }
+
     // We want to send values in milisecond
     const int divisor = buffer_->getSampleRate() / 1000;
 
@@ -60,29 +70,208 @@ AudioFile::AudioFile(const std::string& fileName, unsigned int sampleRate)
     : AudioLoop(sampleRate)
     , filepath_(fileName)
     , updatePlaybackScale_(0)
+    , file_(AudioFileCache::instance().get(fileName, sampleRate))
+{
+    buffer_ = file_->buffer();
+    complete_ = file_->complete();
+}
+
+/**
+ * Decodes and resamples a file into a growing buffer
+ */
+struct FileDecoder
+{
+    FileDecoder(const std::string& path, const AudioFormat& format)
+        : format(format)
+        , buffer(std::make_shared<AudioBuffer>(0, format))
+        , decoder(std::make_unique<MediaDecoder>(
+              [this](const std::shared_ptr<MediaFrame>& frame) {
+                  buffer->append(*resampler.resample(std::static_pointer_cast<AudioFrame>(frame),
+                                                     this->format));
+              }))
+    {
+        DeviceParams dev;
+        dev.input = path;
+        dev.name = path;
+
+        if (decoder->openInput(dev) < 0)
+            throw AudioFileException("File could not be opened: " + path);
+
+        if (decoder->setupAudio() < 0)
+            throw AudioFileException("Decoder setup failed: " + path);
+    }
+
+    /** @return true at the end of the file */
+    bool decode(std::size_t frames = std::numeric_limits<std::size_t>::max())
+    {
+        while (buffer->frames() < frames) {
+            auto status = decoder->decode();
+            if (status == MediaDemuxer::Status::EndOfFile
+                or status == MediaDemuxer::Status::ReadError)
+                return true;
+        }
+        return false;
+    }
+
+    const AudioFormat format;
+    Resampler resampler;
+    std::shared_ptr<AudioBuffer> buffer;
+    std::unique_ptr<MediaDecoder> decoder;
+};
+
+constexpr std::chrono::seconds AudioFileCache::STREAMING_THRESHOLD;
+constexpr std::size_t AudioFileCache::DEFAULT_MAX_SIZE;
+
+AudioFileCache&
+AudioFileCache::instance()
+{
+    static AudioFileCache cache;
+    return cache;
+}
+
+std::shared_ptr<DecodedAudioFile>
+AudioFileCache::get(const std::string& path, unsigned sampleRate)
+{
+    int64_t mtime;
+    try {
+        mtime = fileutils::writeTime(path).time_since_epoch().count();
+    } catch (const std::exception&) {
+        throw AudioFileException("File could not be opened: " + path);
+    }
+    Key key {path, mtime, sampleRate};
+
+    std::shared_future<std::shared_ptr<DecodedAudioFile>> pending;
+    std::promise<std::shared_ptr<DecodedAudioFile>> promise;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            pending = it->second.file;
+        } else {
+            // Older versions of the file won't be used again
+            for (auto old = entries_.lower_bound({path, std::numeric_limits<int64_t>::min(), 0});
+                 old != entries_.end() and std::get<0>(old->first) == path;) {
+                if (std::get<2>(old->first) == sampleRate)
+                    erase(old++);
+                else
+                    ++old;
+            }
+            lru_.emplace_front(key);
+            entries_.emplace(key, Entry {promise.get_future().share(), 0, lru_.begin()});
+        }
+    }
+    if (pending.valid())
+        return pending.get();
+
+    try {
+        auto file = decode(key);
+        promise.set_value(file);
+        return file;
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end())
+            erase(it);
+        throw;
+    }
+}
+
+std::shared_ptr<DecodedAudioFile>
+AudioFileCache::decode(const Key& key)
+{
+    const auto& path = std::get<0>(key);
+    auto sampleRate = std::get<2>(key);
+    auto decoder = std::make_shared<FileDecoder>(path, AudioFormat(sampleRate, 1));
+    auto file = std::make_shared<DecodedAudioFile>();
+
+    if (decoder->decode(STREAMING_THRESHOLD.count() * sampleRate)) {
+        file->buffer_ = std::move(decoder->buffer);
+        file->complete_ = true;
+        setEntrySize(key, file->buffer_->size());
+        return file;
+    }
+
+    // Long file: start with its beginning, decode the rest in the background
+    file->buffer_ = std::make_shared<AudioBuffer>(*decoder->buffer, true);
+    setEntrySize(key, file->buffer_->size());
+    dht::ThreadPool::io().run([this, key, file, decoder] {
+        decoder->decode();
+        std::atomic_store(&file->buffer_, std::move(decoder->buffer));
+        file->complete_ = true;
+        setEntrySize(key, file->buffer()->size());
+        JAMI_DBG("Decoded audio file %s (%zu frames)",
+                 std::get<0>(key).c_str(),
+                 file->buffer()->frames());
+    });
+    return file;
+}
+
+void
+AudioFileCache::prewarm(const std::string& path, unsigned sampleRate)
+{
+    dht::ThreadPool::io().run([path, sampleRate] {
+        try {
+            AudioFileCache::instance().get(path, sampleRate);
+        } catch (const AudioFileException& e) {
+            JAMI_WARN("Audio file error: %s", e.what());
+        }
+    });
+}
+
+void
+AudioFileCache::setEntrySize(const Key& key, std::size_t size)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end())
+        return;
+    size_ = size_ - it->second.size + size;
+    it->second.size = size;
+    // Players keep their own reference, too big files are just not kept
+    if (size > maxSize_ / 2)
+        erase(it);
+    evict();
+}
+
+void
+AudioFileCache::erase(std::map<Key, Entry>::iterator it)
+{
+    size_ -= it->second.size;
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+}
+
+void
+AudioFileCache::evict()
+{
+    while (size_ > maxSize_ and not lru_.empty())
+        erase(entries_.find(lru_.back()));
+}
+
+void
+AudioFileCache::setMaxSize(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    maxSize_ = bytes;
+    evict();
+}
+
+std::size_t
+AudioFileCache::size() const
+{
+    std::lock_guard<std::mutex> lk(mutex_);
+    return size_;
+}
+
+void
+AudioFileCache::clear()
 {
-    const auto& format = getFormat();
-    auto buf = std::make_unique<AudioBuffer>(0, format);
-    Resampler r {};
-    auto decoder = std::make_unique<MediaDecoder>(
-        [&r, &format, &buf](const std::shared_ptr<MediaFrame>& frame) mutable {
-            buf->append(*r.resample(std::static_pointer_cast<AudioFrame>(frame), format));
-        });
-    DeviceParams dev;
-    dev.input = fileName;
-    dev.name = fileName;
-
-    if (decoder->openInput(dev) < 0)
-        throw AudioFileException("File could not be opened: " + fileName);
-
-    if (decoder->setupAudio() < 0)
-        throw AudioFileException("Decoder setup failed: " + fileName);
-
-    while (decoder->decode() != MediaDemuxer::Status::EndOfFile)
-        ;
-
-    delete buffer_;
-    buffer_ = buf.release();
+    std::lock_guard<std::mutex> lk(mutex_);
+    entries_.clear();
+    lru_.clear();
+    size_ = 0;
 }
 
 } // namespace jami
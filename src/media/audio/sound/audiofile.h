@@ -24,7 +24,15 @@
 #ifndef __AUDIOFILE_H__
 #define __AUDIOFILE_H__
 
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <tuple>
 #include "audio/audioloop.h"
 
 namespace jami {
@@ -37,6 +45,75 @@ public:
     {}
 };
 
+/**
+ * @brief Decoded (mono, resampled) content of a sound file, shared by its players.
+ * For long files, the buffer first holds the beginning of the file, and is replaced
+ * by the whole content once decoded.
+ */
+class DecodedAudioFile
+{
+public:
+    std::shared_ptr<AudioBuffer> buffer() const { return std::atomic_load(&buffer_); }
+    bool complete() const { return complete_; }
+
+private:
+    friend class AudioFileCache;
+    std::shared_ptr<AudioBuffer> buffer_;
+    std::atomic_bool complete_ {false};
+};
+
+/**
+ * @brief Process-wide cache of decoded sound files (ringtones, notification sounds).
+ * Entries are keyed by path, modification time and sample rate. The least recently
+ * used are dropped above the memory limit; files bigger than half of it aren't kept.
+ */
+class AudioFileCache
+{
+public:
+    /** Files longer than this are decoded in the background, after their beginning */
+    static constexpr std::chrono::seconds STREAMING_THRESHOLD {4};
+    static constexpr std::size_t DEFAULT_MAX_SIZE {32 * 1024 * 1024};
+
+    static AudioFileCache& instance();
+
+    /**
+     * @return the decoded file, decoding it on the calling thread if needed
+     * (only the beginning of long files). Concurrent requests share the decoding.
+     * @throw AudioFileException
+     */
+    std::shared_ptr<DecodedAudioFile> get(const std::string& path, unsigned sampleRate);
+
+    /** Decode the file in the background, so that the next get() is immediate */
+    void prewarm(const std::string& path, unsigned sampleRate);
+
+    void setMaxSize(std::size_t bytes);
+    std::size_t size() const;
+    void clear();
+
+private:
+    AudioFileCache() = default;
+    NON_COPYABLE(AudioFileCache);
+
+    using Key = std::tuple<std::string, int64_t, unsigned>;
+    struct Entry
+    {
+        std::shared_future<std::shared_ptr<DecodedAudioFile>> file;
+        std::size_t size {0};
+        std::list<Key>::iterator lru;
+    };
+
+    std::shared_ptr<DecodedAudioFile> decode(const Key& key);
+    void setEntrySize(const Key& key, std::size_t size);
+    void erase(std::map<Key, Entry>::iterator it);
+    void evict();
+
+    mutable std::mutex mutex_;
+    std::map<Key, Entry> entries_;
+    std::list<Key> lru_; ///< most recently used first
+    std::size_t size_ {0};
+    std::size_t maxSize_ {DEFAULT_MAX_SIZE};
+};
+
 /**
  * @brief Abstract interface for file readers
  */
@@ -55,6 +132,9 @@ private:
     // override
     void onBufferFinish();
     unsigned updatePlaybackScale_;
+
+    std::shared_ptr<DecodedAudioFile> file_;
+    bool complete_;
 };
 
 } // namespace jami
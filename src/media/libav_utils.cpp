@@ -28,6 +28,7 @@
 #endif
 #include "video/video_base.h"
 #include "logger.h"
+#include "memory_accounting.h"
 
 #include <vector>
 #include <algorithm>
@@ -275,5 +276,55 @@ fillWithSilence(AVFrame* frame)
         JAMI_ERR() << "Failed to fill frame with silence";
 }
 
+// Identifies the opaque_ref buffers created by trackFrameMemory
+static char FRAME_MEMORY_TAG;
+
+struct FrameMemory
+{
+    MemoryPool pool;
+    std::size_t bytes;
+};
+
+static void
+releaseFrameMemory(void*, uint8_t* data)
+{
+    auto memory = reinterpret_cast<FrameMemory*>(data);
+    MemoryAccounting::released(memory->pool, memory->bytes);
+    delete memory;
+}
+
+// The accounting rides on opaque_ref, which libav releases with the last frame
+// referencing the buffers, so that the public MediaFrame type doesn't change
+void
+trackFrameMemory(AVFrame* frame)
+{
+    if (not frame)
+        return;
+    if (frame->opaque_ref) {
+        if (av_buffer_get_opaque(frame->opaque_ref) != &FRAME_MEMORY_TAG)
+            return; // Owned by someone else
+        av_buffer_unref(&frame->opaque_ref);
+    }
+    std::size_t bytes = 0;
+    for (const auto* buf : frame->buf)
+        if (buf)
+            bytes += buf->size;
+    if (bytes == 0)
+        return;
+    auto memory = new FrameMemory {frame->width > 0 ? MemoryPool::VIDEO_FRAMES
+                                                    : MemoryPool::AUDIO_FRAMES,
+                                   bytes};
+    frame->opaque_ref = av_buffer_create(reinterpret_cast<uint8_t*>(memory),
+                                         sizeof(FrameMemory),
+                                         releaseFrameMemory,
+                                         &FRAME_MEMORY_TAG,
+                                         0);
+    if (not frame->opaque_ref) {
+        delete memory;
+        return;
+    }
+    MemoryAccounting::allocated(memory->pool, bytes);
+}
+
 } // namespace libav_utils
 } // namespace jami
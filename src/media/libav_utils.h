@@ -51,5 +51,11 @@ void fillWithBlack(AVFrame* frame);
 
 void fillWithSilence(AVFrame* frame);
 
+/**
+ * Account the buffers of frame to the video or audio frames memory pool until
+ * they are released. Frame references made with av_frame_ref share the accounting.
+ */
+void trackFrameMemory(AVFrame* frame);
+
 } // namespace libav_utils
 } // namespace jami
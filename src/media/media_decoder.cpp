@@ -24,6 +24,7 @@
 #include "media_decoder.h"
 #include "media_device.h"
 #include "media_buffer.h"
+#include "cpu_accounting.h"
 #include "media_io_handle.h"
 #include "audio/audiobuffer.h"
 #include "audio/ringbuffer.h"
@@ -618,6 +619,7 @@ MediaDecoder::updateStartTime(int64_t startTime)
 DecodeStatus
 MediaDecoder::decode(AVPacket& packet)
 {
+    JAMI_CPU_PROBE("media.decode");
     int frameFinished = 0;
     auto ret = avcodec_send_packet(decoderCtx_, &packet);
     if (ret < 0 && ret != AVERROR(EAGAIN)) {
@@ -645,6 +647,7 @@ MediaDecoder::decode(AVPacket& packet)
 #endif
     auto frame = f->pointer();
     ret = avcodec_receive_frame(decoderCtx_, frame);
+    libav_utils::trackFrameMemory(frame);
     if (resolutionChangedCallback_) {
         if (decoderCtx_->width != width_ or decoderCtx_->height != height_) {
             JAMI_DBG("Resolution changed from %dx%d to %dx%d",
@@ -749,6 +752,7 @@ MediaDecoder::flush()
 
     auto result = std::make_shared<MediaFrame>();
     ret = avcodec_receive_frame(decoderCtx_, result->pointer());
+    libav_utils::trackFrameMemory(result->pointer());
     if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
         return DecodeStatus::DecodeError;
     if (ret >= 0)
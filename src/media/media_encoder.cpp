@@ -24,6 +24,7 @@
 #include "media_codec.h"
 #include "media_encoder.h"
 #include "media_buffer.h"
+#include "cpu_accounting.h"
 
 #include "client/ring_signal.h"
 #include "fileutils.h"
@@ -485,6 +486,7 @@ MediaEncoder::encodeAudio(AudioFrame& frame)
 int
 MediaEncoder::encode(AVFrame* frame, int streamIdx)
 {
+    JAMI_CPU_PROBE("media.encode");
     if (!initialized_ && frame) {
         // Initialize on first video frame, or first audio frame if no video stream
         bool isVideo = (frame->width > 0 && frame->height > 0);
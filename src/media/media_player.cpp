@@ -33,6 +33,7 @@ MediaPlayer::MediaPlayer(const std::string& path)
             std::bind(&MediaPlayer::process, this),
             [] {})
 {
+    loop_.setName("media", "media_player");
     static const std::string& sep = DRing::Media::VideoProtocolPrefix::SEPARATOR;
     const auto pos = path.find(sep);
     const auto suffix = path.substr(pos + sep.size());
@@ -72,6 +72,11 @@ public:
         onSuccessfulSetup_ = cb;
     }
 
+    /**
+     * Set the callback run by the receiver thread when it decodes its first remote frame
+     */
+    void setFirstFrameCb(const std::function<void(MediaType)>& cb) { onFirstFrame_ = cb; }
+
     virtual void initRecorder(std::shared_ptr<MediaRecorder>& rec) = 0;
     virtual void deinitRecorder(std::shared_ptr<MediaRecorder>& rec) = 0;
     std::shared_ptr<AccountCodecInfo> getCodec() const { return send_.codec; }
@@ -89,6 +94,7 @@ protected:
     uint16_t mtu_;
 
     std::function<void(MediaType, bool)> onSuccessfulSetup_;
+    std::function<void(MediaType)> onFirstFrame_;
 
     std::string getRemoteRtpUri() const { return "rtp://" + send_.addr.toString(true); }
 };
@@ -25,6 +25,7 @@
 
 #include "socket_pair.h"
 #include "ice_socket.h"
+#include "cpu_accounting.h"
 #include "libav_utils.h"
 #include "logger.h"
 #include "security/memory.h"
@@ -560,7 +561,11 @@ SocketPair::readCallback(uint8_t* buf, int buf_size)
         if (rtpDelayCallback_ and res_delay)
             rtpDelayCallback_(gradient, deltaT);
 
-        auto err = ff_srtp_decrypt(&srtpContext_->srtp_in, buf, &len);
+        int err;
+        {
+            JAMI_CPU_PROBE("srtp.decrypt");
+            err = ff_srtp_decrypt(&srtpContext_->srtp_in, buf, &len);
+        }
         if (packetLossCallback_ and (buf[2] << 8 | buf[3]) != lastSeqNumIn_ + 1)
             packetLossCallback_();
         lastSeqNumIn_ = buf[2] << 8 | buf[3];
@@ -629,6 +634,7 @@ SocketPair::writeCallback(uint8_t* buf, int buf_size)
 
     // Encrypt?
     if (not isRTCP and srtpContext_ and srtpContext_->srtp_out.aes) {
+        JAMI_CPU_PROBE("srtp.encrypt");
         buf_size = ff_srtp_encrypt(&srtpContext_->srtp_out,
                                    buf,
                                    buf_size,
@@ -0,0 +1,164 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#pragma once
+
+#include "fileutils.h"
+#include "logger.h"
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <linux/videodev2.h>
+}
+
+#include <msgpack.hpp>
+
+namespace jami {
+namespace video {
+
+// Capabilities of a device, as stored in the cache
+struct CachedV4l2Rate
+{
+    double num;
+    double den;
+    unsigned format;
+
+    bool operator==(const CachedV4l2Rate& o) const
+    {
+        return num == o.num and den == o.den and format == o.format;
+    }
+    MSGPACK_DEFINE(num, den, format)
+};
+
+struct CachedV4l2Size
+{
+    unsigned width;
+    unsigned height;
+    std::vector<CachedV4l2Rate> rates;
+
+    bool operator==(const CachedV4l2Size& o) const
+    {
+        return width == o.width and height == o.height and rates == o.rates;
+    }
+    MSGPACK_DEFINE(width, height, rates)
+};
+
+struct CachedV4l2Channel
+{
+    unsigned idx;
+    std::string name;
+    std::vector<CachedV4l2Size> sizes;
+
+    bool operator==(const CachedV4l2Channel& o) const
+    {
+        return idx == o.idx and name == o.name and sizes == o.sizes;
+    }
+    MSGPACK_DEFINE(idx, name, sizes)
+};
+
+using CachedV4l2Channels = std::vector<CachedV4l2Channel>;
+
+/**
+ * Capabilities of the devices probed before, persisted in the cache directory,
+ * so that a known camera doesn't have to be enumerated again to be usable.
+ * Devices are identified by their bus, name, driver version and firmware
+ * revision, as another driver or firmware may expose other formats.
+ */
+class V4l2CapabilityCache
+{
+public:
+    static V4l2CapabilityCache& instance()
+    {
+        static V4l2CapabilityCache cache(fileutils::get_cache_dir() + DIR_SEPARATOR_STR
+                                         + "v4l2_capabilities");
+        return cache;
+    }
+
+    /** Entries are loaded from path, a missing or unreadable file is an empty cache */
+    explicit V4l2CapabilityCache(const std::string& path)
+        : path_(path)
+    {
+        try {
+            std::vector<uint8_t> data;
+            {
+                std::lock_guard<std::mutex> lk(fileutils::getFileLock(path_));
+                data = fileutils::loadFile(path_);
+            }
+            auto oh = msgpack::unpack((const char*) data.data(), data.size());
+            oh.get().convert(entries_);
+        } catch (const std::exception& e) {
+            // Missing or from an incompatible version, devices are probed again
+            entries_.clear();
+        }
+    }
+
+    static std::string key(const v4l2_capability& cap, const std::string& revision)
+    {
+        return std::string(reinterpret_cast<const char*>(cap.bus_info)) + "|"
+               + reinterpret_cast<const char*>(cap.card) + "|"
+               + reinterpret_cast<const char*>(cap.driver) + "|" + std::to_string(cap.version)
+               + "|" + revision;
+    }
+
+    std::optional<CachedV4l2Channels> get(const std::string& key) const
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end())
+            return std::nullopt;
+        return it->second;
+    }
+
+    /**
+     * Store the capabilities probed for a device, the file is only written if
+     * they changed.
+     * @return true if they differ from the cached ones
+     */
+    bool update(const std::string& key, CachedV4l2Channels channels)
+    {
+        msgpack::sbuffer buffer;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            auto it = entries_.find(key);
+            if (it != entries_.end() and it->second == channels)
+                return false;
+            entries_[key] = std::move(channels);
+            msgpack::pack(buffer, entries_);
+        }
+        try {
+            std::lock_guard<std::mutex> lk(fileutils::getFileLock(path_));
+            fileutils::saveFile(path_, (const uint8_t*) buffer.data(), buffer.size(), 0600);
+        } catch (const std::exception& e) {
+            JAMI_WARN("Can't save video capabilities to %s: %s", path_.c_str(), e.what());
+        }
+        return true;
+    }
+
+private:
+    const std::string path_;
+    mutable std::mutex mutex_;
+    std::map<std::string, CachedV4l2Channels> entries_;
+};
+
+} // namespace video
+} // namespace jami
@@ -25,6 +25,7 @@
 #include <climits>
 #include <cstring>
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -43,7 +44,13 @@ extern "C" {
 
 #include "logger.h"
 #include "../video_device.h"
+#include "v4l2_capability_cache.h"
+#include "manager.h"
 #include "string_utils.h"
+#include "client/ring_signal.h"
+#include "client/videomanager.h"
+
+#include <opendht/thread_pool.h>
 
 #define ZEROVAR(x) std::memset(&(x), 0, sizeof(x))
 
@@ -71,6 +78,8 @@ public:
         , height(height)
         , rates_()
     {}
+    VideoV4l2Size(const CachedV4l2Size& cached);
+    CachedV4l2Size toCache() const;
 
     /**
      * @throw std::runtime_error
@@ -98,6 +107,8 @@ class VideoV4l2Channel
 {
 public:
     VideoV4l2Channel(unsigned idx, const char* s);
+    VideoV4l2Channel(const CachedV4l2Channel& cached);
+    CachedV4l2Channel toCache() const;
 
     /**
      * @throw std::runtime_error
@@ -126,12 +137,27 @@ public:
     /**
      * @throw std::runtime_error
      */
-    VideoDeviceImpl(const std::string& id, const std::string& path);
+    VideoDeviceImpl(const std::string& id, const std::string& path, const std::string& revision);
 
     std::string unique_id;
     std::string path;
     std::string name;
 
+    /** True until refresh() confirmed the cached capabilities */
+    bool fromCache() const
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return fromCache_;
+    }
+
+    /**
+     * Probe the device again and replace the cached capabilities.
+     * The current settings are kept if the device still supports them.
+     * @param settingsChanged set to true if they had to be changed
+     * @return true if the capabilities changed
+     */
+    bool refresh(bool& settingsChanged);
+
     std::vector<std::string> getChannelList() const;
     std::vector<VideoSize> getSizeList(const std::string& channel) const;
     std::vector<FrameRate> getRateList(const std::string& channel, VideoSize size) const;
@@ -140,6 +166,15 @@ public:
     void setDeviceParams(const DeviceParams&);
 
 private:
+    /**
+     * @throw std::runtime_error
+     */
+    static std::vector<VideoV4l2Channel> probeChannels(int fd);
+    static CachedV4l2Channels toCache(const std::vector<VideoV4l2Channel>& channels);
+
+    std::string cacheKey_;
+    bool fromCache_ {false};
+    mutable std::mutex mutex_;
     std::vector<VideoV4l2Channel> channels_;
     const VideoV4l2Channel& getChannel(const std::string& name) const;
 
@@ -244,6 +279,30 @@ pixelformat_score(unsigned pixelformat)
 using std::vector;
 using std::string;
 
+VideoV4l2Size::VideoV4l2Size(const CachedV4l2Size& cached)
+    : width(cached.width)
+    , height(cached.height)
+{
+    rates_.reserve(cached.rates.size());
+    for (const auto& r : cached.rates) {
+        VideoV4l2Rate rate;
+        rate.frame_rate = FrameRate(r.num, r.den);
+        rate.pixel_format = r.format;
+        rates_.emplace_back(rate);
+    }
+}
+
+CachedV4l2Size
+VideoV4l2Size::toCache() const
+{
+    CachedV4l2Size cached {width, height, {}};
+    cached.rates.reserve(rates_.size());
+    for (const auto& r : rates_)
+        cached.rates.push_back(
+            {r.frame_rate.numerator(), r.frame_rate.denominator(), r.pixel_format});
+    return cached;
+}
+
 vector<FrameRate>
 VideoV4l2Size::getRateList() const
 {
@@ -317,6 +376,22 @@ VideoV4l2Channel::VideoV4l2Channel(unsigned idx, const char* s)
     , sizes_()
 {}
 
+VideoV4l2Channel::VideoV4l2Channel(const CachedV4l2Channel& cached)
+    : idx(cached.idx)
+    , name(cached.name)
+    , sizes_(cached.sizes.begin(), cached.sizes.end())
+{}
+
+CachedV4l2Channel
+VideoV4l2Channel::toCache() const
+{
+    CachedV4l2Channel cached {idx, name, {}};
+    cached.sizes.reserve(sizes_.size());
+    for (const auto& size : sizes_)
+        cached.sizes.emplace_back(size.toCache());
+    return cached;
+}
+
 std::vector<VideoSize>
 VideoV4l2Channel::getSizeList() const
 {
@@ -432,7 +507,9 @@ VideoV4l2Channel::getSize(VideoSize s) const
     return sizes_.front();
 }
 
-VideoDeviceImpl::VideoDeviceImpl(const string& id, const std::string& path)
+VideoDeviceImpl::VideoDeviceImpl(const string& id,
+                                 const std::string& path,
+                                 const std::string& revision)
     : unique_id(id)
     , path(path)
     , name()
@@ -449,6 +526,7 @@ VideoDeviceImpl::VideoDeviceImpl(const string& id, const std::string& path)
     int fd = open(path.c_str(), O_RDWR);
     if (fd == -1)
         throw std::runtime_error("could not open device");
+    std::unique_ptr<int, void (*)(int*)> closeFd(&fd, [](int* fd) { ::close(*fd); });
 
     v4l2_capability cap;
     if (ioctl(fd, VIDIOC_QUERYCAP, &cap))
@@ -462,6 +540,24 @@ VideoDeviceImpl::VideoDeviceImpl(const string& id, const std::string& path)
 
     name = string(reinterpret_cast<const char*>(cap.card));
 
+    // Enumerating the formats can take hundreds of milliseconds: a known device
+    // starts with its cached capabilities, confirmed later by refresh(). A device
+    // seen for the first time is still probed here.
+    cacheKey_ = V4l2CapabilityCache::key(cap, revision);
+    if (auto cached = V4l2CapabilityCache::instance().get(cacheKey_)) {
+        channels_.assign(cached->begin(), cached->end());
+        fromCache_ = not channels_.empty();
+    }
+    if (not fromCache_) {
+        channels_ = probeChannels(fd);
+        V4l2CapabilityCache::instance().update(cacheKey_, toCache(channels_));
+    }
+}
+
+std::vector<VideoV4l2Channel>
+VideoDeviceImpl::probeChannels(int fd)
+{
+    std::vector<VideoV4l2Channel> channels;
     v4l2_input input;
     ZEROVAR(input);
     unsigned idx;
@@ -474,13 +570,62 @@ VideoDeviceImpl::VideoDeviceImpl(const string& id, const std::string& path)
             VideoV4l2Channel channel(idx, (const char*) input.name);
             channel.readFormats(fd);
             if (not channel.getSizeList().empty())
-                channels_.push_back(channel);
+                channels.push_back(channel);
         }
 
         input.index = ++idx;
     }
+    return channels;
+}
+
+CachedV4l2Channels
+VideoDeviceImpl::toCache(const std::vector<VideoV4l2Channel>& channels)
+{
+    CachedV4l2Channels cached;
+    cached.reserve(channels.size());
+    for (const auto& channel : channels)
+        cached.emplace_back(channel.toCache());
+    return cached;
+}
 
+bool
+VideoDeviceImpl::refresh(bool& settingsChanged)
+{
+    settingsChanged = false;
+    std::vector<VideoV4l2Channel> channels;
+    int fd = open(path.c_str(), O_RDWR);
+    if (fd == -1)
+        return false;
+    try {
+        channels = probeChannels(fd);
+    } catch (const std::exception& e) {
+        // e.g. the device is already streaming
+        JAMI_WARN("Can't probe %s again, keeping its cached capabilities: %s",
+                  path.c_str(),
+                  e.what());
+    }
     ::close(fd);
+    if (channels.empty())
+        return false;
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    fromCache_ = false;
+    if (not V4l2CapabilityCache::instance().update(cacheKey_, toCache(channels)))
+        return false;
+
+    JAMI_DBG("Capabilities of %s changed", name.c_str());
+    auto channelName = channel_.name;
+    auto size = VideoSize(size_.width, size_.height);
+    auto rate = rate_.frame_rate;
+    auto format = rate_.pixel_format;
+    channels_ = std::move(channels);
+    channel_ = getChannel(channelName);
+    size_ = channel_.getSize(size);
+    rate_ = size_.getRate(rate);
+    settingsChanged = channel_.name != channelName or size_.width != size.first
+                      or size_.height != size.second or rate_.frame_rate != rate
+                      or rate_.pixel_format != format;
+    return true;
 }
 
 string
@@ -521,6 +666,7 @@ VideoDeviceImpl::getChannelList() const
 {
     if (unique_id == DEVICE_DESKTOP)
         return {"default"};
+    std::lock_guard<std::mutex> lk(mutex_);
     vector<string> v;
     v.reserve(channels_.size());
     for (const auto& itr : channels_)
@@ -535,6 +681,7 @@ VideoDeviceImpl::getSizeList(const string& channel) const
     if (unique_id == DEVICE_DESKTOP) {
         return {VideoSize(0, 0)};
     }
+    std::lock_guard<std::mutex> lk(mutex_);
     return getChannel(channel).getSizeList();
 }
 
@@ -552,6 +699,7 @@ VideoDeviceImpl::getRateList(const string& channel, VideoSize size) const
                 FrameRate(120),
                 FrameRate(144)};
     }
+    std::lock_guard<std::mutex> lk(mutex_);
     return getChannel(channel).getSize(size).getRateList();
 }
 
@@ -569,6 +717,7 @@ VideoDeviceImpl::getChannel(const string& name) const
 DeviceParams
 VideoDeviceImpl::getDeviceParams() const
 {
+    std::lock_guard<std::mutex> lk(mutex_);
     DeviceParams params;
     params.name = name;
     params.unique_id = unique_id;
@@ -591,6 +740,7 @@ VideoDeviceImpl::getDeviceParams() const
 void
 VideoDeviceImpl::setDeviceParams(const DeviceParams& params)
 {
+    std::lock_guard<std::mutex> lk(mutex_);
     if (unique_id == DEVICE_DESKTOP) {
         rate_.frame_rate = params.framerate;
         return;
@@ -609,10 +759,30 @@ VideoDevice::VideoDevice(const std::string& id,
                          const std::vector<std::map<std::string, std::string>>& devInfo)
     : id_(id)
 {
-    deviceImpl_ = std::make_shared<VideoDeviceImpl>(id,
-                                                    devInfo.empty() ? id
-                                                                    : devInfo.at(0).at("devPath"));
+    std::string path = id, revision;
+    if (not devInfo.empty()) {
+        path = devInfo.at(0).at("devPath");
+        auto it = devInfo.at(0).find("revision");
+        if (it != devInfo.at(0).end())
+            revision = it->second;
+    }
+    deviceImpl_ = std::make_shared<VideoDeviceImpl>(id, path, revision);
     name = deviceImpl_->name;
+
+    if (deviceImpl_->fromCache()) {
+        dht::ThreadPool::io().run([id, w = std::weak_ptr<VideoDeviceImpl>(deviceImpl_)] {
+            auto impl = w.lock();
+            bool settingsChanged;
+            if (not impl or not impl->refresh(settingsChanged) or not Manager::initialized)
+                return;
+            // Settings no longer supported were replaced: save them as the preferences
+            if (settingsChanged) {
+                Manager::instance().getVideoManager().videoDeviceMonitor.updatePreferences(id);
+                Manager::instance().saveConfig();
+            }
+            emitSignal<DRing::VideoSignal::DeviceEvent>();
+        });
+    }
 }
 
 DeviceParams
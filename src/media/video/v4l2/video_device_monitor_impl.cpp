@@ -25,6 +25,7 @@
 #include <cstdio>
 #include <cstring>
 #include <libudev.h>
+#include <map>
 #include <mutex>
 #include <sstream>
 #include <stdexcept> // for std::runtime_error
@@ -89,6 +90,16 @@ getDeviceString(struct udev_device* udev_device)
     throw std::invalid_argument("No ID_SERIAL detected");
 }
 
+// The firmware revision is part of the key of the capability cache
+static std::vector<std::map<std::string, std::string>>
+getDeviceInfo(struct udev_device* udev_device, const char* path)
+{
+    std::map<std::string, std::string> info {{"devPath", path}};
+    if (auto revision = udev_device_get_property_value(udev_device, "ID_REVISION"))
+        info.emplace("revision", revision);
+    return {std::move(info)};
+}
+
 static int
 is_v4l2(struct udev_device* dev)
 {
@@ -148,11 +159,11 @@ VideoDeviceMonitorImpl::VideoDeviceMonitorImpl(VideoDeviceMonitor* monitor)
             try {
                 auto unique_name = getDeviceString(dev);
                 JAMI_DBG("udev: adding device with id %s", unique_name.c_str());
-                if (monitor_->addDevice(unique_name, {{{"devPath", path}}}))
+                if (monitor_->addDevice(unique_name, getDeviceInfo(dev, path)))
                     currentPathToId_.emplace(path, unique_name);
             } catch (const std::exception& e) {
                 JAMI_WARN("udev: %s, fallback on path (your camera may be a fake camera)", e.what());
-                if (monitor_->addDevice(path, {{{"devPath", path}}}))
+                if (monitor_->addDevice(path, getDeviceInfo(dev, path)))
                     currentPathToId_.emplace(path, path);
             }
         }
@@ -236,7 +247,7 @@ VideoDeviceMonitorImpl::run()
                     const char* action = udev_device_get_action(dev);
                     if (!strcmp(action, "add")) {
                         JAMI_DBG("udev: adding device with id %s", unique_name.c_str());
-                        if (monitor_->addDevice(unique_name, {{{"devPath", path}}}))
+                        if (monitor_->addDevice(unique_name, getDeviceInfo(dev, path)))
                             currentPathToId_.emplace(path, unique_name);
                     } else if (!strcmp(action, "remove")) {
                         auto it = currentPathToId_.find(path);
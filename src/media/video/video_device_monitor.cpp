@@ -97,6 +97,19 @@ VideoDeviceMonitor::applySettings(const string& id, const VideoSettings& setting
         (*it) = settings;
 }
 
+void
+VideoDeviceMonitor::updatePreferences(const string& id)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    const auto iter = findDeviceById(id);
+    if (iter == devices_.end())
+        return;
+
+    auto it = findPreferencesById(id);
+    if (it != preferences_.end())
+        (*it) = iter->getSettings();
+}
+
 string
 VideoDeviceMonitor::getDefaultDevice() const
 {
@@ -192,16 +205,23 @@ VideoDeviceMonitor::addDevice(const string& id,
                               const std::vector<std::map<std::string, std::string>>& devInfo)
 {
     try {
-        std::lock_guard<std::mutex> l(lock_);
-        if (findDeviceById(id) != devices_.end())
-            return false;
+        {
+            std::lock_guard<std::mutex> l(lock_);
+            if (findDeviceById(id) != devices_.end())
+                return false;
+        }
 
-        // instantiate a new unique device
+        // instantiate a new unique device, probing it may be slow: don't block
+        // the other users of the monitor meanwhile
         VideoDevice dev {id, devInfo};
 
         if (dev.getChannelList().empty())
             return false;
 
+        std::lock_guard<std::mutex> l(lock_);
+        if (findDeviceById(id) != devices_.end())
+            return false;
+
         giveUniqueName(dev, devices_);
 
         // restore its preferences if any, or store the defaults
@@ -53,6 +53,8 @@ public:
     DRing::VideoCapabilities getCapabilities(const std::string& name) const;
     VideoSettings getSettings(const std::string& name);
     void applySettings(const std::string& name, const VideoSettings& settings);
+    /** Save the current settings of a device, after the device itself changed them */
+    void updatePreferences(const std::string& id);
 
     std::string getDefaultDevice() const;
     std::string getMRLForDefaultDevice() const;
@@ -61,6 +61,7 @@ VideoInput::VideoInput(VideoInputMode inputMode, const std::string& id_)
             std::bind(&VideoInput::process, this),
             std::bind(&VideoInput::cleanup, this))
 {
+    loop_.setName("media", "video_input");
     inputMode_ = inputMode;
     if (inputMode_ == VideoInputMode::Undefined) {
 #if (defined(__ANDROID__) || defined(RING_UWP) || (defined(TARGET_OS_IOS) && TARGET_OS_IOS))
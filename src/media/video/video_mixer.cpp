@@ -23,6 +23,7 @@
 
 #include "video_mixer.h"
 #include "media_buffer.h"
+#include "cpu_accounting.h"
 #include "client/videomanager.h"
 #include "manager.h"
 #include "media_filter.h"
@@ -84,6 +85,7 @@ VideoMixer::VideoMixer(const std::string& id, const std::string& localInput)
     , sink_(Manager::instance().createSinkClient(id, true))
     , loop_([] { return true; }, std::bind(&VideoMixer::process, this), [] {})
 {
+    loop_.setName("media", "video_mixer");
     // Local video camera is the main participant
     if (not localInput.empty())
         videoLocal_ = getVideoInput(localInput);
@@ -267,6 +269,8 @@ VideoMixer::process()
     if (delay.count() > 0)
         std::this_thread::sleep_for(delay);
 
+    JAMI_CPU_PROBE("media.video_mix");
+
     // Nothing to do.
     if (width_ == 0 or height_ == 0) {
         return;
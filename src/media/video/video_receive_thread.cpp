@@ -58,6 +58,7 @@ VideoReceiveThread::VideoReceiveThread(const std::string& id,
             std::bind(&VideoReceiveThread::decodeFrame, this),
             std::bind(&VideoReceiveThread::cleanup, this))
 {
+    loop_.setName("media", "video_receive");
     JAMI_DBG("[%p] Instance created", this);
 }
 
@@ -96,6 +97,11 @@ VideoReceiveThread::setup()
             av_frame_new_side_data_from_buf(frame->pointer(),
                                             AV_FRAME_DATA_DISPLAYMATRIX,
                                             av_buffer_ref(displayMatrix.get()));
+        if (not firstFrameDecoded_) {
+            firstFrameDecoded_ = true;
+            if (onFirstFrame_)
+                onFirstFrame_(MEDIA_VIDEO);
+        }
         publishFrame(std::static_pointer_cast<VideoFrame>(frame));
     }));
     videoDecoder_->setResolutionChangedCallback([this](int width, int height) {
@@ -85,6 +85,8 @@ public:
         onSuccessfulSetup_ = cb;
     }
 
+    void setFirstFrameCb(const std::function<void(MediaType)>& cb) { onFirstFrame_ = cb; }
+
 private:
     NON_COPYABLE(VideoReceiveThread);
 
@@ -121,6 +123,8 @@ private:
 
     std::function<void(void)> keyFrameRequestCallback_;
     std::function<void(MediaType, bool)> onSuccessfulSetup_;
+    std::function<void(MediaType)> onFirstFrame_;
+    bool firstFrameDecoded_ {false};
 };
 
 } // namespace video
@@ -0,0 +1,184 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+#include "memory_accounting.h"
+#include "logger.h"
+
+#include <git2.h>
+
+#include <array>
+#include <atomic>
+
+namespace jami {
+namespace MemoryAccounting {
+
+static constexpr std::size_t GIT_DEFAULT_CACHE_SIZE {256 * 1024 * 1024}; // libgit2's default
+
+struct PoolCounters
+{
+    std::atomic<std::size_t> bytes {0};
+    std::atomic<std::size_t> peak {0};
+    std::atomic<std::size_t> allocations {0};
+    std::atomic<std::size_t> dropped {0};
+    std::atomic<std::size_t> limit {0};
+};
+
+// Constant-initialized, so usable during static initialization
+static std::array<PoolCounters, static_cast<std::size_t>(MemoryPool::COUNT__)> pools_;
+
+static constexpr std::array<std::string_view, static_cast<std::size_t>(MemoryPool::COUNT__)>
+    NAMES {"video_frames", "audio_frames", "channel_rx", "tls_rx", "ice_rx", "git_cache"};
+
+static PoolCounters&
+counters(MemoryPool pool)
+{
+    return pools_[static_cast<std::size_t>(pool)];
+}
+
+static void
+gitCache(std::size_t& current, std::size_t& allowed)
+{
+    ssize_t c = 0, a = 0;
+    if (git_libgit2_opts(GIT_OPT_GET_CACHED_MEMORY, &c, &a) < 0)
+        c = a = 0;
+    current = c;
+    allowed = a;
+}
+
+void
+allocated(MemoryPool pool, std::size_t bytes) noexcept
+{
+    auto& c = counters(pool);
+    auto total = c.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    auto peak = c.peak.load(std::memory_order_relaxed);
+    while (total > peak
+           and not c.peak.compare_exchange_weak(peak, total, std::memory_order_relaxed))
+        ;
+}
+
+void
+released(MemoryPool pool, std::size_t bytes) noexcept
+{
+    auto& c = counters(pool);
+    c.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    c.allocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void
+dropped(MemoryPool pool, std::size_t bytes) noexcept
+{
+    counters(pool).dropped.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+std::size_t
+bytes(MemoryPool pool) noexcept
+{
+    if (pool == MemoryPool::GIT_CACHE) {
+        std::size_t current, allowed;
+        gitCache(current, allowed);
+        return current;
+    }
+    return counters(pool).bytes.load(std::memory_order_relaxed);
+}
+
+std::size_t
+softLimit(MemoryPool pool) noexcept
+{
+    return counters(pool).limit.load(std::memory_order_relaxed);
+}
+
+void
+setSoftLimit(MemoryPool pool, std::size_t bytes)
+{
+    counters(pool).limit = bytes;
+    // libgit2 evicts its cache by itself
+    if (pool == MemoryPool::GIT_CACHE)
+        git_libgit2_opts(GIT_OPT_SET_CACHE_MAX_SIZE,
+                         static_cast<ssize_t>(bytes ? bytes : GIT_DEFAULT_CACHE_SIZE));
+}
+
+std::string_view
+name(MemoryPool pool)
+{
+    return NAMES.at(static_cast<std::size_t>(pool));
+}
+
+void
+setSoftLimits(const std::map<std::string, std::string>& limits)
+{
+    for (std::size_t i = 0; i < NAMES.size(); ++i) {
+        auto it = limits.find(std::string(NAMES[i]));
+        if (it == limits.end())
+            continue;
+        try {
+            setSoftLimit(static_cast<MemoryPool>(i), std::stoull(it->second));
+        } catch (const std::exception& e) {
+            JAMI_WARN("Invalid memory limit for %s: %s", it->first.c_str(), it->second.c_str());
+        }
+    }
+}
+
+std::map<std::string, std::string>
+getStats()
+{
+    std::map<std::string, std::string> stats;
+    for (std::size_t i = 0; i < NAMES.size(); ++i) {
+        auto pool = static_cast<MemoryPool>(i);
+        auto prefix = std::string(NAMES[i]) + ".";
+        if (pool == MemoryPool::GIT_CACHE) {
+            std::size_t current, allowed;
+            gitCache(current, allowed);
+            stats[prefix + "bytes"] = std::to_string(current);
+            stats[prefix + "limit"] = std::to_string(allowed);
+            continue;
+        }
+        const auto& c = counters(pool);
+        stats[prefix + "bytes"] = std::to_string(c.bytes.load(std::memory_order_relaxed));
+        stats[prefix + "peak"] = std::to_string(c.peak.load(std::memory_order_relaxed));
+        stats[prefix + "allocations"] = std::to_string(
+            c.allocations.load(std::memory_order_relaxed));
+        stats[prefix + "dropped"] = std::to_string(c.dropped.load(std::memory_order_relaxed));
+        stats[prefix + "limit"] = std::to_string(c.limit.load(std::memory_order_relaxed));
+    }
+    return stats;
+}
+
+void
+monitor()
+{
+    for (std::size_t i = 0; i < NAMES.size(); ++i) {
+        auto pool = static_cast<MemoryPool>(i);
+        if (pool == MemoryPool::GIT_CACHE) {
+            std::size_t current, allowed;
+            gitCache(current, allowed);
+            JAMI_DBG("- Memory %s: %zu bytes (max %zu)", NAMES[i].data(), current, allowed);
+            continue;
+        }
+        const auto& c = counters(pool);
+        JAMI_DBG("- Memory %s: %zu bytes in %zu allocations (peak %zu, limit %zu, dropped %zu)",
+                 NAMES[i].data(),
+                 c.bytes.load(std::memory_order_relaxed),
+                 c.allocations.load(std::memory_order_relaxed),
+                 c.peak.load(std::memory_order_relaxed),
+                 c.limit.load(std::memory_order_relaxed),
+                 c.dropped.load(std::memory_order_relaxed));
+    }
+}
+
+} // namespace MemoryAccounting
+} // namespace jami
@@ -0,0 +1,110 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace jami {
+
+/**
+ * Memory pools whose live bytes are accounted
+ */
+enum class MemoryPool {
+    VIDEO_FRAMES, // Buffers held by VideoFrame
+    AUDIO_FRAMES, // Buffers held by AudioFrame
+    CHANNEL_RX,   // ChannelSocket receive buffers
+    TLS_RX,       // TlsSession received packets (DTLS)
+    ICE_RX,       // IceTransport component queues
+    GIT_CACHE,    // libgit2 object cache (read from libgit2)
+    COUNT__
+};
+
+/**
+ * Live bytes, peak and soft limit of the memory pools.
+ * The soft limit of a queue pool applies to each queue (a channel, a TLS session,
+ * an ICE component): I/O threads are shared and never wait for a reader, so when
+ * one exceeds it, datagrams are dropped and reliable streams, which can't skip
+ * bytes, are closed. 0 means no limit.
+ */
+namespace MemoryAccounting {
+
+void allocated(MemoryPool pool, std::size_t bytes) noexcept;
+void released(MemoryPool pool, std::size_t bytes) noexcept;
+
+/**
+ * Count bytes refused by a queue over its soft limit
+ */
+void dropped(MemoryPool pool, std::size_t bytes) noexcept;
+
+std::size_t bytes(MemoryPool pool) noexcept;
+std::size_t softLimit(MemoryPool pool) noexcept;
+void setSoftLimit(MemoryPool pool, std::size_t bytes);
+
+std::string_view name(MemoryPool pool);
+
+/**
+ * Set soft limits from pool name -> bytes. Unknown pools are ignored.
+ */
+void setSoftLimits(const std::map<std::string, std::string>& limits);
+
+/**
+ * Per pool: <name>.bytes, <name>.peak, <name>.allocations, <name>.dropped and <name>.limit
+ */
+std::map<std::string, std::string> getStats();
+
+/**
+ * Log one line per pool
+ */
+void monitor();
+
+} // namespace MemoryAccounting
+
+/**
+ * Bytes held by one buffer, accounted to Pool. update() must follow each change of the buffer.
+ * Buffers are not given a custom allocator: copies into them would no longer be memmove.
+ */
+template<MemoryPool Pool>
+class TrackedBytes
+{
+public:
+    TrackedBytes() = default;
+    ~TrackedBytes() { update(0); }
+    TrackedBytes(const TrackedBytes&) = delete;
+    TrackedBytes& operator=(const TrackedBytes&) = delete;
+
+    void update(std::size_t bytes) noexcept
+    {
+        if (bytes == bytes_)
+            return;
+        if (bytes_)
+            MemoryAccounting::released(Pool, bytes_);
+        if (bytes)
+            MemoryAccounting::allocated(Pool, bytes);
+        bytes_ = bytes;
+    }
+
+    std::size_t bytes() const noexcept { return bytes_; }
+
+private:
+    std::size_t bytes_ {0};
+};
+
+} // namespace jami
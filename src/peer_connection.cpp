@@ -26,14 +26,18 @@
 #include "jamidht/jamiaccount.h"
 #include "string_utils.h"
 #include "security/tls_session.h"
+#include "memory_accounting.h"
 
 #include <opendht/thread_pool.h>
 
 #include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <future>
 #include <vector>
 #include <atomic>
+#include <mutex>
 #include <stdexcept>
 #include <istream>
 #include <ostream>
@@ -193,6 +197,7 @@ public:
             /*.dh_params = */ dh_params,
             /*.timeout = */ TLS_TIMEOUT,
             /*.cert_check = */ nullptr,
+            /*.unordered = */ true, // DTLS records are reordered by MultiplexedSocket
         };
         tls = std::make_unique<tls::TlsSession>(std::move(ep), tls_param, tls_cbs);
 
@@ -230,6 +235,7 @@ public:
             /*.dh_params = */ dh_params,
             /*.timeout = */ std::chrono::duration_cast<decltype(tls::TlsParams::timeout)>(TLS_TIMEOUT),
             /*.cert_check = */ nullptr,
+            /*.unordered = */ true, // DTLS records are reordered by MultiplexedSocket
         };
         tls = std::make_unique<tls::TlsSession>(std::move(ep), tls_param, tls_cbs);
 
@@ -267,6 +273,18 @@ public:
     OnReadyCb onReadyCb_;
     std::unique_ptr<tls::TlsSession> tls;
     const IceSocketEndpoint* ep_;
+
+    // DTLS: received records, read one by one. Bounded like the TlsSession input queue,
+    // oldest records are dropped first.
+    static constexpr std::size_t RX_QUEUE_MAX_RECORDS {1000};
+    std::mutex rxMtx_ {};
+    std::condition_variable rxCv_ {};
+    std::deque<std::vector<uint8_t>> rxQueue_ {};
+    std::size_t rxQueueBytes_ {0};
+    TrackedBytes<MemoryPool::TLS_RX> rxQueueTracked_ {};
+    bool rxClosed_ {false};
+    void popRx();
+    void closeRx();
 };
 
 int
@@ -296,6 +314,8 @@ TlsSocketEndpoint::Impl::verifyCertificate(gnutls_session_t session)
 void
 TlsSocketEndpoint::Impl::onTlsStateChange(tls::TlsSessionState state)
 {
+    if (state == tls::TlsSessionState::SHUTDOWN)
+        closeRx();
     std::lock_guard<std::mutex> lk(cbMtx_);
     if ((state == tls::TlsSessionState::SHUTDOWN || state == tls::TlsSessionState::ESTABLISHED)
         && !isReady_) {
@@ -308,8 +328,45 @@ TlsSocketEndpoint::Impl::onTlsStateChange(tls::TlsSessionState state)
 }
 
 void
-TlsSocketEndpoint::Impl::onTlsRxData(UNUSED std::vector<uint8_t>&& buf)
-{}
+TlsSocketEndpoint::Impl::onTlsRxData(std::vector<uint8_t>&& buf)
+{
+    // Only called in DTLS mode: TLS data is read from the session
+    {
+        std::lock_guard<std::mutex> lk(rxMtx_);
+        if (rxClosed_)
+            return;
+        // Runs on the TlsSession thread: never wait for the reader
+        auto limit = MemoryAccounting::softLimit(MemoryPool::TLS_RX);
+        while (not rxQueue_.empty()
+               and (rxQueue_.size() >= RX_QUEUE_MAX_RECORDS
+                    or (limit and rxQueueBytes_ + buf.size() > limit))) {
+            MemoryAccounting::dropped(MemoryPool::TLS_RX, rxQueue_.front().size());
+            popRx();
+        }
+        rxQueueBytes_ += buf.size();
+        rxQueue_.emplace_back(std::move(buf));
+        rxQueueTracked_.update(rxQueueBytes_);
+    }
+    rxCv_.notify_one();
+}
+
+void
+TlsSocketEndpoint::Impl::popRx()
+{
+    rxQueueBytes_ -= rxQueue_.front().size();
+    rxQueue_.pop_front();
+    rxQueueTracked_.update(rxQueueBytes_);
+}
+
+void
+TlsSocketEndpoint::Impl::closeRx()
+{
+    {
+        std::lock_guard<std::mutex> lk(rxMtx_);
+        rxClosed_ = true;
+    }
+    rxCv_.notify_all();
+}
 
 void
 TlsSocketEndpoint::Impl::onTlsCertificatesUpdate(UNUSED const gnutls_datum_t* local_raw,
@@ -335,6 +392,14 @@ TlsSocketEndpoint::TlsSocketEndpoint(
 
 TlsSocketEndpoint::~TlsSocketEndpoint() {}
 
+bool
+TlsSocketEndpoint::isReliable() const
+{
+    if (!pimpl_->tls)
+        return true;
+    return pimpl_->tls->isReliable();
+}
+
 bool
 TlsSocketEndpoint::isInitiator() const
 {
@@ -360,7 +425,28 @@ TlsSocketEndpoint::read(ValueType* buf, std::size_t len, std::error_code& ec)
         ec = std::make_error_code(std::errc::broken_pipe);
         return -1;
     }
-    return pimpl_->tls->read(buf, len, ec);
+    if (pimpl_->tls->isReliable())
+        return pimpl_->tls->read(buf, len, ec);
+
+    // DTLS: one record per read, 0 once shutdown
+    std::unique_lock<std::mutex> lk(pimpl_->rxMtx_);
+    pimpl_->rxCv_.wait(lk, [&] { return pimpl_->rxClosed_ or not pimpl_->rxQueue_.empty(); });
+    if (pimpl_->rxQueue_.empty()) {
+        ec = std::make_error_code(std::errc::broken_pipe);
+        return 0;
+    }
+    auto& record = pimpl_->rxQueue_.front();
+    auto size = std::min(len, record.size());
+    std::copy_n(record.begin(), size, buf);
+    if (size == record.size()) {
+        pimpl_->popRx();
+    } else {
+        record.erase(record.begin(), record.begin() + size);
+        pimpl_->rxQueueBytes_ -= size;
+        pimpl_->rxQueueTracked_.update(pimpl_->rxQueueBytes_);
+    }
+    ec.clear();
+    return size;
 }
 
 std::size_t
@@ -397,7 +483,20 @@ TlsSocketEndpoint::waitForData(std::chrono::milliseconds timeout, std::error_cod
         ec = std::make_error_code(std::errc::broken_pipe);
         return -1;
     }
-    return pimpl_->tls->waitForData(timeout, ec);
+    if (pimpl_->tls->isReliable())
+        return pimpl_->tls->waitForData(timeout, ec);
+
+    std::unique_lock<std::mutex> lk(pimpl_->rxMtx_);
+    pimpl_->rxCv_.wait_for(lk, timeout, [&] {
+        return pimpl_->rxClosed_ or not pimpl_->rxQueue_.empty();
+    });
+    if (pimpl_->rxQueue_.empty()) {
+        if (pimpl_->rxClosed_)
+            ec = std::make_error_code(std::errc::broken_pipe);
+        return 0;
+    }
+    ec.clear();
+    return pimpl_->rxQueue_.front().size();
 }
 
 void
@@ -422,6 +521,7 @@ TlsSocketEndpoint::shutdown()
         if (iceSocket && iceSocket->underlyingICE())
             iceSocket->underlyingICE()->cancelOperations();
     }
+    pimpl_->closeRx();
     pimpl_->tls->shutdown();
 }
 
@@ -82,7 +82,11 @@ public:
     ~IceSocketEndpoint();
 
     void shutdown() override;
-    bool isReliable() const override { return ice_ ? ice_->isRunning() : false; }
+    bool isReliable() const override
+    {
+        // ICE-TCP is reliable, ICE over UDP is a datagram transport (DTLS is used on top)
+        return ice_ ? ice_->isRunning() and ice_->isTCPEnabled() : false;
+    }
     bool isInitiator() const override { return ice_ ? ice_->isInitiator() : true; }
     int maxPayload() const override
     {
@@ -129,7 +133,7 @@ public:
                       std::function<bool(const dht::crypto::Certificate&)>&& cert_check);
     ~TlsSocketEndpoint();
 
-    bool isReliable() const override { return true; }
+    bool isReliable() const override;
     bool isInitiator() const override;
     int maxPayload() const override;
     void shutdown() override;
@@ -37,6 +37,7 @@ CallServicesManager::CallServicesManager(PluginManager& pluginManager)
 
 CallServicesManager::~CallServicesManager()
 {
+    mediaHandlerStages_.clear();
     callMediaHandlers_.clear();
     callAVsubjects_.clear();
     mediaHandlerToggled_.clear();
@@ -86,6 +87,12 @@ CallServicesManager::createAVSubject(const StreamData& data, AVSubjectSPtr subje
 void
 CallServicesManager::clearAVSubject(const std::string& callId)
 {
+    // Stages are destroyed out of the lock, as they wait for their MediaHandler
+    decltype(mediaHandlerStages_)::node_type stages;
+    {
+        std::lock_guard<std::mutex> lk(stagesMutex_);
+        stages = mediaHandlerStages_.extract(callId);
+    }
     callAVsubjects_.erase(callId);
 }
 
@@ -219,6 +226,73 @@ CallServicesManager::getCallMediaHandlerStatus(const std::string& callId)
     return ret;
 }
 
+std::vector<std::map<std::string, std::string>>
+CallServicesManager::getCallMediaHandlerStats(const std::string& callId)
+{
+    std::vector<std::map<std::string, std::string>> ret;
+    std::lock_guard<std::mutex> lk(stagesMutex_);
+    const auto& it = mediaHandlerStages_.find(callId);
+    if (it == mediaHandlerStages_.end())
+        return ret;
+    for (const auto& [mediaHandlerId, stages] : it->second) {
+        for (const auto& stage : stages) {
+            auto stats = stage->getStats();
+            const auto& data = stage->streamData();
+            stats.emplace("mediaHandlerId", std::to_string(mediaHandlerId));
+            stats.emplace("streamType", data.type == StreamType::video ? "video" : "audio");
+            stats.emplace("direction", data.direction ? "receive" : "send");
+            ret.emplace_back(std::move(stats));
+        }
+    }
+    return ret;
+}
+
+void
+CallServicesManager::setCallMediaHandlerLatencyBudget(const std::string& mediaHandlerId,
+                                                      int budgetMs)
+{
+    uintptr_t id;
+    try {
+        id = std::stoull(mediaHandlerId);
+    } catch (const std::exception& e) {
+        JAMI_ERR("Error setting media handler latency budget: %s", e.what());
+        return;
+    }
+    std::lock_guard<std::mutex> lk(stagesMutex_);
+    if (budgetMs < 0)
+        latencyBudgets_.erase(id);
+    else
+        latencyBudgets_[id] = std::chrono::milliseconds(budgetMs);
+    for (auto& [callId, handlers] : mediaHandlerStages_) {
+        auto stages = handlers.find(id);
+        if (stages == handlers.end())
+            continue;
+        for (auto& stage : stages->second)
+            stage->setBudget(latencyBudget(id, stage->streamData().type));
+    }
+}
+
+std::chrono::microseconds
+CallServicesManager::latencyBudget(uintptr_t mediaHandlerId, StreamType type) const
+{
+    auto it = latencyBudgets_.find(mediaHandlerId);
+    if (it != latencyBudgets_.end())
+        return it->second;
+    return type == StreamType::video ? PluginMediaStage::DEFAULT_VIDEO_BUDGET
+                                     : PluginMediaStage::DEFAULT_AUDIO_BUDGET;
+}
+
+PluginMediaStage::BusyPolicy
+CallServicesManager::busyPolicy(const CallMediaHandlerPtr& mediaHandler)
+{
+    // "audioBusy" is known from the MediaHandler implementation.
+    const auto& details = mediaHandler->getCallMediaHandlerDetails();
+    const auto& it = details.find("audioBusy");
+    if (it != details.end() && it->second == "queue")
+        return PluginMediaStage::BusyPolicy::QUEUE;
+    return PluginMediaStage::BusyPolicy::DROP;
+}
+
 bool
 CallServicesManager::setPreference(const std::string& key,
                                    const std::string& value,
@@ -247,8 +321,49 @@ CallServicesManager::notifyAVSubject(CallMediaHandlerPtr& callMediaHandlerPtr,
                                      const StreamData& data,
                                      AVSubjectSPtr& subject)
 {
-    if (auto soSubject = subject.lock())
-        callMediaHandlerPtr->notifyAVFrameSubject(data, soSubject);
+    auto soSubject = subject.lock();
+    if (!soSubject)
+        return;
+    // The MediaHandler runs on a stage of its own, off the media thread
+    auto mediaHandlerId = (uintptr_t) callMediaHandlerPtr.get();
+    std::chrono::microseconds budget;
+    {
+        std::lock_guard<std::mutex> lk(stagesMutex_);
+        budget = latencyBudget(mediaHandlerId, data.type);
+    }
+    auto stage = std::make_shared<PluginMediaStage>(data,
+                                                    budget,
+                                                    busyPolicy(callMediaHandlerPtr));
+    soSubject->attachPriorityObserver(stage);
+    callMediaHandlerPtr->notifyAVFrameSubject(data, stage);
+
+    // Replaced stages are destroyed out of the lock, as they wait for their MediaHandler
+    std::list<std::shared_ptr<PluginMediaStage>> replaced;
+    std::lock_guard<std::mutex> lk(stagesMutex_);
+    auto& stages = mediaHandlerStages_[data.id][mediaHandlerId];
+    for (auto it = stages.begin(); it != stages.end();) {
+        const auto& d = (*it)->streamData();
+        if (d.direction == data.direction && d.type == data.type)
+            replaced.splice(replaced.end(), stages, it++);
+        else
+            ++it;
+    }
+    // Keep it only if the MediaHandler processes this stream
+    if (stage->getObserversCount() > 0)
+        stages.emplace_back(std::move(stage));
+}
+
+void
+CallServicesManager::eraseStages(const std::string& callId, uintptr_t mediaHandlerId)
+{
+    // Stages are destroyed out of the lock, as they wait for their MediaHandler
+    decltype(mediaHandlerStages_)::mapped_type::node_type stages;
+    {
+        std::lock_guard<std::mutex> lk(stagesMutex_);
+        auto it = mediaHandlerStages_.find(callId);
+        if (it != mediaHandlerStages_.end())
+            stages = it->second.extract(mediaHandlerId);
+    }
 }
 
 void
@@ -274,6 +389,7 @@ CallServicesManager::toggleCallMediaHandler(const uintptr_t mediaHandlerId,
             } else {
                 (*handlerIt)->detach();
                 handlers[mediaHandlerId] = false;
+                eraseStages(callId, mediaHandlerId);
             }
             if (subject.first.type == StreamType::video && isVideoType((*handlerIt)))
                 applyRestart = true;
@@ -21,12 +21,14 @@
 #pragma once
 
 #include "mediahandler.h"
+#include "pluginmediastage.h"
 #include "streamdata.h"
 
 #include "noncopyable.h"
 
 #include <list>
 #include <map>
+#include <mutex>
 #include <tuple>
 
 namespace jami {
@@ -110,6 +112,23 @@ public:
      */
     std::vector<std::string> getCallMediaHandlerStatus(const std::string& callId);
 
+    /**
+     * @brief Returns the processing statistics of the active MediaHandlers of a call,
+     * one map per MediaHandler and stream (see PluginMediaStage::getStats), with the
+     * "mediaHandlerId", "streamType" (audio or video) and "direction" (send or receive).
+     * @param callId
+     */
+    std::vector<std::map<std::string, std::string>> getCallMediaHandlerStats(
+        const std::string& callId);
+
+    /**
+     * @brief Sets the time a media thread waits for a MediaHandler on each frame.
+     * If the MediaHandler is late, frames are skipped or the last result reused.
+     * @param mediaHandlerId
+     * @param budgetMs 0 to process every frame synchronously, -1 for the default
+     */
+    void setCallMediaHandlerLatencyBudget(const std::string& mediaHandlerId, int budgetMs);
+
     /**
      * @brief Sets a preference that may be changed while MediaHandler is active.
      * @param key
@@ -145,6 +164,16 @@ private:
                          const StreamData& data,
                          AVSubjectSPtr& subject);
 
+    /**
+     * @brief Latency budget of a MediaHandler's stages. stagesMutex_ must be held.
+     */
+    std::chrono::microseconds latencyBudget(uintptr_t mediaHandlerId, StreamType type) const;
+
+    /**
+     * @brief Drops the stages of a MediaHandler for a call, which detaches it.
+     */
+    void eraseStages(const std::string& callId, uintptr_t mediaHandlerId);
+
     void toggleCallMediaHandler(const uintptr_t mediaHandlerId,
                                 const std::string& callId,
                                 const bool toggle);
@@ -165,6 +194,13 @@ private:
      */
     bool isAttached(const CallMediaHandlerPtr& mediaHandler);
 
+    /**
+     * @brief What the MediaHandler's stages do with audio frames while it is busy.
+     * @param mediaHandler
+     * @return QUEUE if the MediaHandler details have "audioBusy" -> "queue", else DROP.
+     */
+    PluginMediaStage::BusyPolicy busyPolicy(const CallMediaHandlerPtr& mediaHandler);
+
     // Components that a plugin can register through registerMediaHandler service.
     // These objects can then be activated with toggleCallMediaHandler.
     std::list<CallMediaHandlerPtr> callMediaHandlers_;
@@ -177,5 +213,16 @@ private:
     // Component that stores MediaHandlers' status for each existing call.
     // A map of callIds and MediaHandler-status pairs.
     std::map<std::string, std::map<uintptr_t, bool>> mediaHandlerToggled_;
+
+    // Worker stages running the active MediaHandlers, by callId and MediaHandler.
+    // Subjects only hold weak references: dropping a stage detaches it.
+    // stagesMutex_ guards the stages and the latency budgets, which the client API reads
+    // and writes from its own threads.
+    std::mutex stagesMutex_;
+    std::map<std::string, std::map<uintptr_t, std::list<std::shared_ptr<PluginMediaStage>>>>
+        mediaHandlerStages_;
+
+    // Latency budgets set through setCallMediaHandlerLatencyBudget
+    std::map<uintptr_t, std::chrono::milliseconds> latencyBudgets_;
 };
 } // namespace jami
@@ -25,11 +25,15 @@
 
 #include "logger.h"
 
+#include <atomic>
+#include <cstdio>
 #include <fstream>
 #include <stdexcept>
 #include <msgpack.hpp>
+#include <opendht/thread_pool.h>
 #include "manager.h"
 #include "preferences.h"
+#include "client/ring_signal.h"
 #include "jami/plugin_manager_interface.h"
 
 #define PLUGIN_ALREADY_INSTALLED 100 /* Plugin already installed with the same version */
@@ -95,59 +99,180 @@ JamiPluginManager::getInstalledPlugins()
     return pluginsPaths;
 }
 
+int
+JamiPluginManager::checkPackage(const std::string& jplPath, bool force, std::string& destinationDir)
+{
+    auto manifestMap = PluginUtils::readPluginManifestFromArchive(jplPath);
+    const std::string& name = manifestMap["name"];
+    if (name.empty())
+        throw std::runtime_error("Invalid plugin manifest: " + jplPath);
+    const std::string& version = manifestMap["version"];
+    destinationDir = fileutils::get_data_dir() + DIR_SEPARATOR_CH + "plugins" + DIR_SEPARATOR_CH
+                     + name;
+    // Find if there is an existing version of this plugin
+    const auto alreadyInstalledManifestMap = PluginUtils::parseManifestFile(
+        PluginUtils::manifestPath(destinationDir));
+
+    if (!alreadyInstalledManifestMap.empty() && !force) {
+        std::string installedVersion = alreadyInstalledManifestMap.at("version");
+        if (version == installedVersion)
+            return PLUGIN_ALREADY_INSTALLED;
+        if (version < installedVersion)
+            return PLUGIN_OLD_VERSION;
+    }
+    return 0;
+}
+
+// Next to the plugins folder, so that it can be moved in place
+static std::string
+getStagingDir()
+{
+    return fileutils::get_data_dir() + DIR_SEPARATOR_CH + ".plugins-staging";
+}
+
+void
+JamiPluginManager::cleanStaging()
+{
+    const auto stagingRoot = getStagingDir();
+    if (!fileutils::isDirectory(stagingRoot))
+        return;
+    const std::string oldSuffix = ".old";
+    const auto pluginsDir = fileutils::get_data_dir() + DIR_SEPARATOR_CH + "plugins";
+    for (const auto& entry : fileutils::readDirectory(stagingRoot)) {
+        auto path = stagingRoot + DIR_SEPARATOR_CH + entry;
+        // Named <plugin>.<id>.old, see extractPackage and replacePlugin
+        if (entry.size() > oldSuffix.size()
+            && entry.compare(entry.size() - oldSuffix.size(), oldSuffix.size(), oldSuffix) == 0) {
+            auto name = entry.substr(0, entry.size() - oldSuffix.size());
+            auto destinationDir = pluginsDir + DIR_SEPARATOR_CH
+                                  + name.substr(0, name.find_last_of('.'));
+            if (!fileutils::isDirectory(destinationDir)) {
+                fileutils::check_dir(pluginsDir.c_str());
+                if (std::rename(path.c_str(), destinationDir.c_str()) == 0) {
+                    JAMI_WARN() << "PLUGIN: restored " << destinationDir;
+                    continue;
+                }
+            }
+        }
+        fileutils::removeAll(path);
+    }
+    fileutils::removeAll(stagingRoot);
+}
+
+std::string
+JamiPluginManager::extractPackage(const std::string& jplPath,
+                                  const std::string& destinationDir,
+                                  const archiver::ExtractProgress& onProgress)
+{
+    static std::atomic<unsigned> stagingId {0};
+    auto stagingDir = getStagingDir() + DIR_SEPARATOR_CH
+                      + destinationDir.substr(destinationDir.find_last_of(DIR_SEPARATOR_CH) + 1)
+                      + "." + std::to_string(++stagingId);
+    fileutils::removeAll(stagingDir);
+    archiver::uncompressArchive(jplPath,
+                                stagingDir,
+                                PluginUtils::uncompressJplFunction,
+                                onProgress);
+    if (!PluginUtils::checkPluginValidity(stagingDir)) {
+        fileutils::removeAll(stagingDir);
+        throw std::runtime_error("Invalid plugin package: " + jplPath);
+    }
+    return stagingDir;
+}
+
+int
+JamiPluginManager::replacePlugin(const std::string& stagingDir, const std::string& destinationDir)
+{
+    // Same as uninstallPlugin, but the files of the previous version are moved
+    // aside and removed only once the new version is in place
+    std::string oldDir;
+    if (fileutils::isDirectory(destinationDir)) {
+        if (pm_.checkLoadedPlugin(destinationDir)) {
+            JAMI_INFO() << "PLUGIN: unloading before uninstall.";
+            if (!DRing::unloadPlugin(destinationDir)) {
+                JAMI_INFO() << "PLUGIN: could not unload, not performing install.";
+                fileutils::removeAll(stagingDir);
+                return -1;
+            }
+        }
+        pluginDetailsMap_.erase(destinationDir);
+        oldDir = stagingDir + ".old";
+        if (std::rename(destinationDir.c_str(), oldDir.c_str()) != 0) {
+            JAMI_ERR() << "PLUGIN: could not move " << destinationDir;
+            fileutils::removeAll(stagingDir);
+            return -1;
+        }
+    }
+    fileutils::check_dir((fileutils::get_data_dir() + DIR_SEPARATOR_CH + "plugins").c_str());
+    if (std::rename(stagingDir.c_str(), destinationDir.c_str()) != 0) {
+        JAMI_ERR() << "PLUGIN: could not install " << destinationDir;
+        if (!oldDir.empty())
+            std::rename(oldDir.c_str(), destinationDir.c_str());
+        fileutils::removeAll(stagingDir);
+        return -1;
+    }
+    if (!oldDir.empty())
+        fileutils::removeAll(oldDir);
+    return 0;
+}
+
 int
 JamiPluginManager::installPlugin(const std::string& jplPath, bool force)
 {
     int r {0};
     if (fileutils::isFile(jplPath)) {
         try {
-            auto manifestMap = PluginUtils::readPluginManifestFromArchive(jplPath);
-            const std::string& name = manifestMap["name"];
-            if (name.empty())
-                return 0;
-            const std::string& version = manifestMap["version"];
-            std::string destinationDir {fileutils::get_data_dir() + DIR_SEPARATOR_CH
-                                              + "plugins" + DIR_SEPARATOR_CH + name};
-            // Find if there is an existing version of this plugin
-            const auto alreadyInstalledManifestMap = PluginUtils::parseManifestFile(
-                PluginUtils::manifestPath(destinationDir));
-
-            if (!alreadyInstalledManifestMap.empty()) {
-                if (force) {
-                    r = uninstallPlugin(destinationDir);
-                    if (r == 0) {
-                        archiver::uncompressArchive(jplPath,
-                                                    destinationDir,
-                                                    PluginUtils::uncompressJplFunction);
-                    }
-                } else {
-                    std::string installedVersion = alreadyInstalledManifestMap.at("version");
-                    if (version > installedVersion) {
-                        r = uninstallPlugin(destinationDir);
-                        if (r == 0) {
-                            archiver::uncompressArchive(jplPath,
-                                                        destinationDir,
-                                                        PluginUtils::uncompressJplFunction);
-                        }
-                    } else if (version == installedVersion) {
-                        r = PLUGIN_ALREADY_INSTALLED;
-                    } else {
-                        r = PLUGIN_OLD_VERSION;
-                    }
-                }
-            } else {
-                archiver::uncompressArchive(jplPath,
-                                            destinationDir,
-                                            PluginUtils::uncompressJplFunction);
-            }
+            std::string destinationDir;
+            r = checkPackage(jplPath, force, destinationDir);
+            if (r == 0)
+                r = replacePlugin(extractPackage(jplPath, destinationDir), destinationDir);
             DRing::loadPlugin(destinationDir);
         } catch (const std::exception& e) {
             JAMI_ERR() << e.what();
+            r = -1;
         }
     }
     return r;
 }
 
+void
+JamiPluginManager::installPluginAsync(const std::string& jplPath, bool force)
+{
+    using InstallationProgress = DRing::ConfigurationSignal::PluginInstallationProgress;
+    dht::ThreadPool::io().run([this, jplPath, force] {
+        int r {-1};
+        std::string destinationDir, stagingDir;
+        try {
+            if (!fileutils::isFile(jplPath))
+                throw std::runtime_error("No such file: " + jplPath);
+            r = checkPackage(jplPath, force, destinationDir);
+            if (r == 0) {
+                stagingDir = extractPackage(jplPath,
+                                            destinationDir,
+                                            [&jplPath](uint64_t done, uint64_t total) {
+                                                emitSignal<InstallationProgress>(jplPath,
+                                                                                 done,
+                                                                                 total);
+                                            });
+            }
+        } catch (const std::exception& e) {
+            JAMI_ERR() << e.what();
+            r = -1;
+            destinationDir.clear();
+        }
+        // Plugins are loaded and unloaded from the main thread
+        runOnMainThread([this, jplPath, r, destinationDir, stagingDir]() mutable {
+            if (!stagingDir.empty())
+                r = replacePlugin(stagingDir, destinationDir);
+            if (!destinationDir.empty())
+                DRing::loadPlugin(destinationDir);
+            emitSignal<DRing::ConfigurationSignal::PluginInstallationFinished>(jplPath,
+                                                                               destinationDir,
+                                                                               r);
+        });
+    });
+}
+
 int
 JamiPluginManager::uninstallPlugin(const std::string& rootPath)
 {
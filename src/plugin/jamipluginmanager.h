@@ -21,6 +21,7 @@
 #pragma once
 
 #include "noncopyable.h"
+#include "archiver.h"
 #include "pluginmanager.h"
 #include "pluginpreferencesutils.h"
 
@@ -47,6 +48,7 @@ public:
         , chatsm_ {pm_}
     {
         registerServices();
+        cleanStaging();
     }
 
     /**
@@ -74,6 +76,16 @@ public:
      */
     int installPlugin(const std::string& jplPath, bool force);
 
+    /**
+     * @brief Same as installPlugin, but the package is extracted on a worker thread.
+     * PluginInstallationProgress signals are emitted while extracting, then
+     * PluginInstallationFinished with the installation path and the status
+     * (-1 if the package can't be installed).
+     * @param jplPath
+     * @param force If true, allows installing an older plugin version.
+     */
+    void installPluginAsync(const std::string& jplPath, bool force);
+
     /**
      * @brief Checks if the plugin has a valid manifest and if the plugin is loaded,
      * tries to unload it and then removes plugin folder.
@@ -143,6 +155,36 @@ private:
      */
     void registerServices();
 
+    /**
+     * @brief Removes what an interrupted installation left in the staging folder.
+     * A previous version moved aside, but not replaced, is restored.
+     */
+    static void cleanStaging();
+
+    /**
+     * @brief Reads the manifest of a package and compares it to the installed version.
+     * @param destinationDir set to the installation path of the plugin
+     * @return 0 if the package should be installed, 100 or 200 like installPlugin
+     * @throw std::runtime_error if the manifest is invalid
+     */
+    static int checkPackage(const std::string& jplPath, bool force, std::string& destinationDir);
+
+    /**
+     * @brief Extracts a package in a staging folder, next to the installed plugins.
+     * @return the staging folder
+     * @throw std::runtime_error, nothing is left in the staging folder
+     */
+    static std::string extractPackage(const std::string& jplPath,
+                                      const std::string& destinationDir,
+                                      const archiver::ExtractProgress& onProgress = {});
+
+    /**
+     * @brief Unloads the installed plugin, if any, and moves the staging folder in its place.
+     * The previous version is restored if the new one can't be moved.
+     * @return 0 if success
+     */
+    int replacePlugin(const std::string& stagingDir, const std::string& destinationDir);
+
     // PluginManager instance
     PluginManager pm_;
 
@@ -82,6 +82,9 @@ public:
      *      "attached" -> 1 if handler is attached;
      *      "dataType" -> 1 if data processed is video;
      *      "dataType" -> 0 if data processed is audio;
+     * and optionally:
+     *      "audioBusy" -> "queue" to get every audio frame, later, while busy (e.g. analysis);
+     *      "audioBusy" -> "drop" (default) to skip audio frames while busy (e.g. filters).
      * @return Map with CallMediaHandler details.
      */
     virtual std::map<std::string, std::string> getCallMediaHandlerDetails() = 0;
@@ -0,0 +1,277 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "libav_deps.h" // MUST BE INCLUDED FIRST
+#include "pluginmediastage.h"
+
+#include "cpu_accounting.h"
+#include "logger.h"
+
+namespace jami {
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+
+PluginMediaStage::FramePtr
+PluginMediaStage::makeFrame()
+{
+    return {av_frame_alloc(), [](AVFrame* f) { av_frame_free(&f); }};
+}
+
+PluginMediaStage::PluginMediaStage(const StreamData& data,
+                                   std::chrono::microseconds budget,
+                                   BusyPolicy policy)
+    : data_(data)
+    , policy_(data.type == StreamType::video ? BusyPolicy::DROP : policy)
+    , budget_(budget)
+    , input_(makeFrame())
+    , result_(makeFrame())
+    , output_(makeFrame())
+    , worker_([this] {
+        CpuAccounting::getInstance().registerThread("media", "plugin");
+        process();
+    })
+{}
+
+PluginMediaStage::~PluginMediaStage()
+{
+    {
+        std::lock_guard<std::mutex> lk(stageMutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable())
+        worker_.join();
+}
+
+void
+PluginMediaStage::setBudget(std::chrono::microseconds budget)
+{
+    std::lock_guard<std::mutex> lk(stageMutex_);
+    budget_ = budget;
+}
+
+static bool
+sameGeometry(const AVFrame* a, const AVFrame* b)
+{
+    return a->format == b->format and a->width == b->width and a->height == b->height
+           and a->nb_samples == b->nb_samples and a->channels == b->channels
+           and a->channel_layout == b->channel_layout;
+}
+
+static bool
+copyFrame(AVFrame* dst, const AVFrame* src)
+{
+    // Buffers still referenced by a frame given back are not overwritten
+    if (not dst->data[0] or not sameGeometry(dst, src) or not av_frame_is_writable(dst)) {
+        av_frame_unref(dst);
+        dst->format = src->format;
+        dst->width = src->width;
+        dst->height = src->height;
+        dst->nb_samples = src->nb_samples;
+        dst->channels = src->channels;
+        dst->channel_layout = src->channel_layout;
+        dst->sample_rate = src->sample_rate;
+        if (av_frame_get_buffer(dst, 0) < 0)
+            return false;
+    }
+    return av_frame_copy(dst, src) >= 0 and av_frame_copy_props(dst, src) >= 0;
+}
+
+void
+PluginMediaStage::runSync(AVFrame* frame)
+{
+    auto start = clock::now();
+    notify(frame);
+    auto elapsed = clock::now() - start;
+    std::lock_guard<std::mutex> lk(stageMutex_);
+    running_ = false;
+    ++frames_;
+    ++processed_;
+    ++runs_;
+    totalTime_ += elapsed;
+    maxTime_ = std::max(maxTime_, elapsed);
+    cv_.notify_all();
+}
+
+void
+PluginMediaStage::update(Observable<AVFrame*>*, AVFrame* const& frame)
+{
+    if (not frame)
+        return;
+    std::unique_lock<std::mutex> lk(stageMutex_);
+    if (stopping_)
+        return;
+    // Hardware frames can't be copied here, their plugins run synchronously
+    bool copyable = not frame->hw_frames_ctx and frame->data[0];
+    if (budget_.count() == 0 or not copyable) {
+        // Frames reach the plugin in order: wait for the frames in progress
+        if (cv_.wait_for(lk, MAX_SYNC_WAIT, [&] { return idle() or stopping_; })
+            and not stopping_) {
+            running_ = true;
+            lk.unlock();
+            runSync(frame);
+        } else if (not stopping_) {
+            ++frames_;
+            onBusy(copyable ? frame : nullptr);
+        }
+        return;
+    }
+
+    auto deadline = clock::now() + budget_;
+    ++frames_;
+    // Queued frames are older, they go first
+    if (busy_ or not queue_.empty() or not copyFrame(input_.get(), frame)) {
+        onBusy(frame);
+        return;
+    }
+    busy_ = true;
+    auto seq = ++submitted_;
+    cv_.notify_all();
+
+    if (cv_.wait_until(lk, deadline, [&] { return completed_ >= seq or stopping_; })
+        and completed_ >= seq) {
+        ++processed_;
+        takeResult(frame);
+    } else {
+        ++late_;
+        reuseResult(frame);
+    }
+}
+
+void
+PluginMediaStage::onBusy(AVFrame* frame)
+{
+    ++late_;
+    if (frame and policy_ == BusyPolicy::QUEUE and enqueue(frame))
+        return;
+    ++skipped_;
+    if (frame)
+        reuseResult(frame);
+}
+
+void
+PluginMediaStage::reuseResult(AVFrame* frame)
+{
+    // Keeps the effect visible, the properties of the frame are unchanged
+    if (data_.type == StreamType::video and hasResult_ and sameGeometry(result_.get(), frame)) {
+        ++reused_;
+        av_frame_copy(frame, result_.get());
+    }
+}
+
+bool
+PluginMediaStage::enqueue(const AVFrame* frame)
+{
+    if (queue_.size() >= MAX_QUEUED) {
+        // The plugin won't see the oldest one
+        spare_.emplace_back(std::move(queue_.front()));
+        queue_.pop_front();
+        --queued_;
+        ++skipped_;
+    }
+    FramePtr copy {nullptr, input_.get_deleter()};
+    if (spare_.empty()) {
+        copy = makeFrame();
+    } else {
+        copy = std::move(spare_.back());
+        spare_.pop_back();
+    }
+    if (not copyFrame(copy.get(), frame)) {
+        spare_.emplace_back(std::move(copy));
+        return false;
+    }
+    queue_.emplace_back(std::move(copy));
+    ++queued_;
+    cv_.notify_all();
+    return true;
+}
+
+void
+PluginMediaStage::takeResult(AVFrame* frame)
+{
+    // Refcounted frames take a reference on the result: the input is the only copy
+    if (frame->buf[0] and av_frame_ref(output_.get(), result_.get()) >= 0) {
+        av_frame_unref(frame);
+        av_frame_move_ref(frame, output_.get());
+    } else {
+        av_frame_copy(frame, result_.get());
+    }
+}
+
+void
+PluginMediaStage::process()
+{
+    std::unique_lock<std::mutex> lk(stageMutex_);
+    while (true) {
+        cv_.wait(lk, [&] { return stopping_ or busy_ or not queue_.empty(); });
+        if (stopping_)
+            break;
+        // The input, when submitted, is older than the queued frames
+        FramePtr queued {nullptr, input_.get_deleter()};
+        if (not busy_) {
+            queued = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        auto seq = submitted_;
+        running_ = true;
+        lk.unlock();
+
+        // Plugins process the copy in place
+        auto start = clock::now();
+        try {
+            notify(queued ? queued.get() : input_.get());
+        } catch (const std::exception& e) {
+            JAMI_ERR("[plugin] media handler failure: %s", e.what());
+        }
+        auto elapsed = clock::now() - start;
+
+        lk.lock();
+        running_ = false;
+        if (queued) {
+            spare_.emplace_back(std::move(queued));
+        } else {
+            std::swap(input_, result_);
+            hasResult_ = true;
+            completed_ = seq;
+            busy_ = false;
+        }
+        ++runs_;
+        totalTime_ += elapsed;
+        maxTime_ = std::max(maxTime_, elapsed);
+        cv_.notify_all();
+    }
+}
+
+std::map<std::string, std::string>
+PluginMediaStage::getStats() const
+{
+    std::lock_guard<std::mutex> lk(stageMutex_);
+    auto avg = runs_ ? totalTime_ / static_cast<clock::rep>(runs_) : clock::duration {};
+    return {{"frames", std::to_string(frames_)},
+            {"processed", std::to_string(processed_)},
+            {"late", std::to_string(late_)},
+            {"skipped", std::to_string(skipped_)},
+            {"queued", std::to_string(queued_)},
+            {"reused", std::to_string(reused_)},
+            {"budgetUs", std::to_string(budget_.count())},
+            {"avgProcessingUs", std::to_string(duration_cast<microseconds>(avg).count())},
+            {"maxProcessingUs", std::to_string(duration_cast<microseconds>(maxTime_).count())}};
+}
+
+} // namespace jami
@@ -0,0 +1,137 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#pragma once
+
+#include "observer.h"
+#include "streamdata.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+struct AVFrame;
+}
+
+namespace jami {
+
+/**
+ * @brief Runs the observers of one CallMediaHandler (plugin) on a worker thread.
+ *
+ * The stage sits between a call's AV stream subject and the plugin: the plugin
+ * attaches to the stage instead of the stream. For each frame, the media thread
+ * hands a copy to the worker and waits at most for the latency budget:
+ * - if the plugin is done in time, the frame takes a reference on its result;
+ * - if the plugin is still busy with a previous frame, a video frame is skipped and an
+ *   audio frame is skipped or queued, following the BusyPolicy of the handler;
+ * - when late, video frames get the last processed image (same geometry), so that
+ *   the effect stays visible; audio frames go through unprocessed.
+ * A budget of zero, or a hardware frame, runs the plugin synchronously on the media
+ * thread once the worker is idle, waiting at most MAX_SYNC_WAIT for it.
+ */
+class PluginMediaStage : public Observer<AVFrame*>, public Observable<AVFrame*>
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * What happens to an audio frame that arrives while the plugin is busy
+     */
+    enum class BusyPolicy {
+        DROP,  ///< the plugin doesn't see it (filters: a late result is not used)
+        QUEUE, ///< the plugin processes it later, in order, the frame goes on unmodified
+    };
+
+    static constexpr auto DEFAULT_VIDEO_BUDGET = std::chrono::milliseconds(15);
+    static constexpr auto DEFAULT_AUDIO_BUDGET = std::chrono::milliseconds(5);
+    static constexpr auto MAX_SYNC_WAIT = std::chrono::milliseconds(50);
+    static constexpr std::size_t MAX_QUEUED {16}; ///< oldest frames are dropped beyond
+
+    /**
+     * @param policy    applies to audio streams, video frames are always dropped
+     */
+    PluginMediaStage(const StreamData& data,
+                     std::chrono::microseconds budget,
+                     BusyPolicy policy = BusyPolicy::DROP);
+    ~PluginMediaStage();
+
+    void update(Observable<AVFrame*>*, AVFrame* const& frame) override;
+
+    const StreamData& streamData() const { return data_; }
+    void setBudget(std::chrono::microseconds budget);
+
+    /**
+     * @return frames, processed (in time), late (not processed in time, including
+     * skipped, queued and reused), skipped (never seen by the plugin), queued (processed
+     * after the frame went on), reused, budgetUs, avgProcessingUs, maxProcessingUs
+     */
+    std::map<std::string, std::string> getStats() const;
+
+private:
+    NON_COPYABLE(PluginMediaStage);
+
+    using FramePtr = std::unique_ptr<AVFrame, void (*)(AVFrame*)>;
+    static FramePtr makeFrame();
+    bool idle() const { return not busy_ and not running_ and queue_.empty(); }
+    void onBusy(AVFrame* frame);
+    bool enqueue(const AVFrame* frame);
+    void reuseResult(AVFrame* frame);
+    void takeResult(AVFrame* frame);
+    void process();
+    void runSync(AVFrame* frame);
+
+    const StreamData data_;
+    const BusyPolicy policy_;
+
+    mutable std::mutex stageMutex_;
+    std::condition_variable cv_;
+    std::chrono::microseconds budget_;
+    bool stopping_ {false};
+    bool busy_ {false};    ///< the worker owns input_
+    bool running_ {false}; ///< the plugin is processing a frame
+    bool hasResult_ {false};
+    uint64_t submitted_ {0};
+    uint64_t completed_ {0};
+    FramePtr input_;
+    FramePtr result_;
+    FramePtr output_; ///< reference on result_ given to the frame
+    std::deque<FramePtr> queue_;
+    std::vector<FramePtr> spare_; ///< queue frames, to keep their buffers
+
+    // Statistics
+    uint64_t frames_ {0};
+    uint64_t processed_ {0};
+    uint64_t late_ {0};
+    uint64_t skipped_ {0};
+    uint64_t queued_ {0};
+    uint64_t reused_ {0};
+    uint64_t runs_ {0};
+    clock::duration totalTime_ {};
+    clock::duration maxTime_ {};
+
+    std::thread worker_;
+};
+
+} // namespace jami
@@ -19,6 +19,7 @@
  */
 #include "scheduled_executor.h"
 #include "logger.h"
+#include "cpu_accounting.h"
 
 namespace jami {
 
@@ -27,6 +28,7 @@ ScheduledExecutor::ScheduledExecutor()
     , thread_([this, is_running = running_] {
         // The thread needs its own reference of `running_` in case the
         // scheduler is destroyed within the thread because of a job
+        CpuAccounting::getInstance().registerThread("core", "scheduler");
 
         while (*is_running)
             loop();
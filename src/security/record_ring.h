@@ -0,0 +1,101 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+#pragma once
+
+#include "memory_accounting.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace jami {
+
+/**
+ * Fixed capacity FIFO of received records (DTLS datagrams).
+ * Slots keep their storage once popped, so that steady traffic does not allocate.
+ * Only the first WARM_SLOTS slots stay allocated once the ring is drained, which
+ * bounds the memory kept after a burst. Slot storage is accounted to MemoryPool::TLS_RX.
+ * Not thread-safe.
+ */
+class RecordRing
+{
+public:
+    using Record = std::vector<uint8_t>;
+
+    static constexpr std::size_t WARM_SLOTS {16};
+
+    explicit RecordRing(std::size_t capacity)
+        : slots_(capacity)
+    {}
+
+    bool empty() const noexcept { return count_ == 0; }
+    bool full() const noexcept { return count_ == slots_.size(); }
+    std::size_t size() const noexcept { return count_; }
+
+    /**
+     * @return bytes of the queued records
+     */
+    std::size_t bytes() const noexcept { return bytes_; }
+
+    const Record& front() const { return slots_[head_]; }
+
+    /**
+     * Queue a copy of data. The ring must not be full.
+     */
+    void push(const uint8_t* data, std::size_t len)
+    {
+        auto index = (head_ + count_) % slots_.size();
+        auto& slot = slots_[index];
+        auto capacity = slot.capacity();
+        slot.assign(data, data + len);
+        if (slot.capacity() != capacity) {
+            storage_ += slot.capacity() - capacity;
+            memory_.update(storage_);
+        }
+        used_ = std::max(used_, index + 1);
+        bytes_ += len;
+        ++count_;
+    }
+
+    void pop()
+    {
+        bytes_ -= slots_[head_].size();
+        slots_[head_].clear();
+        head_ = (head_ + 1) % slots_.size();
+        if (--count_ == 0) {
+            // Restart from the first slots, whose storage is already allocated
+            head_ = 0;
+            for (; used_ > WARM_SLOTS; --used_) {
+                storage_ -= slots_[used_ - 1].capacity();
+                Record().swap(slots_[used_ - 1]);
+            }
+            memory_.update(storage_);
+        }
+    }
+
+private:
+    std::vector<Record> slots_;
+    std::size_t head_ {0};
+    std::size_t count_ {0};
+    std::size_t bytes_ {0};
+    std::size_t used_ {0}; // slots that may hold storage
+    std::size_t storage_ {0};
+    TrackedBytes<MemoryPool::TLS_RX> memory_;
+};
+
+} // namespace jami
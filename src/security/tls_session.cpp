@@ -27,10 +27,13 @@
 
 #include "threadloop.h"
 #include "logger.h"
+#include "cpu_accounting.h"
+#include "memory_accounting.h"
 #include "noncopyable.h"
 #include "compiler_intrinsics.h"
 #include "manager.h"
 #include "certstore.h"
+#include "record_ring.h"
 #include "scheduled_executor.h"
 
 #include <gnutls/gnutls.h>
@@ -41,9 +44,9 @@
 #include <gnutls/ocsp.h>
 #include <opendht/http.h>
 
-#include <list>
 #include <mutex>
 #include <condition_variable>
+#include <deque>
 #include <utility>
 #include <map>
 #include <atomic>
@@ -94,7 +97,8 @@ static constexpr auto COOKIE_TIMEOUT = std::chrono::seconds(
     10); // Time to wait for a cookie packet from client
 static constexpr int MIN_MTU {
     512 - 20 - 8}; // minimal payload size of a DTLS packet carried by an IPv4 packet
-static constexpr uint8_t HEARTBEAT_TRIES = 1; // Number of tries at each heartbeat ping send
+static constexpr uint8_t HEARTBEAT_TRIES
+    = 2; // Number of tries at each heartbeat ping send (a retry tells a loss from a too big packet)
 static constexpr auto HEARTBEAT_RETRANS_TIMEOUT = std::chrono::milliseconds(
     700); // gnutls heartbeat retransmission timeout for each ping (in milliseconds)
 static constexpr auto HEARTBEAT_TOTAL_TIMEOUT
@@ -103,6 +107,11 @@ static constexpr auto HEARTBEAT_TOTAL_TIMEOUT
 static constexpr int MISS_ORDERING_LIMIT
     = 32; // maximal accepted distance of out-of-order packet (note: must be a signed type)
 static constexpr auto RX_OOO_TIMEOUT = std::chrono::milliseconds(1500);
+static constexpr int PMTUD_PRECISION {32}; // stop probing once the path MTU is known within it
+static constexpr auto PMTUD_REPROBE_PERIOD = std::chrono::minutes(10);
+static constexpr auto PMTUD_BLACKHOLE_REPROBE = std::chrono::seconds(30); // after a fallback
+static constexpr std::size_t TX_PENDING_MAX_SIZE {
+    512 * 1024}; // Application data queued while the path MTU is verified, dropped beyond
 static constexpr int ASYMETRIC_TRANSPORT_MTU_OFFSET
     = 20; // when client, if your local IP is IPV4 and server is IPV6; you must reduce your MTU to
           // avoid packet too big error on server side. the offset is the difference in size of IP headers
@@ -247,18 +256,19 @@ public:
     // IO GnuTLS <-> ICE
     std::mutex rxMutex_ {};
     std::condition_variable rxCv_ {};
-    std::list<std::vector<ValueType>> rxQueue_ {};
+    RecordRing rxQueue_ {INPUT_MAX_SIZE};
 
     bool flushProcessing_ {false};     ///< protect against recursive call to flushRxQueue
-    std::vector<ValueType> rawPktBuf_; ///< gnutls incoming packet buffer
+    std::vector<ValueType> rawPktBuf_; ///< gnutls incoming packet buffer, reused
     uint64_t baseSeq_ {0};   ///< sequence number of first application data packet received
     uint64_t lastRxSeq_ {0}; ///< last received and valid packet sequence number
     uint64_t gapOffset_ {0}; ///< offset of first byte not received yet
     clock::time_point lastReadTime_;
     std::map<uint64_t, std::vector<ValueType>> reorderBuffer_ {};
-    std::list<clock::time_point> nextFlush_ {};
 
     std::size_t send(const ValueType*, std::size_t, std::error_code&);
+    std::size_t sendRecords(const ValueType*, std::size_t, std::error_code&);
+    void flushPendingTx();
     ssize_t sendRaw(const void*, size_t);
     ssize_t sendRawVec(const giovec_t*, int);
     ssize_t recvRaw(void*, size_t);
@@ -274,6 +284,8 @@ public:
     std::atomic<std::size_t> stRxRawPacketDropCnt_ {0};
     std::atomic<std::size_t> stTxRawPacketCnt_ {0};
     std::atomic<std::size_t> stTxRawBytesCnt_ {0};
+    std::atomic<std::size_t> stTxPendingDropCnt_ {0};
+    std::atomic<std::size_t> stTxRawPacketDropCnt_ {0};
     void dump_io_stats() const;
 
     std::unique_ptr<TlsAnonymousClientCredendials> cacred_; // ctor init.
@@ -281,6 +293,9 @@ public:
     std::unique_ptr<TlsCertificateCredendials> xcred_;      // ctor init.
     std::mutex sessionReadMutex_;
     std::mutex sessionWriteMutex_;
+    bool probing_ {false}; ///< heartbeats in flight: queue application data in pendingTx_
+    std::deque<std::vector<ValueType>> pendingTx_;
+    std::size_t pendingTxBytes_ {0};
     gnutls_session_t session_ {nullptr};
     gnutls_datum_t cookie_key_ {nullptr, 0};
     gnutls_dtls_prestate_st prestate_ {};
@@ -320,11 +335,17 @@ public:
     void cleanup();
 
     // Path mtu discovery
-    std::array<int, 3> MTUS_;
-    int mtuProbe_;
-    int hbPingRecved_ {0};
-    bool pmtudOver_ {false};
-    void pathMtuHeartbeat();
+    int mtu_ {MIN_MTU};                 ///< path MTU in use
+    int mtuOffset_ {0};                 ///< IP headers difference, see pathMtuSearch()
+    bool pmtudOver_ {false};            ///< initial discovery done
+    bool rxSeqResync_ {false};          ///< heartbeats used sequence numbers, resync on next data
+    std::size_t lastRxDatagram_ {0};    ///< size of the last pulled datagram
+    std::size_t probedMtu_ {0};         ///< server: last probe received from the client
+    clock::time_point nextProbe_ {};    ///< client: next path MTU verification
+    void setMtu(int mtu);
+    int probeMtu(int mtu);
+    int pathMtuSearch(int low, int high);
+    void reprobeMtu();
 
     std::mutex requestsMtx_;
     std::set<std::shared_ptr<dht::http::Request>> requests_;
@@ -348,11 +369,18 @@ TlsSession::TlsSessionImpl::TlsSessionImpl(std::unique_ptr<SocketType>&& transpo
     if (not transport_->isReliable()) {
         transport_->setOnRecv([this](const ValueType* buf, size_t len) {
             std::lock_guard<std::mutex> lk {rxMutex_};
-            if (rxQueue_.size() == INPUT_MAX_SIZE) {
-                rxQueue_.pop_front(); // drop oldest packet if input buffer is full
+            if (rxQueue_.full()) {
+                rxQueue_.pop(); // drop oldest packet if input buffer is full
                 ++stRxRawPacketDropCnt_;
             }
-            rxQueue_.emplace_back(buf, buf + len);
+            // Datagrams: drop oldest packets over the memory budget
+            if (auto limit = MemoryAccounting::softLimit(MemoryPool::TLS_RX)) {
+                while (!rxQueue_.empty() && rxQueue_.bytes() + len > limit) {
+                    rxQueue_.pop();
+                    ++stRxRawPacketDropCnt_;
+                }
+            }
+            rxQueue_.push(buf, len);
             ++stRxRawPacketCnt_;
             stRxRawBytesCnt_ += len;
             rxCv_.notify_one();
@@ -383,11 +411,14 @@ TlsSession::TlsSessionImpl::typeName() const
 void
 TlsSession::TlsSessionImpl::dump_io_stats() const
 {
-    JAMI_DBG("[TLS] RxRawPkt=%zu (%zu bytes) - TxRawPkt=%zu (%zu bytes)",
+    JAMI_DBG("[TLS] RxRawPkt=%zu (%zu bytes) - TxRawPkt=%zu (%zu bytes) - TxPendingDrop=%zu"
+             " - TxRawDrop=%zu",
              stRxRawPacketCnt_.load(),
              stRxRawBytesCnt_.load(),
              stTxRawPacketCnt_.load(),
-             stTxRawBytesCnt_.load());
+             stTxRawBytesCnt_.load(),
+             stTxPendingDropCnt_.load(),
+             stTxRawPacketDropCnt_.load());
 }
 
 TlsSessionState
@@ -397,9 +428,8 @@ TlsSession::TlsSessionImpl::setupClient()
 
     if (not transport_->isReliable()) {
         ret = gnutls_init(&session_, GNUTLS_CLIENT | GNUTLS_DATAGRAM);
-        // uncoment to reactivate PMTUD
-        // JAMI_DBG("[TLS] set heartbeat reception for retrocompatibility check on server");
-        // gnutls_heartbeat_enable(session_,GNUTLS_HB_PEER_ALLOWED_TO_SEND);
+        if (ret == GNUTLS_E_SUCCESS)
+            gnutls_heartbeat_enable(session_, GNUTLS_HB_PEER_ALLOWED_TO_SEND);
     } else {
         ret = gnutls_init(&session_, GNUTLS_CLIENT);
     }
@@ -423,12 +453,10 @@ TlsSession::TlsSessionImpl::setupServer()
 
     if (not transport_->isReliable()) {
         ret = gnutls_init(&session_, GNUTLS_SERVER | GNUTLS_DATAGRAM);
-
-        // uncoment to reactivate PMTUD
-        // JAMI_DBG("[TLS] set heartbeat reception");
-        // gnutls_heartbeat_enable(session_, GNUTLS_HB_PEER_ALLOWED_TO_SEND);
-
-        gnutls_dtls_prestate_set(session_, &prestate_);
+        if (ret == GNUTLS_E_SUCCESS) {
+            gnutls_heartbeat_enable(session_, GNUTLS_HB_PEER_ALLOWED_TO_SEND);
+            gnutls_dtls_prestate_set(session_, &prestate_);
+        }
     } else {
         ret = gnutls_init(&session_, GNUTLS_SERVER);
     }
@@ -831,6 +859,27 @@ TlsSession::TlsSessionImpl::send(const ValueType* tx_data, std::size_t tx_size,
         return 0;
     }
 
+    // Heartbeats and application records can't be sent concurrently, and a path MTU
+    // verification may last seconds: queue the data instead of waiting (datagrams)
+    if (probing_) {
+        if (pendingTxBytes_ + tx_size > TX_PENDING_MAX_SIZE) {
+            ++stTxPendingDropCnt_;
+        } else {
+            pendingTx_.emplace_back(tx_data, tx_data + tx_size);
+            pendingTxBytes_ += tx_size;
+        }
+        ec.clear();
+        return tx_size;
+    }
+    return sendRecords(tx_data, tx_size, ec);
+}
+
+// sessionWriteMutex_ must be locked
+std::size_t
+TlsSession::TlsSessionImpl::sendRecords(const ValueType* tx_data,
+                                        std::size_t tx_size,
+                                        std::error_code& ec)
+{
     std::size_t total_written = 0;
     std::size_t max_tx_sz;
 
@@ -882,6 +931,13 @@ TlsSession::TlsSessionImpl::sendRaw(const void* buf, size_t size)
             return n;
         }
 
+        if (ec.value() == EAGAIN and not transport_->isReliable()) {
+            // A datagram transport never waits for room: the record is lost as it
+            // would be on the network, DTLS and the upper layers cope with that.
+            ++stTxRawPacketDropCnt_;
+            return size;
+        }
+
         if (ec.value() == EAGAIN) {
             JAMI_WARN() << "[TLS] EAGAIN from transport, retry#" << ++retry_count;
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -939,7 +995,8 @@ TlsSession::TlsSessionImpl::recvRaw(void* buf, size_t size)
     const auto& pkt = rxQueue_.front();
     const std::size_t count = std::min(pkt.size(), size);
     std::copy_n(pkt.begin(), count, reinterpret_cast<ValueType*>(buf));
-    rxQueue_.pop_front();
+    lastRxDatagram_ = pkt.size();
+    rxQueue_.pop();
     return count;
 }
 
@@ -1124,7 +1181,7 @@ TlsSession::TlsSessionImpl::handleStateCookie(TlsSessionState state)
         // Drop front packet
         {
             std::lock_guard<std::mutex> lk {rxMutex_};
-            rxQueue_.pop_front();
+            rxQueue_.pop();
         }
 
         // Cookie may be sent on multiple network packets
@@ -1134,7 +1191,12 @@ TlsSession::TlsSessionImpl::handleStateCookie(TlsSessionState state)
             JAMI_WARN("[TLS] flood threshold reach (retry in %zds)",
                       std::chrono::duration_cast<std::chrono::seconds>(FLOOD_PAUSE).count());
             dump_io_stats();
-            std::this_thread::sleep_for(FLOOD_PAUSE); // flood attack protection
+            // flood attack protection, interrupted by shutdown
+            std::unique_lock<std::mutex> lk {stateMutex_};
+            stateCondition_.wait_for(lk, FLOOD_PAUSE, [this] {
+                return state_ == TlsSessionState::SHUTDOWN
+                       or newState_ == TlsSessionState::SHUTDOWN;
+            });
         }
         return state;
     }
@@ -1164,8 +1226,10 @@ TlsSession::TlsSessionImpl::handleStateHandshake(TlsSessionState state)
 
     // Continue handshaking on non-fatal error
     if (ret != GNUTLS_E_SUCCESS) {
-        // TODO: handle GNUTLS_E_LARGE_PACKET (MTU must be lowered)
-        if (ret != GNUTLS_E_AGAIN)
+        if (ret == GNUTLS_E_LARGE_PACKET and not transport_->isReliable()) {
+            JAMI_WARN("[TLS] handshake packet too large, using minimal MTU %d", MIN_MTU);
+            gnutls_dtls_set_mtu(session_, MIN_MTU);
+        } else if (ret != GNUTLS_E_AGAIN)
             JAMI_DBG("[TLS] non-fatal handshake error: %s", gnutls_strerror(ret));
         return state;
     }
@@ -1240,108 +1304,159 @@ TlsSession::TlsSessionImpl::handleStateMtuDiscovery(UNUSED TlsSessionState state
         JAMI_WARN("No transport available when discovering the MTU");
         return TlsSessionState::SHUTDOWN;
     }
-    mtuProbe_ = transport_->maxPayload();
-    assert(mtuProbe_ >= MIN_MTU);
-    MTUS_ = {MIN_MTU, std::max((mtuProbe_ + MIN_MTU) / 2, MIN_MTU), mtuProbe_};
+    auto maxMtu = transport_->maxPayload();
+    assert(maxMtu >= MIN_MTU);
 
     // retrocompatibility check
-    if (gnutls_heartbeat_allowed(session_, GNUTLS_HB_LOCAL_ALLOWED_TO_SEND) == 1) {
-        if (!isServer_) {
-            pathMtuHeartbeat();
-            if (state_ == TlsSessionState::SHUTDOWN) {
-                JAMI_ERR("[TLS] session destroyed while performing PMTUD, shuting down");
-                return TlsSessionState::SHUTDOWN;
-            }
-            pmtudOver_ = true;
-        }
+    if (gnutls_heartbeat_allowed(session_, GNUTLS_HB_LOCAL_ALLOWED_TO_SEND) != 1) {
+        JAMI_WARN("[TLS] peer heartbeat disabled: using transport MTU value %d", maxMtu);
+        setMtu(maxMtu);
+        pmtudOver_ = true;
+    } else if (isServer_) {
+        // The client probes: use its last probe (see handleStateEstablished)
+        setMtu(MIN_MTU);
+        return TlsSessionState::ESTABLISHED;
     } else {
-        JAMI_ERR() << "[TLS] PEER HEARTBEAT DISABLED: using transport MTU value " << mtuProbe_;
+        // when the remote (server) has a IPV6 interface selected by ICE, and local (client) has a
+        // IPV4 selected, the path MTU discovery triggers errors for packets too big on server side
+        // because of different IP headers overhead. Hence we have to signal to the TLS session to
+        // reduce the MTU on client size accordingly.
+        if (transport_->localAddr().isIpv4() and transport_->remoteAddr().isIpv6()) {
+            mtuOffset_ = ASYMETRIC_TRANSPORT_MTU_OFFSET;
+            JAMI_WARN() << "[TLS] local/remote IP protocol version not alike, use an MTU offset of "
+                        << ASYMETRIC_TRANSPORT_MTU_OFFSET << " bytes to compensate";
+        }
+        gnutls_heartbeat_set_timeouts(session_,
+                                      HEARTBEAT_RETRANS_TIMEOUT.count(),
+                                      HEARTBEAT_TOTAL_TIMEOUT.count());
+        setMtu(pathMtuSearch(MIN_MTU, maxMtu));
+        if (state_ == TlsSessionState::SHUTDOWN) {
+            JAMI_ERR("[TLS] session destroyed while performing PMTUD, shuting down");
+            return TlsSessionState::SHUTDOWN;
+        }
         pmtudOver_ = true;
+        nextProbe_ = clock::now() + PMTUD_REPROBE_PERIOD;
     }
 
-    gnutls_dtls_set_mtu(session_, mtuProbe_);
-    maxPayload_ = gnutls_dtls_get_data_mtu(session_);
+    JAMI_DBG() << "[TLS] maxPayload: " << maxPayload_.load();
+    if (!initFromRecordState())
+        return TlsSessionState::SHUTDOWN;
+    return TlsSessionState::ESTABLISHED;
+}
 
-    if (pmtudOver_) {
-        JAMI_DBG() << "[TLS] maxPayload: " << maxPayload_.load();
-        if (!initFromRecordState())
-            return TlsSessionState::SHUTDOWN;
-    }
+void
+TlsSession::TlsSessionImpl::setMtu(int mtu)
+{
+    mtu_ = mtu;
+    gnutls_dtls_set_mtu(session_, mtu);
+    maxPayload_ = gnutls_dtls_get_data_mtu(session_);
+    JAMI_DBG("[TLS] PMTUD: using mtu %d, payload %d", mtu, maxPayload_.load());
+}
 
-    return TlsSessionState::ESTABLISHED;
+/*
+ * Send a heartbeat of the size of mtu and wait for its answer.
+ * A timeout is considered as a packet drop from the network due to the size of the packet.
+ */
+int
+TlsSession::TlsSessionImpl::probeMtu(int mtu)
+{
+    gnutls_dtls_set_mtu(session_, mtu);
+    auto bytesToSend = gnutls_dtls_get_data_mtu(session_) - mtuOffset_
+                       - 3; // want to know why -3? ask gnutls!
+    int ret;
+    do {
+        ret = gnutls_heartbeat_ping(session_, bytesToSend, HEARTBEAT_TRIES, GNUTLS_HEARTBEAT_WAIT);
+    } while (ret == GNUTLS_E_AGAIN
+             || (ret == GNUTLS_E_INTERRUPTED && state_ != TlsSessionState::SHUTDOWN));
+    JAMI_DBG("[TLS] PMTUD: mtu %d %s", mtu, ret == GNUTLS_E_SUCCESS ? "[OK]" : "[FAILED]");
+    gnutls_dtls_set_mtu(session_, mtu_);
+    return ret;
 }
 
 /*
  * Path MTU discovery heuristic
- * heuristic description:
- * The two members of the current tls connection will exchange dtls heartbeat messages
- * of increasing size until the heartbeat times out which will be considered as a packet
- * drop from the network due to the size of the packet. (one retry to test for a buffer issue)
- * when timeout happens or all the values have been tested, the mtu will be returned.
- * In case of unexpected error the first (and minimal) value of the mtu array
+ * low is known to work. The transport MTU (high) is tried first as it usually works, then
+ * the path MTU is searched by dichotomy until it is known within PMTUD_PRECISION bytes.
+ * The last probe sent is always at the returned MTU, which the server adopts.
+ * In case of unexpected error the last working value is returned.
  */
-void
-TlsSession::TlsSessionImpl::pathMtuHeartbeat()
+int
+TlsSession::TlsSessionImpl::pathMtuSearch(int low, int high)
 {
-    JAMI_DBG() << "[TLS] PMTUD: starting probing with " << HEARTBEAT_RETRANS_TIMEOUT.count()
-               << "ms of retransmission timeout";
-
-    gnutls_heartbeat_set_timeouts(session_,
-                                  HEARTBEAT_RETRANS_TIMEOUT.count(),
-                                  HEARTBEAT_TOTAL_TIMEOUT.count());
-
-    int errno_send = GNUTLS_E_SUCCESS;
-    int mtuOffset = 0;
-
-    // when the remote (server) has a IPV6 interface selected by ICE, and local (client) has a IPV4
-    // selected, the path MTU discovery triggers errors for packets too big on server side because
-    // of different IP headers overhead. Hence we have to signal to the TLS session to reduce the
-    // MTU on client size accordingly.
-    if (transport_ and transport_->localAddr().isIpv4() and transport_->remoteAddr().isIpv6()) {
-        mtuOffset = ASYMETRIC_TRANSPORT_MTU_OFFSET;
-        JAMI_WARN() << "[TLS] local/remote IP protocol version not alike, use an MTU offset of "
-                    << ASYMETRIC_TRANSPORT_MTU_OFFSET << " bytes to compensate";
-    }
-
-    mtuProbe_ = MTUS_[0];
-
-    for (auto mtu : MTUS_) {
-        gnutls_dtls_set_mtu(session_, mtu);
-        auto data_mtu = gnutls_dtls_get_data_mtu(session_);
-        JAMI_DBG() << "[TLS] PMTUD: mtu " << mtu << ", payload " << data_mtu;
-        auto bytesToSend = data_mtu - mtuOffset - 3; // want to know why -3? ask gnutls!
-
-        do {
-            errno_send = gnutls_heartbeat_ping(session_,
-                                               bytesToSend,
-                                               HEARTBEAT_TRIES,
-                                               GNUTLS_HEARTBEAT_WAIT);
-        } while (errno_send == GNUTLS_E_AGAIN
-                 || (errno_send == GNUTLS_E_INTERRUPTED && state_ != TlsSessionState::SHUTDOWN));
-
-        if (errno_send != GNUTLS_E_SUCCESS) {
-            JAMI_DBG() << "[TLS] PMTUD: mtu " << mtu << " [FAILED]";
+    JAMI_DBG() << "[TLS] PMTUD: probing from " << low << " to " << high << " with "
+               << HEARTBEAT_RETRANS_TIMEOUT.count() << "ms of retransmission timeout";
+
+    auto mtu = high;
+    while (low < high and state_ != TlsSessionState::SHUTDOWN) {
+        auto ret = probeMtu(mtu);
+        if (ret == GNUTLS_E_SUCCESS) {
+            low = mtu;
+        } else if (ret == GNUTLS_E_TIMEDOUT) {
+            high = mtu - 1;
+        } else {
+            JAMI_ERR() << "[TLS] PMTUD: failed with gnutls error '" << gnutls_strerror(ret)
+                       << '\'';
             break;
         }
-
-        mtuProbe_ = mtu;
-        JAMI_DBG() << "[TLS] PMTUD: mtu " << mtu << " [OK]";
+        if (high - low < PMTUD_PRECISION)
+            break;
+        mtu = (low + high + 1) / 2;
     }
+    // The server uses the last probe it receives: end with the MTU found, so that it
+    // doesn't keep a larger probe whose pong was lost
+    if (mtu != low and state_ != TlsSessionState::SHUTDOWN)
+        probeMtu(low);
+    // Pongs used sequence numbers
+    rxSeqResync_ = true;
+    return low;
+}
 
-    if (errno_send == GNUTLS_E_TIMEDOUT) { // timeout is considered as a packet loss, then the good
-                                           // mtu is the precedent
-        if (mtuProbe_ == MTUS_[0]) {
-            JAMI_WARN() << "[TLS] PMTUD: no response on first ping, using minimal MTU value "
-                        << mtuProbe_;
-        } else {
-            JAMI_WARN() << "[TLS] PMTUD: timed out, using last working mtu " << mtuProbe_;
-        }
-    } else if (errno_send != GNUTLS_E_SUCCESS) {
-        JAMI_ERR() << "[TLS] PMTUD: failed with gnutls error '" << gnutls_strerror(errno_send)
-                   << '\'';
+/*
+ * Verify periodically that the path MTU still works (client only).
+ * A failure at the current MTU is a black hole (e.g. the route changed): fall back to the
+ * minimal MTU and search again soon. The server follows as the MTU is confirmed to it.
+ */
+void
+TlsSession::TlsSessionImpl::reprobeMtu()
+{
+    // Writers queue their data rather than wait for the heartbeats (see send())
+    {
+        std::lock_guard<std::mutex> lk(sessionWriteMutex_);
+        probing_ = true;
+    }
+    auto ret = probeMtu(mtu_);
+    if (ret == GNUTLS_E_SUCCESS) {
+        auto maxMtu = transport_->maxPayload();
+        if (mtu_ < maxMtu)
+            setMtu(pathMtuSearch(mtu_, maxMtu));
+        nextProbe_ = clock::now() + PMTUD_REPROBE_PERIOD;
+    } else if (ret == GNUTLS_E_TIMEDOUT and mtu_ > MIN_MTU) {
+        JAMI_WARN("[TLS] PMTUD: black hole at mtu %d, falling back to %d", mtu_, MIN_MTU);
+        setMtu(MIN_MTU);
+        probeMtu(MIN_MTU);
+        nextProbe_ = clock::now() + PMTUD_BLACKHOLE_REPROBE;
     } else {
-        JAMI_DBG() << "[TLS] PMTUD: reached maximal value";
+        nextProbe_ = clock::now() + PMTUD_REPROBE_PERIOD;
+    }
+    rxSeqResync_ = true;
+
+    std::lock_guard<std::mutex> lk(sessionWriteMutex_);
+    probing_ = false;
+    flushPendingTx();
+}
+
+// sessionWriteMutex_ must be locked
+void
+TlsSession::TlsSessionImpl::flushPendingTx()
+{
+    std::error_code ec;
+    while (not pendingTx_.empty() and state_ == TlsSessionState::ESTABLISHED) {
+        const auto& data = pendingTx_.front();
+        sendRecords(data.data(), data.size(), ec);
+        pendingTx_.pop_front();
     }
+    pendingTx_.clear();
+    pendingTxBytes_ = 0;
 }
 
 void
@@ -1361,7 +1476,14 @@ TlsSession::TlsSessionImpl::handleDataPacket(std::vector<ValueType>&& buf, uint6
         // No duplicate check as DTLS prevents that for us (replay protection)
 
         // accept Out-Of-Order pkt - will be reordered by queue flush operation
-        JAMI_WARN("[TLS] OOO pkt: 0x%lx", pkt_seq);
+        if (not params_.unordered)
+            JAMI_WARN("[TLS] OOO pkt: 0x%lx", pkt_seq);
+    }
+
+    if (params_.unordered) {
+        if (callbacks_.onRxData)
+            callbacks_.onRxData(std::move(buf));
+        return;
     }
 
     std::unique_lock<std::mutex> lk {rxMutex_};
@@ -1369,8 +1491,6 @@ TlsSession::TlsSessionImpl::handleDataPacket(std::vector<ValueType>&& buf, uint6
     if (reorderBuffer_.empty())
         lastReadTime_ = now;
     reorderBuffer_.emplace(pkt_seq, std::move(buf));
-    nextFlush_.emplace_back(now + RX_OOO_TIMEOUT);
-    rxCv_.notify_one();
     // Try to flush right now as a new packet is available
     flushRxQueue(lk);
 }
@@ -1464,52 +1584,64 @@ TlsSession::TlsSessionImpl::handleStateEstablished(TlsSessionState state)
         return oldState;
     }
 
-    // block until rx packet or state change
+    // block until rx packet, state change or out-of-order timeout
     {
+        auto wakeUp = [this] {
+            return state_ != TlsSessionState::ESTABLISHED
+                   or newState_ != TlsSessionState::NONE or not rxQueue_.empty();
+        };
         std::unique_lock<std::mutex> lk {rxMutex_};
-        if (nextFlush_.empty())
-            rxCv_.wait(lk, [this] {
-                return state_ != TlsSessionState::ESTABLISHED or not rxQueue_.empty()
-                       or not nextFlush_.empty();
-            });
+        auto deadline = nextProbe_;
+        if (not reorderBuffer_.empty()
+            and (deadline == clock::time_point {} or lastReadTime_ + RX_OOO_TIMEOUT < deadline))
+            deadline = lastReadTime_ + RX_OOO_TIMEOUT;
+        if (deadline == clock::time_point {})
+            rxCv_.wait(lk, wakeUp);
         else
-            rxCv_.wait_until(lk, nextFlush_.front(), [this] {
-                return state_ != TlsSessionState::ESTABLISHED or !rxQueue_.empty();
-            });
+            rxCv_.wait_until(lk, deadline, wakeUp);
         state = state_.load();
         if (state != TlsSessionState::ESTABLISHED)
             return state;
+        auto newState = newState_.exchange(TlsSessionState::NONE);
+        if (newState != TlsSessionState::NONE)
+            return newState;
 
-        if (not nextFlush_.empty()) {
-            auto now = clock::now();
-            if (nextFlush_.front() <= now) {
-                while (nextFlush_.front() <= now)
-                    nextFlush_.pop_front();
-                flushRxQueue(lk);
-                return state;
-            }
+        auto now = clock::now();
+        if (not reorderBuffer_.empty() and now - lastReadTime_ >= RX_OOO_TIMEOUT) {
+            flushRxQueue(lk);
+            return state;
+        }
+        if (nextProbe_ != clock::time_point {} and now >= nextProbe_) {
+            lk.unlock();
+            reprobeMtu();
+            return state;
         }
     }
 
     std::array<uint8_t, 8> seq;
-    rawPktBuf_.resize(RX_MAX_SIZE);
+    rawPktBuf_.resize(RX_MAX_SIZE); // allocated once
     auto ret = gnutls_record_recv_seq(session_, rawPktBuf_.data(), rawPktBuf_.size(), &seq[0]);
 
     if (ret > 0) {
-        // Are we in PMTUD phase?
-        if (!pmtudOver_) {
-            mtuProbe_ = MTUS_[std::max(0, hbPingRecved_ - 1)];
-            gnutls_dtls_set_mtu(session_, mtuProbe_);
-            maxPayload_ = gnutls_dtls_get_data_mtu(session_);
+        // First data after heartbeats, which used sequence numbers?
+        bool resync = !pmtudOver_;
+        if (rxSeqResync_) {
+            std::lock_guard<std::mutex> lk {rxMutex_};
+            resync = reorderBuffer_.empty(); // else lost packets are waited for
+        }
+        if (resync) {
+            // The last probe that the client sent us is the path MTU
+            if (isServer_ and probedMtu_)
+                setMtu(std::clamp(static_cast<int>(probedMtu_), MIN_MTU, transport_->maxPayload()));
+            probedMtu_ = 0;
             pmtudOver_ = true;
-            JAMI_DBG() << "[TLS] maxPayload: " << maxPayload_.load();
-
+            rxSeqResync_ = false;
             if (!initFromRecordState(-1))
                 return TlsSessionState::SHUTDOWN;
         }
 
-        rawPktBuf_.resize(ret);
-        handleDataPacket(std::move(rawPktBuf_), array2uint(seq));
+        handleDataPacket(std::vector<ValueType>(rawPktBuf_.begin(), rawPktBuf_.begin() + ret),
+                         array2uint(seq));
         // no state change
     } else if (ret == GNUTLS_E_HEARTBEAT_PING_RECEIVED) {
         JAMI_DBG("[TLS] PMTUD: ping received sending pong");
@@ -1520,7 +1652,9 @@ TlsSession::TlsSessionImpl::handleStateEstablished(TlsSessionState state)
                      errno_send,
                      gnutls_strerror(errno_send));
         } else {
-            ++hbPingRecved_;
+            // The client ends each probing round with the MTU it chose
+            probedMtu_ = lastRxDatagram_;
+            rxSeqResync_ = pmtudOver_;
         }
         // no state change
     } else if (ret == 0) {
@@ -1597,6 +1731,9 @@ TlsSession::maxPayload() const
         throw std::runtime_error("Getting maxPayload from non-valid TLS session");
     if (!pimpl_->transport_)
         return 0;
+    // DTLS: payload of a record at the discovered path MTU
+    if (not pimpl_->transport_->isReliable() and pimpl_->maxPayload_ > 0)
+        return pimpl_->maxPayload_;
     return pimpl_->transport_->maxPayload();
 }
 
@@ -1604,7 +1741,11 @@ TlsSession::maxPayload() const
 void
 TlsSession::shutdown()
 {
-    pimpl_->newState_ = TlsSessionState::SHUTDOWN;
+    {
+        // Under rxMutex_, so that the waiting FSM can't miss it
+        std::lock_guard<std::mutex> lk(pimpl_->rxMutex_);
+        pimpl_->newState_ = TlsSessionState::SHUTDOWN;
+    }
     pimpl_->stateCondition_.notify_all();
     pimpl_->rxCv_.notify_one(); // unblock waiting FSM
 }
@@ -1612,6 +1753,7 @@ TlsSession::shutdown()
 std::size_t
 TlsSession::write(const ValueType* data, std::size_t size, std::error_code& ec)
 {
+    JAMI_CPU_PROBE("tls.write");
     return pimpl_->send(data, size, ec);
 }
 
@@ -1631,6 +1773,8 @@ TlsSession::read(ValueType* data, std::size_t size, std::error_code& ec)
             std::lock_guard<std::mutex> lk(pimpl_->sessionReadMutex_);
             if (!pimpl_->session_)
                 return 0;
+            // Wall time includes the wait for incoming data
+            JAMI_CPU_PROBE("tls.read");
             ret = gnutls_record_recv(pimpl_->session_, data, size);
         }
         if (ret > 0) {
@@ -80,6 +80,9 @@ struct TlsParams
     // Callback for certificate checkings
     std::function<int(unsigned status, const gnutls_datum_t* cert_list, unsigned cert_list_size)>
         cert_check;
+
+    // DTLS: deliver records as soon as received, the upper layer handles losses and ordering
+    bool unordered {false};
 };
 
 /// TlsSession
@@ -54,6 +54,7 @@ using std::stringstream;
 
 static constexpr int POOL_INITIAL_SIZE = 16384;
 static constexpr int POOL_INCREMENT_SIZE = POOL_INITIAL_SIZE;
+static constexpr const char MEDIA_CHANNEL_ATTR[] {"x-jami-media-channel"};
 
 static std::map<MediaDirection, const char*> DIRECTION_STR {{MediaDirection::SENDRECV, "sendrecv"},
                                                             {MediaDirection::SENDONLY, "sendonly"},
@@ -996,6 +997,35 @@ Sdp::getIceAttributes(const pjmedia_sdp_session* session)
     return ice_attrs;
 }
 
+void
+Sdp::addMediaChannelToken(const std::string& token)
+{
+    pj_str_t value = sip_utils::CONST_PJ_STR(token);
+    pjmedia_sdp_attr* attr = pjmedia_sdp_attr_create(memPool_.get(), MEDIA_CHANNEL_ATTR, &value);
+
+    if (pjmedia_sdp_attr_add(&localSession_->attr_count, localSession_->attr, attr) != PJ_SUCCESS)
+        throw SdpException("Could not add media channel attribute to local SDP");
+}
+
+std::string
+Sdp::getMediaChannelToken() const
+{
+    if (auto session = activeRemoteSession_ ? activeRemoteSession_ : remoteSession_)
+        return getMediaChannelToken(session);
+    return {};
+}
+
+std::string
+Sdp::getMediaChannelToken(const pjmedia_sdp_session* session)
+{
+    if (auto attr = pjmedia_sdp_attr_find2(session->attr_count,
+                                           session->attr,
+                                           MEDIA_CHANNEL_ATTR,
+                                           nullptr))
+        return std::string(attr->value.ptr, attr->value.slen);
+    return {};
+}
+
 void
 Sdp::clearIce()
 {
@@ -1012,6 +1042,7 @@ Sdp::clearIce(pjmedia_sdp_session* session)
         return;
     pjmedia_sdp_attr_remove_all(&session->attr_count, session->attr, "ice-ufrag");
     pjmedia_sdp_attr_remove_all(&session->attr_count, session->attr, "ice-pwd");
+    pjmedia_sdp_attr_remove_all(&session->attr_count, session->attr, MEDIA_CHANNEL_ATTR);
     // TODO. Why this? we should not have "candidate" attribute at session level.
     pjmedia_sdp_attr_remove_all(&session->attr_count, session->attr, "candidate");
     for (unsigned i = 0; i < session->media_count; i++) {
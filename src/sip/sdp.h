@@ -190,6 +190,14 @@ public:
     IceTransport::Attribute getIceAttributes() const;
     static IceTransport::Attribute getIceAttributes(const pjmedia_sdp_session* session);
 
+    /**
+     * Token used to open the media channels over the peer connection
+     * instead of negotiating a dedicated ICE session
+     */
+    void addMediaChannelToken(const std::string& token);
+    std::string getMediaChannelToken() const;
+    static std::string getMediaChannelToken(const pjmedia_sdp_session* session);
+
     void addIceCandidates(unsigned media_index, const std::vector<std::string>& cands);
 
     std::vector<std::string> getIceCandidates(unsigned media_index) const;
@@ -421,6 +421,7 @@ SIPAccount::SIPStartCall(std::shared_ptr<SIPCall>& call)
         JAMI_ERR("Unable to send invite message for this call");
         return false;
     }
+    call->markSetupPhase(Call::SetupPhase::SIP_INVITE);
 
     call->setState(Call::CallState::ACTIVE, Call::ConnectionState::PROGRESSING);
 
@@ -26,6 +26,7 @@
 
 #include "account.h"
 
+#include "generic_io.h"
 #include "sip_utils.h"
 #include "ip_utils.h"
 #include "noncopyable.h"
@@ -239,6 +240,45 @@ public:
 
     IceTransportOptions getIceOptions() const noexcept;
 
+    /**
+     * Initialize ice with a transport already gathered by the account, if any
+     * @return false if ice must be initialized with initIceInstance()
+     */
+    virtual bool initPooledIceTransport(IceTransport& /*ice*/,
+                                        const IceTransportOptions& /*options*/)
+    {
+        return false;
+    }
+
+    /// Media channels indexed by ICE component id
+    using MediaChannels = std::map<unsigned, std::shared_ptr<GenericSocket<uint8_t>>>;
+
+    /**
+     * @return true if calls to devices can carry their media over the channels
+     * of the connection used for SIP (only if that connection sends datagrams)
+     */
+    virtual bool mediaChannelsSupported() const { return false; }
+
+    /**
+     * Allow deviceId to open the media channels of token
+     */
+    virtual void acceptMediaChannels(const std::string& /*token*/, std::string_view /*deviceId*/)
+    {}
+
+    /**
+     * Open (initiator) or wait for the media channels of token
+     * @param cb    called once, with all the channels or none on failure
+     * @return false if media channels are not supported (cb is not called)
+     */
+    virtual bool getMediaChannels(const std::string& /*token*/,
+                                  std::string_view /*deviceId*/,
+                                  const std::vector<unsigned>& /*compIds*/,
+                                  bool /*initiator*/,
+                                  std::function<void(MediaChannels&&)>&& /*cb*/)
+    {
+        return false;
+    }
+
     virtual void sendTextMessage(const std::string& to,
                                  const std::map<std::string, std::string>& payloads,
                                  uint64_t id,
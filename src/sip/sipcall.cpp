@@ -225,6 +225,10 @@ SIPCall::configureRtpSession(const std::shared_ptr<RtpSession>& rtpSession,
         if (auto thisPtr = w.lock())
             thisPtr->rtpSetupSuccess(type, isRemote);
     });
+    rtpSession->setFirstFrameCb([w = weak()](MediaType) {
+        if (auto thisPtr = w.lock())
+            thisPtr->markSetupPhase(SetupPhase::FIRST_FRAME);
+    });
 
 #ifdef ENABLE_VIDEO
     if (localMedia.type == MediaType::MEDIA_VIDEO) {
@@ -256,6 +260,11 @@ SIPCall::getSIPAccount() const
 void
 SIPCall::createCallAVStreams()
 {
+    // In a conference, plugins process the conference mix once, not each participant
+    if (auto conf = getConference(); conf and conf->getParticipantList().count(getCallId())) {
+        clearCallAVStreams();
+        return;
+    }
 #ifdef ENABLE_VIDEO
     if (hasVideo()) {
         auto videoRtp = getVideoRtp();
@@ -824,7 +833,10 @@ SIPCall::answer(const std::vector<DRing::MediaMap>& mediaList)
     // Create the SDP answer
     sdp_->processIncomingOffer(mediaAttrList);
 
-    if (isIceEnabled() and remoteHasValidIceAttributes()) {
+    if (acceptMediaChannels()) {
+        JAMI_DBG("[call:%s] Media over the peer connection, no media ICE session gathered",
+                 getCallId().c_str());
+    } else if (isIceEnabled() and remoteHasValidIceAttributes()) {
         setupIceResponse();
     }
 
@@ -1506,6 +1518,9 @@ SIPCall::removeCall()
         std::lock_guard<std::mutex> lk(transportMtx_);
         resetTransport(std::move(iceMedia_));
         resetTransport(std::move(reinvIceMedia_));
+        for (auto& [compId, channel] : mediaChannels_)
+            channel->shutdown();
+        mediaChannels_.clear();
     }
 
     setInviteSession();
@@ -1765,6 +1780,14 @@ SIPCall::addLocalIceAttributes()
 
     sdp_->addIceAttributes(iceMedia->getLocalAttributes());
 
+    // Offer to carry the first negotiated media over the channels of the connection
+    // used by SIP. ICE attributes are still sent for peers that do not support it.
+    if (not sdp_->getRemoteSdpSession() and canUseMediaChannels()) {
+        dht::crypto::random_device rd;
+        mediaChannelToken_ = to_hex_string(std::uniform_int_distribution<uint64_t>()(rd));
+        sdp_->addMediaChannelToken(mediaChannelToken_);
+    }
+
     if (account->isIceCompIdRfc5245Compliant()) {
         unsigned streamIdx = 0;
         for (auto const& stream : rtpStreams_) {
@@ -2043,6 +2066,8 @@ SIPCall::startAllMedia()
                   getCallId().c_str());
     }
 
+    markSetupPhase(SetupPhase::MEDIA_START);
+
     // reset
     readyToRecord_ = false;
     resetMediaReady();
@@ -2063,7 +2088,7 @@ SIPCall::startAllMedia()
         // Not restarting media loop on hold as it's a huge waste of CPU ressources
         // because of the audio loop
         if (getState() != CallState::HOLD) {
-            if (isIceRunning()) {
+            if (isMediaTransportRunning()) {
                 iter->rtpSession_->start(std::move(iter->rtpSocket_), std::move(iter->rtcpSocket_));
             } else {
                 iter->rtpSession_->start(nullptr, nullptr);
@@ -2485,7 +2510,8 @@ SIPCall::onMediaNegotiationComplete()
             // ICE callback, otherwise, it will be handled here.
             // Note that ICE can be negotiated in the first invite and not negotiated
             // in the re-invite. In this case, the media transport is unchanged (reused).
-            if (this_->isIceEnabled() and this_->remoteHasValidIceAttributes()) {
+            if ((this_->isIceEnabled() and this_->remoteHasValidIceAttributes())
+                or this_->mediaChannelsNegotiated()) {
                 if (not this_->isSubcall()) {
                     // Start ICE checks. Media will be started once ICE checks complete.
                     this_->startIceMedia();
@@ -2520,9 +2546,110 @@ SIPCall::reportMediaNegotiationStatus()
         MediaAttribute::mediaAttributesToMediaMaps(getMediaAttributeList()));
 }
 
+bool
+SIPCall::canUseMediaChannels() const
+{
+    auto account = getSIPAccount();
+    // Only over a datagram connection, and only for the first media negotiation
+    return account and account->mediaChannelsSupported() and sipTransport_
+           and not sipTransport_->isReliable() and not sipTransport_->deviceId().empty()
+           and getConnectionState() != ConnectionState::CONNECTED;
+}
+
+bool
+SIPCall::acceptMediaChannels()
+{
+    if (not sdp_ or not sdp_->getRemoteSdpSession() or not canUseMediaChannels())
+        return false;
+    auto token = Sdp::getMediaChannelToken(sdp_->getRemoteSdpSession());
+    if (token.empty())
+        return false;
+    getSIPAccount()->acceptMediaChannels(token, sipTransport_->deviceId());
+    sdp_->addMediaChannelToken(token);
+    mediaChannelToken_ = std::move(token);
+    return true;
+}
+
+bool
+SIPCall::mediaChannelsNegotiated() const
+{
+    return not mediaChannelToken_.empty() and sdp_
+           and sdp_->getMediaChannelToken() == mediaChannelToken_;
+}
+
+bool
+SIPCall::startMediaChannels()
+{
+    // Only if both peers agreed on the token, and only once (re-invites use ICE)
+    if (not mediaChannelsNegotiated()) {
+        mediaChannelToken_.clear();
+        return false;
+    }
+    auto token = std::exchange(mediaChannelToken_, {});
+    auto account = getSIPAccount();
+    auto deviceId = sipTransport_ ? sipTransport_->deviceId() : std::string_view {};
+    if (not account or deviceId.empty())
+        return false;
+
+    std::vector<unsigned> compIds;
+    for (unsigned idx = 0, compId = 1; idx < rtpStreams_.size(); idx++, compId += 2) {
+        compIds.emplace_back(compId);
+        if (not rtcpMuxEnabled_)
+            compIds.emplace_back(compId + 1);
+    }
+
+    JAMI_DBG("[call:%s] Starting media channels", getCallId().c_str());
+    return account->getMediaChannels(
+        token,
+        deviceId,
+        compIds,
+        getCallType() == CallType::OUTGOING,
+        [w = weak(), start = std::chrono::steady_clock::now()](
+            SIPAccountBase::MediaChannels&& channels) {
+            runOnMainThread([w, start, channels = std::move(channels)]() mutable {
+                auto call = w.lock();
+                // Channels of a subcall belong to the parent call once merged
+                if (call and call->isSubcall())
+                    call = std::dynamic_pointer_cast<SIPCall>(call->parent_);
+                if (not call) {
+                    for (auto& [compId, channel] : channels)
+                        channel->shutdown();
+                    return;
+                }
+                std::lock_guard<std::recursive_mutex> lk {call->callMutex_};
+                if (channels.empty()) {
+                    // The callee did not gather a media ICE session: the caller re-invites
+                    // with a new one, the callee waits for it.
+                    if (call->getCallType() == CallType::OUTGOING) {
+                        JAMI_WARN("[call:%s] Media channels failed, re-inviting with ICE",
+                                  call->getCallId().c_str());
+                        call->requestReinvite(call->getMediaAttributeList(), true);
+                    } else {
+                        JAMI_WARN("[call:%s] Media channels failed, waiting for an ICE re-invite",
+                                  call->getCallId().c_str());
+                    }
+                    return;
+                }
+                JAMI_DBG("[call:%s] Media channels ready in %ld ms",
+                         call->getCallId().c_str(),
+                         std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count());
+                {
+                    std::lock_guard<std::mutex> lkt(call->transportMtx_);
+                    call->mediaChannels_ = std::move(channels);
+                }
+                call->onMediaChannelsReady();
+            });
+        });
+}
+
 void
 SIPCall::startIceMedia()
 {
+    if (startMediaChannels())
+        return;
+
     JAMI_DBG("[call:%s] Starting ICE", getCallId().c_str());
     auto iceMedia = getIceMedia();
     if (not iceMedia or iceMedia->isFailed()) {
@@ -2566,11 +2693,40 @@ SIPCall::onIceNegoSucceed()
 
     JAMI_DBG("[call:%s] ICE negotiation succeeded", getCallId().c_str());
 
+    // Media is now carried by ICE
+    SIPAccountBase::MediaChannels channels;
+    {
+        std::lock_guard<std::mutex> lkt(transportMtx_);
+        channels = std::move(mediaChannels_);
+    }
+    for (auto& [compId, channel] : channels)
+        channel->shutdown();
+
+    onMediaTransportReady();
+}
+
+void
+SIPCall::onMediaChannelsReady()
+{
+    std::lock_guard<std::recursive_mutex> lk {callMutex_};
+
+    JAMI_DBG("[call:%s] Media channels opened", getCallId().c_str());
+    {
+        // Release the candidates gathered for the offer (the callee did not gather any)
+        std::lock_guard<std::mutex> lkt(transportMtx_);
+        resetTransport(std::move(iceMedia_));
+    }
+    onMediaTransportReady();
+}
+
+void
+SIPCall::onMediaTransportReady()
+{
     // Check if the call is already ended, so we don't need to restart medias
     // This is typically the case in a multi-device context where one device
     // can stop a call. So do not start medias
     if (not inviteSession_ or inviteSession_->state == PJSIP_INV_STATE_DISCONNECTED or not sdp_) {
-        JAMI_ERR("[call:%s] ICE negotiation succeeded, but call is in invalid state",
+        JAMI_ERR("[call:%s] Media transport ready, but call is in invalid state",
                  getCallId().c_str());
         return;
     }
@@ -2914,6 +3070,12 @@ SIPCall::enterConference(std::shared_ptr<Conference> conference)
 
 #ifdef ENABLE_PLUGIN
     clearCallAVStreams();
+    {
+        // Release the media handlers' stages of this call, the conference has its own
+        std::lock_guard<std::mutex> lk(avStreamsMtx_);
+        Manager::instance().getJamiPluginManager().getCallServicesManager().clearAVSubject(
+            getCallId());
+    }
 #endif
 }
 
@@ -3227,8 +3389,9 @@ SIPCall::initIceMediaTransport(bool master, std::optional<IceTransportOptions> o
     // Each RTP stream requires a pair of ICE components (RTP + RTCP).
     iceOptions.compCountPerStream = ICE_COMP_COUNT_PER_STREAM;
 
-    // Init ICE.
-    iceMedia->initIceInstance(iceOptions);
+    // Init ICE, with candidates already gathered by the account if possible
+    if (not acc->initPooledIceTransport(*iceMedia, iceOptions))
+        iceMedia->initIceInstance(iceOptions);
 
     return true;
 }
@@ -3278,6 +3441,13 @@ SIPCall::merge(Call& call)
     peerSupportMultiStream_ = subcall.peerSupportMultiStream_;
     peerAllowedMethods_ = subcall.peerAllowedMethods_;
     peerSupportReuseIceInReinv_ = subcall.peerSupportReuseIceInReinv_;
+    mediaChannelToken_ = std::move(subcall.mediaChannelToken_);
+    {
+        std::lock(transportMtx_, subcall.transportMtx_);
+        std::lock_guard<std::mutex> lkt1 {transportMtx_, std::adopt_lock};
+        std::lock_guard<std::mutex> lkt2 {subcall.transportMtx_, std::adopt_lock};
+        mediaChannels_ = std::move(subcall.mediaChannels_);
+    }
 
     Call::merge(subcall);
     if (isIceEnabled())
@@ -3384,15 +3554,22 @@ SIPCall::setupIceResponse(bool isReinvite)
 }
 
 bool
-SIPCall::isIceRunning() const
+SIPCall::isMediaTransportRunning() const
 {
     std::lock_guard<std::mutex> lk(transportMtx_);
-    return iceMedia_ and iceMedia_->isRunning();
+    // Media channels replace the media ICE session
+    return (iceMedia_ and iceMedia_->isRunning()) or not mediaChannels_.empty();
 }
 
 std::unique_ptr<IceSocket>
 SIPCall::newIceSocket(unsigned compId)
 {
+    {
+        std::lock_guard<std::mutex> lk(transportMtx_);
+        auto it = mediaChannels_.find(compId);
+        if (it != mediaChannels_.end())
+            return std::unique_ptr<IceSocket> {new IceSocket(it->second, compId)};
+    }
     return std::unique_ptr<IceSocket> {new IceSocket(getIceMedia(), compId)};
 }
 
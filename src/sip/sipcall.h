@@ -29,6 +29,7 @@
 #endif
 
 #include "call.h"
+#include "generic_io.h"
 #include "ice_transport.h"
 #include "media_codec.h" // for MediaType enum
 #include "sip_utils.h"
@@ -304,7 +305,7 @@ private:
 
     void openPortsUPnP();
 
-    bool isIceRunning() const;
+    bool isMediaTransportRunning() const;
 
     std::unique_ptr<IceSocket> newIceSocket(unsigned compId);
 
@@ -324,6 +325,16 @@ private:
 
     mutable std::mutex transportMtx_ {};
 
+    /**
+     * Media channels opened over the connection of the SIP channel (when it runs over
+     * ICE-UDP and the account enables it), used instead of a dedicated ICE session for
+     * the first media negotiation of Jami calls. Token is exchanged in SDP and consumed
+     * on use. The callee does not gather a media ICE session; if the channels fail, the
+     * caller re-invites with ICE.
+     */
+    std::string mediaChannelToken_ {};
+    std::map<unsigned, std::shared_ptr<GenericSocket<uint8_t>>> mediaChannels_ {};
+
 #ifdef ENABLE_PLUGIN
     /**
      * Call Streams and some typedefs
@@ -358,7 +369,13 @@ private:
 
     void setCallMediaLocal();
     void startIceMedia();
+    bool canUseMediaChannels() const;
+    bool acceptMediaChannels();
+    bool mediaChannelsNegotiated() const;
+    bool startMediaChannels();
     void onIceNegoSucceed();
+    void onMediaChannelsReady();
+    void onMediaTransportReady();
     void setupNegotiatedMedia();
     void startAllMedia();
     void stopAllMedia();
@@ -416,6 +416,7 @@ SipTransportBroker::getChanneledTransport(const std::shared_ptr<SIPAccountBase>&
     auto tr = sips_tr->getTransportBase();
     auto sip_tr = std::make_shared<SipTransport>(tr);
     sip_tr->setDeviceId(socket->deviceId().toString());
+    sip_tr->setReliable(socket->isReliable());
     sip_tr->setAccount(account);
 
     {
@@ -115,6 +115,9 @@ public:
 
     inline void setDeviceId(const std::string& deviceId) { deviceId_ = deviceId; }
     inline std::string_view deviceId() const { return deviceId_; }
+    /** False if the transport is a channel of a datagram (DTLS) peer connection */
+    inline void setReliable(bool reliable) { reliable_ = reliable; }
+    inline bool isReliable() const { return reliable_; }
     inline void setAccount(const std::shared_ptr<SIPAccountBase>& account) { account_ = account; }
     inline const std::weak_ptr<SIPAccountBase>& getAccount() const { return account_; }
 
@@ -133,6 +136,7 @@ private:
 
     bool connected_ {false};
     std::string deviceId_ {};
+    bool reliable_ {true};
     TlsInfos tlsInfos_;
 };
 
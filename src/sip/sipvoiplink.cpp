@@ -51,6 +51,7 @@
 #include "sip_utils.h"
 #include "string_utils.h"
 #include "logger.h"
+#include "cpu_accounting.h"
 
 #include <opendht/thread_pool.h>
 
@@ -416,6 +417,7 @@ transaction_request_cb(pjsip_rx_data* rdata)
     if (!call) {
         return PJ_FALSE;
     }
+    call->markSetupPhase(Call::SetupPhase::SIP_INVITE);
 
     call->setPeerUaVersion(sip_utils::getPeerUserAgent(rdata));
 
@@ -735,6 +737,7 @@ SIPVoIPLink::SIPVoIPLink()
 #undef TRY
 
     sipThread_ = std::thread([this] {
+        CpuAccounting::getInstance().registerThread("sip", "sip");
         while (running_)
             handleEvents();
     });
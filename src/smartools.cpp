@@ -22,8 +22,14 @@
 #include "jami/callmanager_interface.h"
 #include "client/ring_signal.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace jami {
 
+// Number of calls used to compute the setup percentiles
+static constexpr size_t MAX_SETUP_SAMPLES {256};
+
 Smartools&
 Smartools::getInstance()
 {
@@ -41,10 +47,42 @@ void
 Smartools::sendInfo()
 {
     std::lock_guard<std::mutex> lk(mutexInfo_);
+    information_.merge(getSetupPercentiles());
     emitSignal<DRing::CallSignal::SmartInfo>(information_);
     information_.clear();
 }
 
+void
+Smartools::addCallSetupTimeline(const std::map<std::string, std::chrono::milliseconds>& timeline)
+{
+    std::lock_guard<std::mutex> lk(mutexInfo_);
+    for (const auto& [phase, time] : timeline) {
+        auto& samples = setupSamples_[phase];
+        samples.emplace_back(time);
+        if (samples.size() > MAX_SETUP_SAMPLES)
+            samples.pop_front();
+    }
+}
+
+std::map<std::string, std::string>
+Smartools::getSetupPercentiles() const
+{
+    std::map<std::string, std::string> percentiles;
+    for (const auto& [phase, samples] : setupSamples_) {
+        if (samples.empty())
+            continue;
+        std::vector<std::chrono::milliseconds> sorted(samples.begin(), samples.end());
+        std::sort(sorted.begin(), sorted.end());
+        for (auto p : {50, 90, 99}) {
+            // Nearest-rank percentile
+            auto rank = (p * sorted.size() + 99) / 100;
+            percentiles["setup " + phase + " p" + std::to_string(p)] = std::to_string(
+                sorted[std::max<size_t>(rank, 1) - 1].count());
+        }
+    }
+    return percentiles;
+}
+
 void
 Smartools::start(std::chrono::milliseconds refreshTimeMs)
 {
@@ -21,6 +21,7 @@
 
 #include <string>
 #include <chrono>
+#include <deque>
 #include <mutex>
 #include <map>
 #include <memory>
@@ -45,6 +46,11 @@ public:
     void setRemoteVideoCodec(const std::string& remoteVideoCodec, const std::string& callID);
     void setRemoteAudioCodec(const std::string& remoteAudioCodec);
     void setLocalAudioCodec(const std::string& remoteAudioCodec);
+    /**
+     * Add the setup timeline of a call (phase -> time since the creation of the call).
+     * Percentiles over the last calls are sent with the other information.
+     */
+    void addCallSetupTimeline(const std::map<std::string, std::chrono::milliseconds>& timeline);
     void sendInfo();
 
 private:
@@ -52,6 +58,9 @@ private:
     ~Smartools();
     std::mutex mutexInfo_; // Protect information_ from multithreading
     std::map<std::string, std::string> information_;
+    // Setup times of the last calls, per phase
+    std::map<std::string, std::deque<std::chrono::milliseconds>> setupSamples_;
+    std::map<std::string, std::string> getSetupPercentiles() const;
     std::shared_ptr<RepeatedTask> task_;
 };
 } // namespace jami
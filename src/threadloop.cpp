@@ -20,6 +20,7 @@
 
 #include "threadloop.h"
 #include "logger.h"
+#include "cpu_accounting.h"
 
 #include <ciso646> // fix windows compiler bug
 
@@ -32,6 +33,8 @@ ThreadLoop::mainloop(std::thread::id& tid,
                      const std::function<void()> cleanup)
 {
     tid = std::this_thread::get_id();
+    if (not group_.empty())
+        CpuAccounting::getInstance().registerThread(group_, name_);
     try {
         if (setup()) {
             while (state_ == ThreadState::RUNNING)
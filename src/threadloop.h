@@ -27,6 +27,7 @@
 #include <stdexcept>
 #include <condition_variable>
 #include <mutex>
+#include <string>
 
 namespace jami {
 
@@ -53,6 +54,16 @@ public:
     void join();
     void waitForCompletion(); // thread will stop itself
 
+    /**
+     * Name the thread and account its CPU time to group (see CpuAccounting).
+     * Takes effect on next start().
+     */
+    void setName(std::string group, std::string name)
+    {
+        group_ = std::move(group);
+        name_ = std::move(name);
+    }
+
     bool isRunning() const noexcept;
     bool isStopping() const noexcept { return state_ == ThreadState::STOPPING; }
     std::thread::id get_id() const noexcept { return threadId_; }
@@ -73,6 +84,9 @@ private:
                   const std::function<void()> process,
                   const std::function<void()> cleanup);
 
+    std::string group_;
+    std::string name_;
+
     std::atomic<ThreadState> state_ {ThreadState::READY};
     std::thread::id threadId_;
     std::thread thread_;
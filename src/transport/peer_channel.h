@@ -18,6 +18,8 @@
  */
 #pragma once
 
+#include "memory_accounting.h"
+
 #include <mutex>
 #include <condition_variable>
 #include <deque>
@@ -34,6 +36,8 @@ public:
     {
         std::lock_guard<std::mutex> lk(o.mutex_);
         stream_ = std::move(o.stream_);
+        streamMemory_.update(stream_.size());
+        o.streamMemory_.update(o.stream_.size());
         stop_ = o.stop_;
         o.cv_.notify_all();
     }
@@ -61,6 +65,7 @@ public:
                 auto endIt = stream_.begin() + toRead;
                 std::copy(stream_.begin(), endIt, output);
                 stream_.erase(stream_.begin(), endIt);
+                streamMemory_.update(stream_.size());
             }
             ec.clear();
             return toRead;
@@ -73,6 +78,12 @@ public:
         return -1;
     }
 
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lk {mutex_};
+        return stream_.size();
+    }
+
     ssize_t write(const char* data, std::size_t size, std::error_code& ec)
     {
         std::lock_guard<std::mutex> lk {mutex_};
@@ -81,6 +92,7 @@ public:
             return -1;
         }
         stream_.insert(stream_.end(), data, data + size);
+        streamMemory_.update(stream_.size());
         cv_.notify_all();
         ec.clear();
         return size;
@@ -100,9 +112,10 @@ private:
     PeerChannel& operator=(const PeerChannel& o) = delete;
     PeerChannel& operator=(PeerChannel&& o) = delete;
 
-    std::mutex mutex_ {};
+    mutable std::mutex mutex_ {};
     std::condition_variable cv_ {};
     std::deque<char> stream_;
+    TrackedBytes<MemoryPool::ICE_RX> streamMemory_;
     bool stop_ {false};
 };
 
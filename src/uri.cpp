@@ -41,6 +41,8 @@ Uri::Uri(const std::string_view& uri)
             scheme_ = Uri::Scheme::GIT;
         else if (scheme_str == "sync")
             scheme_ = Uri::Scheme::SYNC;
+        else if (scheme_str == "media")
+            scheme_ = Uri::Scheme::MEDIA;
         else
             scheme_ = Uri::Scheme::UNRECOGNIZED;
         authority_ = uri.substr(posSep + 1);
@@ -79,6 +81,8 @@ Uri::schemeToString() const
         return "git";
     case Uri::Scheme::SYNC:
         return "sync";
+    case Uri::Scheme::MEDIA:
+        return "media";
     case Uri::Scheme::JAMI:
     case Uri::Scheme::UNRECOGNIZED:
     default:
@@ -34,6 +34,7 @@ public:
         GIT,           // Start with "git:"
         DATA_TRANSFER, // Start with "data-transfer://"
         SYNC,          // Start with "sync:"
+        MEDIA,         // Start with "media://"
         UNRECOGNIZED   // Anything that doesn't fit in other categories
     };
 
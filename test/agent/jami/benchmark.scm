@@ -0,0 +1,107 @@
+(define-module (jami benchmark)
+  #:use-module (ice-9 format)
+  #:use-module (ice-9 rdelim)
+  #:use-module (ice-9 threads)
+  #:use-module (srfi srfi-1)
+  #:export (make-recorder
+            now-ms
+            record!
+            measure
+            samples
+            percentile
+            process-stats
+            recorder->report
+            write-report))
+
+;;; Monotonic time in milliseconds.
+(define (now-ms)
+  (/ (* 1000.0 (get-internal-real-time)) internal-time-units-per-second))
+
+;;; A recorder accumulates latency samples (in ms) by name, from any thread.
+(define (make-recorder)
+  (cons (make-mutex) (make-hash-table)))
+
+(define (record! recorder name ms)
+  (with-mutex (car recorder)
+    (hash-set! (cdr recorder) name
+               (cons ms (hash-ref (cdr recorder) name '())))))
+
+;;; Call THUNK, record its duration under NAME and return its value.
+(define (measure recorder name thunk)
+  (let* ([start (now-ms)]
+         [result (thunk)])
+    (record! recorder name (- (now-ms) start))
+    result))
+
+(define (samples recorder name)
+  (with-mutex (car recorder)
+    (hash-ref (cdr recorder) name '())))
+
+;;; Nearest-rank percentile P (0-100) of the list of numbers LST.
+(define (percentile lst p)
+  (if (null? lst)
+      #f
+      (let* ([sorted (sort lst <)]
+             [rank (max 1 (inexact->exact (ceiling (* (/ p 100) (length sorted)))))])
+        (list-ref sorted (1- rank)))))
+
+(define (proc-status-ref key)
+  (call-with-input-file "/proc/self/status"
+    (lambda (port)
+      (let loop ([line (read-line port)])
+        (cond
+         [(eof-object? line) #f]
+         [(string-prefix? key line)
+          (string->number (car (string-tokenize (substring line (string-length key)))))]
+         [else (loop (read-line port))])))))
+
+;;; CPU time (ms), resident memory (KiB) and thread count of this process.
+(define (process-stats)
+  (let ([t (times)])
+    `(("cpu-user-ms" . ,(/ (* 1000.0 (tms:utime t)) internal-time-units-per-second))
+      ("cpu-system-ms" . ,(/ (* 1000.0 (tms:stime t)) internal-time-units-per-second))
+      ("rss-kib" . ,(proc-status-ref "VmRSS:"))
+      ("hwm-kib" . ,(proc-status-ref "VmHWM:"))
+      ("threads" . ,(proc-status-ref "Threads:")))))
+
+;;; Latency summary of each sample set of RECORDER.
+(define (recorder->report recorder)
+  (with-mutex (car recorder)
+    (hash-map->list
+     (lambda (name lst)
+       (cons name
+             `(("count" . ,(length lst))
+               ("p50" . ,(percentile lst 50))
+               ("p90" . ,(percentile lst 90))
+               ("p99" . ,(percentile lst 99))
+               ("max" . ,(apply max lst)))))
+     (cdr recorder))))
+
+(define (write-json value port)
+  (cond
+   [(null? value) (display "{}" port)]
+   [(and (pair? value) (every pair? value))
+    (display "{" port)
+    (let loop ([lst value] [first? #t])
+      (unless (null? lst)
+        (unless first? (display "," port))
+        (write (format #f "~a" (caar lst)) port)
+        (display ":" port)
+        (write-json (cdar lst) port)
+        (loop (cdr lst) #f)))
+    (display "}" port)]
+   [(number? value) (format port "~,3f" value)]
+   [(boolean? value) (display (if value "true" "null") port)]
+   [else (write (format #f "~a" value) port)]))
+
+;;; Write a JSON report for SCENARIO with RECORDER's percentiles, the process
+;;; statistics and the EXTRA alist to FILENAME.
+(define* (write-report filename scenario recorder #:optional (extra '()))
+  (call-with-output-file filename
+    (lambda (port)
+      (write-json `(("scenario" . ,scenario)
+                    ("latency-ms" . ,(recorder->report recorder))
+                    ("process" . ,(process-stats))
+                    ,@extra)
+                  port)
+      (newline port))))
@@ -0,0 +1 @@
+../../agent.scm
\ No newline at end of file
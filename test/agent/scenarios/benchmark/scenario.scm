@@ -0,0 +1,352 @@
+#!/usr/bin/env -S ./agent.exe --no-auto-compile -e main -s
+!#
+
+;;; Commentary:
+;;;
+;;; This scenario measures the latency of common workloads between one host
+;;; and one or more drivers, all running on the same machine.
+;;;
+;;; Parameters (environment):
+;;;   BENCH_COUNT       iterations per driver (default 20)
+;;;   BENCH_FILE_SIZE   size in bytes of the transferred file (default 10 MiB)
+;;;   BENCH_BOOTSTRAP   DHT bootstrap node, e.g. 127.0.0.1:4222
+;;;   BENCH_PROXY       DHT proxy of the idle accounts (default: account's)
+;;;   BENCH_IDLE_TIME   seconds during which idle accounts are observed (default 120)
+;;;   BENCH_REPORT      JSON report file (default <role>-report.json)
+;;;   BENCH_WORKLOAD    workload of the drivers, for the host
+;;;
+;;; Host's view:
+;;;   accept trust requests and calls
+;;;   join each incoming call into a conference      (conference workload)
+;;;   acknowledge "bench:" messages and received files
+;;;   write report on SIGINT/SIGTERM
+;;;
+;;; Driver's view, for one WORKLOAD:
+;;;   call-storm:     BENCH_COUNT x (call host, wait CURRENT, hang up)
+;;;   message-flood:  BENCH_COUNT messages sent at once, wait each ack
+;;;   file-transfer:  BENCH_COUNT x (send file, wait ack)
+;;;   conference:     call host and stay in its conference
+;;;   write report, exit success if every iteration completed
+;;;
+;;; Idle view, for one MODE (standby or always) and COUNT accounts:
+;;;   add COUNT accounts using the DHT proxy, activated on demand if standby
+;;;   wait BENCH_IDLE_TIME seconds without any activity
+;;;   write report with the memory, threads and DHT messages per account,
+;;;   exit success if every account is in MODE
+;;;
+;;; Code:
+
+(use-modules
+ (ice-9 match)
+ (ice-9 threads)
+ (srfi srfi-1)
+ ((agent) #:prefix agent:)
+ ((jami account) #:prefix account:)
+ ((jami call) #:prefix call:)
+ ((jami conversation) #:prefix conversation:)
+ ((jami signal) #:prefix jami:)
+ ((jami logger) #:prefix jami:)
+ ((jami benchmark) #:prefix bench:))
+
+(define (getenv/default name default)
+  (or (getenv name) default))
+
+(define COUNT (string->number (getenv/default "BENCH_COUNT" "20")))
+(define FILE-SIZE (string->number (getenv/default "BENCH_FILE_SIZE" "10485760")))
+(define IDLE-TIME (string->number (getenv/default "BENCH_IDLE_TIME" "120")))
+(define TIMEOUT 30)
+
+(define (report-file role)
+  (getenv/default "BENCH_REPORT" (string-append role "-report.json")))
+
+(define* (make-agent account-id #:optional (details '()))
+  (agent:make-agent account-id
+                    #:details
+                    `(,@details
+                      ("Account.upnpEnabled" . "false")
+                      ("TURN.enable" . "false")
+                      ,@(let ([bootstrap (getenv "BENCH_BOOTSTRAP")])
+                          (if bootstrap
+                              `(("Account.hostname" . ,bootstrap))
+                              '())))))
+
+(define (message-ref msg key)
+  (or (assoc-ref msg key) ""))
+
+(define (host)
+
+  (define me (make-agent "bebebebebebebebe"))
+  (define account-id (agent:account-id me))
+  (define recorder (bench:make-recorder))
+  (define conference-call #f)
+  (define file-names (make-hash-table))
+
+  (jami:on-signal 'incoming-trust-request
+                  (lambda (acc conversation-id peer-id payload received)
+                    (when (string= acc account-id)
+                      (account:accept-trust-request acc peer-id))
+                    #t))
+
+  (jami:on-signal 'incoming-call/media
+                  (lambda (acc call-id peer media-lst)
+                    (when (string= acc account-id)
+                      (call:accept acc call-id media-lst))
+                    #t))
+
+  ;; Join every call into the conference of the first one.
+  (jami:on-signal 'state-changed
+                  (lambda (acc call-id state code)
+                    (when (and (string= acc account-id)
+                               (string= state "CURRENT")
+                               (string= (getenv/default "BENCH_WORKLOAD" "") "conference"))
+                      (if conference-call
+                          (bench:measure recorder "conference-join"
+                                         (lambda ()
+                                           (call:join-participant acc conference-call
+                                                                  acc call-id)))
+                          (set! conference-call call-id)))
+                    #t))
+
+  (jami:on-signal 'message-received
+                  (lambda (acc conversation-id msg)
+                    (when (and (string= acc account-id)
+                               (not (string= (message-ref msg "author")
+                                             (agent:peer-id me))))
+                      (let ([type (message-ref msg "type")]
+                            [body (message-ref msg "body")])
+                        (cond
+                         [(and (string= type "text/plain")
+                               (string-prefix? "bench:" body))
+                          (conversation:send-message acc conversation-id
+                                                     (string-append "ack:" body))]
+                         [(string= type "application/data-transfer+json")
+                          (hash-set! file-names (message-ref msg "fileId")
+                                     (message-ref msg "displayName"))
+                          (conversation:download-file
+                           acc conversation-id
+                           (message-ref msg "id")
+                           (message-ref msg "fileId")
+                           (string-append (getenv/default "XDG_DATA_HOME" "/tmp")
+                                          "/" (message-ref msg "fileId")))])))
+                    #t))
+
+  (jami:on-signal 'data-transfer-event
+                  (lambda (acc conversation-id interaction-id file-id code)
+                    ;; 6: DataTransferEventCode::finished
+                    (when (and (string= acc account-id) (= code 6))
+                      (conversation:send-message
+                       acc conversation-id
+                       (string-append "ack:" (or (hash-ref file-names file-id) file-id))))
+                    #t))
+
+  (let ([done (lambda (sig)
+                (bench:write-report (report-file "host") "host" recorder)
+                (jami:info "Host report written")
+                (primitive-exit EXIT_SUCCESS))])
+    (sigaction SIGINT done)
+    (sigaction SIGTERM done))
+
+  (jami:info "Host is ready @~a" (agent:peer-id me))
+
+  (while #t (pause)))
+
+;;; Wait until PRED is true for a signal SIG, at most TIMEOUT seconds.
+(define-syntax-rule (wait-signal sig pred trigger)
+  (jami:with-signal-sync sig pred TIMEOUT trigger))
+
+;;; Call the host and wait for the call to be CURRENT.  Returns the call id, or
+;;; #f on timeout.
+(define (timed-call me host-id recorder)
+  (let* ([account-id (agent:account-id me)]
+         [this-call-id ""]
+         [start (bench:now-ms)])
+    (and (wait-signal 'state-changed
+                      (lambda (acc call-id state code)
+                        (and (string= acc account-id)
+                             (string= call-id this-call-id)
+                             (string= state "CURRENT")))
+                      (set! this-call-id (agent:call-friend me host-id)))
+         (begin
+           (bench:record! recorder "call-setup" (- (bench:now-ms) start))
+           ;; Setup phases measured by the daemon
+           (for-each (match-lambda
+                       [(key . value)
+                        (when (string-prefix? "SETUP_TIMELINE_" key)
+                          (bench:record! recorder key (string->number value)))])
+                     (call:details account-id this-call-id))
+           this-call-id))))
+
+(define (call-storm me host-id recorder)
+  (let loop ([cnt 0] [ok 0])
+    (if (< cnt COUNT)
+        (let ([call-id (timed-call me host-id recorder)])
+          (when call-id
+            (call:hang-up (agent:account-id me) call-id))
+          (sleep 1)
+          (loop (1+ cnt) (if call-id (1+ ok) ok)))
+        ok)))
+
+(define (conversation-with me)
+  (let ([conversations (conversation:get-conversations (agent:account-id me))])
+    (and (> (vector-length conversations) 0)
+         (vector-ref conversations 0))))
+
+;;; Run SEND for each iteration and wait for the host's acknowledgement of the
+;;; key it returns.  All iterations are sent before waiting.
+(define (acknowledged me recorder name send)
+  (let ([mtx (make-mutex)]
+        [cnd (make-condition-variable)]
+        [pending (make-hash-table)]
+        [acked 0])
+    (with-mutex mtx
+      (jami:with-signal
+       'message-received
+       (lambda (acc conversation-id msg)
+         (let ([body (message-ref msg "body")])
+           (when (and (string= acc (agent:account-id me))
+                      (string-prefix? "ack:" body))
+             (with-mutex mtx
+               (let ([start (hash-ref pending (substring body 4))])
+                 (when start
+                   (hash-remove! pending (substring body 4))
+                   (bench:record! recorder name (- (bench:now-ms) start))
+                   (set! acked (1+ acked))
+                   (signal-condition-variable cnd)))))))
+       (let loop ([cnt 0])
+         (when (< cnt COUNT)
+           (hash-set! pending (send cnt) (bench:now-ms))
+           (loop (1+ cnt))))
+       (let wait ()
+         (when (and (< acked COUNT)
+                    (wait-condition-variable cnd mtx (+ (current-time) TIMEOUT)))
+           (wait)))
+       acked))))
+
+(define (message-flood me recorder)
+  (let ([conversation-id (conversation-with me)])
+    (acknowledged me recorder "message-ack"
+                  (lambda (cnt)
+                    (let ([body (format #f "bench:~a" cnt)])
+                      (conversation:send-message (agent:account-id me) conversation-id body)
+                      body)))))
+
+(define (file-transfer me recorder)
+  (let ([conversation-id (conversation-with me)]
+        [path (string-append (getenv/default "XDG_DATA_HOME" "/tmp") "/bench.bin")])
+    (call-with-output-file path
+      (lambda (port)
+        (display (make-string FILE-SIZE #\x) port)))
+    ;; The host acknowledges with the display name of the file
+    (acknowledged me recorder "file-transfer"
+                  (lambda (cnt)
+                    (let ([name (format #f "bench-~a.bin" cnt)])
+                      (conversation:send-file (agent:account-id me) conversation-id
+                                              path name)
+                      name)))))
+
+(define (conference me host-id recorder)
+  ;; The host records the join latency, only the call setup is measured here.
+  (let ([call-id (timed-call me host-id recorder)])
+    (sleep TIMEOUT)
+    (if call-id 1 0)))
+
+(define (driver workload host-id index)
+
+  (define me (make-agent (string-append "dfdfdfdfdfdf" (string-pad index 4 #\0))))
+  (define recorder (bench:make-recorder))
+
+  (unless (agent:make-friend me host-id)
+    (jami:error "Can't make friend with host")
+    (exit EXIT_FAILURE))
+
+  (let* ([expected (if (string= workload "conference") 1 COUNT)]
+         [completed
+          (match workload
+            ["call-storm" (call-storm me host-id recorder)]
+            ["message-flood" (message-flood me recorder)]
+            ["file-transfer" (file-transfer me recorder)]
+            ["conference" (conference me host-id recorder)])])
+    (bench:write-report (report-file (string-append "driver-" index)) workload recorder
+                        `(("completed" . ,completed)
+                          ("expected" . ,expected)))
+    (jami:info "Driver ~a: ~a/~a" index completed expected)
+    (exit (= completed expected))))
+
+;;; Sum of the numeric activity statistic KEY of the accounts ACCOUNT-IDS.
+(define (activity-sum account-ids key)
+  (apply + (map (lambda (account-id)
+                  (or (string->number (message-ref (account:get-activity account-id) key))
+                      0))
+                account-ids)))
+
+(define (idle mode nb-accounts)
+
+  (define n (string->number nb-accounts))
+  (define recorder (bench:make-recorder))
+  (define baseline (bench:process-stats))
+  (define account-ids
+    (map (lambda (i)
+           (agent:account-id
+            (bench:measure recorder "account-ready"
+                           (lambda ()
+                             (make-agent
+                              (string-append "1d1e1d1e1d1e" (string-pad (number->string i) 4 #\0))
+                              `(("Account.activateOnDemand" . ,(if (string= mode "standby")
+                                                                   "true"
+                                                                   "false"))
+                                ("Account.proxyEnabled" . "true")
+                                ,@(let ([proxy (getenv "BENCH_PROXY")])
+                                    (if proxy
+                                        `(("Account.proxyServer" . ,proxy))
+                                        '()))))))))
+         (iota n)))
+
+  ;; Process statistics are for the whole daemon, the difference with the
+  ;; baseline is shared between the accounts.
+  (define (per-account key before after)
+    (exact->inexact (/ (- (assoc-ref after key) (assoc-ref before key)) n)))
+
+  (define (mean key)
+    (exact->inexact (/ (activity-sum account-ids key) n)))
+
+  (let ([name (string-append "idle-" mode)]
+        [in (activity-sum account-ids "dht.messages.in")]
+        [out (activity-sum account-ids "dht.messages.out")]
+        [start (bench:now-ms)])
+    (sleep IDLE-TIME)
+    (let* ([minutes (/ (- (bench:now-ms) start) 60000)]
+           [stats (bench:process-stats)]
+           [in-mode (count (lambda (account-id)
+                             (string= mode (message-ref (account:get-activity account-id)
+                                                        "mode")))
+                           account-ids)])
+      (bench:write-report
+       (report-file name) name recorder
+       `(("accounts" . ,n)
+         ("in-mode" . ,in-mode)
+         ("per-account"
+          . (("rss-kib" . ,(per-account "rss-kib" baseline stats))
+             ("threads" . ,(per-account "threads" baseline stats))
+             ("cpu-ms" . ,(+ (per-account "cpu-user-ms" baseline stats)
+                             (per-account "cpu-system-ms" baseline stats)))
+             ("dht-in-per-min"
+              . ,(/ (- (activity-sum account-ids "dht.messages.in") in) n minutes))
+             ("dht-out-per-min"
+              . ,(/ (- (activity-sum account-ids "dht.messages.out") out) n minutes))
+             ("connections" . ,(mean "connections"))
+             ("ice-pooled" . ,(mean "ice.pooled"))))))
+      (jami:info "Idle ~a: ~a/~a accounts in mode" mode in-mode n)
+      (exit (= in-mode n)))))
+
+(define (main args)
+
+  (match (cdr args)
+    [("host") (host)]
+    [("driver" workload host-id index) (driver workload host-id index)]
+    [("idle" (and mode (or "standby" "always")) nb-accounts) (idle mode nb-accounts)]
+    [_
+     (jami:error "Invalid arguments: ~a" args)
+     (jami:error "Usage: ~a host|driver WORKLOAD HOST-ID INDEX|idle MODE COUNT\n" (car args))
+     (exit EXIT_FAILURE)])
+
+  (exit EXIT_SUCCESS))
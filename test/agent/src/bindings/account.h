@@ -68,6 +68,14 @@ static SCM export_to_file_binding(SCM accountID_str, SCM path_str, SCM passwd_st
                                         from_guile(passwd_str_optional)));
 }
 
+static SCM
+get_activity_binding(SCM accountID_str)
+{
+    LOG_BINDING();
+
+    return to_guile(DRing::getAccountActivity(from_guile(accountID_str)));
+}
+
 static SCM
 add_account_binding(SCM details_alist, SCM accountID_str_optional)
 {
@@ -155,6 +163,7 @@ install_account_primitives(void *)
     define_primitive("set-details", 2, 0, 0, (void*) set_details_binding);
     define_primitive("get-details", 1, 0, 0, (void*) get_details_binding);
     define_primitive("send-register", 2, 0, 0, (void*) send_register_binding);
+    define_primitive("get-activity", 1, 0, 0, (void*) get_activity_binding);
     define_primitive("account->archive", 2, 1, 0, (void*) export_to_file_binding);
     define_primitive("add", 1, 1, 0, (void*) add_account_binding);
     define_primitive("add-contact", 2, 0, 0, (void*) add_contact_binding);
@@ -89,6 +89,25 @@ unhold_binding(SCM accountID_str, SCM callID_str)
     return to_guile(DRing::unhold(from_guile(accountID_str), from_guile(callID_str)));
 }
 
+static SCM
+details_binding(SCM accountID_str, SCM callID_str)
+{
+    LOG_BINDING();
+
+    return to_guile(DRing::getCallDetails(from_guile(accountID_str), from_guile(callID_str)));
+}
+
+static SCM
+join_participant_binding(SCM accountID_str, SCM callID_str, SCM account2ID_str, SCM call2ID_str)
+{
+    LOG_BINDING();
+
+    return to_guile(DRing::joinParticipant(from_guile(accountID_str),
+                                           from_guile(callID_str),
+                                           from_guile(account2ID_str),
+                                           from_guile(call2ID_str)));
+}
+
 static void
 install_call_primitives(void*)
 {
@@ -98,4 +117,6 @@ install_call_primitives(void*)
     define_primitive("refuse", 2, 0, 0, (void*) refuse_binding);
     define_primitive("hold", 2, 0, 0, (void*) hold_binding);
     define_primitive("unhold", 2, 0, 0, (void*) unhold_binding);
+    define_primitive("details", 2, 0, 0, (void*) details_binding);
+    define_primitive("join-participant", 4, 0, 0, (void*) join_participant_binding);
 }
@@ -22,6 +22,7 @@
 
 /* Jami */
 #include "jami/conversation_interface.h"
+#include "jami/datatransfer_interface.h"
 
 /* Agent */
 #include "utils.h"
@@ -77,6 +78,33 @@ send_message_binding(SCM accountID_str, SCM conversationID_str, SCM message_str,
     return SCM_UNDEFINED;
 }
 
+static SCM
+send_file_binding(SCM accountID_str, SCM conversationID_str, SCM path_str, SCM displayName_str)
+{
+    LOG_BINDING();
+
+    DRing::sendFile(from_guile(accountID_str),
+                    from_guile(conversationID_str),
+                    from_guile(path_str),
+                    from_guile(displayName_str),
+                    "");
+
+    return SCM_UNDEFINED;
+}
+
+static SCM
+download_file_binding(SCM accountID_str, SCM conversationID_str, SCM interactionID_str,
+                      SCM fileID_str, SCM path_str)
+{
+    LOG_BINDING();
+
+    return to_guile(DRing::downloadFile(from_guile(accountID_str),
+                                        from_guile(conversationID_str),
+                                        from_guile(interactionID_str),
+                                        from_guile(fileID_str),
+                                        from_guile(path_str)));
+}
+
 static void
 install_conversation_primitives(void *)
 {
@@ -91,4 +119,10 @@ install_conversation_primitives(void *)
 
     define_primitive("send-message", 3, 1, 0,
                      (void*) send_message_binding);
+
+    define_primitive("send-file", 4, 0, 0,
+                     (void*) send_file_binding);
+
+    define_primitive("download-file", 5, 0, 0,
+                     (void*) download_file_binding);
 }
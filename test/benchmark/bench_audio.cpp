@@ -0,0 +1,77 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "audio/audiobuffer.h"
+#include "audio/ringbuffer.h"
+#include "media_buffer.h"
+
+namespace jami {
+namespace bench {
+
+static constexpr size_t FRAME_SIZE {960}; // 20 ms @ 48 kHz
+
+static void
+RingBufferPutGet(benchmark::State& state)
+{
+    const auto format = AudioFormat::STEREO();
+    const auto readers = state.range(0);
+    RingBuffer rb("bench", FRAME_SIZE * 8, format);
+    std::vector<std::string> ids;
+    for (int64_t i = 0; i < readers; ++i)
+        rb.createReadOffset(ids.emplace_back("reader" + std::to_string(i)));
+
+    for (auto _ : state) {
+        rb.put(std::make_shared<AudioFrame>(format, FRAME_SIZE));
+        for (const auto& id : ids)
+            benchmark::DoNotOptimize(rb.get(id));
+    }
+    state.SetItemsProcessed(state.iterations() * FRAME_SIZE);
+}
+BENCHMARK(RingBufferPutGet)->Arg(1)->Arg(4);
+
+static void
+AudioBufferMix(benchmark::State& state)
+{
+    AudioBuffer a(FRAME_SIZE, AudioFormat::STEREO());
+    AudioBuffer b(FRAME_SIZE, AudioFormat::MONO());
+    for (auto _ : state) {
+        a.mix(b, state.range(0));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * FRAME_SIZE);
+}
+BENCHMARK(AudioBufferMix)->Arg(false)->Arg(true);
+
+static void
+AudioFrameMix(benchmark::State& state)
+{
+    const auto format = AudioFormat::STEREO();
+    AudioFrame a(format, FRAME_SIZE);
+    AudioFrame b(format, FRAME_SIZE);
+    for (auto _ : state) {
+        a.mix(b);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * FRAME_SIZE);
+}
+BENCHMARK(AudioFrameMix);
+
+} // namespace bench
+} // namespace jami
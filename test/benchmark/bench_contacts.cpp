@@ -0,0 +1,101 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "jamidht/contact_list.h"
+#include "fileutils.h"
+
+#include <cstdlib>
+
+namespace jami {
+namespace bench {
+
+static std::unique_ptr<ContactList>
+makeContactList(const std::string& path)
+{
+    ContactList::OnChangeCallback cb;
+    cb.contactAdded = [](const std::string&, bool) {};
+    cb.contactRemoved = [](const std::string&, bool) {};
+    cb.trustRequest =
+        [](const std::string&, const std::string&, const std::vector<uint8_t>&, time_t) {};
+    cb.devicesChanged = [](const std::map<dht::PkId, KnownDevice>&) {};
+    cb.acceptConversation = [](const std::string&) {};
+    cb.onConfirmation = [](const std::string&, const std::string&) {};
+    return std::make_unique<ContactList>(nullptr, path, std::move(cb));
+}
+
+static std::map<dht::InfoHash, Contact>
+makeContacts(int64_t count)
+{
+    std::map<dht::InfoHash, Contact> contacts;
+    for (int64_t i = 0; i < count; ++i) {
+        Contact contact;
+        contact.added = 1650000000;
+        contact.confirmed = true;
+        contact.conversationId = dht::InfoHash::get("conversation" + std::to_string(i)).toString();
+        contacts.emplace(dht::InfoHash::get(std::to_string(i)), std::move(contact));
+    }
+    return contacts;
+}
+
+// Contacts added one by one, each change saved
+static void
+ContactListAddEach(benchmark::State& state)
+{
+    auto contacts = makeContacts(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        char templateName[] = {"jami_bench_XXXXXX"};
+        std::string path = mkdtemp(templateName);
+        auto list = makeContactList(path);
+        state.ResumeTiming();
+        for (const auto& c : contacts)
+            list->addContact(c.first, true, c.second.conversationId);
+        state.PauseTiming();
+        list.reset();
+        fileutils::removeAll(path);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(ContactListAddEach)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+// Contacts received from another device
+static void
+ContactListImport(benchmark::State& state)
+{
+    auto contacts = makeContacts(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        char templateName[] = {"jami_bench_XXXXXX"};
+        std::string path = mkdtemp(templateName);
+        auto list = makeContactList(path);
+        state.ResumeTiming();
+        list->updateContacts(contacts);
+        state.PauseTiming();
+        list.reset();
+        fileutils::removeAll(path);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(ContactListImport)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+} // namespace bench
+} // namespace jami
@@ -0,0 +1,131 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "jamidht/conversation_module.h"
+#include "jamidht/conversationrepository.h"
+#include "fileutils.h"
+
+#include <cstdlib>
+#include <fmt/format.h>
+
+namespace jami {
+namespace bench {
+
+constexpr int64_t NB_CONVERSATIONS = 100;
+
+static std::unique_ptr<ConversationModule> module;
+static std::vector<std::string> convIds;
+static std::string dataPath;
+
+// Conversations are only known by their infos (as after an import), the module has
+// no account so nothing is cloned. Infos are saved in a temporary data directory.
+static void
+setupModule()
+{
+    char templateName[] = {"jami_bench_XXXXXX"};
+    dataPath = mkdtemp(templateName);
+    setenv("XDG_DATA_HOME", dataPath.c_str(), 1);
+    module = std::make_unique<ConversationModule>(
+        std::weak_ptr<JamiAccount> {},
+        [] {},
+        [](const std::string&, std::map<std::string, std::string>&&) {},
+        [](const std::string&, const std::string&, ChannelCb&&) {},
+        [](const std::string&, const std::string&, bool) {});
+    for (int64_t i = 0; i < NB_CONVERSATIONS; ++i) {
+        ConvInfo info;
+        info.id = dht::InfoHash::get("conversation" + std::to_string(i)).toString();
+        info.created = 1650000000;
+        info.members = {dht::InfoHash::get("member" + std::to_string(i)).toString()};
+        convIds.emplace_back(info.id);
+        module->addConvInfo(info);
+    }
+}
+
+static void
+teardownModule()
+{
+    module.reset();
+    convIds.clear();
+    fileutils::removeAll(dataPath);
+}
+
+// Client API reads while one thread out of four applies sync writes
+// Note: the setup done by the first thread is visible to all threads once the loop starts
+static void
+ConversationModuleMixedAccess(benchmark::State& state)
+{
+    if (state.thread_index() == 0)
+        setupModule();
+    auto writer = state.thread_index() % 4 == 3;
+    std::vector<std::string> members {dht::InfoHash::get("alice").toString(),
+                                      dht::InfoHash::get("bob").toString()};
+    auto peer = dht::InfoHash::get("bob").toString();
+    size_t i = state.thread_index();
+    for (auto _ : state) {
+        const auto& convId = convIds[i++ % convIds.size()];
+        if (writer) {
+            module->setConversationMembers(convId, members);
+        } else {
+            benchmark::DoNotOptimize(module->getConversationSummaries());
+            benchmark::DoNotOptimize(module->needsSyncingWith(peer, {}));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0)
+        teardownModule();
+}
+BENCHMARK(ConversationModuleMixedAccess)->ThreadRange(1, 16)->UseRealTime();
+
+// Permission checks done on each fetched commit, on a swarm of state.range(0) members
+// (2 devices per member, one member out of ten is invited, one is banned)
+static void
+ConversationMemberIndexPermissionCheck(benchmark::State& state)
+{
+    auto nbMembers = static_cast<std::size_t>(state.range(0));
+    ConversationMemberIndex index;
+    std::vector<ConversationMember> members;
+    std::map<std::string, bool> devices;
+    std::vector<std::string> uris;
+    for (std::size_t i = 0; i < nbMembers; ++i) {
+        auto uri = fmt::format("{:040x}", i);
+        auto role = MemberRole::MEMBER;
+        if (i == 0)
+            role = MemberRole::ADMIN;
+        else if (i == 1)
+            role = MemberRole::BANNED;
+        else if (i % 10 == 0)
+            role = MemberRole::INVITED;
+        members.emplace_back(ConversationMember {uri, role});
+        devices.emplace(fmt::format("{:064x}", 2 * i), false);
+        devices.emplace(fmt::format("{:064x}", 2 * i + 1), false);
+        uris.emplace_back(std::move(uri));
+    }
+    index.reset(std::move(members), std::move(devices));
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const auto& uri = uris[i++ % nbMembers];
+        benchmark::DoNotOptimize(index.isMember(uri, true) && !index.isBanned(uri));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(ConversationMemberIndexPermissionCheck)->Arg(1000)->Arg(10000);
+
+} // namespace bench
+} // namespace jami
@@ -0,0 +1,79 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "observer.h"
+#include "scheduled_executor.h"
+
+namespace jami {
+namespace bench {
+
+using namespace std::literals::chrono_literals;
+
+// Jobs are scheduled far enough in the future to never run during the benchmark.
+// Cancelled tasks stay queued until their time, so the executor is renewed
+// regularly to keep the queue size bounded.
+static void
+ScheduledExecutorInsertCancel(benchmark::State& state)
+{
+    static constexpr int64_t MAX_QUEUED {1 << 16};
+    auto executor = std::make_unique<ScheduledExecutor>();
+    int64_t queued = 0;
+    std::vector<std::shared_ptr<Task>> tasks;
+    tasks.reserve(state.range(0));
+    for (auto _ : state) {
+        for (int64_t i = 0; i < state.range(0); ++i)
+            tasks.emplace_back(executor->scheduleIn([] {}, 1h));
+        for (auto& task : tasks)
+            task->cancel();
+        tasks.clear();
+        if ((queued += state.range(0)) >= MAX_QUEUED) {
+            state.PauseTiming();
+            executor = std::make_unique<ScheduledExecutor>();
+            queued = 0;
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(ScheduledExecutorInsertCancel)->Arg(1)->Arg(64)->Arg(1024);
+
+static void
+ObservableNotify(benchmark::State& state)
+{
+    PublishObservable<std::shared_ptr<int>> observable;
+    std::vector<std::unique_ptr<FuncObserver<std::shared_ptr<int>>>> observers;
+    size_t updates = 0;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        observers.emplace_back(std::make_unique<FuncObserver<std::shared_ptr<int>>>(
+            [&](const std::shared_ptr<int>&) { ++updates; }));
+        observable.attach(observers.back().get());
+    }
+    auto data = std::make_shared<int>(0);
+    for (auto _ : state)
+        observable.publish(data);
+    benchmark::DoNotOptimize(updates);
+    for (auto& o : observers)
+        observable.detach(o.get());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(ObservableNotify)->Arg(1)->Arg(8)->Arg(64);
+
+} // namespace bench
+} // namespace jami
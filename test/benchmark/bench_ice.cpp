@@ -0,0 +1,349 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "ice_transport.h"
+#include "manager.h"
+#include "jami.h"
+#include "peer_connection.h"
+#include "security/tls_session.h"
+
+#include <opendht/crypto.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+
+namespace jami {
+namespace bench {
+
+static void
+initDaemon()
+{
+    static std::once_flag once;
+    std::call_once(once, [] {
+        DRing::init(DRing::InitFlag(0));
+        if (not Manager::instance().initialized)
+            DRing::start();
+    });
+}
+
+// Time until the candidates of a new transport are usable
+static void
+waitInitDone(benchmark::State& state, bool pooled)
+{
+    initDaemon();
+    IceTransportOptions options;
+    options.stunServers.emplace_back(StunServerInfo().setUri("stun.jami.net"));
+    auto pool = std::make_shared<IceTransportPool>(
+        "bench", 1, 1, false, 1, [&](std::function<void(IceTransportOptions&&)>&& cb) {
+            cb(IceTransportOptions(options));
+        });
+    if (pooled)
+        pool->start();
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    for (auto _ : state) {
+        state.PauseTiming();
+        bool done = false;
+        auto config = options;
+        config.onInitDone = [&](bool) {
+            std::lock_guard<std::mutex> lk(mtx);
+            done = true;
+            cv.notify_one();
+        };
+        auto ice = Manager::instance().getIceTransportFactory().createTransport("bench");
+        // Let the pool refill between two requests, as between two calls
+        while (pooled and pool->stats().ready == 0 and state.iterations() > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        state.ResumeTiming();
+
+        if (not pool->initTransport(*ice, config))
+            ice->initIceInstance(config);
+        std::unique_lock<std::mutex> lk(mtx);
+        cv.wait_for(lk, std::chrono::seconds(10), [&] { return done; });
+
+        state.PauseTiming();
+        lk.unlock();
+        dht::ThreadPool::io().run([ice = std::move(ice)] {});
+        state.ResumeTiming();
+    }
+    auto stats = pool->stats();
+    state.counters["hit_rate"] = stats.hitRate();
+    pool->stop();
+}
+
+static void
+IceTransportGathering(benchmark::State& state)
+{
+    waitInitDone(state, false);
+}
+BENCHMARK(IceTransportGathering)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void
+IceTransportPooled(benchmark::State& state)
+{
+    waitInitDone(state, true);
+}
+BENCHMARK(IceTransportPooled)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static constexpr std::size_t DATAGRAM_SIZE {1200}; // RTP packet size
+
+// Two ICE-UDP transports of this process, negotiated with host candidates only
+struct IceLoopback
+{
+    std::shared_ptr<IceTransport> master;
+    std::shared_ptr<IceTransport> slave;
+};
+
+static std::string
+localSdp(const IceTransport& ice)
+{
+    auto attributes = ice.getLocalAttributes();
+    std::ostringstream msg;
+    msg << attributes.ufrag << "\n" << attributes.pwd << "\n";
+    for (const auto& candidate : ice.getLocalCandidates(1))
+        msg << candidate << "\n";
+    return msg.str();
+}
+
+static std::optional<IceLoopback>
+connectLoopback()
+{
+    initDaemon();
+    // Shared with the callbacks, which may outlive a failed negotiation
+    struct Progress
+    {
+        std::mutex mtx;
+        std::condition_variable cv;
+        int initDone {0};
+        int negoDone {0};
+        bool ok {true};
+    };
+    auto progress = std::make_shared<Progress>();
+    IceTransportOptions options;
+    options.streamsCount = 1;
+    options.compCountPerStream = 1;
+    options.onInitDone = [progress](bool ok) {
+        std::lock_guard<std::mutex> lk(progress->mtx);
+        progress->ok = progress->ok and ok;
+        progress->initDone++;
+        progress->cv.notify_all();
+    };
+    options.onNegoDone = [progress](bool ok) {
+        std::lock_guard<std::mutex> lk(progress->mtx);
+        progress->ok = progress->ok and ok;
+        progress->negoDone++;
+        progress->cv.notify_all();
+    };
+
+    auto& factory = Manager::instance().getIceTransportFactory();
+    IceLoopback link {factory.createTransport("bench master"),
+                      factory.createTransport("bench slave")};
+    options.master = true;
+    link.master->initIceInstance(options);
+    options.master = false;
+    link.slave->initIceInstance(options);
+
+    std::unique_lock<std::mutex> lk(progress->mtx);
+    if (not progress->cv.wait_for(lk, std::chrono::seconds(10), [&] {
+            return progress->initDone == 2;
+        })
+        or not progress->ok)
+        return {};
+    lk.unlock();
+    auto masterSdp = link.master->parseIceCandidates(localSdp(*link.slave));
+    auto slaveSdp = link.slave->parseIceCandidates(localSdp(*link.master));
+    if (not link.master->startIce({masterSdp.rem_ufrag, masterSdp.rem_pwd},
+                                  std::move(masterSdp.rem_candidates))
+        or not link.slave->startIce({slaveSdp.rem_ufrag, slaveSdp.rem_pwd},
+                                    std::move(slaveSdp.rem_candidates)))
+        return {};
+    lk.lock();
+    if (not progress->cv.wait_for(lk, std::chrono::seconds(10), [&] {
+            return progress->negoDone == 2;
+        })
+        or not progress->ok)
+        return {};
+    return link;
+}
+
+static void
+releaseLoopback(IceLoopback&& link)
+{
+    link.master->setOnRecv(1, nullptr);
+    link.slave->setOnRecv(1, nullptr);
+    dht::ThreadPool::io().run([link = std::move(link)] {});
+}
+
+// Delivery time of one datagram, from the send call to the receive callback of the peer
+static void
+IceLoopbackLatency(benchmark::State& state)
+{
+    auto link = connectLoopback();
+    if (not link) {
+        state.SkipWithError("ICE negotiation failed");
+        return;
+    }
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool received {false};
+    link->slave->setOnRecv(1, [&](unsigned char*, size_t len) {
+        std::lock_guard<std::mutex> lk(mtx);
+        received = true;
+        cv.notify_one();
+        return static_cast<ssize_t>(len);
+    });
+    std::vector<uint8_t> datagram(DATAGRAM_SIZE, 'x');
+    int64_t lost {0};
+    for (auto _ : state) {
+        std::unique_lock<std::mutex> lk(mtx);
+        received = false;
+        link->master->send(1, datagram.data(), datagram.size());
+        if (not cv.wait_for(lk, std::chrono::milliseconds(100), [&] { return received; }))
+            lost++;
+    }
+    state.counters["lost"] = lost;
+    releaseLoopback(std::move(*link));
+}
+BENCHMARK(IceLoopbackLatency)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// Bursts of range(0) datagrams, until all of them are received or the burst times out
+static void
+IceLoopbackThroughput(benchmark::State& state)
+{
+    auto link = connectLoopback();
+    if (not link) {
+        state.SkipWithError("ICE negotiation failed");
+        return;
+    }
+    std::mutex mtx;
+    std::condition_variable cv;
+    int64_t received {0};
+    link->slave->setOnRecv(1, [&](unsigned char*, size_t len) {
+        std::lock_guard<std::mutex> lk(mtx);
+        received++;
+        cv.notify_one();
+        return static_cast<ssize_t>(len);
+    });
+    std::vector<uint8_t> datagram(DATAGRAM_SIZE, 'x');
+    auto burst = state.range(0);
+    int64_t lost {0};
+    for (auto _ : state) {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            received = 0;
+        }
+        for (int64_t i = 0; i < burst; ++i)
+            link->master->send(1, datagram.data(), datagram.size());
+        std::unique_lock<std::mutex> lk(mtx);
+        cv.wait_for(lk, std::chrono::milliseconds(100), [&] { return received == burst; });
+        lost += burst - received;
+    }
+    state.SetBytesProcessed(state.iterations() * burst * DATAGRAM_SIZE);
+    state.counters["lost"] = lost;
+    releaseLoopback(std::move(*link));
+}
+BENCHMARK(IceLoopbackThroughput)->Arg(1)->Arg(64)->UseRealTime();
+
+// Goodput of DTLS (as used by peer connections over UDP) on top of the loopback ICE session
+static void
+IceDtlsLoopbackThroughput(benchmark::State& state)
+{
+    static constexpr std::size_t CHUNK {256 * 1024}; // below the receive queue capacity
+
+    auto link = connectLoopback();
+    if (not link) {
+        state.SkipWithError("ICE negotiation failed");
+        return;
+    }
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::size_t received {0};
+    std::atomic<tls::TlsSessionState> clientState {tls::TlsSessionState::NONE};
+
+    std::promise<tls::DhParams> dhPromise;
+    dhPromise.set_value({});
+    auto makeParams = [dh = dhPromise.get_future().share()] {
+        auto id = dht::crypto::generateEcIdentity("bench");
+        return tls::TlsParams {"", nullptr, id.second, id.first, dh, std::chrono::seconds(10), {}};
+    };
+    auto makeCallbacks = [&](bool server) {
+        tls::TlsSession::TlsSessionCallbacks cbs {};
+        if (server)
+            cbs.onRxData = [&](std::vector<uint8_t>&& buf) {
+                std::lock_guard<std::mutex> lk(mtx);
+                received += buf.size();
+                cv.notify_one();
+            };
+        else
+            cbs.onStateChange = [&](tls::TlsSessionState s) { clientState = s; };
+        cbs.verifyCertificate = [](gnutls_session_t) { return static_cast<int>(GNUTLS_E_SUCCESS); };
+        return cbs;
+    };
+
+    {
+        tls::TlsSession server(std::make_unique<IceSocketEndpoint>(link->slave, false),
+                               makeParams(),
+                               makeCallbacks(true),
+                               false);
+        tls::TlsSession client(std::make_unique<IceSocketEndpoint>(link->master, true),
+                               makeParams(),
+                               makeCallbacks(false),
+                               false);
+        try {
+            client.waitForReady(std::chrono::seconds(30));
+            server.waitForReady(std::chrono::seconds(30));
+        } catch (const std::logic_error&) {
+        }
+        if (clientState != tls::TlsSessionState::ESTABLISHED) {
+            state.SkipWithError("DTLS handshake failed");
+        } else {
+            std::vector<uint8_t> data(CHUNK, 'x');
+            std::error_code ec;
+            for (auto _ : state) {
+                {
+                    std::lock_guard<std::mutex> lk(mtx);
+                    received = 0;
+                }
+                client.write(data.data(), data.size(), ec);
+                std::unique_lock<std::mutex> lk(mtx);
+                if (ec or not cv.wait_for(lk, std::chrono::seconds(5), [&] {
+                        return received >= CHUNK;
+                    })) {
+                    state.SkipWithError("Records lost");
+                    break;
+                }
+            }
+            state.SetBytesProcessed(state.iterations() * CHUNK);
+        }
+        client.shutdown();
+        server.shutdown();
+    }
+    releaseLoopback(std::move(*link));
+}
+BENCHMARK(IceDtlsLoopbackThroughput)->UseRealTime();
+
+} // namespace bench
+} // namespace jami
@@ -0,0 +1,160 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "client/ring_signal.h"
+#include "jami/signal_queue.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace jami {
+namespace bench {
+
+using clock = std::chrono::steady_clock;
+using DRing::ConfigurationSignal;
+using Details = std::map<std::string, std::string>;
+
+// Signals are emitted at 10k/s during one second, only the time spent in
+// emitSignal by the producer thread is measured. The client callback is simulated by busy waiting
+// state.range(0) microseconds (VM entry and conversion of the arguments).
+// Note: neither the JVM nor V8 is involved, the figures don't include their own
+// costs (thread attachment, garbage collection, event loop latency).
+static constexpr auto PERIOD = std::chrono::microseconds(100);
+static constexpr int64_t SIGNALS {10000};
+
+static void
+busyWait(std::chrono::microseconds duration)
+{
+    auto end = clock::now() + duration;
+    while (clock::now() < end)
+        ;
+}
+
+static void
+emitPaced(benchmark::State& state)
+{
+    const std::string accountId = "a1b2c3d4e5f6";
+    const Details details {{"Account.registrationStatus", "REGISTERED"},
+                           {"Account.deviceAnnounced", "true"}};
+    auto next = clock::now();
+    for (auto _ : state) {
+        auto start = clock::now();
+        emitSignal<ConfigurationSignal::VolatileDetailsChanged>(accountId, details);
+        state.SetIterationTime(std::chrono::duration<double>(clock::now() - start).count());
+        next += PERIOD;
+        std::this_thread::sleep_until(next);
+    }
+    DRing::unregisterSignalHandlers();
+}
+
+static void
+setCoalesced(benchmark::State& state, const DRing::SignalQueue& queue)
+{
+    state.counters["coalesced"] = benchmark::Counter(queue.getStats().second,
+                                                     benchmark::Counter::kAvgIterations);
+}
+
+// Callback run by the producer thread (previous behavior of the bindings)
+static void
+SignalEmitDirect(benchmark::State& state)
+{
+    std::chrono::microseconds cost(state.range(0));
+    DRing::registerSignalHandlers(
+        {DRing::exportable_callback<ConfigurationSignal::VolatileDetailsChanged>(
+            [cost](const std::string&, const Details&) { busyWait(cost); })});
+    emitPaced(state);
+}
+BENCHMARK(SignalEmitDirect)
+    ->Arg(5)
+    ->Arg(50)
+    ->Arg(200)
+    ->Iterations(SIGNALS)
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+
+// Queue with its own dispatch thread (JNI)
+static void
+SignalEmitQueuedThread(benchmark::State& state)
+{
+    std::chrono::microseconds cost(state.range(0));
+    DRing::SignalQueue queue;
+    DRing::registerSignalHandlers(
+        {DRing::exportable_queued_callback<ConfigurationSignal::VolatileDetailsChanged>(
+            queue, [cost](const std::string&, const Details&) { busyWait(cost); }, true)});
+    emitPaced(state);
+    setCoalesced(state, queue);
+}
+BENCHMARK(SignalEmitQueuedThread)
+    ->Arg(5)
+    ->Arg(50)
+    ->Arg(200)
+    ->Iterations(SIGNALS)
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+
+// Queue processed by the event loop of the client, woken up by the queue (Node)
+static void
+SignalEmitQueuedLoop(benchmark::State& state)
+{
+    std::chrono::microseconds cost(state.range(0));
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool pending {false};
+    bool running {true};
+    DRing::SignalQueue queue([&] {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            pending = true;
+        }
+        cv.notify_one();
+    });
+    std::thread loop([&] {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (running) {
+            cv.wait(lock, [&] { return pending or not running; });
+            pending = false;
+            lock.unlock();
+            queue.process();
+            lock.lock();
+        }
+    });
+    DRing::registerSignalHandlers(
+        {DRing::exportable_queued_callback<ConfigurationSignal::VolatileDetailsChanged>(
+            queue, [cost](const std::string&, const Details&) { busyWait(cost); }, true)});
+    emitPaced(state);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        running = false;
+    }
+    cv.notify_one();
+    loop.join();
+    setCoalesced(state, queue);
+}
+BENCHMARK(SignalEmitQueuedLoop)
+    ->Arg(5)
+    ->Arg(50)
+    ->Arg(200)
+    ->Iterations(SIGNALS)
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace bench
+} // namespace jami
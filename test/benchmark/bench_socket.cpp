@@ -0,0 +1,146 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "jamidht/multiplexed_socket.h"
+#include "security/record_ring.h"
+
+#include <msgpack.hpp>
+
+namespace jami {
+namespace bench {
+
+// Framing cost alone: msgpack with the packet layout of the multiplexed socket,
+// no endpoint nor event loop involved
+struct MsgpackFrame
+{
+    uint16_t channel;
+    std::vector<uint8_t> data;
+    MSGPACK_DEFINE(channel, data)
+};
+
+static void
+packMsgpackFrame(msgpack::sbuffer& buffer, uint16_t channel, const std::vector<uint8_t>& data)
+{
+    msgpack::packer<msgpack::sbuffer> pk(&buffer);
+    pk.pack_array(2);
+    pk.pack(channel);
+    pk.pack_bin(data.size());
+    pk.pack_bin_body((const char*) data.data(), data.size());
+}
+
+static void
+MsgpackFrameWrite(benchmark::State& state)
+{
+    std::vector<uint8_t> data(state.range(0), 'x');
+    for (auto _ : state) {
+        msgpack::sbuffer buffer(16 + data.size());
+        packMsgpackFrame(buffer, 1, data);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(MsgpackFrameWrite)->Arg(64)->Arg(1500)->Arg(8191);
+
+// Feed a stream of frames to an unpacker by chunks of the event loop buffer size
+static void
+MsgpackFrameRead(benchmark::State& state)
+{
+    static constexpr size_t IO_BUFFER_SIZE {8192};
+    std::vector<uint8_t> data(state.range(0), 'x');
+    msgpack::sbuffer stream;
+    for (int i = 0; i < 64; ++i)
+        packMsgpackFrame(stream, i % 8, data);
+
+    for (auto _ : state) {
+        msgpack::unpacker pac;
+        size_t packets = 0;
+        for (size_t off = 0; off < stream.size(); off += IO_BUFFER_SIZE) {
+            auto len = std::min(IO_BUFFER_SIZE, stream.size() - off);
+            pac.reserve_buffer(len);
+            std::copy_n(stream.data() + off, len, pac.buffer());
+            pac.buffer_consumed(len);
+            msgpack::object_handle oh;
+            while (pac.next(oh)) {
+                auto msg = oh.get().as<MsgpackFrame>();
+                benchmark::DoNotOptimize(msg.data.data());
+                ++packets;
+            }
+        }
+        if (packets != 64)
+            state.SkipWithError("Truncated stream");
+    }
+    state.SetBytesProcessed(state.iterations() * stream.size());
+}
+BENCHMARK(MsgpackFrameRead)->Arg(64)->Arg(1500)->Arg(8191);
+
+static void
+ChannelRequestPack(benchmark::State& state)
+{
+    ChannelRequest req {"git://8f54c9b6a1e2d3f4a5b6c7d8e9f0a1b2c3d4e5f6/"
+                        "b1c2d3e4f5a6b7c8d9e0f1a2b3c4d5e6f7a8b9c0",
+                        42,
+                        ChannelRequestState::REQUEST};
+    for (auto _ : state) {
+        msgpack::sbuffer buffer(512);
+        msgpack::pack(buffer, req);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+}
+BENCHMARK(ChannelRequestPack);
+
+static void
+ChannelRequestUnpack(benchmark::State& state)
+{
+    ChannelRequest req {"sync://", 42, ChannelRequestState::ACCEPT};
+    msgpack::sbuffer buffer(512);
+    msgpack::pack(buffer, req);
+    for (auto _ : state) {
+        size_t off = 0;
+        msgpack::unpacked result;
+        msgpack::unpack(result, buffer.data(), buffer.size(), off);
+        benchmark::DoNotOptimize(result.get().as<ChannelRequest>());
+    }
+}
+BENCHMARK(ChannelRequestUnpack);
+
+// DTLS receive path: bursts of records queued by the ICE thread, then pulled by GnuTLS
+static void
+DtlsRecordQueue(benchmark::State& state)
+{
+    std::vector<uint8_t> record(1200, 'x');
+    std::vector<uint8_t> pulled(64 * 1024);
+    RecordRing ring(1000);
+    auto burst = state.range(0);
+    for (auto _ : state) {
+        for (int64_t i = 0; i < burst; ++i)
+            ring.push(record.data(), record.size());
+        while (not ring.empty()) {
+            const auto& front = ring.front();
+            std::copy(front.begin(), front.end(), pulled.begin());
+            ring.pop();
+        }
+        benchmark::DoNotOptimize(pulled.data());
+    }
+    state.SetBytesProcessed(state.iterations() * burst * record.size());
+}
+BENCHMARK(DtlsRecordQueue)->Arg(1)->Arg(64);
+
+} // namespace bench
+} // namespace jami
@@ -0,0 +1,115 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "base64.h"
+#include "string_utils.h"
+#include "utf8_utils.h"
+
+namespace jami {
+namespace bench {
+
+static std::string
+makeText(size_t size)
+{
+    static constexpr std::string_view sample {"Salut à tous, ça va? こんにちは 👋 "};
+    std::string text;
+    text.reserve(size + sample.size());
+    while (text.size() < size)
+        text += sample;
+    return text;
+}
+
+static void
+Base64Encode(benchmark::State& state)
+{
+    std::vector<uint8_t> data(state.range(0), 0xa5);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(base64::encode(data));
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(Base64Encode)->Arg(64)->Arg(4096)->Arg(1 << 20);
+
+static void
+Base64Decode(benchmark::State& state)
+{
+    auto encoded = base64::encode(std::vector<uint8_t>(state.range(0), 0xa5));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(base64::decode(encoded));
+    state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+BENCHMARK(Base64Decode)->Arg(64)->Arg(4096)->Arg(1 << 20);
+
+static void
+Utf8Validate(benchmark::State& state)
+{
+    auto text = makeText(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(utf8_validate(text));
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(Utf8Validate)->Arg(64)->Arg(4096);
+
+static void
+Utf8MakeValid(benchmark::State& state)
+{
+    auto text = makeText(state.range(0));
+    text[text.size() / 2] = '\xff';
+    for (auto _ : state)
+        benchmark::DoNotOptimize(utf8_make_valid(text));
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(Utf8MakeValid)->Arg(64)->Arg(4096);
+
+static void
+SplitString(benchmark::State& state)
+{
+    std::string str;
+    for (int i = 0; i < 64; ++i)
+        str += "token" + std::to_string(i) + "/";
+    for (auto _ : state)
+        benchmark::DoNotOptimize(split_string(str, '/'));
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(SplitString);
+
+static void
+SplitStringToUnsigned(benchmark::State& state)
+{
+    std::string str;
+    for (int i = 0; i < 64; ++i)
+        str += std::to_string(i * 977) + ",";
+    for (auto _ : state)
+        benchmark::DoNotOptimize(split_string_to_unsigned(str, ','));
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(SplitStringToUnsigned);
+
+static void
+HexString(benchmark::State& state)
+{
+    uint64_t id = 0x0123456789abcdef;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(from_hex_string(to_hex_string(id++)));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(HexString);
+
+} // namespace bench
+} // namespace jami
@@ -0,0 +1,173 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "security/tls_session.h"
+
+#include <opendht/crypto.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+
+namespace jami {
+namespace bench {
+
+// UDP payload of an IPv4 packet on an Ethernet link
+static constexpr int TRANSPORT_MTU {1500 - 20 - 8};
+
+/**
+ * One end of an in-process datagram link. Datagrams larger than the path MTU are
+ * silently lost, like on a route with a smaller MTU than the local link.
+ */
+class LoopbackDatagramSocket : public GenericSocket<uint8_t>
+{
+public:
+    LoopbackDatagramSocket(bool initiator, int pathMtu, int transportMtu = TRANSPORT_MTU)
+        : initiator_(initiator)
+        , pathMtu_(pathMtu)
+        , transportMtu_(transportMtu)
+    {}
+
+    static void connect(LoopbackDatagramSocket& a, LoopbackDatagramSocket& b)
+    {
+        a.peer_ = &b;
+        b.peer_ = &a;
+    }
+
+    void setOnRecv(RecvCb&& cb) override
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        onRecv_ = std::move(cb);
+    }
+
+    bool isReliable() const override { return false; }
+    bool isInitiator() const override { return initiator_; }
+    int maxPayload() const override { return transportMtu_; }
+
+    int waitForData(std::chrono::milliseconds, std::error_code&) const override { return 0; }
+    std::size_t read(ValueType*, std::size_t, std::error_code&) override { return 0; }
+
+    std::size_t write(const ValueType* buf, std::size_t len, std::error_code& ec) override
+    {
+        ec.clear();
+        if (static_cast<int>(len) <= pathMtu_)
+            peer_->deliver(buf, len);
+        return len;
+    }
+
+private:
+    void deliver(const ValueType* buf, std::size_t len)
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (onRecv_)
+            onRecv_(buf, len);
+    }
+
+    const bool initiator_;
+    const int pathMtu_;
+    const int transportMtu_;
+    LoopbackDatagramSocket* peer_ {nullptr};
+    std::mutex mutex_;
+    RecvCb onRecv_;
+};
+
+// Goodput of a DTLS session over a link of a given path MTU (range(0)), including the
+// path MTU discovery done during the connection. The transport MTU (range(1)) bounds the
+// discovery: at the minimal MTU, the session runs as without discovery.
+static void
+DtlsThroughput(benchmark::State& state)
+{
+    static constexpr std::size_t CHUNK {256 * 1024}; // below the receive queue capacity
+
+    auto pathMtu = static_cast<int>(state.range(0));
+    auto transportMtu = static_cast<int>(state.range(1));
+    auto clientEp = std::make_unique<LoopbackDatagramSocket>(true, pathMtu, transportMtu);
+    auto serverEp = std::make_unique<LoopbackDatagramSocket>(false, pathMtu, transportMtu);
+    LoopbackDatagramSocket::connect(*clientEp, *serverEp);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t received {0};
+    std::atomic<tls::TlsSessionState> clientState {tls::TlsSessionState::NONE};
+
+    std::promise<tls::DhParams> dhPromise;
+    dhPromise.set_value({});
+    auto makeParams = [dh = dhPromise.get_future().share()] {
+        auto id = dht::crypto::generateEcIdentity("bench");
+        return tls::TlsParams {"", nullptr, id.second, id.first, dh, std::chrono::seconds(10), {}};
+    };
+    auto makeCallbacks = [&](bool server) {
+        tls::TlsSession::TlsSessionCallbacks cbs {};
+        if (server)
+            cbs.onRxData = [&](std::vector<uint8_t>&& buf) {
+                std::lock_guard<std::mutex> lk(mutex);
+                received += buf.size();
+                cv.notify_one();
+            };
+        else
+            cbs.onStateChange = [&](tls::TlsSessionState s) { clientState = s; };
+        cbs.verifyCertificate = [](gnutls_session_t) { return static_cast<int>(GNUTLS_E_SUCCESS); };
+        return cbs;
+    };
+
+    tls::TlsSession server(std::move(serverEp), makeParams(), makeCallbacks(true), false);
+    tls::TlsSession client(std::move(clientEp), makeParams(), makeCallbacks(false), false);
+    try {
+        client.waitForReady(std::chrono::seconds(30));
+        server.waitForReady(std::chrono::seconds(30));
+    } catch (const std::logic_error&) {
+    }
+    if (clientState != tls::TlsSessionState::ESTABLISHED) {
+        state.SkipWithError("DTLS handshake failed");
+        return;
+    }
+
+    std::vector<uint8_t> data(CHUNK, 'x');
+    std::error_code ec;
+    for (auto _ : state) {
+        {
+            std::lock_guard<std::mutex> lk(mutex);
+            received = 0;
+        }
+        client.write(data.data(), data.size(), ec);
+        std::unique_lock<std::mutex> lk(mutex);
+        if (ec or not cv.wait_for(lk, std::chrono::seconds(5), [&] { return received >= CHUNK; })) {
+            state.SkipWithError("Records lost");
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * CHUNK);
+    state.counters["payload"] = client.maxPayload();
+    client.shutdown();
+    server.shutdown();
+}
+// Path MTU 484: minimal MTU, 1280: IPv6 minimum (tunnels), 1472: Ethernet.
+// {1472, 484} is the baseline to compare the discovered MTUs with: the minimal MTU.
+BENCHMARK(DtlsThroughput)
+    ->ArgNames({"path_mtu", "transport_mtu"})
+    ->Args({484, TRANSPORT_MTU})
+    ->Args({1280, TRANSPORT_MTU})
+    ->Args({TRANSPORT_MTU, TRANSPORT_MTU})
+    ->Args({TRANSPORT_MTU, 484})
+    ->UseRealTime();
+
+} // namespace bench
+} // namespace jami
@@ -0,0 +1,69 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "libav_deps.h"
+#include "media_buffer.h"
+#include "video/video_scaler.h"
+
+namespace jami {
+namespace video {
+namespace bench {
+
+static void
+VideoScalerConvert(benchmark::State& state)
+{
+    VideoScaler scaler;
+    VideoFrame input;
+    input.reserve(AV_PIX_FMT_NV12, state.range(0), state.range(1));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(scaler.convertFormat(input, AV_PIX_FMT_YUV420P));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(VideoScalerConvert)->Args({640, 480})->Args({1280, 720})->Args({1920, 1080});
+
+static void
+VideoScalerScale(benchmark::State& state)
+{
+    VideoScaler scaler;
+    VideoFrame input, output;
+    input.reserve(AV_PIX_FMT_YUV420P, 1920, 1080);
+    output.reserve(AV_PIX_FMT_YUV420P, state.range(0), state.range(1));
+    for (auto _ : state)
+        scaler.scale(input, output);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(VideoScalerScale)->Args({1280, 720})->Args({640, 360})->Args({320, 180});
+
+static void
+VideoScalerScaleAndPad(benchmark::State& state)
+{
+    VideoScaler scaler;
+    VideoFrame input, output;
+    input.reserve(AV_PIX_FMT_YUV420P, 1280, 720);
+    output.reserve(AV_PIX_FMT_YUV420P, 1920, 1080);
+    for (auto _ : state)
+        scaler.scale_and_pad(input, output, 0, 0, 960, 540, true);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(VideoScalerScaleAndPad);
+
+} // namespace bench
+} // namespace video
+} // namespace jami
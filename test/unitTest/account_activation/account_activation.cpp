@@ -0,0 +1,190 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <condition_variable>
+#include <string>
+
+#include "manager.h"
+#include "jamidht/jamiaccount.h"
+#include "jamidht/connectionmanager.h"
+#include "jamidht/multiplexed_socket.h"
+#include "../../test_runner.h"
+#include "jami.h"
+#include "account_const.h"
+#include "common.h"
+
+using namespace std::literals::chrono_literals;
+using namespace DRing::Account;
+
+namespace jami {
+namespace test {
+
+class AccountActivationTest : public CppUnit::TestFixture
+{
+public:
+    AccountActivationTest()
+    {
+        // Init daemon
+        DRing::init(DRing::InitFlag(DRing::DRING_FLAG_DEBUG | DRing::DRING_FLAG_CONSOLE_LOG));
+        if (not Manager::instance().initialized)
+            CPPUNIT_ASSERT(DRing::start("dring-sample.yml"));
+    }
+    ~AccountActivationTest() { DRing::fini(); }
+    static std::string name() { return "AccountActivation"; }
+    void tearDown();
+
+    std::string aliceId;
+    std::string bobId;
+
+private:
+    void testStandbyWakeUpIdle();
+    void testNoStandbyWithoutProxy();
+    void testNoIdleWithOpenChannel();
+
+    CPPUNIT_TEST_SUITE(AccountActivationTest);
+    CPPUNIT_TEST(testStandbyWakeUpIdle);
+    CPPUNIT_TEST(testNoStandbyWithoutProxy);
+    CPPUNIT_TEST(testNoIdleWithOpenChannel);
+    CPPUNIT_TEST_SUITE_END();
+
+    std::string addAccount(const std::string& alias, bool onDemand, bool proxy);
+};
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(AccountActivationTest, AccountActivationTest::name());
+
+std::string
+AccountActivationTest::addAccount(const std::string& alias, bool onDemand, bool proxy)
+{
+    std::map<std::string, std::string> details = DRing::getAccountTemplate("RING");
+    details[ConfProperties::ALIAS] = alias;
+    details[ConfProperties::ACTIVATE_ON_DEMAND] = onDemand ? "true" : "false";
+    details[ConfProperties::PROXY_ENABLED] = proxy ? "true" : "false";
+    auto accountId = Manager::instance().addAccount(details);
+    wait_for_announcement_of(accountId);
+    return accountId;
+}
+
+void
+AccountActivationTest::tearDown()
+{
+    if (!bobId.empty())
+        wait_for_removal_of({aliceId, bobId});
+    else
+        wait_for_removal_of(aliceId);
+    bobId.clear();
+}
+
+void
+AccountActivationTest::testStandbyWakeUpIdle()
+{
+    aliceId = addAccount("ALICE", true, true);
+    auto aliceAccount = Manager::instance().getAccount<JamiAccount>(aliceId);
+    CPPUNIT_ASSERT(aliceAccount->isStandby());
+    auto stats = aliceAccount->getActivityStats();
+    CPPUNIT_ASSERT_EQUAL(std::string("standby"), stats["mode"]);
+    CPPUNIT_ASSERT_EQUAL(std::string("0"), stats["connections"]);
+    CPPUNIT_ASSERT_EQUAL(std::string("0"), stats["ice.pooled"]);
+
+    aliceAccount->wakeUp("test");
+    CPPUNIT_ASSERT(not aliceAccount->isStandby());
+    stats = aliceAccount->getActivityStats();
+    CPPUNIT_ASSERT_EQUAL(std::string("active"), stats["mode"]);
+    CPPUNIT_ASSERT_EQUAL(std::string("1"), stats["wakeUps"]);
+    CPPUNIT_ASSERT_EQUAL(std::string("test"), stats["lastWakeUpReason"]);
+
+    // Just used
+    CPPUNIT_ASSERT(not aliceAccount->checkIdle(1h));
+    CPPUNIT_ASSERT(not aliceAccount->isStandby());
+
+    // Back to standby, still registered
+    CPPUNIT_ASSERT(aliceAccount->checkIdle(0s));
+    CPPUNIT_ASSERT(aliceAccount->isStandby());
+    CPPUNIT_ASSERT(aliceAccount->getRegistrationState() == RegistrationState::REGISTERED);
+    stats = aliceAccount->getActivityStats();
+    CPPUNIT_ASSERT_EQUAL(std::string("standby"), stats["mode"]);
+    CPPUNIT_ASSERT_EQUAL(std::string(TRUE_STR), stats["dht.running"]);
+    CPPUNIT_ASSERT_EQUAL(std::string("0"), stats["connections"]);
+    CPPUNIT_ASSERT_EQUAL(std::string("0"), stats["ice.pooled"]);
+
+    // And woken up again
+    aliceAccount->wakeUp("test again");
+    CPPUNIT_ASSERT(not aliceAccount->isStandby());
+    stats = aliceAccount->getActivityStats();
+    CPPUNIT_ASSERT_EQUAL(std::string("2"), stats["wakeUps"]);
+    CPPUNIT_ASSERT_EQUAL(std::string("test again"), stats["lastWakeUpReason"]);
+}
+
+void
+AccountActivationTest::testNoStandbyWithoutProxy()
+{
+    aliceId = addAccount("ALICE", true, false);
+    auto aliceAccount = Manager::instance().getAccount<JamiAccount>(aliceId);
+    CPPUNIT_ASSERT(not aliceAccount->isStandby());
+    CPPUNIT_ASSERT_EQUAL(std::string("always"), aliceAccount->getActivityStats()["mode"]);
+    CPPUNIT_ASSERT(not aliceAccount->checkIdle(0s));
+    CPPUNIT_ASSERT(not aliceAccount->isStandby());
+}
+
+void
+AccountActivationTest::testNoIdleWithOpenChannel()
+{
+    aliceId = addAccount("ALICE", true, true);
+    bobId = addAccount("BOB", false, false);
+    auto aliceAccount = Manager::instance().getAccount<JamiAccount>(aliceId);
+    auto bobAccount = Manager::instance().getAccount<JamiAccount>(bobId);
+    auto bobDeviceId = DeviceId(std::string(bobAccount->currentDeviceId()));
+    aliceAccount->wakeUp("test");
+    CPPUNIT_ASSERT(not aliceAccount->isStandby());
+
+    bobAccount->connectionManager().onICERequest([](const DeviceId&) { return true; });
+    bobAccount->connectionManager().onChannelRequest(
+        [](const std::shared_ptr<dht::crypto::Certificate>&, const std::string&) { return true; });
+
+    std::mutex mtx;
+    std::unique_lock<std::mutex> lk {mtx};
+    std::condition_variable cv;
+    std::shared_ptr<ChannelSocket> channel;
+    aliceAccount->connectionManager().connectDevice(bobDeviceId,
+                                                    "test",
+                                                    [&](std::shared_ptr<ChannelSocket> socket,
+                                                        const DeviceId&) {
+                                                        std::lock_guard<std::mutex> lk {mtx};
+                                                        channel = socket;
+                                                        cv.notify_one();
+                                                    });
+    CPPUNIT_ASSERT(cv.wait_for(lk, std::chrono::seconds(60), [&] { return channel != nullptr; }));
+    lk.unlock();
+
+    // Used by a transfer or a chat, even without a new channel for a while
+    CPPUNIT_ASSERT(not aliceAccount->checkIdle(0s));
+    CPPUNIT_ASSERT(not aliceAccount->isStandby());
+    CPPUNIT_ASSERT_EQUAL(std::string("1"), aliceAccount->getActivityStats()["connections"]);
+
+    channel->shutdown();
+    aliceAccount->connectionManager().closeConnectionsWith(bobDeviceId);
+    CPPUNIT_ASSERT(aliceAccount->checkIdle(0s));
+    CPPUNIT_ASSERT(aliceAccount->isStandby());
+}
+
+} // namespace test
+} // namespace jami
+
+RING_TEST_RUNNER(jami::test::AccountActivationTest::name())
@@ -22,14 +22,17 @@
 
 #include <condition_variable>
 #include <filesystem>
+#include <set>
 #include <string>
 
 #include "manager.h"
 #include "jamidht/connectionmanager.h"
 #include "jamidht/jamiaccount.h"
+#include "sip/sipcall.h"
 #include "../../test_runner.h"
 #include "jami.h"
 #include "account_const.h"
+#include "media_const.h"
 
 #include "common.h"
 
@@ -62,12 +65,18 @@ private:
     void testCachedCall();
     void testStopSearching();
     void testDeclineMultiDevice();
+    void testMediaOverPeerConnection();
+    void testMediaOverPeerConnectionFallback();
+
+    void callWithMediaOverPeerConnection(bool refuseChannels);
 
     CPPUNIT_TEST_SUITE(CallTest);
     CPPUNIT_TEST(testCall);
     CPPUNIT_TEST(testCachedCall);
     CPPUNIT_TEST(testStopSearching);
     CPPUNIT_TEST(testDeclineMultiDevice);
+    CPPUNIT_TEST(testMediaOverPeerConnection);
+    CPPUNIT_TEST(testMediaOverPeerConnectionFallback);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -296,6 +305,91 @@ CallTest::testDeclineMultiDevice()
     }));
 }
 
+void
+CallTest::callWithMediaOverPeerConnection(bool refuseChannels)
+{
+    auto aliceAccount = Manager::instance().getAccount<JamiAccount>(aliceId);
+    auto bobAccount = Manager::instance().getAccount<JamiAccount>(bobId);
+    auto bobUri = bobAccount->getUsername();
+    for (const auto& account : {aliceAccount, bobAccount}) {
+        auto details = account->getAccountDetails();
+        details[ConfProperties::PEER_CONNECTIONS_OVER_UDP] = "true";
+        details[ConfProperties::MEDIA_OVER_PEER_CONNECTIONS] = "true";
+        account->setAccountDetails(details);
+    }
+    bobAccount->refuseMediaChannels(refuseChannels);
+
+    std::mutex mtx;
+    std::unique_lock<std::mutex> lk {mtx};
+    std::condition_variable cv;
+    std::map<std::string, std::shared_ptr<DRing::CallbackWrapperBase>> confHandlers;
+    std::string bobCallId;
+    std::set<std::string> negotiated;
+    std::atomic<int> callStopped {0};
+    confHandlers.insert(DRing::exportable_callback<DRing::CallSignal::IncomingCallWithMedia>(
+        [&](const std::string& accountId,
+            const std::string& callId,
+            const std::string&,
+            const std::vector<std::map<std::string, std::string>>&) {
+            if (accountId != bobId)
+                return;
+            std::lock_guard<std::mutex> l {mtx};
+            bobCallId = callId;
+            cv.notify_one();
+        }));
+    confHandlers.insert(DRing::exportable_callback<DRing::CallSignal::MediaNegotiationStatus>(
+        [&](const std::string& callId,
+            const std::string& event,
+            const std::vector<std::map<std::string, std::string>>&) {
+            if (event != DRing::Media::MediaNegotiationStatusEvents::NEGOTIATION_SUCCESS)
+                return;
+            std::lock_guard<std::mutex> l {mtx};
+            negotiated.emplace(callId);
+            cv.notify_one();
+        }));
+    confHandlers.insert(DRing::exportable_callback<DRing::CallSignal::StateChange>(
+        [&](const std::string&, const std::string&, const std::string& state, signed) {
+            if (state == "OVER") {
+                callStopped += 1;
+                if (callStopped == 2)
+                    cv.notify_one();
+            }
+        }));
+    DRing::registerSignalHandlers(confHandlers);
+
+    JAMI_INFO("Start call between alice and Bob");
+    auto call = DRing::placeCallWithMedia(aliceId, bobUri, {});
+    CPPUNIT_ASSERT(cv.wait_for(lk, std::chrono::seconds(30), [&] { return !bobCallId.empty(); }));
+    Manager::instance().answerCall(bobId, bobCallId);
+
+    // With refused channels, media is only negotiated after the ICE re-invite
+    CPPUNIT_ASSERT(cv.wait_for(lk, std::chrono::seconds(30), [&] {
+        return negotiated.count(call) and negotiated.count(bobCallId);
+    }));
+    auto aliceCall = std::dynamic_pointer_cast<SIPCall>(
+        Manager::instance().getCallFromCallID(call));
+    CPPUNIT_ASSERT(aliceCall);
+    // The media ICE session is only kept if the call fell back to it
+    CPPUNIT_ASSERT(refuseChannels == (aliceCall->getIceMedia() != nullptr));
+
+    JAMI_INFO("Stop call between alice and Bob");
+    callStopped = 0;
+    Manager::instance().hangupCall(aliceId, call);
+    CPPUNIT_ASSERT(cv.wait_for(lk, std::chrono::seconds(30), [&] { return callStopped == 2; }));
+}
+
+void
+CallTest::testMediaOverPeerConnection()
+{
+    callWithMediaOverPeerConnection(false);
+}
+
+void
+CallTest::testMediaOverPeerConnectionFallback()
+{
+    callWithMediaOverPeerConnection(true);
+}
+
 } // namespace test
 } // namespace jami
 
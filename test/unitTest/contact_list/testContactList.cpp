@@ -0,0 +1,183 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../../test_runner.h"
+#include "jamidht/contact_list.h"
+#include "account_const.h"
+#include "fileutils.h"
+
+#include <fstream>
+#include <cstdlib>
+
+namespace jami {
+namespace test {
+
+class ContactListTest : public CppUnit::TestFixture
+{
+public:
+    static std::string name() { return "contact_list"; }
+
+    void setUp();
+    void tearDown();
+
+private:
+    void testJournal();
+    void testRewrite();
+    void testTruncatedJournal();
+
+    CPPUNIT_TEST_SUITE(ContactListTest);
+    CPPUNIT_TEST(testJournal);
+    CPPUNIT_TEST(testRewrite);
+    CPPUNIT_TEST(testTruncatedJournal);
+    CPPUNIT_TEST_SUITE_END();
+
+    std::unique_ptr<ContactList> makeList() const;
+
+    std::string path_;
+    std::string contactsJournal_;
+};
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(ContactListTest, ContactListTest::name());
+
+void
+ContactListTest::setUp()
+{
+    char templateName[] = {"ring_unit_tests_XXXXXX"};
+    auto directory = mkdtemp(templateName);
+    CPPUNIT_ASSERT(directory);
+    path_ = directory;
+    contactsJournal_ = path_ + DIR_SEPARATOR_STR "contacts.journal";
+}
+
+void
+ContactListTest::tearDown()
+{
+    fileutils::removeAll(path_);
+}
+
+std::unique_ptr<ContactList>
+ContactListTest::makeList() const
+{
+    ContactList::OnChangeCallback cb;
+    cb.contactAdded = [](const std::string&, bool) {};
+    cb.contactRemoved = [](const std::string&, bool) {};
+    cb.trustRequest =
+        [](const std::string&, const std::string&, const std::vector<uint8_t>&, time_t) {};
+    cb.devicesChanged = [](const std::map<dht::PkId, KnownDevice>&) {};
+    cb.acceptConversation = [](const std::string&) {};
+    cb.onConfirmation = [](const std::string&, const std::string&) {};
+    auto list = std::make_unique<ContactList>(nullptr, path_, std::move(cb));
+    list->load();
+    return list;
+}
+
+void
+ContactListTest::testJournal()
+{
+    auto key = dht::crypto::PrivateKey::generate(2048).getSharedPublicKey();
+    auto a = dht::InfoHash::get("a"), b = dht::InfoHash::get("b"), c = dht::InfoHash::get("c");
+    {
+        auto list = makeList();
+        list->addContact(a, true, "conv-a");
+        list->addContact(b);
+        list->updateConversation(b, "conv-b");
+        list->onTrustRequest(c, key, 1000, false, "conv-c", {});
+        list->onTrustRequest(dht::InfoHash::get("d"), key, 1000, false, "conv-d", {});
+        list->discardTrustRequest(dht::InfoHash::get("d"));
+    }
+    CPPUNIT_ASSERT(fileutils::isFile(contactsJournal_));
+
+    auto list = makeList();
+    const auto& contacts = list->getContacts();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), contacts.size());
+    CPPUNIT_ASSERT(contacts.at(a).confirmed);
+    CPPUNIT_ASSERT_EQUAL(std::string("conv-a"), contacts.at(a).conversationId);
+    CPPUNIT_ASSERT_EQUAL(std::string("conv-b"), contacts.at(b).conversationId);
+    auto requests = list->getTrustRequests();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), requests.size());
+    CPPUNIT_ASSERT_EQUAL(c.toString(), requests[0][DRing::Account::TrustRequest::FROM]);
+}
+
+void
+ContactListTest::testRewrite()
+{
+    std::map<dht::InfoHash, Contact> contacts;
+    for (unsigned i = 0; i < 100; ++i) {
+        Contact contact;
+        contact.added = 1000;
+        contacts.emplace(dht::InfoHash::get(std::to_string(i)), contact);
+    }
+    auto list = makeList();
+    list->setContacts(contacts);
+    CPPUNIT_ASSERT(not fileutils::isFile(contactsJournal_));
+
+    // The journal is merged once longer than the list
+    for (unsigned i = 0; i < 100; ++i)
+        list->updateConversation(dht::InfoHash::get(std::to_string(i)), "conv");
+    CPPUNIT_ASSERT(fileutils::isFile(contactsJournal_));
+    list->updateConversation(dht::InfoHash::get("0"), "conv-0");
+    CPPUNIT_ASSERT(not fileutils::isFile(contactsJournal_));
+
+    // A batch is written once
+    {
+        ContactList::Batch batch(*list);
+        list->updateContacts(contacts);
+        list->addContact(dht::InfoHash::get("new"));
+        CPPUNIT_ASSERT(not fileutils::isFile(contactsJournal_));
+    }
+    CPPUNIT_ASSERT(fileutils::isFile(contactsJournal_));
+
+    list = makeList();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(101), list->getContacts().size());
+    CPPUNIT_ASSERT_EQUAL(std::string("conv-0"),
+                         list->getContacts().at(dht::InfoHash::get("0")).conversationId);
+}
+
+void
+ContactListTest::testTruncatedJournal()
+{
+    auto a = dht::InfoHash::get("a"), b = dht::InfoHash::get("b");
+    {
+        auto list = makeList();
+        list->addContact(a);
+        list->addContact(b);
+    }
+    // Crash while appending a record
+    auto journal = fileutils::loadFile(contactsJournal_);
+    {
+        std::ofstream file(contactsJournal_, std::ios::trunc | std::ios::binary);
+        file.write((const char*) journal.data(), journal.size() - 4);
+    }
+
+    auto list = makeList();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), list->getContacts().size());
+    // The next change rewrites the file instead of appending after the damage
+    list->addContact(b);
+    CPPUNIT_ASSERT(not fileutils::isFile(contactsJournal_));
+    list = makeList();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), list->getContacts().size());
+}
+
+} // namespace test
+} // namespace jami
+
+RING_TEST_RUNNER(jami::test::ContactListTest::name())
@@ -20,8 +20,10 @@
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <atomic>
 #include <condition_variable>
 #include <string>
+#include <thread>
 #include <fstream>
 #include <streambuf>
 #include <git2.h>
@@ -112,6 +114,10 @@ private:
     void testDoNotLoadIncorrectConversation();
     void testSyncingWhileAccepting();
     void testCountInteractions();
+    void testLoadMessagesPaged();
+    void testConcurrentAccess();
+    void testConversationSummaries();
+    void testBatchedQueries();
     void testReplayConversation();
     void testSyncWithoutPinnedCert();
     void testImportMalformedContacts();
@@ -147,6 +153,10 @@ private:
     CPPUNIT_TEST(testDoNotLoadIncorrectConversation);
     CPPUNIT_TEST(testSyncingWhileAccepting);
     CPPUNIT_TEST(testCountInteractions);
+    CPPUNIT_TEST(testLoadMessagesPaged);
+    CPPUNIT_TEST(testConcurrentAccess);
+    CPPUNIT_TEST(testConversationSummaries);
+    CPPUNIT_TEST(testBatchedQueries);
     CPPUNIT_TEST(testReplayConversation);
     CPPUNIT_TEST(testSyncWithoutPinnedCert);
     CPPUNIT_TEST(testImportMalformedContacts);
@@ -2477,6 +2487,290 @@ ConversationTest::testCountInteractions()
     CPPUNIT_ASSERT(DRing::countInteractions(aliceId, convId, msgId2, "", "") == 1);
 }
 
+void
+ConversationTest::testLoadMessagesPaged()
+{
+    auto aliceAccount = Manager::instance().getAccount<JamiAccount>(aliceId);
+    auto convId = DRing::startConversation(aliceId);
+    std::mutex mtx;
+    std::unique_lock<std::mutex> lk {mtx};
+    std::condition_variable cv;
+
+    std::vector<std::string> sent;
+    for (auto i = 0; i < 4; ++i) {
+        aliceAccount->convModule()->sendMessage(convId,
+                                                std::to_string(i),
+                                                "",
+                                                "text/plain",
+                                                true,
+                                                [&](bool, std::string commitId) {
+                                                    sent.emplace_back(commitId);
+                                                    cv.notify_one();
+                                                });
+        CPPUNIT_ASSERT(cv.wait_for(lk, 30s, [&] { return sent.size() == i + 1u; }));
+    }
+
+    std::map<uint32_t, std::vector<std::pair<std::size_t, std::string>>> pages;
+    std::map<std::string, std::shared_ptr<DRing::CallbackWrapperBase>> confHandlers;
+    confHandlers.insert(
+        DRing::exportable_callback<DRing::ConversationSignal::ConversationMessagesPage>(
+            [&](uint32_t id,
+                const std::string& accountId,
+                const std::string& conversationId,
+                std::vector<std::map<std::string, std::string>> messages,
+                const std::string& next) {
+                if (accountId == aliceId && conversationId == convId) {
+                    std::lock_guard<std::mutex> lock {mtx};
+                    pages[id].emplace_back(messages.size(), next);
+                }
+                cv.notify_one();
+            }));
+    DRing::registerSignalHandlers(confHandlers);
+
+    // 4 messages + initial commit => 2 + 2 + 1
+    auto id = DRing::loadConversationMessagesPaged(aliceId, convId, "", 2);
+    CPPUNIT_ASSERT(id != 0);
+    CPPUNIT_ASSERT(cv.wait_for(lk, 30s, [&] {
+        return pages[id].size() == 3 && pages[id].rbegin()->second.empty();
+    }));
+    CPPUNIT_ASSERT(pages[id][0].first == 2 && pages[id][1].first == 2 && pages[id][2].first == 1);
+    CPPUNIT_ASSERT(pages[id][0].second == sent[1]);
+    CPPUNIT_ASSERT(!DRing::cancelLoadConversationMessages(aliceId, id));
+
+    // Continue from a token
+    auto idNext = DRing::loadConversationMessagesPaged(aliceId, convId, sent[1], 10);
+    CPPUNIT_ASSERT(cv.wait_for(lk, 30s, [&] { return pages[idNext].size() == 1; }));
+    CPPUNIT_ASSERT(pages[idNext][0].first == 3 && pages[idNext][0].second.empty());
+
+    // The id is released even if the conversation is removed during the loading
+    auto idRemoved = DRing::loadConversationMessagesPaged(aliceId, convId, "", 1);
+    CPPUNIT_ASSERT(idRemoved != 0);
+    DRing::removeConversation(aliceId, convId);
+    CPPUNIT_ASSERT(cv.wait_for(lk, 30s, [&] {
+        return !pages[idRemoved].empty() && pages[idRemoved].rbegin()->second.empty();
+    }));
+    CPPUNIT_ASSERT(!DRing::cancelLoadConversationMessages(aliceId, idRemoved));
+
+    DRing::unregisterSignalHandlers();
+}
+
+void
+ConversationTest::testConcurrentAccess()
+{
+    // Mix client API reads with sync writes, readers must always see a consistent state
+    constexpr size_t NB_CONVERSATIONS = 20;
+    constexpr size_t NB_READERS = 4;
+    constexpr size_t NB_WRITERS = 2;
+    constexpr size_t NB_WRITES = 200;
+    auto aliceAccount = Manager::instance().getAccount<JamiAccount>(aliceId);
+    auto bobAccount = Manager::instance().getAccount<JamiAccount>(bobId);
+    auto bobUri = bobAccount->getUsername();
+    auto bobDevice = std::string(bobAccount->currentDeviceId());
+    auto convModule = aliceAccount->convModule();
+
+    std::vector<std::string> convIds;
+    for (size_t i = 0; i < NB_CONVERSATIONS; ++i)
+        convIds.emplace_back(DRing::startConversation(aliceId));
+    std::vector<std::string> members {aliceAccount->getUsername(), bobUri};
+
+    std::atomic_bool stop {false};
+    std::atomic_bool consistent {true};
+    std::atomic<uint64_t> nbReads {0};
+    std::vector<std::thread> readers, writers;
+    for (size_t r = 0; r < NB_READERS; ++r)
+        readers.emplace_back([&, r] {
+            for (size_t i = r; !stop; ++i) {
+                const auto& convId = convIds[i % NB_CONVERSATIONS];
+                if (convModule->getConversations().size() != NB_CONVERSATIONS
+                    || convModule->conversationInfos(convId).empty()
+                    || convModule->getConversationMembers(convId).empty())
+                    consistent = false;
+                convModule->needsSyncingWith(bobUri, bobDevice);
+                nbReads++;
+            }
+        });
+    for (size_t w = 0; w < NB_WRITERS; ++w)
+        writers.emplace_back([&, w] {
+            for (size_t i = w; i < NB_WRITES; ++i) {
+                const auto& convId = convIds[i % NB_CONVERSATIONS];
+                convModule->setConversationMembers(convId, members);
+                convModule->setFetched(convId, bobDevice);
+            }
+        });
+    for (auto& t : writers)
+        t.join();
+    stop = true;
+    for (auto& t : readers)
+        t.join();
+    CPPUNIT_ASSERT(consistent);
+    CPPUNIT_ASSERT(nbReads > 0);
+
+    // Every write is visible once the writers are done
+    auto infos = ConversationModule::convInfos(aliceId);
+    for (const auto& convId : convIds) {
+        auto it = infos.find(convId);
+        CPPUNIT_ASSERT(it != infos.end() && it->second.members == members);
+    }
+    CPPUNIT_ASSERT(convModule->getConversations().size() == NB_CONVERSATIONS);
+}
+
+void
+ConversationTest::testConversationSummaries()
+{
+    auto aliceAccount = Manager::instance().getAccount<JamiAccount>(aliceId);
+    auto bobAccount = Manager::instance().getAccount<JamiAccount>(bobId);
+    auto bobUri = bobAccount->getUsername();
+
+    std::mutex mtx;
+    std::unique_lock<std::mutex> lk {mtx};
+    std::condition_variable cv;
+    std::map<std::string, std::shared_ptr<DRing::CallbackWrapperBase>> confHandlers;
+    auto messageBobReceived = 0, messageAliceReceived = 0;
+    bool requestReceived = false;
+    bool conversationReady = false;
+    std::string lastBobMessage;
+    confHandlers.insert(DRing::exportable_callback<DRing::ConversationSignal::MessageReceived>(
+        [&](const std::string& accountId,
+            const std::string& /* conversationId */,
+            std::map<std::string, std::string> message) {
+            if (accountId == bobId) {
+                messageBobReceived += 1;
+                lastBobMessage = message["id"];
+            } else {
+                messageAliceReceived += 1;
+            }
+            cv.notify_one();
+        }));
+    confHandlers.insert(
+        DRing::exportable_callback<DRing::ConversationSignal::ConversationRequestReceived>(
+            [&](const std::string& /*accountId*/,
+                const std::string& /* conversationId */,
+                std::map<std::string, std::string> /*metadatas*/) {
+                requestReceived = true;
+                cv.notify_one();
+            }));
+    confHandlers.insert(DRing::exportable_callback<DRing::ConversationSignal::ConversationReady>(
+        [&](const std::string& accountId, const std::string& /* conversationId */) {
+            if (accountId == bobId) {
+                conversationReady = true;
+                cv.notify_one();
+            }
+        }));
+    DRing::registerSignalHandlers(confHandlers);
+
+    auto summaryOf = [](const std::string& accountId, const std::string& convId) {
+        for (auto& summary : DRing::getConversationSummaries(accountId))
+            if (summary["id"] == convId)
+                return summary;
+        return std::map<std::string, std::string> {};
+    };
+
+    auto convId = DRing::startConversation(aliceId);
+    auto summary = summaryOf(aliceId, convId);
+    CPPUNIT_ASSERT(summary["unread"] == "0");
+    CPPUNIT_ASSERT(!summary["lastMessageId"].empty());
+
+    DRing::addConversationMember(aliceId, convId, bobUri);
+    CPPUNIT_ASSERT(cv.wait_for(lk, 30s, [&]() { return requestReceived; }));
+
+    DRing::acceptConversationRequest(bobId, convId);
+    CPPUNIT_ASSERT(cv.wait_for(lk, 30s, [&]() { return conversationReady; }));
+    // Wait that alice sees Bob
+    cv.wait_for(lk, 30s, [&]() { return messageAliceReceived == 2; });
+    // Bob's own join resets the unread count
+    CPPUNIT_ASSERT(summaryOf(bobId, convId)["unread"] == "0");
+
+    DRing::sendMessage(aliceId, convId, "hi"s, "");
+    DRing::sendMessage(aliceId, convId, "hello"s, "");
+    CPPUNIT_ASSERT(cv.wait_for(lk, 30s, [&]() { return messageBobReceived == 2; }));
+
+    summary = summaryOf(bobId, convId);
+    CPPUNIT_ASSERT(summary["unread"] == "2");
+    CPPUNIT_ASSERT(summary["lastMessageId"] == lastBobMessage);
+    CPPUNIT_ASSERT(summary["lastMessageBody"] == "hello");
+    CPPUNIT_ASSERT(summary["lastMessageAuthor"] == aliceAccount->getUsername());
+    CPPUNIT_ASSERT(summary["unread"]
+                   == std::to_string(DRing::countInteractions(bobId,
+                                                              convId,
+                                                              summary["lastDisplayed"],
+                                                              "",
+                                                              bobUri)));
+    CPPUNIT_ASSERT(summaryOf(aliceId, convId)["unread"] == "0");
+
+    // Member events are not interactions, they are never unread
+    DRing::addConversationMember(aliceId, convId, std::string(40, 'c'));
+    CPPUNIT_ASSERT(cv.wait_for(lk, 30s, [&]() { return messageBobReceived == 3; }));
+    summary = summaryOf(bobId, convId);
+    CPPUNIT_ASSERT(summary["lastMessageType"] == "member");
+    CPPUNIT_ASSERT(summary["unread"] == "2");
+
+    // Displaying the last message resets the count
+    bobAccount->setMessageDisplayed("swarm:" + convId, lastBobMessage, 3);
+    summary = summaryOf(bobId, convId);
+    CPPUNIT_ASSERT(summary["unread"] == "0");
+    CPPUNIT_ASSERT(summary["lastDisplayed"] == lastBobMessage);
+    DRing::unregisterSignalHandlers();
+}
+
+void
+ConversationTest::testBatchedQueries()
+{
+    auto aliceAccount = Manager::instance().getAccount<JamiAccount>(aliceId);
+    auto aliceUri = aliceAccount->getUsername();
+
+    std::mutex mtx;
+    std::unique_lock<std::mutex> lk {mtx};
+    std::condition_variable cv;
+    std::map<std::string, std::shared_ptr<DRing::CallbackWrapperBase>> confHandlers;
+    auto messageAliceReceived = 0;
+    confHandlers.insert(DRing::exportable_callback<DRing::ConversationSignal::MessageReceived>(
+        [&](const std::string& accountId,
+            const std::string& /* conversationId */,
+            std::map<std::string, std::string> /* message */) {
+            if (accountId == aliceId) {
+                messageAliceReceived += 1;
+                cv.notify_one();
+            }
+        }));
+    DRing::registerSignalHandlers(confHandlers);
+
+    auto convId1 = DRing::startConversation(aliceId);
+    auto convId2 = DRing::startConversation(aliceId);
+    messageAliceReceived = 0;
+    aliceAccount->convModule()->updateConversationInfos(convId1, {{"title", "My awesome swarm"}});
+    CPPUNIT_ASSERT(cv.wait_for(lk, 30s, [&]() { return messageAliceReceived == 1; }));
+
+    // One result per requested conversation, in order, unknown ones being empty
+    auto infos = DRing::conversationsInfos(aliceId, {convId2, "unknown", convId1}, {});
+    CPPUNIT_ASSERT(infos.size() == 3);
+    CPPUNIT_ASSERT(infos[0] == DRing::conversationInfos(aliceId, convId2));
+    CPPUNIT_ASSERT(infos[1].empty());
+    CPPUNIT_ASSERT(infos[2] == DRing::conversationInfos(aliceId, convId1));
+    CPPUNIT_ASSERT(infos[2]["title"] == "My awesome swarm");
+
+    // Field masks
+    infos = DRing::conversationsInfos(aliceId, {convId1}, {"mode"});
+    CPPUNIT_ASSERT(infos.size() == 1 && infos[0].size() == 1 && infos[0].count("mode"));
+    infos = DRing::conversationsInfos(aliceId, {convId1}, {"title"});
+    CPPUNIT_ASSERT(infos[0].size() == 1 && infos[0]["title"] == "My awesome swarm");
+
+    auto members = DRing::getConversationsMembers(aliceId, {convId1, convId2});
+    CPPUNIT_ASSERT(members.size() == 2);
+    CPPUNIT_ASSERT(members[0]["conversationId"] == convId1 && members[0]["uri"] == aliceUri);
+    CPPUNIT_ASSERT(members[1]["conversationId"] == convId2 && members[1]["uri"] == aliceUri);
+
+    auto accounts = DRing::getAccountsDetails({aliceId, "unknown"},
+                                              {DRing::Account::ConfProperties::USERNAME});
+    CPPUNIT_ASSERT(accounts.size() == 2 && accounts[1].empty());
+    CPPUNIT_ASSERT(accounts[0].size() == 1);
+    CPPUNIT_ASSERT(accounts[0][DRing::Account::ConfProperties::USERNAME]
+                   == DRing::getAccountDetails(aliceId)[DRing::Account::ConfProperties::USERNAME]);
+
+    auto contacts = DRing::getContactsDetails(aliceId, {aliceUri}, {});
+    CPPUNIT_ASSERT(contacts.size() == 1 && contacts[0].empty());
+    DRing::unregisterSignalHandlers();
+}
+
 void
 ConversationTest::testReplayConversation()
 {
@@ -78,6 +78,10 @@ private:
     // void testCloneHugeRepo();
 
     void testMergeProfileWithConflict();
+    void testMemberIndexPermissionChecks();
+    void testMergeUpdatesMemberIndex();
+    void testAddMembers();
+    void testMergeAfterReopen();
 
     std::string addCommit(git_repository* repo,
                           const std::shared_ptr<JamiAccount> account,
@@ -98,6 +102,10 @@ private:
     CPPUNIT_TEST(testFFMerge);
     CPPUNIT_TEST(testDiff);
     CPPUNIT_TEST(testMergeProfileWithConflict);
+    CPPUNIT_TEST(testMemberIndexPermissionChecks);
+    CPPUNIT_TEST(testMergeUpdatesMemberIndex);
+    CPPUNIT_TEST(testAddMembers);
+    CPPUNIT_TEST(testMergeAfterReopen);
     // CPPUNIT_TEST(testCloneHugeRepo);
 
     CPPUNIT_TEST_SUITE_END();
@@ -756,6 +764,285 @@ ConversationRepositoryTest::testMergeProfileWithConflict()
     CPPUNIT_ASSERT(repository->log().size() == 5 /* Initial, add, modify 1, modify 2, merge */);
 }
 
+void
+ConversationRepositoryTest::testMemberIndexPermissionChecks()
+{
+    // Simulate a swarm with 1000 members (and 2 devices per member)
+    constexpr std::size_t NB_MEMBERS = 1000;
+    ConversationMemberIndex index;
+    std::vector<ConversationMember> members;
+    std::map<std::string, bool> devices;
+    std::vector<std::string> uris;
+    for (std::size_t i = 0; i < NB_MEMBERS; ++i) {
+        auto uri = fmt::format("{:040x}", i);
+        auto role = MemberRole::MEMBER;
+        if (i == 0)
+            role = MemberRole::ADMIN;
+        else if (i % 10 == 0)
+            role = MemberRole::INVITED;
+        members.emplace_back(ConversationMember {uri, role});
+        devices.emplace(fmt::format("{:064x}", 2 * i), false);
+        devices.emplace(fmt::format("{:064x}", 2 * i + 1), false);
+        uris.emplace_back(std::move(uri));
+    }
+    index.reset(std::move(members), std::move(devices));
+    CPPUNIT_ASSERT(index.size() == NB_MEMBERS);
+
+    // Incremental updates
+    auto generation = index.generation();
+    index.setRole(uris[1], MemberRole::BANNED);
+    index.setDevice(fmt::format("{:064x}", 3), true);
+    index.remove(uris[2]);
+    CPPUNIT_ASSERT(index.generation() == generation + 3);
+    index.setRole(uris[3], MemberRole::MEMBER); // No change
+    CPPUNIT_ASSERT(index.generation() == generation + 3);
+
+    CPPUNIT_ASSERT(index.isMember(uris[0]));
+    CPPUNIT_ASSERT(!index.isMember(uris[1]));
+    CPPUNIT_ASSERT(index.isBanned(uris[1]));
+    CPPUNIT_ASSERT(index.isBanned(fmt::format("{:064x}", 3)));
+    CPPUNIT_ASSERT(!index.isMember(uris[2], true));
+    CPPUNIT_ASSERT(!index.isMember(uris[10]));
+    CPPUNIT_ASSERT(index.isMember(uris[10], true));
+    CPPUNIT_ASSERT(index.size() == NB_MEMBERS - 1);
+    // Order is preserved after a removal
+    auto current = index.members();
+    CPPUNIT_ASSERT(current[0].uri == uris[0]);
+    CPPUNIT_ASSERT(current[2].uri == uris[3]);
+    CPPUNIT_ASSERT(index.role(uris[NB_MEMBERS - 1]) == MemberRole::MEMBER);
+
+    // Every known member, except the banned and removed ones, passes the permission check
+    std::size_t nbValid = 0;
+    for (const auto& uri : uris)
+        if (index.isMember(uri, true) && !index.isBanned(uri))
+            nbValid++;
+    CPPUNIT_ASSERT(nbValid == NB_MEMBERS - 2);
+}
+
+void
+ConversationRepositoryTest::testMergeUpdatesMemberIndex()
+{
+    auto aliceAccount = Manager::instance().getAccount<JamiAccount>(aliceId);
+    auto repository = ConversationRepository::createConversation(aliceAccount->weak());
+    CPPUNIT_ASSERT(repository != nullptr);
+    auto repoPath = fileutils::get_data_dir() + DIR_SEPARATOR_STR + aliceAccount->getAccountID()
+                    + DIR_SEPARATOR_STR + "conversations" + DIR_SEPARATOR_STR + repository->id()
+                    + DIR_SEPARATOR_STR;
+
+    auto bobUri = fmt::format("{:040x}", 1);
+    auto carolUri = fmt::format("{:040x}", 2);
+    auto daveUri = fmt::format("{:040x}", 3);
+    auto erinUri = fmt::format("{:040x}", 4);
+    auto frankUri = fmt::format("{:040x}", 5);
+    auto writeFile = [&](const std::string& dir, const std::string& name) {
+        fileutils::recursive_mkdir(repoPath + dir, 0700);
+        std::ofstream file(repoPath + dir + DIR_SEPARATOR_STR + name);
+        file << name;
+    };
+
+    git_repository* repo;
+    CPPUNIT_ASSERT(git_repository_open(&repo, repoPath.c_str()) == 0);
+    auto removeFile = [&](const std::string& path) {
+        fileutils::remove(repoPath + path);
+        git_index* index_ptr = nullptr;
+        if (git_repository_index(&index_ptr, repo) < 0)
+            return;
+        GitIndex index {index_ptr, git_index_free};
+        git_index_remove_bypath(index.get(), path.c_str());
+        git_index_write(index.get());
+    };
+
+    // Carol and Dave are members, Erin is an admin and Frank is invited
+    writeFile("members", carolUri + ".crt");
+    writeFile("members", daveUri + ".crt");
+    writeFile("admins", erinUri + ".crt");
+    writeFile("invited", frankUri);
+    addAll(repo);
+    auto id1 = addCommit(repo, aliceAccount, "main", "add members");
+    repository->refreshMembers();
+    CPPUNIT_ASSERT(repository->memberRole(carolUri) == MemberRole::MEMBER);
+    CPPUNIT_ASSERT(repository->memberRole(erinUri) == MemberRole::ADMIN);
+    CPPUNIT_ASSERT(repository->memberRole(frankUri) == MemberRole::INVITED);
+
+    git_reference* ref = nullptr;
+    git_commit* commit = nullptr;
+    git_oid commit_id;
+    git_oid_fromstr(&commit_id, id1.c_str());
+    git_commit_lookup(&commit, repo, &commit_id);
+    git_branch_create(&ref, repo, "to_merge", commit, false);
+    git_reference_free(ref);
+    git_commit_free(commit);
+    git_repository_set_head(repo, "refs/heads/to_merge");
+
+    // Add Bob, ban Carol, promote Dave, ban Erin (admin) and Frank (invited)
+    writeFile("members", bobUri + ".crt");
+    removeFile("members/" + carolUri + ".crt");
+    writeFile("banned/members", carolUri + ".crt");
+    removeFile("members/" + daveUri + ".crt");
+    writeFile("admins", daveUri + ".crt");
+    removeFile("admins/" + erinUri + ".crt");
+    writeFile("banned/admins", erinUri + ".crt");
+    removeFile("invited/" + frankUri);
+    writeFile("banned/invited", frankUri);
+    addAll(repo);
+    auto id2 = addCommit(repo, aliceAccount, "to_merge", "update members");
+    git_repository_free(repo);
+
+    // Same path as Conversation::mergeHistory: fast forward, then update from the diff
+    auto generation = repository->membersGeneration();
+    repository->merge(id2);
+    repository->updateMembers(id1);
+    CPPUNIT_ASSERT(repository->membersGeneration() > generation);
+
+    CPPUNIT_ASSERT(repository->memberRole(bobUri) == MemberRole::MEMBER);
+    CPPUNIT_ASSERT(repository->memberRole(carolUri) == MemberRole::BANNED);
+    CPPUNIT_ASSERT(repository->memberRole(daveUri) == MemberRole::ADMIN);
+    CPPUNIT_ASSERT(repository->memberRole(erinUri) == MemberRole::BANNED);
+    CPPUNIT_ASSERT(repository->memberRole(frankUri) == MemberRole::BANNED);
+    CPPUNIT_ASSERT(repository->isBanned(carolUri));
+    CPPUNIT_ASSERT(repository->isBanned(erinUri));
+    CPPUNIT_ASSERT(!repository->isMember(frankUri, true));
+    CPPUNIT_ASSERT(repository->memberRole(aliceAccount->getUsername()) == MemberRole::ADMIN);
+
+    // The incremental update must match a full rebuild
+    auto toMap = [](const std::vector<ConversationMember>& members) {
+        std::map<std::string, MemberRole> res;
+        for (const auto& member : members)
+            res.emplace(member.uri, member.role);
+        return res;
+    };
+    auto incremental = toMap(repository->members());
+    repository->refreshMembers();
+    CPPUNIT_ASSERT(incremental == toMap(repository->members()));
+}
+
+void
+ConversationRepositoryTest::testAddMembers()
+{
+    auto aliceAccount = Manager::instance().getAccount<JamiAccount>(aliceId);
+    auto repository = ConversationRepository::createConversation(aliceAccount->weak());
+    CPPUNIT_ASSERT(repository != nullptr);
+
+    constexpr std::size_t NB_MEMBERS = 20;
+    std::vector<std::string> uris;
+    for (std::size_t i = 0; i < NB_MEMBERS; ++i)
+        uris.emplace_back(fmt::format("{:040x}", i));
+    // A duplicate is only added once
+    uris.emplace_back(uris.front());
+
+    auto commits = repository->addMembers(uris);
+    CPPUNIT_ASSERT(commits.size() == NB_MEMBERS);
+    // One commit per member, on top of each other, and main is on the last one
+    auto log = repository->log();
+    CPPUNIT_ASSERT(log.size() == NB_MEMBERS + 1 /* initial */);
+    CPPUNIT_ASSERT(log.front().id == commits.back());
+    for (std::size_t i = 0; i < NB_MEMBERS; ++i) {
+        const auto& commit = log[NB_MEMBERS - 1 - i];
+        CPPUNIT_ASSERT(commit.id == commits[i]);
+        auto changedFiles = ConversationRepository::changedFiles(
+            repository->diffStats(commit.id, commit.parents.front()));
+        CPPUNIT_ASSERT(changedFiles.size() == 1 && changedFiles[0] == "invited/" + uris[i]);
+    }
+    auto invited = repository->memberUris("", {MemberRole::ADMIN, MemberRole::MEMBER});
+    CPPUNIT_ASSERT(invited.size() == NB_MEMBERS);
+
+    // Already invited
+    CPPUNIT_ASSERT(repository->addMembers({uris.front()}).empty());
+    CPPUNIT_ASSERT(repository->addMember(uris.back()).empty());
+
+    // Commits are built in memory, the on-disk index is not written
+    auto repoPath = fileutils::get_data_dir() + DIR_SEPARATOR_STR + aliceAccount->getAccountID()
+                    + DIR_SEPARATOR_STR + "conversations" + DIR_SEPARATOR_STR + repository->id();
+    git_repository* repo_ptr = nullptr;
+    CPPUNIT_ASSERT(git_repository_open(&repo_ptr, repoPath.c_str()) == 0);
+    GitRepository repo {repo_ptr, git_repository_free};
+    git_index* index_ptr = nullptr;
+    CPPUNIT_ASSERT(git_repository_index(&index_ptr, repo.get()) == 0);
+    GitIndex index {index_ptr, git_index_free};
+    for (const auto& uri : uris) {
+        auto path = "invited/" + uri;
+        CPPUNIT_ASSERT(git_index_get_bypath(index.get(), path.c_str(), 0) == nullptr);
+    }
+
+    // A message commit only contains its own changes
+    auto id = repository->commitMessage("Commit 1");
+    CPPUNIT_ASSERT(
+        ConversationRepository::changedFiles(repository->diffStats(id, commits.back())).empty());
+}
+
+void
+ConversationRepositoryTest::testMergeAfterReopen()
+{
+    auto aliceAccount = Manager::instance().getAccount<JamiAccount>(aliceId);
+    auto repository = ConversationRepository::createConversation(aliceAccount->weak());
+    CPPUNIT_ASSERT(repository != nullptr);
+    auto uri = fmt::format("{:040x}", 1);
+    auto path = "invited/" + uri;
+    auto otherPath = "invited/" + fmt::format("{:040x}", 2);
+    auto commits = repository->addMembers({uri, fmt::format("{:040x}", 2)});
+    CPPUNIT_ASSERT(commits.size() == 2);
+    auto headId = commits.back();
+
+    // As after a restart: the on-disk index does not contain the invited files
+    auto conversationId = repository->id();
+    repository = std::make_unique<ConversationRepository>(aliceAccount->weak(), conversationId);
+
+    // Update the invited file in a commit built without the index of the repository
+    auto repoPath = fileutils::get_data_dir() + DIR_SEPARATOR_STR + aliceAccount->getAccountID()
+                    + DIR_SEPARATOR_STR + "conversations" + DIR_SEPARATOR_STR + conversationId;
+    git_repository* repo_ptr = nullptr;
+    CPPUNIT_ASSERT(git_repository_open(&repo_ptr, repoPath.c_str()) == 0);
+    GitRepository repo {repo_ptr, git_repository_free};
+    git_oid oid;
+    git_oid_fromstr(&oid, headId.c_str());
+    git_commit* commit_ptr = nullptr;
+    CPPUNIT_ASSERT(git_commit_lookup(&commit_ptr, repo.get(), &oid) == 0);
+    GitCommit head {commit_ptr, git_commit_free};
+    git_tree* tree_ptr = nullptr;
+    CPPUNIT_ASSERT(git_commit_tree(&tree_ptr, head.get()) == 0);
+    GitTree headTree {tree_ptr, git_tree_free};
+    git_index* index_ptr = nullptr;
+    CPPUNIT_ASSERT(git_index_new(&index_ptr) == 0);
+    GitIndex index {index_ptr, git_index_free};
+    CPPUNIT_ASSERT(git_index_read_tree(index.get(), headTree.get()) == 0);
+    std::string content = "updated";
+    git_index_entry entry {};
+    entry.mode = GIT_FILEMODE_BLOB;
+    entry.path = path.c_str();
+    CPPUNIT_ASSERT(
+        git_index_add_from_buffer(index.get(), &entry, content.data(), content.size()) == 0);
+    CPPUNIT_ASSERT(git_index_write_tree_to(&oid, index.get(), repo.get()) == 0);
+    CPPUNIT_ASSERT(git_tree_lookup(&tree_ptr, repo.get(), &oid) == 0);
+    GitTree tree {tree_ptr, git_tree_free};
+    git_signature* sig_ptr = nullptr;
+    CPPUNIT_ASSERT(git_signature_now(&sig_ptr, "test", "test@jami.net") == 0);
+    GitSignature sig {sig_ptr, git_signature_free};
+    const git_commit* parents[1] = {head.get()};
+    CPPUNIT_ASSERT(git_commit_create(&oid,
+                                     repo.get(),
+                                     nullptr,
+                                     sig.get(),
+                                     sig.get(),
+                                     nullptr,
+                                     "update invited",
+                                     tree.get(),
+                                     1,
+                                     parents)
+                   == 0);
+    std::string id2 = git_oid_tostr_s(&oid);
+
+    // Fast forward: the checkout compares the working directory with the index
+    CPPUNIT_ASSERT(repository->merge(id2).first);
+    CPPUNIT_ASSERT(repository->log().front().id == id2);
+    auto data = fileutils::loadFile(repoPath + DIR_SEPARATOR_STR + path);
+    CPPUNIT_ASSERT(std::string(data.begin(), data.end()) == content);
+    // Files not changed by the merge are in the index too
+    CPPUNIT_ASSERT(git_repository_index(&index_ptr, repo.get()) == 0);
+    GitIndex repoIndex {index_ptr, git_index_free};
+    CPPUNIT_ASSERT(git_index_read(repoIndex.get(), true) == 0);
+    CPPUNIT_ASSERT(git_index_get_bypath(repoIndex.get(), otherPath.c_str(), 0) != nullptr);
+}
+
 /*
 void
 ConversationRepositoryTest::testCloneHugeRepo()
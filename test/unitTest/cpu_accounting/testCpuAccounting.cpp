@@ -0,0 +1,136 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "cpu_accounting.h"
+#include "../../test_runner.h"
+
+#include <algorithm>
+
+namespace jami {
+namespace test {
+
+class CpuAccountingTest : public CppUnit::TestFixture
+{
+public:
+    static std::string name() { return "cpu_accounting"; }
+
+    void setUp() override { CpuAccounting::setProbesEnabled(true); }
+    void tearDown() override { CpuAccounting::setProbesEnabled(false); }
+
+private:
+    void testProbe();
+    void testProbeDisabled();
+    void testThreadGroup();
+    void testOpenMetrics();
+
+    CPPUNIT_TEST_SUITE(CpuAccountingTest);
+    CPPUNIT_TEST(testProbe);
+    CPPUNIT_TEST(testProbeDisabled);
+    CPPUNIT_TEST(testThreadGroup);
+    CPPUNIT_TEST(testOpenMetrics);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(CpuAccountingTest, CpuAccountingTest::name());
+
+static std::map<std::string, std::string>
+findStat(const std::string& type, const std::string& name)
+{
+    auto stats = CpuAccounting::getInstance().getStats();
+    auto it = std::find_if(stats.begin(), stats.end(), [&](const auto& stat) {
+        return stat.at("type") == type and stat.at("name") == name;
+    });
+    return it != stats.end() ? *it : std::map<std::string, std::string> {};
+}
+
+static void
+burnCpu(std::chrono::milliseconds duration)
+{
+    auto start = CpuAccounting::threadCpuTime();
+    volatile uint64_t x = 0;
+    while (CpuAccounting::threadCpuTime() - start < duration)
+        x = x + 1;
+}
+
+void
+CpuAccountingTest::testProbe()
+{
+    for (int i = 0; i < 3; ++i) {
+        JAMI_CPU_PROBE("test.probe");
+        burnCpu(std::chrono::milliseconds(10));
+    }
+    auto stat = findStat("probe", "test.probe");
+    CPPUNIT_ASSERT(!stat.empty());
+    CPPUNIT_ASSERT_EQUAL(std::string("test"), stat["subsystem"]);
+    CPPUNIT_ASSERT_EQUAL(std::string("3"), stat["calls"]);
+    CPPUNIT_ASSERT(std::stoul(stat["cpu_ms"]) >= 30);
+    CPPUNIT_ASSERT(std::stoul(stat["wall_ms"]) >= std::stoul(stat["cpu_ms"]));
+}
+
+void
+CpuAccountingTest::testProbeDisabled()
+{
+    CpuAccounting::setProbesEnabled(false);
+    {
+        JAMI_CPU_PROBE("test.disabled");
+    }
+    CPPUNIT_ASSERT_EQUAL(std::string("0"), findStat("probe", "test.disabled")["calls"]);
+    CpuAccounting::setProbesEnabled(true);
+    {
+        JAMI_CPU_PROBE("test.disabled");
+    }
+    CPPUNIT_ASSERT_EQUAL(std::string("1"), findStat("probe", "test.disabled")["calls"]);
+}
+
+void
+CpuAccountingTest::testThreadGroup()
+{
+    std::thread([] {
+        CpuAccounting::getInstance().registerThread("test_group", "test_thread");
+        burnCpu(std::chrono::milliseconds(20));
+    }).join();
+    // CPU time of exited threads stays accounted to their group
+    auto stat = findStat("group", "test_group");
+    CPPUNIT_ASSERT(!stat.empty());
+    CPPUNIT_ASSERT_EQUAL(std::string("0"), stat["threads"]);
+    CPPUNIT_ASSERT(std::stoul(stat["cpu_ms"]) >= 20);
+    CPPUNIT_ASSERT(!findStat("process", "jami").empty());
+}
+
+void
+CpuAccountingTest::testOpenMetrics()
+{
+    {
+        JAMI_CPU_PROBE("test.metrics");
+    }
+    auto metrics = CpuAccounting::getInstance().toOpenMetrics();
+    CPPUNIT_ASSERT(metrics.find("jami_process_cpu_seconds_total ") != std::string::npos);
+    CPPUNIT_ASSERT(
+        metrics.find("jami_probe_calls_total{probe=\"test.metrics\",subsystem=\"test\"} 1\n")
+        != std::string::npos);
+    CPPUNIT_ASSERT(metrics.size() > 6 and metrics.substr(metrics.size() - 6) == "# EOF\n");
+}
+
+} // namespace test
+} // namespace jami
+
+RING_TEST_RUNNER(jami::test::CpuAccountingTest::name())
@@ -60,6 +60,7 @@ private:
     void testTurnSlaveIceConnection();
     void testReceiveTooManyCandidates();
     void testCompleteOnFailure();
+    void testPooledTransport();
 
     CPPUNIT_TEST_SUITE(IceTest);
     CPPUNIT_TEST(testRawIceConnection);
@@ -67,6 +68,7 @@ private:
     CPPUNIT_TEST(testTurnSlaveIceConnection);
     CPPUNIT_TEST(testReceiveTooManyCandidates);
     CPPUNIT_TEST(testCompleteOnFailure);
+    CPPUNIT_TEST(testPooledTransport);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -631,6 +633,68 @@ IceTest::testCompleteOnFailure()
     }));
 }
 
+void
+IceTest::testPooledTransport()
+{
+    IceTransportOptions poolOptions;
+    poolOptions.stunServers.emplace_back(StunServerInfo().setUri("stun.jami.net"));
+    auto pool = std::make_shared<IceTransportPool>(
+        "pool ICE", 1, 1, false, 1, [&](std::function<void(IceTransportOptions&&)>&& cb) {
+            cb(IceTransportOptions(poolOptions));
+        });
+    pool->start();
+
+    IceTransportOptions ice_config;
+    ice_config.master = false;
+    ice_config.streamsCount = 1;
+    ice_config.compCountPerStream = 1;
+    ice_config.stunServers = poolOptions.stunServers;
+    // Nothing is gathered before the first request
+    auto first = Manager::instance().getIceTransportFactory().createTransport("first ICE");
+    CPPUNIT_ASSERT(!pool->initTransport(*first, ice_config));
+    auto waitReady = [&] {
+        auto start = std::chrono::steady_clock::now();
+        while (pool->stats().ready == 0
+               and std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return pool->stats().ready == 1;
+    };
+    CPPUNIT_ASSERT(waitReady());
+
+    std::mutex mtx;
+    std::unique_lock<std::mutex> lk {mtx};
+    std::condition_variable cv;
+    bool initDone = false;
+    ice_config.onInitDone = [&](bool ok) {
+        CPPUNIT_ASSERT(ok);
+        std::lock_guard<std::mutex> l {mtx};
+        initDone = true;
+        cv.notify_one();
+    };
+    // Another shape is not served by the pool
+    auto ice = Manager::instance().getIceTransportFactory().createTransport("slave ICE");
+    ice_config.compCountPerStream = 2;
+    CPPUNIT_ASSERT(!pool->initTransport(*ice, ice_config));
+    ice_config.compCountPerStream = 1;
+    CPPUNIT_ASSERT(pool->initTransport(*ice, ice_config));
+    CPPUNIT_ASSERT(cv.wait_for(lk, std::chrono::seconds(5), [&] { return initDone; }));
+    CPPUNIT_ASSERT(ice->isInitialized());
+    CPPUNIT_ASSERT(!ice->isInitiator());
+    CPPUNIT_ASSERT(!ice->getLocalCandidates(1).empty());
+
+    // Transports gathered with other servers are not handed out
+    CPPUNIT_ASSERT(waitReady());
+    auto other = Manager::instance().getIceTransportFactory().createTransport("other ICE");
+    ice_config.onInitDone = {};
+    ice_config.stunServers.clear();
+    CPPUNIT_ASSERT(!pool->initTransport(*other, ice_config));
+
+    auto stats = pool->stats();
+    CPPUNIT_ASSERT(stats.hits == 1);
+    CPPUNIT_ASSERT(stats.misses == 2);
+    pool->stop();
+}
+
 } // namespace test
 } // namespace jami
 
@@ -0,0 +1,389 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../../../bin/ipc/ipcserver.h"
+#include "../../test_runner.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+
+namespace jami {
+namespace test {
+
+using namespace std::literals::chrono_literals;
+
+static int
+add(int a, int b)
+{
+    return a + b;
+}
+
+/** A client of the socket, reading the frames with a timeout */
+class Connection
+{
+public:
+    explicit Connection(const std::string& path)
+    {
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+        CPPUNIT_ASSERT(fd_ >= 0 and ::connect(fd_, (sockaddr*) &addr, sizeof(addr)) == 0);
+    }
+    ~Connection() { ::close(fd_); }
+
+    void send(const std::vector<uint8_t>& data)
+    {
+        CPPUNIT_ASSERT_EQUAL(ssize_t(data.size()), ::send(fd_, data.data(), data.size(), 0));
+    }
+
+    template<typename... Args>
+    void request(uint64_t id, const std::string& name, const Args&... args)
+    {
+        std::vector<uint8_t> frame;
+        IpcEncoder enc(frame);
+        enc.begin(IpcFrame::Request);
+        enc << id << name;
+        (void) (enc << ... << args);
+        enc.end();
+        send(frame);
+    }
+
+    void subscribe(const std::vector<std::string>& names)
+    {
+        std::vector<uint8_t> frame;
+        IpcEncoder enc(frame);
+        enc.begin(IpcFrame::Subscribe);
+        enc << names;
+        enc.end();
+        send(frame);
+    }
+
+    /** @return the body of the next frame, empty if the server closed the connection */
+    std::vector<uint8_t> readFrame(std::chrono::milliseconds timeout = 5s)
+    {
+        uint8_t header[IPC_FRAME_HEADER];
+        if (not readFull(header, sizeof(header), timeout))
+            return {};
+        std::vector<uint8_t> body(header[0] | header[1] << 8 | header[2] << 16
+                                  | uint32_t(header[3]) << 24);
+        CPPUNIT_ASSERT(readFull(body.data(), body.size(), timeout));
+        return body;
+    }
+
+    /** Read a reply and check its id and status, its result starts at byte 3 */
+    std::vector<uint8_t> reply(uint64_t id, uint8_t status = 0)
+    {
+        auto body = readFrame();
+        CPPUNIT_ASSERT(not body.empty());
+        IpcDecoder in(body.data(), body.size());
+        uint8_t kind, replyStatus;
+        uint64_t replyId;
+        in >> kind >> replyId >> replyStatus;
+        CPPUNIT_ASSERT_EQUAL(uint8_t(IpcFrame::Reply), kind);
+        CPPUNIT_ASSERT_EQUAL(id, replyId);
+        CPPUNIT_ASSERT_EQUAL(status, replyStatus);
+        return body;
+    }
+
+private:
+    bool readFull(uint8_t* data, std::size_t size, std::chrono::milliseconds timeout)
+    {
+        while (size) {
+            pollfd pfd {fd_, POLLIN, 0};
+            if (::poll(&pfd, 1, timeout.count()) <= 0)
+                throw std::runtime_error("Timeout");
+            auto n = ::recv(fd_, data, size, 0);
+            if (n <= 0)
+                return false;
+            data += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    int fd_ {-1};
+};
+
+class IpcTest : public CppUnit::TestFixture
+{
+public:
+    static std::string name() { return "ipc"; }
+    void setUp();
+    void tearDown();
+
+private:
+    void testCodecRoundTrip();
+    void testCodecTruncated();
+    void testRequestReply();
+    void testSubscribe();
+    void testInvalidFrame();
+    void testSlowMethod();
+    void testPrivateDirectory();
+
+    CPPUNIT_TEST_SUITE(IpcTest);
+    CPPUNIT_TEST(testCodecRoundTrip);
+    CPPUNIT_TEST(testCodecTruncated);
+    CPPUNIT_TEST(testRequestReply);
+    CPPUNIT_TEST(testSubscribe);
+    CPPUNIT_TEST(testInvalidFrame);
+    CPPUNIT_TEST(testSlowMethod);
+    CPPUNIT_TEST(testPrivateDirectory);
+    CPPUNIT_TEST_SUITE_END();
+
+    std::string dir_;
+    std::string path_;
+    std::unique_ptr<IpcServer> server_;
+    std::thread serverThread_;
+};
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(IpcTest, IpcTest::name());
+
+void
+IpcTest::setUp()
+{
+    char dirTemplate[] = "/tmp/jami-ipc-test-XXXXXX";
+    CPPUNIT_ASSERT(mkdtemp(dirTemplate));
+    dir_ = dirTemplate;
+    path_ = dir_ + "/jamid.sock";
+    server_ = std::make_unique<IpcServer>(path_);
+    server_->addMethod("add", &add);
+    server_->addMethod("sleep", [](IpcDecoder& in, IpcEncoder& out) {
+        uint32_t ms;
+        in >> ms;
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        out << ms;
+    });
+    serverThread_ = std::thread([this] { server_->run(); });
+}
+
+void
+IpcTest::tearDown()
+{
+    server_->stop();
+    serverThread_.join();
+    server_.reset();
+    ::rmdir(dir_.c_str());
+}
+
+void
+IpcTest::testCodecRoundTrip()
+{
+    std::vector<uint8_t> data;
+    IpcEncoder enc(data);
+    enc.begin(IpcFrame::Signal);
+    enc << true << int32_t(-300) << uint64_t(1ull << 63) << 3.25 << std::string("héllo")
+        << std::vector<std::string> {"a", "", "c"}
+        << std::map<std::string, std::string> {{"k1", "v1"}, {"k2", ""}}
+        << std::vector<uint8_t> {0, 255, 7};
+    enc.end();
+
+    uint32_t size = data[0] | data[1] << 8 | data[2] << 16 | uint32_t(data[3]) << 24;
+    CPPUNIT_ASSERT_EQUAL(std::size_t(size), data.size() - IPC_FRAME_HEADER);
+
+    IpcDecoder in(data.data() + IPC_FRAME_HEADER, size);
+    uint8_t kind;
+    bool b;
+    int32_t i;
+    uint64_t u;
+    double d;
+    std::string s;
+    std::vector<std::string> v;
+    std::map<std::string, std::string> m;
+    std::vector<uint8_t> bytes;
+    in >> kind >> b >> i >> u >> d >> s >> v >> m >> bytes;
+    CPPUNIT_ASSERT(in.empty());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(IpcFrame::Signal), kind);
+    CPPUNIT_ASSERT(b);
+    CPPUNIT_ASSERT_EQUAL(int32_t(-300), i);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1ull << 63), u);
+    CPPUNIT_ASSERT_EQUAL(3.25, d);
+    CPPUNIT_ASSERT_EQUAL(std::string("héllo"), s);
+    CPPUNIT_ASSERT(v == (std::vector<std::string> {"a", "", "c"}));
+    CPPUNIT_ASSERT(m == (std::map<std::string, std::string> {{"k1", "v1"}, {"k2", ""}}));
+    CPPUNIT_ASSERT(bytes == (std::vector<uint8_t> {0, 255, 7}));
+}
+
+void
+IpcTest::testCodecTruncated()
+{
+    std::vector<uint8_t> data;
+    IpcEncoder enc(data);
+    enc << std::string("hello") << 1.5;
+
+    // Every prefix of a valid encoding is rejected
+    for (std::size_t size = 0; size < data.size(); ++size) {
+        IpcDecoder in(data.data(), size);
+        std::string s;
+        double d;
+        CPPUNIT_ASSERT_THROW(in >> s >> d, std::runtime_error);
+    }
+
+    // Counts bigger than what remains, before allocating anything
+    std::vector<uint8_t> huge;
+    IpcEncoder hugeEnc(huge);
+    hugeEnc.varint(1ull << 40);
+    {
+        IpcDecoder in(huge.data(), huge.size());
+        std::vector<std::string> v;
+        CPPUNIT_ASSERT_THROW(in >> v, std::runtime_error);
+    }
+    {
+        IpcDecoder in(huge.data(), huge.size());
+        std::map<std::string, std::string> m;
+        CPPUNIT_ASSERT_THROW(in >> m, std::runtime_error);
+    }
+
+    // A varint longer than 64 bits
+    std::vector<uint8_t> varint(11, 0x80);
+    IpcDecoder in(varint.data(), varint.size());
+    uint64_t u;
+    CPPUNIT_ASSERT_THROW(in >> u, std::runtime_error);
+}
+
+void
+IpcTest::testRequestReply()
+{
+    Connection conn(path_);
+    conn.request(1, "add", 2, -5);
+    conn.request(2, "nothing");
+    conn.request(3, "add", 40, 2);
+
+    auto body = conn.reply(1);
+    IpcDecoder in(body.data() + 3, body.size() - 3);
+    int result;
+    in >> result;
+    CPPUNIT_ASSERT_EQUAL(-3, result);
+
+    body = conn.reply(2, 1);
+    IpcDecoder err(body.data() + 3, body.size() - 3);
+    std::string message;
+    err >> message;
+    CPPUNIT_ASSERT_EQUAL(std::string("Unknown method nothing"), message);
+
+    body = conn.reply(3);
+    IpcDecoder in2(body.data() + 3, body.size() - 3);
+    in2 >> result;
+    CPPUNIT_ASSERT_EQUAL(42, result);
+    CPPUNIT_ASSERT_EQUAL(std::string("3"), server_->getStats().at("requests"));
+}
+
+void
+IpcTest::testSubscribe()
+{
+    Connection conn(path_);
+    conn.subscribe({"Wanted"});
+    // Frames are handled in order: once answered, the subscription is known
+    conn.request(1, "add", 1, 1);
+    conn.reply(1);
+
+    server_->emitSignal("Other", false, 1);
+    server_->emitSignal("Wanted", false, 2);
+    server_->emitSignal("Other", true, 3);
+    server_->emitSignal("Wanted", true, 4);
+    for (int expected : {2, 4}) {
+        auto body = conn.readFrame();
+        IpcDecoder in(body.data(), body.size());
+        uint8_t kind;
+        std::string name;
+        int value;
+        in >> kind >> name >> value;
+        CPPUNIT_ASSERT_EQUAL(uint8_t(IpcFrame::Signal), kind);
+        CPPUNIT_ASSERT_EQUAL(std::string("Wanted"), name);
+        CPPUNIT_ASSERT_EQUAL(expected, value);
+    }
+}
+
+void
+IpcTest::testInvalidFrame()
+{
+    Connection conn(path_);
+    conn.send({1, 0, 0, 0, 9});
+    CPPUNIT_ASSERT(conn.readFrame().empty());
+
+    // A truncated request is only detected by the worker
+    Connection conn2(path_);
+    conn2.send({2, 0, 0, 0, uint8_t(IpcFrame::Request), 1});
+    CPPUNIT_ASSERT(conn2.readFrame().empty());
+
+    // Other clients are still served
+    Connection conn3(path_);
+    conn3.request(1, "add", 1, 2);
+    conn3.reply(1);
+}
+
+void
+IpcTest::testSlowMethod()
+{
+    Connection slow(path_);
+    Connection fast(path_);
+    slow.request(1, "sleep", uint32_t(500));
+    slow.request(2, "add", 1, 2);
+    std::this_thread::sleep_for(50ms);
+
+    // Another client isn't delayed by the slow method
+    auto start = std::chrono::steady_clock::now();
+    fast.request(1, "add", 1, 2);
+    fast.reply(1);
+    CPPUNIT_ASSERT(std::chrono::steady_clock::now() - start < 300ms);
+
+    // The replies of a client stay in order
+    slow.reply(1);
+    slow.reply(2);
+}
+
+void
+IpcTest::testPrivateDirectory()
+{
+    auto sub = dir_ + "/shared";
+    CPPUNIT_ASSERT_EQUAL(0, ::mkdir(sub.c_str(), 0755));
+    CPPUNIT_ASSERT_THROW(IpcServer(sub + "/jamid.sock"), std::runtime_error);
+
+    // Not followed: it could point to a directory of another user
+    auto link = dir_ + "/link";
+    CPPUNIT_ASSERT_EQUAL(0, ::chmod(sub.c_str(), 0700));
+    CPPUNIT_ASSERT_EQUAL(0, ::symlink(sub.c_str(), link.c_str()));
+    CPPUNIT_ASSERT_THROW(IpcServer(link + "/jamid.sock"), std::runtime_error);
+
+    // Created if needed
+    auto created = dir_ + "/created";
+    IpcServer(created + "/jamid.sock");
+    struct stat st;
+    CPPUNIT_ASSERT_EQUAL(0, ::lstat(created.c_str(), &st));
+    CPPUNIT_ASSERT_EQUAL(0, int(st.st_mode & 077));
+
+    ::unlink(link.c_str());
+    ::rmdir(sub.c_str());
+    ::rmdir(created.c_str());
+}
+
+} // namespace test
+} // namespace jami
+
+RING_TEST_RUNNER(jami::test::IpcTest::name())
@@ -0,0 +1,209 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "jami.h"
+#include "fileutils.h"
+#include "audio/sound/audiofile.h"
+
+#include "../test_runner.h"
+
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+#include <sys/stat.h>
+#include <utime.h>
+
+namespace jami { namespace test {
+
+class AudioFileCacheTest : public CppUnit::TestFixture {
+public:
+    static std::string name() { return "audio_file_cache"; }
+
+    void setUp();
+    void tearDown();
+
+private:
+    void testSharedDecoding();
+    void testModifiedFile();
+    void testLongFile();
+    void testMemoryLimit();
+
+    CPPUNIT_TEST_SUITE(AudioFileCacheTest);
+    CPPUNIT_TEST(testSharedDecoding);
+    CPPUNIT_TEST(testModifiedFile);
+    CPPUNIT_TEST(testLongFile);
+    CPPUNIT_TEST(testMemoryLimit);
+    CPPUNIT_TEST_SUITE_END();
+
+    const std::string path_ {"audio_file_cache_test.wav"};
+};
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(AudioFileCacheTest, AudioFileCacheTest::name());
+
+static constexpr unsigned FILE_RATE {8000};
+
+// Mono 16 bits PCM WAV of a 440 Hz sine
+static void
+writeWav(const std::string& path, double seconds)
+{
+    auto put = [](std::ofstream& f, uint32_t v, int bytes) {
+        for (int i = 0; i < bytes; ++i)
+            f.put(char((v >> (8 * i)) & 0xff));
+    };
+    uint32_t frames = seconds * FILE_RATE;
+    uint32_t dataSize = frames * 2;
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f << "RIFF";
+    put(f, 36 + dataSize, 4);
+    f << "WAVEfmt ";
+    put(f, 16, 4);
+    put(f, 1, 2); // PCM
+    put(f, 1, 2); // mono
+    put(f, FILE_RATE, 4);
+    put(f, FILE_RATE * 2, 4);
+    put(f, 2, 2);
+    put(f, 16, 2);
+    f << "data";
+    put(f, dataSize, 4);
+    for (uint32_t i = 0; i < frames; ++i)
+        put(f, uint16_t(int16_t(8000 * std::sin(2 * M_PI * 440 * i / FILE_RATE))), 2);
+}
+
+static void
+setWriteTime(const std::string& path, time_t mtime)
+{
+    struct utimbuf times {mtime, mtime};
+    utime(path.c_str(), &times);
+}
+
+void
+AudioFileCacheTest::setUp()
+{
+    DRing::init(DRing::InitFlag(DRing::DRING_FLAG_DEBUG | DRing::DRING_FLAG_CONSOLE_LOG));
+    AudioFileCache::instance().clear();
+    AudioFileCache::instance().setMaxSize(AudioFileCache::DEFAULT_MAX_SIZE);
+}
+
+void
+AudioFileCacheTest::tearDown()
+{
+    AudioFileCache::instance().clear();
+    fileutils::remove(path_);
+    DRing::fini();
+}
+
+void
+AudioFileCacheTest::testSharedDecoding()
+{
+    writeWav(path_, 1);
+    auto& cache = AudioFileCache::instance();
+
+    auto a = cache.get(path_, 48000);
+    auto b = cache.get(path_, 48000);
+    CPPUNIT_ASSERT(a->complete());
+    CPPUNIT_ASSERT_EQUAL(a.get(), b.get());
+    CPPUNIT_ASSERT_EQUAL(48000u, a->buffer()->getSampleRate());
+    CPPUNIT_ASSERT(a->buffer()->frames() >= 47000);
+
+    // Another rate is another entry
+    auto c = cache.get(path_, 16000);
+    CPPUNIT_ASSERT(a.get() != c.get());
+    CPPUNIT_ASSERT_EQUAL(a->buffer()->size() + c->buffer()->size(), cache.size());
+
+    // Players share the buffer
+    AudioFile player1(path_, 48000), player2(path_, 48000);
+    CPPUNIT_ASSERT_EQUAL(a->buffer()->frames(), player1.getSize());
+    CPPUNIT_ASSERT_EQUAL(player1.getSize(), player2.getSize());
+
+    CPPUNIT_ASSERT_THROW(cache.get("missing_audio_file.wav", 48000), AudioFileException);
+}
+
+void
+AudioFileCacheTest::testModifiedFile()
+{
+    auto& cache = AudioFileCache::instance();
+    writeWav(path_, 1);
+    setWriteTime(path_, 1000000);
+    auto a = cache.get(path_, 8000);
+
+    writeWav(path_, 2);
+    setWriteTime(path_, 2000000);
+    auto b = cache.get(path_, 8000);
+    CPPUNIT_ASSERT(a.get() != b.get());
+    CPPUNIT_ASSERT(b->buffer()->frames() > a->buffer()->frames());
+    // The previous version was dropped
+    CPPUNIT_ASSERT_EQUAL(b->buffer()->size(), cache.size());
+}
+
+void
+AudioFileCacheTest::testLongFile()
+{
+    auto& cache = AudioFileCache::instance();
+    writeWav(path_, 60);
+
+    auto file = cache.get(path_, 48000);
+    auto threshold = AudioFileCache::STREAMING_THRESHOLD.count() * 48000;
+    auto begin = file->buffer()->frames();
+    CPPUNIT_ASSERT(begin >= std::size_t(threshold));
+
+    AudioFile player(path_, 48000);
+    AudioBuffer out(480, AudioFormat(48000, 1));
+    for (int i = 0; i < 1000 and not file->complete(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CPPUNIT_ASSERT(file->complete());
+    CPPUNIT_ASSERT(file->buffer()->frames() >= 59 * 48000);
+
+    // The player switches to the whole file
+    player.getNext(out, 1);
+    CPPUNIT_ASSERT_EQUAL(file->buffer()->frames(), player.getSize());
+}
+
+void
+AudioFileCacheTest::testMemoryLimit()
+{
+    auto& cache = AudioFileCache::instance();
+    writeWav(path_, 1);
+    auto file = cache.get(path_, 48000);
+    auto size = file->buffer()->size();
+    cache.setMaxSize(size * 5 / 2);
+    CPPUNIT_ASSERT_EQUAL(size, cache.size());
+
+    // 48 kHz is used again, so 44.1 kHz is the least recently used and gets evicted
+    auto other = cache.get(path_, 44100);
+    cache.get(path_, 48000);
+    cache.get(path_, 32000);
+    CPPUNIT_ASSERT(cache.size() <= size * 5 / 2);
+    CPPUNIT_ASSERT_EQUAL(file.get(), cache.get(path_, 48000).get());
+    CPPUNIT_ASSERT(other.get() != cache.get(path_, 44100).get());
+
+    // Files bigger than half of the limit are not kept
+    cache.setMaxSize(size);
+    CPPUNIT_ASSERT(cache.size() <= size);
+    cache.clear();
+    cache.get(path_, 48000);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache.size());
+}
+
+}} // namespace jami::test
+
+RING_TEST_RUNNER(jami::test::AudioFileCacheTest::name());
@@ -0,0 +1,163 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "media/video/v4l2/v4l2_capability_cache.h"
+#include "fileutils.h"
+
+#include "../../../test_runner.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace jami {
+namespace video {
+namespace test {
+
+static v4l2_capability
+makeCapability(const char* card, unsigned version)
+{
+    v4l2_capability cap {};
+    std::strcpy(reinterpret_cast<char*>(cap.bus_info), "usb-0000:00:14.0-1");
+    std::strcpy(reinterpret_cast<char*>(cap.card), card);
+    std::strcpy(reinterpret_cast<char*>(cap.driver), "uvcvideo");
+    cap.version = version;
+    return cap;
+}
+
+static CachedV4l2Channels
+makeChannels(unsigned width)
+{
+    CachedV4l2Size size {width, 480, {{30, 1, V4L2_PIX_FMT_YUYV}, {15, 1, V4L2_PIX_FMT_MJPEG}}};
+    return {{0, "Camera 1", {size}}};
+}
+
+class V4l2CapabilityCacheTest : public CppUnit::TestFixture
+{
+public:
+    static std::string name() { return "v4l2_capability_cache"; }
+    void setUp();
+    void tearDown();
+
+private:
+    void testKey();
+    void testLoad();
+    void testCorruptFile();
+    void testRefresh();
+
+    CPPUNIT_TEST_SUITE(V4l2CapabilityCacheTest);
+    CPPUNIT_TEST(testKey);
+    CPPUNIT_TEST(testLoad);
+    CPPUNIT_TEST(testCorruptFile);
+    CPPUNIT_TEST(testRefresh);
+    CPPUNIT_TEST_SUITE_END();
+
+    std::string dir_;
+    std::string path_;
+};
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(V4l2CapabilityCacheTest, V4l2CapabilityCacheTest::name());
+
+void
+V4l2CapabilityCacheTest::setUp()
+{
+    char dirTemplate[] = "/tmp/jami-v4l2-cache-XXXXXX";
+    CPPUNIT_ASSERT(mkdtemp(dirTemplate));
+    dir_ = dirTemplate;
+    path_ = dir_ + DIR_SEPARATOR_STR + "v4l2_capabilities";
+}
+
+void
+V4l2CapabilityCacheTest::tearDown()
+{
+    fileutils::removeAll(dir_);
+}
+
+void
+V4l2CapabilityCacheTest::testKey()
+{
+    auto cap = makeCapability("HD Webcam", 0x50f00);
+    auto key = V4l2CapabilityCache::key(cap, "0012");
+    auto same = makeCapability("HD Webcam", 0x50f00);
+    CPPUNIT_ASSERT_EQUAL(key, V4l2CapabilityCache::key(same, "0012"));
+    CPPUNIT_ASSERT(key.find("HD Webcam") != std::string::npos);
+
+    // Another firmware, driver or device is another entry
+    CPPUNIT_ASSERT(key != V4l2CapabilityCache::key(cap, "0013"));
+    auto driver = makeCapability("HD Webcam", 0x51000);
+    CPPUNIT_ASSERT(key != V4l2CapabilityCache::key(driver, "0012"));
+    auto other = makeCapability("Other Webcam", 0x50f00);
+    CPPUNIT_ASSERT(key != V4l2CapabilityCache::key(other, "0012"));
+}
+
+void
+V4l2CapabilityCacheTest::testLoad()
+{
+    {
+        V4l2CapabilityCache cache(path_);
+        CPPUNIT_ASSERT(not cache.get("camera"));
+        CPPUNIT_ASSERT(cache.update("camera", makeChannels(640)));
+    }
+    CPPUNIT_ASSERT(fileutils::isFile(path_));
+
+    // As on the next start
+    V4l2CapabilityCache cache(path_);
+    auto cached = cache.get("camera");
+    CPPUNIT_ASSERT(cached);
+    CPPUNIT_ASSERT(*cached == makeChannels(640));
+    CPPUNIT_ASSERT(not cache.get("other camera"));
+}
+
+void
+V4l2CapabilityCacheTest::testCorruptFile()
+{
+    std::string garbage = "\xc1 not msgpack";
+    fileutils::saveFile(path_, (const uint8_t*) garbage.data(), garbage.size());
+
+    // Ignored, the devices are probed again and the file is replaced
+    V4l2CapabilityCache cache(path_);
+    CPPUNIT_ASSERT(not cache.get("camera"));
+    CPPUNIT_ASSERT(cache.update("camera", makeChannels(640)));
+    CPPUNIT_ASSERT(V4l2CapabilityCache(path_).get("camera"));
+}
+
+void
+V4l2CapabilityCacheTest::testRefresh()
+{
+    V4l2CapabilityCache cache(path_);
+    cache.update("camera", makeChannels(640));
+
+    // Probed again, unchanged: the file isn't written
+    fileutils::remove(path_);
+    CPPUNIT_ASSERT(not cache.update("camera", makeChannels(640)));
+    CPPUNIT_ASSERT(not fileutils::isFile(path_));
+
+    // Changed, e.g. by a firmware update keeping the same revision
+    CPPUNIT_ASSERT(cache.update("camera", makeChannels(1280)));
+    CPPUNIT_ASSERT(*cache.get("camera") == makeChannels(1280));
+    CPPUNIT_ASSERT(*V4l2CapabilityCache(path_).get("camera") == makeChannels(1280));
+}
+
+} // namespace test
+} // namespace video
+} // namespace jami
+
+RING_TEST_RUNNER(jami::video::test::V4l2CapabilityCacheTest::name())
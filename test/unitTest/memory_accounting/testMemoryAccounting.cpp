@@ -0,0 +1,110 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "memory_accounting.h"
+#include "transport/peer_channel.h"
+#include "../../test_runner.h"
+
+#include <vector>
+
+namespace jami {
+namespace test {
+
+class MemoryAccountingTest : public CppUnit::TestFixture
+{
+public:
+    static std::string name() { return "memory_accounting"; }
+
+private:
+    void testTrackedBytes();
+    void testSoftLimits();
+    void testPeerChannelAccounting();
+    void testDropped();
+
+    CPPUNIT_TEST_SUITE(MemoryAccountingTest);
+    CPPUNIT_TEST(testTrackedBytes);
+    CPPUNIT_TEST(testSoftLimits);
+    CPPUNIT_TEST(testPeerChannelAccounting);
+    CPPUNIT_TEST(testDropped);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(MemoryAccountingTest, MemoryAccountingTest::name());
+
+void
+MemoryAccountingTest::testTrackedBytes()
+{
+    auto before = MemoryAccounting::bytes(MemoryPool::CHANNEL_RX);
+    {
+        TrackedBytes<MemoryPool::CHANNEL_RX> buf;
+        buf.update(1024);
+        buf.update(4096);
+        CPPUNIT_ASSERT_EQUAL(before + 4096, MemoryAccounting::bytes(MemoryPool::CHANNEL_RX));
+        auto stats = MemoryAccounting::getStats();
+        CPPUNIT_ASSERT(std::stoull(stats["channel_rx.peak"]) >= before + 4096);
+    }
+    CPPUNIT_ASSERT_EQUAL(before, MemoryAccounting::bytes(MemoryPool::CHANNEL_RX));
+}
+
+void
+MemoryAccountingTest::testSoftLimits()
+{
+    MemoryAccounting::setSoftLimits({{"tls_rx", "65536"}, {"unknown", "1"}, {"ice_rx", "bad"}});
+    CPPUNIT_ASSERT_EQUAL(std::size_t(65536), MemoryAccounting::softLimit(MemoryPool::TLS_RX));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), MemoryAccounting::softLimit(MemoryPool::ICE_RX));
+    CPPUNIT_ASSERT_EQUAL(std::string("65536"), MemoryAccounting::getStats()["tls_rx.limit"]);
+    MemoryAccounting::setSoftLimits({{"tls_rx", "0"}});
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), MemoryAccounting::softLimit(MemoryPool::TLS_RX));
+}
+
+void
+MemoryAccountingTest::testPeerChannelAccounting()
+{
+    auto before = MemoryAccounting::bytes(MemoryPool::ICE_RX);
+    PeerChannel channel;
+    std::error_code ec;
+    std::vector<char> data(1024);
+    channel.write(data.data(), data.size(), ec);
+    CPPUNIT_ASSERT_EQUAL(data.size(), channel.size());
+    CPPUNIT_ASSERT_EQUAL(before + data.size(), MemoryAccounting::bytes(MemoryPool::ICE_RX));
+
+    std::vector<char> out(512);
+    channel.read(out.data(), out.size(), ec);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(512), channel.size());
+    CPPUNIT_ASSERT_EQUAL(before + 512, MemoryAccounting::bytes(MemoryPool::ICE_RX));
+}
+
+void
+MemoryAccountingTest::testDropped()
+{
+    auto dropped = [] {
+        return std::stoull(MemoryAccounting::getStats()["channel_rx.dropped"]);
+    };
+    auto before = dropped();
+    MemoryAccounting::dropped(MemoryPool::CHANNEL_RX, 1500);
+    CPPUNIT_ASSERT_EQUAL(before + 1500, dropped());
+}
+
+} // namespace test
+} // namespace jami
+
+RING_TEST_RUNNER(jami::test::MemoryAccountingTest::name())
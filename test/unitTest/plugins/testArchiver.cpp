@@ -0,0 +1,189 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "archiver.h"
+#include "fileutils.h"
+#include "../../test_runner.h"
+
+extern "C" {
+#include <archive.h>
+#include <archive_entry.h>
+}
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+
+namespace jami {
+namespace test {
+
+// More files than extracting threads, of different sizes
+static std::map<std::string, std::string>
+makeFiles()
+{
+    std::map<std::string, std::string> files;
+    for (int i = 0; i < 8; ++i) {
+        std::string content = "file" + std::to_string(i) + ":";
+        while (content.size() < std::size_t(1000 << i))
+            content += std::to_string(content.size() * 7919 % 1000);
+        files["data/file" + std::to_string(i)] = content;
+    }
+    files["manifest.json"] = "{}";
+    return files;
+}
+
+// Entries are stored, so that their data can be found in the archive
+static std::string
+writeArchive(const std::string& path, const std::map<std::string, std::string>& files)
+{
+    auto* a = archive_write_new();
+    archive_write_set_format_zip(a);
+    archive_write_set_options(a, "zip:compression=store");
+    CPPUNIT_ASSERT_EQUAL(ARCHIVE_OK, archive_write_open_filename(a, path.c_str()));
+    for (const auto& file : files) {
+        auto* entry = archive_entry_new();
+        archive_entry_set_pathname(entry, file.first.c_str());
+        archive_entry_set_size(entry, file.second.size());
+        archive_entry_set_filetype(entry, AE_IFREG);
+        archive_entry_set_perm(entry, 0644);
+        archive_write_header(a, entry);
+        archive_write_data(a, file.second.data(), file.second.size());
+        archive_entry_free(entry);
+    }
+    archive_write_close(a);
+    archive_write_free(a);
+    auto data = fileutils::loadFile(path);
+    return {data.begin(), data.end()};
+}
+
+static std::pair<bool, std::string_view>
+extractAll(std::string_view name)
+{
+    return {true, name};
+}
+
+class ArchiverTest : public CppUnit::TestFixture
+{
+public:
+    static std::string name() { return "archiver"; }
+    void setUp();
+    void tearDown();
+
+private:
+    void testRoundTrip();
+    void testTruncated();
+    void testRollback();
+
+    CPPUNIT_TEST_SUITE(ArchiverTest);
+    CPPUNIT_TEST(testRoundTrip);
+    CPPUNIT_TEST(testTruncated);
+    CPPUNIT_TEST(testRollback);
+    CPPUNIT_TEST_SUITE_END();
+
+    std::string dir_;
+    std::string archivePath_;
+    std::string outputDir_;
+};
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(ArchiverTest, ArchiverTest::name());
+
+void
+ArchiverTest::setUp()
+{
+    char dirTemplate[] = "/tmp/jami-archiver-XXXXXX";
+    CPPUNIT_ASSERT(mkdtemp(dirTemplate));
+    dir_ = dirTemplate;
+    archivePath_ = dir_ + DIR_SEPARATOR_STR + "package.jpl";
+    outputDir_ = dir_ + DIR_SEPARATOR_STR + "output";
+}
+
+void
+ArchiverTest::tearDown()
+{
+    fileutils::removeAll(dir_);
+}
+
+void
+ArchiverTest::testRoundTrip()
+{
+    auto files = makeFiles();
+    writeArchive(archivePath_, files);
+
+    std::mutex mtx;
+    uint64_t lastDone = 0, lastTotal = 0;
+    archiver::uncompressArchive(archivePath_,
+                                outputDir_,
+                                extractAll,
+                                [&](uint64_t done, uint64_t total) {
+                                    std::lock_guard<std::mutex> lk(mtx);
+                                    CPPUNIT_ASSERT(done >= lastDone and done <= total);
+                                    lastDone = done;
+                                    lastTotal = total;
+                                });
+
+    uint64_t total = 0;
+    for (const auto& file : files) {
+        auto data = fileutils::loadFile(outputDir_ + DIR_SEPARATOR_STR + file.first);
+        CPPUNIT_ASSERT(std::string(data.begin(), data.end()) == file.second);
+        total += file.second.size();
+    }
+    CPPUNIT_ASSERT_EQUAL(total, lastTotal);
+    CPPUNIT_ASSERT_EQUAL(total, lastDone);
+}
+
+void
+ArchiverTest::testTruncated()
+{
+    auto archive = writeArchive(archivePath_, makeFiles());
+    archive.resize(archive.size() / 2);
+    fileutils::saveFile(archivePath_, (const uint8_t*) archive.data(), archive.size());
+
+    CPPUNIT_ASSERT_THROW(archiver::uncompressArchive(archivePath_, outputDir_, extractAll),
+                         std::runtime_error);
+    CPPUNIT_ASSERT(not fileutils::isDirectory(outputDir_));
+}
+
+void
+ArchiverTest::testRollback()
+{
+    // The largest file is corrupted: its checksum fails while the other
+    // threads write the smaller ones
+    auto files = makeFiles();
+    auto archive = writeArchive(archivePath_, files);
+    const auto& largest = files["data/file7"];
+    auto pos = archive.find(largest.substr(0, 64));
+    CPPUNIT_ASSERT(pos != std::string::npos);
+    archive[pos + largest.size() / 2] ^= 0x55;
+    fileutils::saveFile(archivePath_, (const uint8_t*) archive.data(), archive.size());
+
+    CPPUNIT_ASSERT_THROW(archiver::uncompressArchive(archivePath_, outputDir_, extractAll),
+                         std::runtime_error);
+    CPPUNIT_ASSERT(not fileutils::isDirectory(outputDir_));
+}
+
+} // namespace test
+} // namespace jami
+
+RING_TEST_RUNNER(jami::test::ArchiverTest::name())
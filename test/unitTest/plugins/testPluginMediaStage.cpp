@@ -0,0 +1,241 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "libav_deps.h"
+#include "plugin/pluginmediastage.h"
+#include "../../test_runner.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jami {
+namespace test {
+
+using namespace std::literals::chrono_literals;
+using FramePtr = std::unique_ptr<AVFrame, void (*)(AVFrame*)>;
+
+static FramePtr
+makeVideoFrame()
+{
+    FramePtr frame {av_frame_alloc(), [](AVFrame* f) { av_frame_free(&f); }};
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = 64;
+    frame->height = 64;
+    CPPUNIT_ASSERT(av_frame_get_buffer(frame.get(), 0) >= 0);
+    frame->data[0][0] = 0;
+    return frame;
+}
+
+static FramePtr
+makeAudioFrame(int64_t pts)
+{
+    FramePtr frame {av_frame_alloc(), [](AVFrame* f) { av_frame_free(&f); }};
+    frame->format = AV_SAMPLE_FMT_S16;
+    frame->nb_samples = 160;
+    frame->channels = 1;
+    frame->channel_layout = AV_CH_LAYOUT_MONO;
+    frame->sample_rate = 8000;
+    CPPUNIT_ASSERT(av_frame_get_buffer(frame.get(), 0) >= 0);
+    frame->pts = pts;
+    return frame;
+}
+
+/**
+ * A MediaHandler taking a given time per frame, which marks the frames it processed.
+ * It outlives the stage, which waits for it on destruction.
+ */
+class SlowHandler : public Observer<AVFrame*>
+{
+public:
+    SlowHandler(std::chrono::milliseconds delay)
+        : delay_(delay)
+    {}
+
+    void update(Observable<AVFrame*>*, AVFrame* const& frame) override
+    {
+        std::this_thread::sleep_for(delay_);
+        frame->data[0][0] = MARK;
+        std::lock_guard<std::mutex> lk(mtx_);
+        seen_.emplace_back(frame->pts);
+        cv_.notify_all();
+    }
+
+    std::vector<int64_t> waitSeen(std::size_t count)
+    {
+        std::unique_lock<std::mutex> lk(mtx_);
+        cv_.wait_for(lk, 5s, [&] { return seen_.size() >= count; });
+        return seen_;
+    }
+
+    static constexpr uint8_t MARK {42};
+
+private:
+    const std::chrono::milliseconds delay_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::vector<int64_t> seen_;
+};
+
+static std::string
+stat(const PluginMediaStage& stage, const std::string& key)
+{
+    return stage.getStats().at(key);
+}
+
+class PluginMediaStageTest : public CppUnit::TestFixture
+{
+public:
+    static std::string name() { return "plugin_media_stage"; }
+
+private:
+    void testInTime();
+    void testSkipAndReuse();
+    void testAudioQueue();
+    void testAudioDrop();
+    void testSyncWaitBounded();
+
+    CPPUNIT_TEST_SUITE(PluginMediaStageTest);
+    CPPUNIT_TEST(testInTime);
+    CPPUNIT_TEST(testSkipAndReuse);
+    CPPUNIT_TEST(testAudioQueue);
+    CPPUNIT_TEST(testAudioDrop);
+    CPPUNIT_TEST(testSyncWaitBounded);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(PluginMediaStageTest, PluginMediaStageTest::name());
+
+void
+PluginMediaStageTest::testInTime()
+{
+    SlowHandler handler(0ms);
+    PluginMediaStage stage({"call", false, StreamType::video, ""}, 500ms);
+    stage.attach(&handler);
+    for (int i = 0; i < 5; ++i) {
+        auto frame = makeVideoFrame();
+        frame->pts = i;
+        stage.update(nullptr, frame.get());
+        CPPUNIT_ASSERT_EQUAL(SlowHandler::MARK, frame->data[0][0]);
+        CPPUNIT_ASSERT_EQUAL(int64_t(i), frame->pts);
+    }
+    CPPUNIT_ASSERT_EQUAL(std::string("5"), stat(stage, "processed"));
+    CPPUNIT_ASSERT_EQUAL(std::string("0"), stat(stage, "late"));
+}
+
+void
+PluginMediaStageTest::testSkipAndReuse()
+{
+    SlowHandler handler(50ms);
+    PluginMediaStage stage({"call", false, StreamType::video, ""}, 5ms);
+    stage.attach(&handler);
+
+    // Late, nothing to reuse yet
+    auto first = makeVideoFrame();
+    stage.update(nullptr, first.get());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0), first->data[0][0]);
+
+    // The handler is busy with the first frame
+    auto skipped = makeVideoFrame();
+    stage.update(nullptr, skipped.get());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0), skipped->data[0][0]);
+    handler.waitSeen(1);
+    std::this_thread::sleep_for(20ms);
+
+    // Late again: gets the result of the first frame
+    auto reused = makeVideoFrame();
+    stage.update(nullptr, reused.get());
+    CPPUNIT_ASSERT_EQUAL(SlowHandler::MARK, reused->data[0][0]);
+
+    CPPUNIT_ASSERT_EQUAL(std::string("3"), stat(stage, "frames"));
+    CPPUNIT_ASSERT_EQUAL(std::string("0"), stat(stage, "processed"));
+    CPPUNIT_ASSERT_EQUAL(std::string("3"), stat(stage, "late"));
+    CPPUNIT_ASSERT_EQUAL(std::string("1"), stat(stage, "skipped"));
+    CPPUNIT_ASSERT_EQUAL(std::string("1"), stat(stage, "reused"));
+}
+
+void
+PluginMediaStageTest::testAudioQueue()
+{
+    SlowHandler handler(10ms);
+    PluginMediaStage stage({"call", false, StreamType::audio, ""},
+                           1ms,
+                           PluginMediaStage::BusyPolicy::QUEUE);
+    stage.attach(&handler);
+    for (int64_t i = 0; i < 10; ++i) {
+        auto frame = makeAudioFrame(i);
+        stage.update(nullptr, frame.get());
+    }
+    // Every frame, in order
+    auto seen = handler.waitSeen(10);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(10), seen.size());
+    for (int64_t i = 0; i < 10; ++i)
+        CPPUNIT_ASSERT_EQUAL(i, seen[i]);
+    CPPUNIT_ASSERT_EQUAL(std::string("0"), stat(stage, "skipped"));
+    CPPUNIT_ASSERT(std::stoi(stat(stage, "queued")) >= 8);
+}
+
+void
+PluginMediaStageTest::testAudioDrop()
+{
+    SlowHandler handler(10ms);
+    PluginMediaStage stage({"call", false, StreamType::audio, ""}, 1ms);
+    stage.attach(&handler);
+    for (int64_t i = 0; i < 10; ++i) {
+        auto frame = makeAudioFrame(i);
+        stage.update(nullptr, frame.get());
+    }
+    std::this_thread::sleep_for(100ms);
+    CPPUNIT_ASSERT(handler.waitSeen(1).size() < 10);
+    CPPUNIT_ASSERT(std::stoi(stat(stage, "skipped")) > 0);
+    CPPUNIT_ASSERT_EQUAL(std::string("0"), stat(stage, "queued"));
+}
+
+void
+PluginMediaStageTest::testSyncWaitBounded()
+{
+    SlowHandler handler(500ms);
+    PluginMediaStage stage({"call", false, StreamType::video, ""}, 1ms);
+    stage.attach(&handler);
+    auto first = makeVideoFrame();
+    stage.update(nullptr, first.get());
+
+    // Synchronous now, but the worker is busy for a while: the frame is skipped
+    stage.setBudget(0ms);
+    auto second = makeVideoFrame();
+    auto start = std::chrono::steady_clock::now();
+    stage.update(nullptr, second.get());
+    CPPUNIT_ASSERT(std::chrono::steady_clock::now() - start < 300ms);
+    CPPUNIT_ASSERT_EQUAL(std::string("1"), stat(stage, "skipped"));
+
+    // Once it is idle, frames are processed on the media thread
+    handler.waitSeen(1);
+    auto third = makeVideoFrame();
+    stage.update(nullptr, third.get());
+    CPPUNIT_ASSERT_EQUAL(SlowHandler::MARK, third->data[0][0]);
+}
+
+} // namespace test
+} // namespace jami
+
+RING_TEST_RUNNER(jami::test::PluginMediaStageTest::name())
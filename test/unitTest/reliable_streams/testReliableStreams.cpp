@@ -0,0 +1,392 @@
+/*
+ *  Copyright (C) 2004-2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "jamidht/reliable_streams.h"
+#include "scheduled_executor.h"
+#include "logger.h"
+#include "../../test_runner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace jami {
+namespace test {
+
+using clock = std::chrono::steady_clock;
+
+/**
+ * One direction of a simulated path: a bottleneck of a given rate with a drop-tail queue,
+ * random losses, a propagation delay and a path MTU. Datagrams are delivered by the
+ * executor's thread.
+ */
+class LossyLink
+{
+public:
+    struct Config
+    {
+        double loss {0};
+        std::chrono::milliseconds delay {25};
+        std::size_t rate {1000 * 1000}; // bytes per second
+        std::size_t queue {64 * 1024};  // bytes
+        std::size_t mtu {1400};
+    };
+
+    LossyLink(ScheduledExecutor& executor, const Config& config, unsigned seed)
+        : executor_(executor)
+        , config_(config)
+        , rand_(seed)
+        , mtu_(config.mtu)
+    {}
+
+    void setPeer(const std::shared_ptr<ReliableStreams>& peer) { peer_ = peer; }
+    void setMtu(std::size_t mtu) { mtu_ = mtu; }
+    int mtu() const { return mtu_; }
+
+    bool send(const uint8_t* data, std::size_t size)
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto now = clock::now();
+        free_ = std::max(free_, now);
+        auto queued = std::chrono::duration<double>(free_ - now).count() * config_.rate;
+        if (size > mtu_ or queued + size > config_.queue
+            or std::bernoulli_distribution(config_.loss)(rand_))
+            return true;
+        free_ += std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(double(size) / config_.rate));
+        executor_.schedule(
+            [w = peer_, datagram = std::vector<uint8_t>(data, data + size)] {
+                if (auto peer = w.lock())
+                    peer->onDatagram(datagram.data(), datagram.size());
+            },
+            free_ + config_.delay);
+        return true;
+    }
+
+private:
+    ScheduledExecutor& executor_;
+    Config config_;
+    std::mt19937 rand_;
+    std::mutex mutex_;
+    clock::time_point free_ {};
+    std::weak_ptr<ReliableStreams> peer_;
+    std::atomic<std::size_t> mtu_;
+};
+
+/**
+ * Two ReliableStreams connected by a LossyLink in each direction
+ */
+struct StreamsPair
+{
+    using OnMessage = ReliableStreams::OnMessage;
+
+    StreamsPair(const LossyLink::Config& config,
+                OnMessage&& onMessage,
+                OnMessage&& onMessageA = [](uint16_t, std::vector<uint8_t>&&) {})
+        : ab(linkExecutor, config, 1)
+        , ba(linkExecutor, config, 2)
+    {
+        a = std::make_shared<ReliableStreams>(
+            timerExecutor,
+            [this](const uint8_t* d, std::size_t s) { return ab.send(d, s); },
+            [this] { return ab.mtu(); },
+            std::move(onMessageA));
+        b = std::make_shared<ReliableStreams>(
+            timerExecutor,
+            [this](const uint8_t* d, std::size_t s) { return ba.send(d, s); },
+            [this] { return ba.mtu(); },
+            std::move(onMessage));
+        ab.setPeer(b);
+        ba.setPeer(a);
+    }
+
+    ~StreamsPair()
+    {
+        a->close();
+        b->close();
+        linkExecutor.stop();
+        timerExecutor.stop();
+    }
+
+    ScheduledExecutor linkExecutor;
+    ScheduledExecutor timerExecutor;
+    LossyLink ab;
+    LossyLink ba;
+    std::shared_ptr<ReliableStreams> a;
+    std::shared_ptr<ReliableStreams> b;
+};
+
+class ReliableStreamsTest : public CppUnit::TestFixture
+{
+public:
+    static std::string name() { return "reliable_streams"; }
+
+private:
+    void testOrderedDelivery();
+    void testMtuDecrease();
+    void testLatencyUnderBulkTransfer();
+    void testCloseChannel();
+    void testWriteFromHandler();
+
+    CPPUNIT_TEST_SUITE(ReliableStreamsTest);
+    CPPUNIT_TEST(testOrderedDelivery);
+    CPPUNIT_TEST(testMtuDecrease);
+    CPPUNIT_TEST(testLatencyUnderBulkTransfer);
+    CPPUNIT_TEST(testCloseChannel);
+    CPPUNIT_TEST(testWriteFromHandler);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(ReliableStreamsTest, ReliableStreamsTest::name());
+
+// Message i of a channel: i repeated, of a size depending on i (and 0 for the EOF)
+static std::vector<uint8_t>
+makeMessage(uint16_t channel, unsigned i, unsigned count)
+{
+    if (i == count)
+        return {};
+    return std::vector<uint8_t>(1 + (i * 7919u + channel * 104729u) % 6000, uint8_t(i));
+}
+
+static bool
+checkDelivery(LossyLink::Config config, std::function<void(StreamsPair&)> midway = {})
+{
+    static constexpr unsigned COUNT {300};
+    static constexpr uint16_t CHANNELS[] {0, 1, 0xffff};
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::map<uint16_t, unsigned> received;
+    bool valid = true;
+    StreamsPair pair(config, [&](uint16_t channel, std::vector<uint8_t>&& message) {
+        std::lock_guard<std::mutex> lk(mtx);
+        auto& i = received[channel];
+        valid &= message == makeMessage(channel, i, COUNT);
+        ++i;
+        cv.notify_all();
+    });
+
+    std::vector<std::thread> writers;
+    for (auto channel : CHANNELS)
+        writers.emplace_back([&, channel] {
+            std::error_code ec;
+            for (unsigned i = 0; i <= COUNT; ++i) {
+                auto message = makeMessage(channel, i, COUNT);
+                CPPUNIT_ASSERT(pair.a->send(channel, message.data(), message.size(), ec));
+                if (i == COUNT / 2 and channel == 1 and midway)
+                    midway(pair);
+            }
+        });
+    for (auto& writer : writers)
+        writer.join();
+
+    std::unique_lock<std::mutex> lk(mtx);
+    auto done = cv.wait_for(lk, std::chrono::seconds(60), [&] {
+        return std::all_of(std::begin(CHANNELS), std::end(CHANNELS), [&](uint16_t c) {
+            return received[c] == COUNT + 1;
+        });
+    });
+    JAMI_DBG("retransmissions: %lu, srtt: %ld ms",
+             static_cast<unsigned long>(pair.a->retransmissions()),
+             static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   pair.a->smoothedRtt())
+                                   .count()));
+    return done and valid;
+}
+
+void
+ReliableStreamsTest::testOrderedDelivery()
+{
+    LossyLink::Config config;
+    config.loss = 0.05;
+    config.rate = 4 * 1000 * 1000;
+    CPPUNIT_ASSERT(checkDelivery(config));
+}
+
+void
+ReliableStreamsTest::testMtuDecrease()
+{
+    // Ranges lost because of the new path MTU must be sent again in smaller datagrams
+    LossyLink::Config config;
+    config.loss = 0.01;
+    config.rate = 4 * 1000 * 1000;
+    CPPUNIT_ASSERT(checkDelivery(config, [](StreamsPair& pair) { pair.ab.setMtu(600); }));
+}
+
+/**
+ * Latency of small messages sent every 20 ms while a bulk transfer runs. With one channel
+ * per stream they do not wait behind the bulk data, as they would in a single ordered
+ * stream (one channel carrying both, like TCP).
+ */
+static std::vector<double>
+interactiveLatencies(bool sharedStream)
+{
+    static constexpr uint16_t BULK {1};
+    static constexpr unsigned PINGS {40};
+    const uint16_t interactive = sharedStream ? BULK : 2;
+
+    LossyLink::Config config;
+    config.loss = 0.02;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<double> latencies;
+    StreamsPair pair(config, [&](uint16_t, std::vector<uint8_t>&& message) {
+        if (message.size() != 1 + sizeof(clock::rep))
+            return; // bulk
+        clock::rep sent;
+        std::memcpy(&sent, message.data() + 1, sizeof(sent));
+        auto latency = clock::now() - clock::time_point(clock::duration(sent));
+        std::lock_guard<std::mutex> lk(mtx);
+        latencies.push_back(std::chrono::duration<double, std::milli>(latency).count());
+        cv.notify_all();
+    });
+
+    std::atomic_bool stop {false};
+    std::thread bulk([&] {
+        std::vector<uint8_t> data(16 * 1024, 'b');
+        std::error_code ec;
+        while (not stop and pair.a->send(BULK, data.data(), data.size(), ec))
+            ;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    for (unsigned i = 0; i < PINGS; ++i) {
+        std::vector<uint8_t> ping(1 + sizeof(clock::rep), 'p');
+        auto now = clock::now().time_since_epoch().count();
+        std::memcpy(ping.data() + 1, &now, sizeof(now));
+        std::error_code ec;
+        pair.a->send(interactive, ping.data(), ping.size(), ec);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    {
+        std::unique_lock<std::mutex> lk(mtx);
+        cv.wait_for(lk, std::chrono::seconds(30), [&] { return latencies.size() == PINGS; });
+    }
+    stop = true;
+    pair.a->close();
+    bulk.join();
+
+    std::lock_guard<std::mutex> lk(mtx);
+    std::sort(latencies.begin(), latencies.end());
+    return latencies;
+}
+
+void
+ReliableStreamsTest::testLatencyUnderBulkTransfer()
+{
+    auto perChannel = interactiveLatencies(false);
+    auto shared = interactiveLatencies(true);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(40), perChannel.size());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(40), shared.size());
+
+    auto percentile = [](const std::vector<double>& v, double p) {
+        return v[std::min(v.size() - 1, std::size_t(p * v.size()))];
+    };
+    JAMI_DBG("Interactive latency (ms) over 2%% loss, 25 ms delay, 1 MB/s: per-channel streams "
+             "median %.1f, p95 %.1f; single stream median %.1f, p95 %.1f",
+             percentile(perChannel, 0.5),
+             percentile(perChannel, 0.95),
+             percentile(shared, 0.5),
+             percentile(shared, 0.95));
+    CPPUNIT_ASSERT(percentile(perChannel, 0.5) < percentile(shared, 0.5));
+    CPPUNIT_ASSERT(percentile(perChannel, 0.95) < percentile(shared, 0.95));
+}
+
+void
+ReliableStreamsTest::testCloseChannel()
+{
+    // A closed channel is forgotten: its number starts a new stream
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<std::vector<uint8_t>> received;
+    StreamsPair pair({}, [&](uint16_t, std::vector<uint8_t>&& message) {
+        std::lock_guard<std::mutex> lk(mtx);
+        received.emplace_back(std::move(message));
+        cv.notify_all();
+    });
+
+    auto sendAndWait = [&](const std::vector<uint8_t>& message) {
+        std::error_code ec;
+        CPPUNIT_ASSERT(pair.a->send(1, message.data(), message.size(), ec));
+        std::unique_lock<std::mutex> lk(mtx);
+        CPPUNIT_ASSERT(cv.wait_for(lk, std::chrono::seconds(10), [&] {
+            return not received.empty() and received.back() == message;
+        }));
+    };
+    sendAndWait(std::vector<uint8_t>(3000, 'a'));
+    sendAndWait({});
+    pair.a->closeChannel(1);
+    pair.b->closeChannel(1);
+
+    sendAndWait(std::vector<uint8_t>(10, 'b'));
+    std::lock_guard<std::mutex> lk(mtx);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), received.size());
+}
+
+void
+ReliableStreamsTest::testWriteFromHandler()
+{
+    // Like the git server, answers a request with more than the send buffer. The ACKs of
+    // the answer are read by the thread that delivered the request.
+    static constexpr std::size_t ANSWER {3 * ReliableStreams::SEND_BUFFER};
+    static constexpr std::size_t CHUNK {16 * 1024};
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::size_t received {0};
+    bool answered {false};
+    StreamsPair* pairPtr {nullptr};
+    StreamsPair pair(
+        {},
+        [&](uint16_t channel, std::vector<uint8_t>&&) {
+            std::vector<uint8_t> chunk(CHUNK, 'g');
+            std::error_code ec;
+            for (std::size_t sent = 0; sent < ANSWER; sent += CHUNK)
+                if (not pairPtr->b->send(channel, chunk.data(), chunk.size(), ec))
+                    return;
+            std::lock_guard<std::mutex> lk(mtx);
+            answered = true;
+            cv.notify_all();
+        },
+        [&](uint16_t, std::vector<uint8_t>&& message) {
+            std::lock_guard<std::mutex> lk(mtx);
+            received += message.size();
+            cv.notify_all();
+        });
+    pairPtr = &pair;
+
+    std::vector<uint8_t> request(100, 'r');
+    std::error_code ec;
+    CPPUNIT_ASSERT(pair.a->send(1, request.data(), request.size(), ec));
+    std::unique_lock<std::mutex> lk(mtx);
+    CPPUNIT_ASSERT(cv.wait_for(lk, std::chrono::seconds(30), [&] {
+        return answered and received == ANSWER;
+    }));
+}
+
+} // namespace test
+} // namespace jami
+
+RING_TEST_RUNNER(jami::test::ReliableStreamsTest::name())
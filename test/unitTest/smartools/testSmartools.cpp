@@ -33,10 +33,12 @@ public:
 private:
     void testSetLocalInformation();
     void testSetRemoteInformation();
+    void testCallSetupPercentiles();
 
     CPPUNIT_TEST_SUITE(SmartoolsTest);
     CPPUNIT_TEST(testSetLocalInformation);
     CPPUNIT_TEST(testSetRemoteInformation);
+    CPPUNIT_TEST(testCallSetupPercentiles);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -95,6 +97,27 @@ SmartoolsTest::testSetRemoteInformation()
     CPPUNIT_ASSERT(Smartools::getInstance().information_.empty());
 }
 
+void
+SmartoolsTest::testCallSetupPercentiles()
+{
+    for (int i = 1; i <= 100; i++)
+        Smartools::getInstance().addCallSetupTimeline(
+            {{"ICE_CHECK", std::chrono::milliseconds(i)},
+             {"FIRST_FRAME", std::chrono::milliseconds(10 * i)}});
+
+    auto percentiles = Smartools::getInstance().getSetupPercentiles();
+    CPPUNIT_ASSERT(percentiles.size() == 6);
+    CPPUNIT_ASSERT(percentiles["setup ICE_CHECK p50"] == "50");
+    CPPUNIT_ASSERT(percentiles["setup ICE_CHECK p90"] == "90");
+    CPPUNIT_ASSERT(percentiles["setup ICE_CHECK p99"] == "99");
+    CPPUNIT_ASSERT(percentiles["setup FIRST_FRAME p99"] == "990");
+
+    // Samples are kept across reports, only information_ is cleared
+    Smartools::getInstance().sendInfo();
+    CPPUNIT_ASSERT(Smartools::getInstance().information_.empty());
+    CPPUNIT_ASSERT(Smartools::getInstance().getSetupPercentiles() == percentiles);
+}
+
 } // namespace jami
 
 RING_TEST_RUNNER(jami::SmartoolsTest::name())